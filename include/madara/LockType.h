@@ -24,6 +24,12 @@ struct null_mutex
 #define MADARA_LOCK_TYPE madara::null_mutex
 #define MADARA_LOCK_LOCK lock
 #define MADARA_LOCK_UNLOCK unlock
+#elif defined _MADARA_PROFILE_LOCK_
+#include "madara/utility/LockProfiler.h"
+
+#define MADARA_LOCK_TYPE madara::utility::ProfiledMutex
+#define MADARA_LOCK_LOCK lock
+#define MADARA_LOCK_UNLOCK unlock
 #else
 #define MADARA_LOCK_TYPE std::recursive_mutex
 #define MADARA_LOCK_LOCK lock
@@ -197,6 +197,7 @@ madara::expression::CompositeArrayReference::dec(
       record->quality = record->write_quality;
 
     knowledge::KnowledgeRecord result(record->dec_index(index));
+    record->set_toi(utility::get_time());
 
     context_.mark_and_signal(ref_);
 
@@ -239,6 +240,7 @@ madara::expression::CompositeArrayReference::inc(
       record->quality = record->write_quality;
 
     knowledge::KnowledgeRecord result(record->inc_index(index));
+    record->set_toi(utility::get_time());
 
     context_.mark_and_signal(ref_);
 
@@ -294,6 +296,7 @@ int madara::expression::CompositeArrayReference::set(
       record->quality = record->write_quality;
 
     record->set_index(index, value);
+    record->set_toi(utility::get_time());
 
     context_.mark_and_signal(ref_);
 
@@ -323,6 +326,7 @@ int madara::expression::CompositeArrayReference::set(
       record->quality = record->write_quality;
 
     record->set_index(index, value);
+    record->set_toi(utility::get_time());
 
     context_.mark_and_signal(ref_);
 
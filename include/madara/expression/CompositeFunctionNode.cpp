@@ -20,6 +20,7 @@
 #ifdef _MADARA_PYTHON_CALLBACKS_
 
 #include <boost/python/call.hpp>
+#include "madara/python/Acquire_GIL.h"
 
 #endif
 
@@ -196,9 +197,14 @@ madara::expression::CompositeFunctionNode::evaluate(
 
 #ifdef _MADARA_PYTHON_CALLBACKS_
   else if (function_->is_python_callable())
+  {
+    // the caller may have released the GIL, e.g., during a Python wait
+    madara::python::Acquire_GIL acquire_gil;
+
     return boost::python::call<madara::knowledge::KnowledgeRecord>(
         function_->python_function.ptr(), boost::ref(args),
         boost::ref(variables));
+  }
 #endif
 
   else if (function_->is_uninitialized())
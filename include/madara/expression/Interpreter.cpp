@@ -5587,6 +5587,73 @@ void madara::expression::Interpreter::system_call_insert(
         {
           call = new Tan(context);
         }
+        else if (name == "#time_series")
+        {
+          using namespace madara::knowledge;
+
+          call = new GenericSystemCall(context, "#time_series",
+              [&context](std::vector<KnowledgeRecord> recs) -> KnowledgeRecord {
+                if (recs.size() < 2 || recs.size() > 4)
+                {
+                  throw exceptions::KarlException(
+                      "#time_series: expects a variable name, a statistic, "
+                      "and optionally a start and end time");
+                }
+
+                std::string key = recs[0].to_string();
+                std::string stat = recs[1].to_string();
+                uint64_t start =
+                    recs.size() > 2 ? (uint64_t)recs[2].to_integer() : 0;
+                uint64_t end = recs.size() > 3
+                                   ? (uint64_t)recs[3].to_integer()
+                                   : std::numeric_limits<uint64_t>::max();
+
+                if (stat == "values" || stat == "times")
+                {
+                  std::vector<double> values;
+                  std::vector<KnowledgeRecord::Integer> times;
+
+                  context.for_time_series(key,
+                      [&](uint64_t toi, double value) {
+                        values.push_back(value);
+                        times.push_back((KnowledgeRecord::Integer)toi);
+                      },
+                      start, end);
+
+                  return stat == "values" ? KnowledgeRecord(std::move(values))
+                                          : KnowledgeRecord(std::move(times));
+                }
+
+                TimeSeries::Window window =
+                    context.summarize_time_series(key, start, end);
+
+                if (stat == "count")
+                {
+                  return KnowledgeRecord(
+                      (KnowledgeRecord::Integer)window.count);
+                }
+                else if (stat == "min")
+                {
+                  return KnowledgeRecord(window.min);
+                }
+                else if (stat == "max")
+                {
+                  return KnowledgeRecord(window.max);
+                }
+                else if (stat == "sum")
+                {
+                  return KnowledgeRecord(window.sum);
+                }
+                else if (stat == "mean")
+                {
+                  return KnowledgeRecord(window.mean);
+                }
+
+                throw exceptions::KarlException("#time_series: unknown "
+                                                "statistic " +
+                                                stat);
+              });
+        }
         else if (name == "#to_buffer")
         {
           call = new ToBuffer(context);
@@ -6638,10 +6705,27 @@ void madara::expression::Interpreter::handle_parenthesis(
 madara::expression::ExpressionTree madara::expression::Interpreter::interpret(
     knowledge::ThreadSafeContext& context, const std::string& input)
 {
+  if (!cache_hits_metric_)
+  {
+    utility::Metrics& metrics = context.get_metrics();
+    cache_hits_metric_ = &metrics.counter(
+        "interpreter.cache_hits", "Compiles served from the expression cache");
+    cache_misses_metric_ = &metrics.counter(
+        "interpreter.cache_misses", "Compiles that parsed the expression");
+    compile_metric_ = &metrics.histogram(
+        "interpreter.compile_ns", "Nanoseconds spent parsing expressions");
+  }
+
   // return the cached expression tree if it exists
   ExpressionTreeMap::const_iterator found = cache_.find(input);
   if (found != cache_.end())
+  {
+    cache_hits_metric_->add();
     return found->second;
+  }
+
+  cache_misses_metric_->add();
+  int64_t start = utility::get_time();
 
   ::std::list<Symbol*> list;
   // list.clear ();
@@ -6699,6 +6783,8 @@ madara::expression::ExpressionTree madara::expression::Interpreter::interpret(
     // store this optimized tree into cached memory
     cache_[input] = tree;
 
+    compile_metric_->record(utility::get_time() - start);
+
     return tree;
   }
 
@@ -253,6 +253,15 @@ private:
    * Cache of expressions that have been previously compiled
    **/
   ExpressionTreeMap cache_;
+
+  /// compiles served from cache_, from the first context compiled with
+  utility::Metrics::Counter* cache_hits_metric_ = nullptr;
+
+  /// compiles that parsed the expression
+  utility::Metrics::Counter* cache_misses_metric_ = nullptr;
+
+  /// nanoseconds spent parsing expressions that were not cached
+  utility::Metrics::Histogram* compile_metric_ = nullptr;
 };
 }
 }
@@ -227,6 +227,16 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
     calls_["#tan"] = "\n#tan (value):\n"
                      "  Returns the tangent of a term (radians)\n";
 
+    calls_["#time_series"] =
+        "\n#time_series (var, statistic) or\n"
+        "  #time_series (var, statistic, start) or\n"
+        "  #time_series (var, statistic, start, end):\n"
+        "  Returns a statistic of the columnar history of a variable between\n"
+        "  two times in nanoseconds, e.g., #get_time () - 1000000000.\n"
+        "  Statistics are 'count', 'min', 'max', 'sum', 'mean', and 'values'\n"
+        "  or 'times', which return arrays of the samples. History is kept\n"
+        "  with KnowledgeBase::set_time_series_capacity.\n";
+
     calls_["#to_buffer"] = "\n#to_buffer (value) or #buffer (value):\n"
                            "  Converts the value to an unsigned char array.\n";
 
@@ -336,6 +336,7 @@ int madara::expression::VariableNode::set(
           key_.c_str());
 
       *record = value;
+      record->set_toi(utility::get_time());
 
       context_.mark_and_signal(ref);
     }
@@ -396,6 +397,7 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::dec(
       record->quality = record->write_quality;
 
     --(*record);
+    record->set_toi(utility::get_time());
 
     std::string expanded_key(expand_key());
     context_.mark_and_signal(ref_);
@@ -424,6 +426,7 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::inc(
       record->quality = record->write_quality;
 
     ++(*record);
+    record->set_toi(utility::get_time());
 
     std::string expanded_key(expand_key());
     context_.mark_and_signal(ref_);
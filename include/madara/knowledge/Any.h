@@ -387,16 +387,8 @@ public:
    **/
   size_t tagged_unserialize(const char* data, size_t size)
   {
-    namespace bio = boost::iostreams;
-
-    bio::array_source input_source(data, size);
-    bio::stream<bio::array_source> input_stream(input_source);
-
-    auto pos = input_stream.tellg();
-    madara_iarchive archive(input_stream);
     std::string tag;
-    archive >> tag;
-    auto len = input_stream.tellg() - pos;
+    size_t len = AnyRegistry::read_tag(data, size, tag);
 
     unserialize(tag.c_str(), data + len, size - len);
 
@@ -1,4 +1,10 @@
+#include <atomic>
+#include <string.h>
+
 #include "Any.h"
+#include "BufferArchive.h"
+#include "madara/exceptions/MemoryException.h"
+#include "madara/utility/Utility.h"
 
 #include "capnp/schema.h"
 
@@ -8,10 +14,30 @@ using namespace knowledge;
 static std::map<const char*, const TypeHandlers*, compare_const_char_ptr>
     type_builders;
 
+/// tags by compact id, or nullptr if more than one tag has the same id
+static std::map<uint32_t, const char*> type_ids;
+
+static std::atomic<bool> send_ids(false);
+
+static void register_type_id(const char* tag)
+{
+  auto result = type_ids.emplace(AnyRegistry::get_type_id(tag), tag);
+  if (!result.second && result.first->second &&
+      strcmp(result.first->second, tag) != 0)
+  {
+    result.first->second = nullptr;
+  }
+}
+
 bool AnyRegistry::register_type_impl(
     const char* tag, const TypeHandlers* handler)
 {
-  return type_builders.emplace(tag, handler).second;
+  bool result = type_builders.emplace(tag, handler).second;
+  if (result)
+  {
+    register_type_id(tag);
+  }
+  return result;
 }
 
 static std::map<const char*, capnp::StructSchema, compare_const_char_ptr>
@@ -20,7 +46,12 @@ static std::map<const char*, capnp::StructSchema, compare_const_char_ptr>
 bool AnyRegistry::register_schema(
     const char* tag, const capnp::StructSchema& schema)
 {
-  return schemas.emplace(tag, schema).second;
+  bool result = schemas.emplace(tag, schema).second;
+  if (result)
+  {
+    register_type_id(tag);
+  }
+  return result;
 }
 
 const std::pair<const char* const, capnp::StructSchema>&
@@ -35,6 +66,16 @@ AnyRegistry::lookup_schema(const char* tag)
   return *iter;
 }
 
+bool AnyRegistry::is_capn_tag(const char* tag)
+{
+  auto biter = type_builders.find(tag);
+  if (biter != type_builders.end())
+  {
+    return biter->second->get_reader != nullptr;
+  }
+  return true;
+}
+
 Any AnyRegistry::construct(const char* tag)
 {
   auto biter = type_builders.find(tag);
@@ -55,3 +96,161 @@ inline ConstAny AnyRegistry::construct_const(const char* tag)
 {
   return construct(tag);
 }
+
+uint32_t AnyRegistry::get_type_id(const char* tag)
+{
+  uint32_t hash = 2166136261u;
+  for (; *tag; ++tag)
+  {
+    hash ^= (uint8_t)*tag;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+const char* AnyRegistry::lookup_type_id(uint32_t id)
+{
+  auto iter = type_ids.find(id);
+  return iter == type_ids.end() ? nullptr : iter->second;
+}
+
+void AnyRegistry::set_send_type_ids(bool enabled)
+{
+  send_ids = enabled;
+}
+
+bool AnyRegistry::send_type_ids(void)
+{
+  return send_ids;
+}
+
+namespace
+{
+/// size of a tag written as a compact id
+const size_t TYPE_ID_SIZE = 1 + sizeof(uint32_t);
+
+/// size of the endian flag and length written before a tag string
+const size_t TAG_HEADER_SIZE = 1 + sizeof(uint64_t);
+
+/// checks if a tag should be written as a compact id
+bool use_type_id(const char* tag, uint32_t& id)
+{
+  if (!send_ids)
+  {
+    return false;
+  }
+
+  id = AnyRegistry::get_type_id(tag);
+  const char* found = AnyRegistry::lookup_type_id(id);
+  return found != nullptr && strcmp(found, tag) == 0;
+}
+
+/// writes a tag in the portable binary format of a std::string, followed
+/// by pad NULs, or as a compact id. The buffer must fit the tag.
+size_t write_tag_impl(const char* tag, size_t len, size_t pad, bool compact,
+    uint32_t id, char* data)
+{
+  if (compact)
+  {
+    data[0] = AnyRegistry::TYPE_ID_MARKER;
+    id = madara::utility::endian_swap(id);
+    memcpy(data + 1, &id, sizeof(id));
+    return TYPE_ID_SIZE;
+  }
+
+  uint64_t size = len + pad;
+  data[0] = (char)cereal::portable_binary_detail::is_little_endian();
+  memcpy(data + 1, &size, sizeof(size));
+  memcpy(data + TAG_HEADER_SIZE, tag, len);
+  memset(data + TAG_HEADER_SIZE + len, 0, pad);
+  return TAG_HEADER_SIZE + len + pad;
+}
+}
+
+size_t AnyRegistry::write_tag(
+    const char* tag, char* data, size_t size, size_t align)
+{
+  uint32_t id = 0;
+  bool compact = use_type_id(tag, id);
+
+  // ids cannot be padded, so a misaligned id is written as a string
+  if (compact && align != 0 && ((uintptr_t)data + TYPE_ID_SIZE) % align != 0)
+  {
+    compact = false;
+  }
+
+  size_t len = compact ? 0 : strlen(tag);
+  size_t pad = 0;
+
+  if (!compact && align != 0)
+  {
+    pad = (align - ((uintptr_t)data + TAG_HEADER_SIZE + len) % align) % align;
+  }
+
+  if ((compact ? TYPE_ID_SIZE : TAG_HEADER_SIZE + len + pad) > size)
+  {
+    throw exceptions::MemoryException(
+        std::string("AnyRegistry::write_tag: buffer too small for tag ") +
+        tag);
+  }
+
+  return write_tag_impl(tag, len, pad, compact, id, data);
+}
+
+size_t AnyRegistry::write_tag(const char* tag, std::vector<char>& vec)
+{
+  uint32_t id = 0;
+  bool compact = use_type_id(tag, id);
+  size_t len = compact ? 0 : strlen(tag);
+
+  size_t start = vec.size();
+  vec.resize(start + (compact ? TYPE_ID_SIZE : TAG_HEADER_SIZE + len));
+
+  return write_tag_impl(tag, len, 0, compact, id, vec.data() + start);
+}
+
+size_t AnyRegistry::read_tag(const char* data, size_t size, std::string& tag)
+{
+  if (size > 0 && data[0] == TYPE_ID_MARKER)
+  {
+    uint32_t id;
+    if (size < TYPE_ID_SIZE)
+    {
+      throw exceptions::BadAnyAccess("Any type id is truncated");
+    }
+
+    memcpy(&id, data + 1, sizeof(id));
+    id = madara::utility::endian_swap(id);
+
+    const char* found = lookup_type_id(id);
+    if (found == nullptr)
+    {
+      throw exceptions::BadAnyAccess(
+          "Any type id " + std::to_string(id) + " is not registered");
+    }
+
+    tag = found;
+    return TYPE_ID_SIZE;
+  }
+
+  uint64_t len;
+  if (size < TAG_HEADER_SIZE)
+  {
+    throw exceptions::BadAnyAccess("Any tag is truncated");
+  }
+
+  memcpy(&len, data + 1, sizeof(len));
+  if ((uint8_t)data[0] != cereal::portable_binary_detail::is_little_endian())
+  {
+    cereal::portable_binary_detail::swap_bytes<sizeof(len)>(
+        reinterpret_cast<uint8_t*>(&len));
+  }
+
+  if (len > size - TAG_HEADER_SIZE)
+  {
+    throw exceptions::BadAnyAccess("Any tag is truncated");
+  }
+
+  tag.assign(data + TAG_HEADER_SIZE, (size_t)len);
+  return TAG_HEADER_SIZE + (size_t)len;
+}
@@ -12,6 +12,8 @@
 
 #include <memory>
 #include <map>
+#include <string>
+#include <vector>
 #include <functional>
 #include <type_traits>
 
@@ -87,6 +89,90 @@ public:
   static Any construct(const char* name);
   static ConstAny construct_const(const char* name);
 
+  /// First byte of a tag written as a compact type id, which follows in
+  /// network byte order. Tag strings begin with the endian flag of the
+  /// portable binary format, which is 0 or 1.
+  static const char TYPE_ID_MARKER = 2;
+
+  /**
+   * Gets the compact id of a tag, which is a 32 bit FNV-1a hash of the tag
+   * string. The same tag has the same id in every process.
+   *
+   * @param tag the tag of a registered type or schema
+   * @return the id of the tag
+   **/
+  static uint32_t get_type_id(const char* tag);
+
+  /**
+   * Looks up the tag that a compact id was computed from
+   *
+   * @param id the id of a tag, from get_type_id
+   * @return the registered tag, or nullptr if no registered tag, or more
+   *   than one, has this id
+   **/
+  static const char* lookup_type_id(uint32_t id);
+
+  /**
+   * Sets whether tagged serialization writes registered tags as compact
+   * type ids instead of strings. Off by default, since processes built
+   * before type ids existed cannot read them. Every reader must register
+   * the same tags as the writer.
+   *
+   * @param enabled true to write compact type ids
+   **/
+  static void set_send_type_ids(bool enabled);
+
+  /**
+   * Checks whether tagged serialization writes compact type ids
+   **/
+  static bool send_type_ids(void);
+
+  /**
+   * Writes a type tag, as a compact id if send_type_ids() is enabled and
+   * the tag is registered, and otherwise as a portable binary string.
+   * Throws an exception if the buffer size is insufficient.
+   *
+   * @param tag the tag to write
+   * @param data the buffer to write to
+   * @param size size of the buffer
+   * @param align if nonzero, the string is padded with NULs, which readers
+   *   ignore, so the bytes after the tag start at a multiple of align
+   * @return the number of bytes written
+   **/
+  static size_t write_tag(
+      const char* tag, char* data, size_t size, size_t align = 0);
+
+  /**
+   * Appends a type tag to a vector, in the same format as the buffer
+   * version of write_tag
+   *
+   * @param tag the tag to write
+   * @param vec the vector to append to
+   * @return the number of bytes written
+   **/
+  static size_t write_tag(const char* tag, std::vector<char>& vec);
+
+  /**
+   * Reads a type tag written by write_tag. Throws BadAnyAccess if the tag
+   * is a compact id that is not registered in this process.
+   *
+   * @param data the buffer to read from
+   * @param size size of the buffer
+   * @param tag the tag that was read
+   * @return the number of bytes read
+   **/
+  static size_t read_tag(const char* data, size_t size, std::string& tag);
+
+  /**
+   * Checks if values with a tag are Cap'n Proto messages, which is true of
+   * registered schemas and Cap'n Proto types, and of unregistered tags,
+   * which are read as GenericCapnObject
+   *
+   * @param tag the tag to check
+   * @return true if the tag names a Cap'n Proto message
+   **/
+  static bool is_capn_tag(const char* tag);
+
 protected:
   static bool register_type_impl(const char* name, const TypeHandlers* handler);
 
@@ -0,0 +1,291 @@
+#include "ArrayDelta.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+#include "madara/exceptions/MemoryException.h"
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace
+{
+/// writes a value in network byte order and advances the buffer
+template<typename T>
+inline void write_value(char*& buffer, T value)
+{
+  value = madara::utility::endian_swap(value);
+  memcpy(buffer, &value, sizeof(value));
+  buffer += sizeof(value);
+}
+
+/// reads a value in host byte order if enough bytes remain
+template<typename T>
+inline bool read_value(const char*& buffer, int64_t& buffer_remaining, T& value)
+{
+  if (buffer_remaining < (int64_t)sizeof(value))
+  {
+    buffer_remaining = -1;
+    return false;
+  }
+
+  memcpy(&value, buffer, sizeof(value));
+  value = madara::utility::endian_swap(value);
+  buffer += sizeof(value);
+  buffer_remaining -= sizeof(value);
+
+  return true;
+}
+}
+
+void ArrayDelta::add_index(Ranges& ranges, uint32_t index)
+{
+  // the first range starting after the index
+  auto next = std::upper_bound(ranges.begin(), ranges.end(), index,
+      [](uint32_t lhs, const Range& rhs) { return lhs < rhs.first; });
+
+  bool joins_prev = false;
+
+  if (next != ranges.begin())
+  {
+    auto prev = next - 1;
+    uint64_t prev_end = (uint64_t)prev->first + prev->second;
+
+    if (index < prev_end)
+    {
+      return;
+    }
+
+    joins_prev = index == prev_end;
+  }
+
+  bool joins_next = next != ranges.end() && next->first == index + 1;
+
+  if (joins_prev && joins_next)
+  {
+    (next - 1)->second += 1 + next->second;
+    ranges.erase(next);
+  }
+  else if (joins_prev)
+  {
+    ++(next - 1)->second;
+  }
+  else if (joins_next)
+  {
+    next->first = index;
+    ++next->second;
+  }
+  else
+  {
+    ranges.insert(next, Range(index, 1));
+  }
+}
+
+size_t ArrayDelta::count(const Ranges& ranges)
+{
+  size_t result = 0;
+
+  for (const Range& range : ranges)
+  {
+    result += range.second;
+  }
+
+  return result;
+}
+
+bool ArrayDelta::is_delta(const char* buffer, int64_t buffer_remaining)
+{
+  uint32_t key_size = 0;
+  uint32_t type = 0;
+
+  if (!read_value(buffer, buffer_remaining, key_size) ||
+      buffer_remaining < (int64_t)key_size)
+  {
+    return false;
+  }
+
+  buffer += key_size;
+  buffer_remaining -= key_size;
+
+  return read_value(buffer, buffer_remaining, type) && type == TYPE;
+}
+
+int64_t ArrayDelta::get_encoded_size(const std::string& key) const
+{
+  // key size, key, type, value size, toi, array type, array size,
+  // base toi, range count, ranges and values
+  return sizeof(uint32_t) + key.size() + 1 + sizeof(uint32_t) * 2 +
+         sizeof(uint64_t) + sizeof(uint32_t) * 2 + sizeof(uint64_t) +
+         sizeof(uint32_t) + ranges.size() * sizeof(uint32_t) * 2 +
+         count(ranges) * sizeof(uint64_t);
+}
+
+char* ArrayDelta::write(char* buffer, const std::string& key,
+    const KnowledgeRecord& record, int64_t& buffer_remaining) const
+{
+  int64_t encoded_size = get_encoded_size(key);
+
+  if (buffer_remaining < encoded_size)
+  {
+    std::stringstream message;
+    message << "ArrayDelta::write: ";
+    message << encoded_size << " byte encoding cannot fit in ";
+    message << buffer_remaining << " byte buffer\n";
+
+    throw exceptions::MemoryException(message.str());
+  }
+
+  write_value(buffer, uint32_t(key.size() + 1));
+  memcpy(buffer, key.c_str(), key.size() + 1);
+  buffer += key.size() + 1;
+
+  write_value(buffer, TYPE);
+  write_value(buffer, uint32_t(count(ranges)));
+  write_value(buffer, toi);
+  write_value(buffer, type);
+  write_value(buffer, size);
+  write_value(buffer, base_toi);
+  write_value(buffer, uint32_t(ranges.size()));
+
+  for (const Range& range : ranges)
+  {
+    write_value(buffer, range.first);
+    write_value(buffer, range.second);
+  }
+
+  auto integers = record.share_integers();
+  auto doubles = record.share_doubles();
+
+  for (const Range& range : ranges)
+  {
+    for (uint32_t i = range.first; i < range.first + range.second; ++i)
+    {
+      uint64_t bits = 0;
+
+      if (integers)
+      {
+        memcpy(&bits, &(*integers)[i], sizeof(bits));
+      }
+      else
+      {
+        memcpy(&bits, &(*doubles)[i], sizeof(bits));
+      }
+
+      write_value(buffer, bits);
+    }
+  }
+
+  buffer_remaining -= encoded_size;
+
+  return buffer;
+}
+
+const char* ArrayDelta::read(
+    const char* buffer, std::string& key, int64_t& buffer_remaining)
+{
+  uint32_t key_size = 0;
+
+  if (!read_value(buffer, buffer_remaining, key_size) || key_size == 0 ||
+      buffer_remaining < (int64_t)key_size)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  key.assign(buffer, key_size - 1);
+  buffer += key_size;
+  buffer_remaining -= key_size;
+
+  uint32_t delta_type = 0;
+  uint32_t value_count = 0;
+  uint32_t range_count = 0;
+
+  if (!read_value(buffer, buffer_remaining, delta_type) ||
+      !read_value(buffer, buffer_remaining, value_count) ||
+      !read_value(buffer, buffer_remaining, toi) ||
+      !read_value(buffer, buffer_remaining, type) ||
+      !read_value(buffer, buffer_remaining, size) ||
+      !read_value(buffer, buffer_remaining, base_toi) ||
+      !read_value(buffer, buffer_remaining, range_count))
+  {
+    return buffer;
+  }
+
+  // check the sizes before allocating anything
+  if (delta_type != TYPE ||
+      (type != KnowledgeRecord::INTEGER_ARRAY &&
+          type != KnowledgeRecord::DOUBLE_ARRAY) ||
+      buffer_remaining < (int64_t)range_count * 8 + (int64_t)value_count * 8)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  ranges.resize(range_count);
+
+  uint64_t total = 0;
+
+  for (Range& range : ranges)
+  {
+    read_value(buffer, buffer_remaining, range.first);
+    read_value(buffer, buffer_remaining, range.second);
+
+    total += range.second;
+
+    if ((uint64_t)range.first + range.second > size)
+    {
+      buffer_remaining = -1;
+      return buffer;
+    }
+  }
+
+  if (total != value_count)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  values.resize(value_count);
+
+  for (uint64_t& value : values)
+  {
+    read_value(buffer, buffer_remaining, value);
+  }
+
+  return buffer;
+}
+
+bool ArrayDelta::patch(KnowledgeRecord& record) const
+{
+  if (record.has_history() || record.type() != type || record.size() != size)
+  {
+    return false;
+  }
+
+  size_t value = 0;
+
+  for (const Range& range : ranges)
+  {
+    for (uint32_t i = range.first; i < range.first + range.second; ++i)
+    {
+      if (type == KnowledgeRecord::INTEGER_ARRAY)
+      {
+        KnowledgeRecord::Integer element;
+        memcpy(&element, &values[value++], sizeof(element));
+        record.set_index(i, element);
+      }
+      else
+      {
+        double element;
+        memcpy(&element, &values[value++], sizeof(element));
+        record.set_index(i, element);
+      }
+    }
+  }
+
+  return true;
+}
+}
+}
@@ -0,0 +1,170 @@
+#ifndef _MADARA_KNOWLEDGE_ARRAY_DELTA_H_
+#define _MADARA_KNOWLEDGE_ARRAY_DELTA_H_
+
+/**
+ * @file ArrayDelta.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ArrayDelta class, which encodes the changed
+ * elements of an array record for transport
+ **/
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "madara/MadaraExport.h"
+#include "madara/utility/IntTypes.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class ArrayDelta
+ * @brief The elements of an integer or double array that changed since
+ *        the array was last sent. A delta names the sender's toi of the
+ *        array it was made from, and receivers apply it only to a copy
+ *        received with that toi and unchanged since. Receivers that missed
+ *        an update, or changed the array locally, drop deltas until the
+ *        next full update of the array.
+ *
+ *        Encoded format is [key_size | key | type | value_size | toi |
+ *        array type | array size | base toi | range count |
+ *        ranges as (start, count) | values], where type is ArrayDelta::TYPE
+ *        and value_size is the number of changed elements.
+ **/
+class MADARA_EXPORT ArrayDelta
+{
+public:
+  /// a run of changed elements as (first index, number of elements)
+  typedef std::pair<uint32_t, uint32_t> Range;
+
+  /// sorted, disjoint and nonadjacent runs of changed elements
+  typedef std::vector<Range> Ranges;
+
+  /// the type code of an encoded delta
+  static const uint32_t TYPE = 0x40000000;
+
+  /**
+   * Adds an index to a list of ranges, merging neighboring ranges
+   * @param  ranges  the ranges to update
+   * @param  index   the changed index
+   **/
+  static void add_index(Ranges& ranges, uint32_t index);
+
+  /**
+   * Counts the elements in a list of ranges
+   * @param  ranges  the ranges
+   * @return  the number of elements
+   **/
+  static size_t count(const Ranges& ranges);
+
+  /**
+   * Checks if the next update in a buffer is an encoded delta
+   * @param  buffer            the start of the update
+   * @param  buffer_remaining  the bytes left in the buffer
+   * @return  true if the update is a delta
+   **/
+  static bool is_delta(const char* buffer, int64_t buffer_remaining);
+
+  /**
+   * Returns the encoded size of the delta
+   * @param  key     the name of the array
+   * @return  the bytes needed by write
+   **/
+  int64_t get_encoded_size(const std::string& key) const;
+
+  /**
+   * Encodes the delta, reading the changed elements from the record
+   * @param  buffer            the buffer to write to
+   * @param  key               the name of the array
+   * @param  record            the array after the changes
+   * @param  buffer_remaining  the bytes left in the buffer, decreased by
+   *                           the bytes written
+   * @return  the position after the delta
+   * @throw exceptions::MemoryException  if the buffer is too small
+   **/
+  char* write(char* buffer, const std::string& key,
+      const KnowledgeRecord& record, int64_t& buffer_remaining) const;
+
+  /**
+   * Decodes a delta
+   * @param  buffer            the buffer to read from
+   * @param  key               the name of the array
+   * @param  buffer_remaining  the bytes left in the buffer, decreased by
+   *                           the bytes read. Negative if the delta is
+   *                           malformed.
+   * @return  the position after the delta
+   **/
+  const char* read(
+      const char* buffer, std::string& key, int64_t& buffer_remaining);
+
+  /**
+   * Changes the elements of an array to the decoded values, in place
+   * unless the array is shared with other records
+   * @param  record  the receiver's copy of the array the delta was made
+   *                 from. The toi is left to the caller.
+   * @return  false if the record does not have the type and size of the
+   *          array the delta was made from
+   **/
+  bool patch(KnowledgeRecord& record) const;
+
+  /// the type of the array, INTEGER_ARRAY or DOUBLE_ARRAY
+  uint32_t type = 0;
+
+  /// the number of elements in the array
+  uint32_t size = 0;
+
+  /// the sender's toi of the array the delta was made from
+  uint64_t base_toi = 0;
+
+  /// the toi of the array after the changes
+  uint64_t toi = 0;
+
+  /// the changed elements
+  Ranges ranges;
+
+  /// the bits of the changed elements in range order, set by read
+  std::vector<uint64_t> values;
+};
+
+/**
+ * The changes made to an array through set_index since it was last sent
+ **/
+struct ArrayDeltaTracker
+{
+  /// the changed elements
+  ArrayDelta::Ranges ranges;
+
+  /// true if ranges holds every change since the array was last sent
+  bool complete = false;
+
+  /// the toi of the array after the last tracked change
+  uint64_t toi = 0;
+
+  /// true if the array has been sent
+  bool sent = false;
+
+  /// the toi of the array when it was last sent
+  uint64_t sent_toi = 0;
+
+  /// the number of deltas sent since the array was last sent in full
+  uint32_t deltas_sent = 0;
+};
+
+/**
+ * The last full update or delta of an array applied from a transport
+ **/
+struct ArrayDeltaBase
+{
+  /// the sender's toi of the array
+  uint64_t sent_toi = 0;
+
+  /// the local toi given to the array when it was applied
+  uint64_t local_toi = 0;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_ARRAY_DELTA_H_
@@ -0,0 +1,258 @@
+#ifndef MADARA_KNOWLEDGE_BUFFER_ARCHIVE_H_
+#define MADARA_KNOWLEDGE_BUFFER_ARCHIVE_H_
+
+/**
+ * @file BufferArchive.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains cereal archives that read and write the portable
+ * binary format directly from and to memory, without iostreams
+ **/
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wexceptions"
+#pragma GCC diagnostic ignored "-Wundef"
+#pragma GCC diagnostic ignored "-Wunused-private-field"
+#endif
+#include "cereal/cereal.hpp"
+#include "cereal/archives/portable_binary.hpp"
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif  // __GNUC__
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * Writes the same bytes as cereal::PortableBinaryOutputArchive with
+ * default options, into a fixed buffer or at the end of a vector.
+ * Writing past the end of a fixed buffer throws cereal::Exception.
+ **/
+class BufferOutputArchive
+  : public cereal::OutputArchive<BufferOutputArchive,
+        cereal::AllowEmptyClassElision>
+{
+public:
+  /**
+   * Constructor for writing to a fixed buffer
+   * @param  data   the buffer to write to
+   * @param  size   the size of the buffer
+   **/
+  BufferOutputArchive(char* data, size_t size)
+    : OutputArchive(this), data_(data), size_(size)
+  {
+    write_endianness();
+  }
+
+  /**
+   * Constructor for appending to a vector, which grows as needed
+   * @param  vec    the vector to append to
+   **/
+  explicit BufferOutputArchive(std::vector<char>& vec)
+    : OutputArchive(this), vec_(&vec), start_(vec.size())
+  {
+    write_endianness();
+  }
+
+  ~BufferOutputArchive() CEREAL_NOEXCEPT = default;
+
+  /**
+   * Writes bytes in host byte order
+   * @param  data   the bytes to write
+   * @param  size   the number of bytes
+   **/
+  template<std::size_t DataSize>
+  void saveBinary(const void* data, std::size_t size)
+  {
+    if (vec_)
+    {
+      const char* bytes = static_cast<const char*>(data);
+      vec_->insert(vec_->end(), bytes, bytes + size);
+    }
+    else
+    {
+      if (size > size_ - pos_)
+      {
+        throw cereal::Exception("Failed to write " + std::to_string(size) +
+                                " bytes to output buffer! " +
+                                std::to_string(size_ - pos_) + " remain");
+      }
+
+      memcpy(data_ + pos_, data, size);
+      pos_ += size;
+    }
+  }
+
+  /**
+   * Returns the number of bytes written
+   **/
+  size_t size(void) const
+  {
+    return vec_ ? vec_->size() - start_ : pos_;
+  }
+
+private:
+  void write_endianness(void)
+  {
+    this->operator()(cereal::portable_binary_detail::is_little_endian());
+  }
+
+  /// the fixed buffer, if not appending to vec_
+  char* data_ = nullptr;
+
+  /// the size of data_
+  size_t size_ = 0;
+
+  /// the bytes written to data_
+  size_t pos_ = 0;
+
+  /// the vector appended to, if any
+  std::vector<char>* vec_ = nullptr;
+
+  /// the size of vec_ before this archive wrote to it
+  size_t start_ = 0;
+};
+
+/**
+ * Reads the format of cereal::PortableBinaryOutputArchive directly from
+ * memory. Reading past the end of the buffer throws cereal::Exception.
+ **/
+class BufferInputArchive
+  : public cereal::InputArchive<BufferInputArchive,
+        cereal::AllowEmptyClassElision>
+{
+public:
+  /**
+   * Constructor
+   * @param  data   the buffer to read from
+   * @param  size   the size of the buffer
+   **/
+  BufferInputArchive(const char* data, size_t size)
+    : InputArchive(this), data_(data), size_(size)
+  {
+    uint8_t little_endian = 0;
+    this->operator()(little_endian);
+    convert_ =
+        cereal::portable_binary_detail::is_little_endian() ^ little_endian;
+  }
+
+  ~BufferInputArchive() CEREAL_NOEXCEPT = default;
+
+  /**
+   * Reads bytes, converting each DataSize element to host byte order
+   * @param  data   the location to read to
+   * @param  size   the number of bytes
+   **/
+  template<std::size_t DataSize>
+  void loadBinary(void* const data, std::size_t size)
+  {
+    if (size > size_ - pos_)
+    {
+      throw cereal::Exception("Failed to read " + std::to_string(size) +
+                              " bytes from input buffer! " +
+                              std::to_string(size_ - pos_) + " remain");
+    }
+
+    memcpy(data, data_ + pos_, size);
+    pos_ += size;
+
+    if (convert_)
+    {
+      std::uint8_t* ptr = reinterpret_cast<std::uint8_t*>(data);
+      for (std::size_t i = 0; i < size; i += DataSize)
+      {
+        cereal::portable_binary_detail::swap_bytes<DataSize>(ptr + i);
+      }
+    }
+  }
+
+  /**
+   * Returns the number of bytes read
+   **/
+  size_t size(void) const
+  {
+    return pos_;
+  }
+
+private:
+  /// the buffer
+  const char* data_;
+
+  /// the size of the buffer
+  size_t size_;
+
+  /// the bytes read from data_
+  size_t pos_ = 0;
+
+  /// true if the buffer was written with the other byte order
+  uint8_t convert_ = 0;
+};
+
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+CEREAL_SAVE_FUNCTION_NAME(BufferOutputArchive& ar, T const& t)
+{
+  static_assert(!std::is_floating_point<T>::value ||
+                    std::numeric_limits<T>::is_iec559,
+      "Buffer archives only support IEEE 754 floating point");
+  ar.template saveBinary<sizeof(T)>(std::addressof(t), sizeof(t));
+}
+
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+CEREAL_LOAD_FUNCTION_NAME(BufferInputArchive& ar, T& t)
+{
+  static_assert(!std::is_floating_point<T>::value ||
+                    std::numeric_limits<T>::is_iec559,
+      "Buffer archives only support IEEE 754 floating point");
+  ar.template loadBinary<sizeof(T)>(std::addressof(t), sizeof(t));
+}
+
+template<class Archive, class T>
+inline CEREAL_ARCHIVE_RESTRICT(BufferInputArchive, BufferOutputArchive)
+    CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, cereal::NameValuePair<T>& t)
+{
+  ar(t.value);
+}
+
+template<class Archive, class T>
+inline CEREAL_ARCHIVE_RESTRICT(BufferInputArchive, BufferOutputArchive)
+    CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, cereal::SizeTag<T>& t)
+{
+  ar(t.size);
+}
+
+template<class T>
+inline void CEREAL_SAVE_FUNCTION_NAME(
+    BufferOutputArchive& ar, cereal::BinaryData<T> const& bd)
+{
+  typedef typename std::remove_pointer<T>::type TT;
+  ar.template saveBinary<sizeof(TT)>(
+      bd.data, static_cast<std::size_t>(bd.size));
+}
+
+template<class T>
+inline void CEREAL_LOAD_FUNCTION_NAME(
+    BufferInputArchive& ar, cereal::BinaryData<T>& bd)
+{
+  typedef typename std::remove_pointer<T>::type TT;
+  ar.template loadBinary<sizeof(TT)>(
+      bd.data, static_cast<std::size_t>(bd.size));
+}
+}
+}
+
+CEREAL_REGISTER_ARCHIVE(madara::knowledge::BufferOutputArchive)
+CEREAL_REGISTER_ARCHIVE(madara::knowledge::BufferInputArchive)
+
+CEREAL_SETUP_ARCHIVE_TRAITS(
+    madara::knowledge::BufferInputArchive, madara::knowledge::BufferOutputArchive)
+
+#endif  // MADARA_KNOWLEDGE_BUFFER_ARCHIVE_H_
@@ -9,6 +9,7 @@
  **/
 
 #include <memory>
+#include <string>
 #include <sstream>
 #include <functional>
 #include <type_traits>
@@ -32,6 +33,8 @@
 #pragma GCC diagnostic pop
 #endif  // __GNUC__
 
+#include "madara/exceptions/MemoryException.h"
+#include "madara/knowledge/SharedBuffer.h"
 #include "madara/utility/SupportTest.h"
 #include "madara/MadaraExport.h"
 #include "madara/logger/GlobalLogger.h"
@@ -113,6 +116,24 @@ protected:
         (char*)memcpy((char*)operator new(size + extra), data, size));
   }
 
+  /**
+   * References data in the SharedBuffer being read, if data is word
+   * aligned, and otherwise copies it. Shared data has no room for the
+   * extra bytes, and must not be modified.
+   **/
+  std::shared_ptr<char> mk_shared(const char* data, size_t size, size_t extra)
+  {
+    if ((uintptr_t)data % sizeof(capnp::word) == 0)
+    {
+      std::shared_ptr<const char> shared = SharedBuffer::share(data, size);
+      if (shared)
+      {
+        return std::const_pointer_cast<char>(shared);
+      }
+    }
+    return mk_copy(data, size, extra);
+  }
+
   std::shared_ptr<char> read_from(std::istream& i, size_t size, size_t extra)
   {
     std::shared_ptr<char> ret((char*)operator new(size + extra));
@@ -130,7 +151,7 @@ protected:
 
   BaseCapnObject(
       const char* data, size_t size, size_t extra = 0, bool init_reader = true)
-    : data_(mk_copy(data, size, extra)),
+    : data_(mk_shared(data, size, extra)),
       size_(size),
       reader_(init_reader ? mk_reader() : nullptr)
   {
@@ -175,11 +196,11 @@ public:
 
   /**
    * Construct with given tag and char buffer. Contents of pointed to tag and
-   * buffer will be copied into this new object.
+   * buffer will be copied into this new object, unless the buffer is in the
+   * SharedBuffer being read.
    **/
   GenericCapnObject(const char* tag, const char* d, size_t s)
-    : Base(d, s, std::strlen(tag) + 1, false),
-      tag_((const char*)std::strcpy(data() + size(), tag))
+    : Base(d, s, std::strlen(tag) + 1, false), tag_(store_tag(tag, d))
   {
   }
 
@@ -258,6 +279,20 @@ private:
     }
   }
 
+  /// copies the tag after the copied data, or apart from shared data
+  const char* store_tag(const char* tag, const char* d)
+  {
+    if (Base::data() == d)
+    {
+      shared_tag_ = std::make_shared<std::string>(tag);
+      return shared_tag_->c_str();
+    }
+    return std::strcpy(data() + size(), tag);
+  }
+
+  /// the tag of an object that references a SharedBuffer
+  std::shared_ptr<const std::string> shared_tag_;
+
   const char* tag_;
 };
 
@@ -519,6 +554,51 @@ inline auto get_type_handler_save(type<knowledge::RegCapnObject>,
   };
 }
 
+/// Copies the raw message of a Cap'n Proto object into a buffer
+template<typename T>
+inline size_t save_capn_buffer(char* out, size_t size, const T& val)
+{
+  if (val.size() > size)
+  {
+    throw exceptions::MemoryException(
+        "CapnObject: buffer too small for serialization");
+  }
+
+  memcpy(out, val.data(), val.size());
+  return val.size();
+}
+
+template<typename T>
+inline auto get_type_handler_save_buffer(type<knowledge::CapnObject<T>>,
+    overload_priority<8>) -> knowledge::TypeHandlers::save_buffer_fn_type
+{
+  return [](char* out, size_t size, const void* ptr) -> size_t {
+    using knowledge::CapnObject;
+    return save_capn_buffer(
+        out, size, *static_cast<const CapnObject<T>*>(ptr));
+  };
+}
+
+inline auto get_type_handler_save_buffer(type<knowledge::GenericCapnObject>,
+    overload_priority<8>) -> knowledge::TypeHandlers::save_buffer_fn_type
+{
+  return [](char* out, size_t size, const void* ptr) -> size_t {
+    using knowledge::GenericCapnObject;
+    return save_capn_buffer(
+        out, size, *static_cast<const GenericCapnObject*>(ptr));
+  };
+}
+
+inline auto get_type_handler_save_buffer(type<knowledge::RegCapnObject>,
+    overload_priority<8>) -> knowledge::TypeHandlers::save_buffer_fn_type
+{
+  return [](char* out, size_t size, const void* ptr) -> size_t {
+    using knowledge::RegCapnObject;
+    return save_capn_buffer(
+        out, size, *static_cast<const RegCapnObject*>(ptr));
+  };
+}
+
 template<typename T>
 inline auto get_type_handler_load(type<knowledge::CapnObject<T>>,
     overload_priority<8>) -> knowledge::TypeHandlers::load_fn_type
@@ -12,6 +12,7 @@
 
 #include "madara/logger/Logger.h"
 #include "madara/knowledge/ContextGuard.h"
+#include "madara/utility/LockProfiler.h"
 
 namespace sc = std::chrono;
 
@@ -68,6 +69,8 @@ private:
 
 void CheckpointStreamer::thread_main(CheckpointStreamer* self)
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
+
   auto period = sc::microseconds(int64_t(1000000 / self->write_hertz_));
   auto wakeup = sc::steady_clock::now() + period;
 
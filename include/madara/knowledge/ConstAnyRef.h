@@ -443,6 +443,15 @@ public:
    **/
   size_t tagged_serialize(char* data, size_t size) const
   {
+    if (handler_ && handler_->save_buffer)
+    {
+      const char* t = this->tag();
+      if (t != nullptr)
+      {
+        return tagged_serialize(t, data, size);
+      }
+    }
+
     namespace bio = boost::iostreams;
 
     bio::array_sink output_sink(data, size);
@@ -467,6 +476,16 @@ public:
    **/
   size_t tagged_serialize(const char* tag, char* data, size_t size) const
   {
+    // types that can write to memory directly skip the streams below
+    if (handler_ && handler_->save_buffer)
+    {
+      // word align Cap'n Proto messages, so receivers can read them in place
+      size_t align = handler_->get_reader ? sizeof(capnp::word) : 0;
+
+      size_t len = AnyRegistry::write_tag(tag, data, size, align);
+      return len + handler_->save_buffer(data + len, size - len, data_);
+    }
+
     namespace bio = boost::iostreams;
 
     bio::array_sink output_sink(data, size);
@@ -552,16 +571,9 @@ public:
    **/
   void tagged_serialize(const char* tag, std::ostream& stream) const
   {
-    madara_oarchive archive(stream);
-    std::string stag(tag);
-    /*
-    const size_t align = sizeof(capnp::word);
-    size_t over = stag.size() % align;
-    if (over > 0) {
-      size_t pad = align - over;
-      stag.resize(stag.size() + pad, '\0');
-    }*/
-    archive << stag;
+    std::vector<char> header;
+    AnyRegistry::write_tag(tag, header);
+    stream.write(header.data(), header.size());
 
     serialize(stream);
   }
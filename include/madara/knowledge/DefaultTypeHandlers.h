@@ -159,16 +159,31 @@ constexpr auto get_type_handler_load(type<T>, overload_priority<12>)
   return [](const char* in, size_t size, void* ptr, const char*) {
     T& val = *static_cast<T*>(ptr);
 
-    namespace bio = boost::iostreams;
-
-    bio::array_source input_source(in, size);
-    bio::stream<bio::array_source> input_stream(input_source);
-    knowledge::madara_iarchive archive(input_stream);
+    knowledge::BufferInputArchive archive(in, size);
 
     archive >> val;
   };
 }
 
+/// Creates a function for serializing the given type directly to a buffer,
+/// without the streams used by save. Specialize this function to customize
+/// otherwise.
+template<typename T>
+constexpr auto get_type_handler_save_buffer(type<T>, overload_priority<12>)
+    -> enable_if_<madara_use_cereal(type<T>{}),
+        knowledge::TypeHandlers::save_buffer_fn_type>
+{
+  return [](char* out, size_t size, const void* ptr) -> size_t {
+    const T& val = *static_cast<const T*>(ptr);
+
+    knowledge::BufferOutputArchive archive(out, size);
+
+    archive << val;
+
+    return archive.size();
+  };
+}
+
 /// Creates a function for serializing the given type to a json_oarchive.
 /// By default, simply use the Boost.Serialization << operator.
 /// Specialize this function to customize otherwise.
@@ -191,6 +191,41 @@ public:
       const KnowledgeReferenceSettings& settings = KnowledgeReferenceSettings(
           false));
 
+  /**
+   * Atomically returns references to many variables, locking the context
+   * once for all of them.
+   * @param   keys      unique identifiers of the variables
+   * @param settings    settings for referring to knowledge variables
+   * @return            references in the same order as the keys
+   **/
+  VariableReferences get_refs(const std::vector<std::string>& keys,
+      const KnowledgeReferenceSettings& settings = KnowledgeReferenceSettings(
+          false));
+
+  /**
+   * Atomically gets the current values of many variables (without any
+   * history). The values are read under a single lock.
+   * @param   variables  references to the variables (@see get_refs)
+   * @param   values     filled with one value per variable
+   * @param   settings   settings for referring to knowledge variables
+   **/
+  void get_batch(const VariableReferences& variables,
+      std::vector<KnowledgeRecord>& values,
+      const KnowledgeReferenceSettings& settings = KnowledgeReferenceSettings(
+          false));
+
+  /**
+   * Atomically gets the current values of many variables (without any
+   * history). Variables that do not exist are returned as empty records.
+   * @param   keys       unique identifiers of the variables
+   * @param   values     filled with one value per key
+   * @param   settings   settings for referring to knowledge variables
+   **/
+  void get_batch(const std::vector<std::string>& keys,
+      std::vector<KnowledgeRecord>& values,
+      const KnowledgeReferenceSettings& settings = KnowledgeReferenceSettings(
+          false));
+
   /**
    * @return a shared_ptr, sharing with the internal one.
    * If this record is not a string, returns NULL shared_ptr
@@ -612,6 +647,36 @@ public:
       const EvalSettings& settings = EvalSettings(
           true, false, true, false, false));
 
+  /**
+   * Atomically sets many variables. The context is locked once, waiting
+   * threads are signaled once, and modifieds are sent at most once.
+   * @param   variables  references to the variables (@see get_refs)
+   * @param   values     new values, one per variable
+   * @param   settings   settings for applying the update
+   * @return   0 if all values were set. -1 if the sizes differ or a
+   *           reference is null. -2 if a write quality was too low.
+   **/
+  template<typename T>
+  int set_batch(const VariableReferences& variables,
+      const std::vector<T>& values,
+      const EvalSettings& settings = EvalSettings(
+          true, false, true, false, false));
+
+  /**
+   * Atomically sets many variables. The context is locked once, waiting
+   * threads are signaled once, and modifieds are sent at most once.
+   * @param   keys       unique identifiers of the variables
+   * @param   values     new values, one per key
+   * @param   settings   settings for applying the update
+   * @return   0 if all values were set. -1 if the sizes differ or a
+   *           key is null. -2 if a write quality was too low.
+   **/
+  template<typename T>
+  int set_batch(const std::vector<std::string>& keys,
+      const std::vector<T>& values,
+      const EvalSettings& settings = EvalSettings(
+          true, false, true, false, false));
+
   /**
    * Atomically sets the value of a variable to a double.
    * @param   variable  reference to a variable (@see get_ref)
@@ -1675,6 +1740,21 @@ public:
       const std::string& prefix = "KnowledgeBase::send_modifieds",
       const EvalSettings& settings = EvalSettings::SEND);
 
+  /**
+   * Caps how often variables are sent. Changes between sends are
+   * coalesced, and the latest value is sent by the next send_modifieds
+   * or, if none comes, by a send thread once the cap allows it. See
+   * ThreadSafeContext::set_send_rate.
+   * @param prefix  a variable name or a prefix of variable names
+   * @param hertz   the most sends per second. 0 or less removes the cap.
+   **/
+  void set_send_rate(const std::string& prefix, double hertz);
+
+  /**
+   * Removes all caps set by set_send_rate
+   **/
+  void clear_send_rates(void);
+
   /**
    * Clear all modifications to the knowledge base. This action may
    * be useful if you are wanting to keep local changes but not
@@ -2153,6 +2233,84 @@ public:
         settings);
   }
 
+  /**
+   * Keeps a compact columnar history of the integer or double values of
+   * a variable, which can be queried by time. This is an alternative to
+   * set_history_capacity that stores each sample in 16 bytes, or a few
+   * bytes if compressed. See ThreadSafeContext::set_time_series_capacity.
+   * @param key         the variable name
+   * @param capacity    the number of samples to keep. 0 removes the
+   *                    history.
+   * @param compressed  true to compress samples
+   **/
+  void set_time_series_capacity(
+      const std::string& key, size_t capacity, bool compressed = false)
+  {
+    get_context().set_time_series_capacity(key, capacity, compressed);
+  }
+
+  /**
+   * Returns samples from the columnar history of a variable
+   * @param key         the variable name
+   * @param start       the earliest toi to include
+   * @param end         the latest toi to include
+   * @return  the samples, oldest first
+   **/
+  std::vector<TimeSeries::Sample> get_time_series(const std::string& key,
+      uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const
+  {
+    return get_context().get_time_series(key, start, end);
+  }
+
+  /**
+   * Returns statistics of the columnar history of a variable
+   * @param key         the variable name
+   * @param start       the earliest toi to include
+   * @param end         the latest toi to include
+   * @return  the statistics. count is 0 if there are no samples.
+   **/
+  TimeSeries::Window summarize_time_series(const std::string& key,
+      uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const
+  {
+    return get_context().summarize_time_series(key, start, end);
+  }
+
+  /**
+   * Downsamples the columnar history of a variable into windows with
+   * the min, max and mean of each
+   * @param key         the variable name
+   * @param window      the duration of each window in nanoseconds
+   * @param start       the earliest toi to include. Windows begin here.
+   * @param end         the latest toi to include
+   * @return  statistics for each window that has samples
+   **/
+  std::vector<TimeSeries::Window> aggregate_time_series(
+      const std::string& key, uint64_t window, uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const
+  {
+    return get_context().aggregate_time_series(key, window, start, end);
+  }
+
+  /**
+   * Calls a function with samples from the columnar history of a
+   * variable without copying them
+   * @param key         the variable name
+   * @param func        called with (uint64_t toi, double value)
+   * @param start       the earliest toi to include
+   * @param end         the latest toi to include
+   * @return  the number of samples visited
+   **/
+  template<typename Func>
+  size_t for_time_series(const std::string& key, Func&& func,
+      uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const
+  {
+    return get_context().for_time_series(
+        key, std::forward<Func>(func), start, end);
+  }
+
   /**
    * Return true if this record has a circular buffer history. Use
    * set_history_capacity to add a buffer
@@ -360,6 +360,77 @@ inline VariableReference KnowledgeBase::get_ref(
   return var;
 }
 
+inline void KnowledgeBase::set_send_rate(
+    const std::string& prefix, double hertz)
+{
+  if (impl_.get())
+  {
+    impl_->set_send_rate(prefix, hertz);
+  }
+  else if (context_)
+  {
+    context_->set_send_rate(prefix, hertz);
+  }
+}
+
+inline void KnowledgeBase::clear_send_rates(void)
+{
+  if (impl_.get())
+  {
+    impl_->clear_send_rates();
+  }
+  else if (context_)
+  {
+    context_->clear_send_rates();
+  }
+}
+
+inline VariableReferences KnowledgeBase::get_refs(
+    const std::vector<std::string>& keys,
+    const KnowledgeReferenceSettings& settings)
+{
+  VariableReferences refs;
+
+  if (impl_.get())
+  {
+    refs = impl_->get_refs(keys, settings);
+  }
+  else if (context_)
+  {
+    refs = context_->get_refs(keys, settings);
+  }
+
+  return refs;
+}
+
+inline void KnowledgeBase::get_batch(const VariableReferences& variables,
+    std::vector<KnowledgeRecord>& values,
+    const KnowledgeReferenceSettings& settings)
+{
+  if (impl_.get())
+  {
+    impl_->get_batch(variables, values, settings);
+  }
+  else if (context_)
+  {
+    context_->get_batch(variables, values, settings);
+  }
+}
+
+inline void KnowledgeBase::get_batch(const std::vector<std::string>& keys,
+    std::vector<KnowledgeRecord>& values,
+    const KnowledgeReferenceSettings& settings)
+{
+  if (impl_.get())
+  {
+    impl_->get_batch(keys, values, settings);
+  }
+  else if (context_)
+  {
+    context_->get_batch(keys, values, settings);
+  }
+}
+
 inline KnowledgeRecord KnowledgeBase::get(const VariableReference& variable,
     const KnowledgeReferenceSettings& settings)
 {
@@ -685,6 +756,42 @@ inline int KnowledgeBase::set_index(const VariableReference& variable,
   return result;
 }
 
+template<typename T>
+inline int KnowledgeBase::set_batch(const VariableReferences& variables,
+    const std::vector<T>& values, const EvalSettings& settings)
+{
+  int result = 0;
+
+  if (impl_.get())
+  {
+    result = impl_->set_batch(variables, values, settings);
+  }
+  else if (context_)
+  {
+    result = context_->set_batch(variables, values, settings);
+  }
+
+  return result;
+}
+
+template<typename T>
+inline int KnowledgeBase::set_batch(const std::vector<std::string>& keys,
+    const std::vector<T>& values, const EvalSettings& settings)
+{
+  int result = 0;
+
+  if (impl_.get())
+  {
+    result = impl_->set_batch(keys, values, settings);
+  }
+  else if (context_)
+  {
+    result = context_->set_batch(keys, values, settings);
+  }
+
+  return result;
+}
+
 inline int KnowledgeBase::set(const std::string& key,
     const KnowledgeRecord::Integer* value, uint32_t size,
     const EvalSettings& settings)
@@ -7,9 +7,14 @@
 #include "madara/transport/udp/UdpRegistryClient.h"
 #include "madara/transport/multicast/MulticastTransport.h"
 #include "madara/transport/broadcast/BroadcastTransport.h"
+#include "madara/transport/shmem/SharedMemoryTransport.h"
+#include "madara/transport/tcp/TcpTransport.h"
 #include "madara/utility/EpochEnforcer.h"
+#include "madara/utility/Tracer.h"
+#include "madara/utility/LockProfiler.h"
 #include "madara/Boost.h"
 
+#include <chrono>
 #include <sstream>
 
 #ifdef _MADARA_USING_ZMQ_
@@ -139,6 +144,15 @@ size_t KnowledgeBaseImpl::attach_transport(
     transport =
         new madara::transport::UdpTransport(originator, map_, settings, true);
   }
+  else if (settings.type == madara::transport::TCP)
+  {
+    madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
+        "KnowledgeBaseImpl::activate_transport:"
+        " creating TCP transport.\n");
+
+    transport =
+        new madara::transport::TcpTransport(originator, map_, settings, true);
+  }
   else if (settings.type == madara::transport::ZMQ)
   {
 #ifdef _MADARA_USING_ZMQ_
@@ -172,6 +186,15 @@ size_t KnowledgeBaseImpl::attach_transport(
     transport = new madara::transport::UdpRegistryClient(
         originator, map_, settings, true);
   }
+  else if (settings.type == madara::transport::SHMEM)
+  {
+    madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
+        "KnowledgeBaseImpl::activate_transport:"
+        " creating Shared Memory transport.\n");
+
+    transport = new madara::transport::SharedMemoryTransport(
+        originator, map_, settings, true);
+  }
   else
   {
     madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
@@ -179,6 +202,7 @@ size_t KnowledgeBaseImpl::attach_transport(
         " no transport was specified. Setting transport to null.\n");
   }
 
+  size_t size = 0;
   {
     MADARA_GUARD_TYPE guard(transport_mutex_);
 
@@ -186,10 +210,19 @@ size_t KnowledgeBaseImpl::attach_transport(
     if (transport != 0)
     {
       transports_.emplace_back(transport);
+      compile_send_routes();
     }
 
-    return transports_.size();
+    size = transports_.size();
   }
+
+  // held variables may have been waiting for a transport
+  if (transport != 0)
+  {
+    wake_send_flusher();
+  }
+
+  return size;
 }
 
 void KnowledgeBaseImpl::close_transport(void)
@@ -199,6 +232,7 @@ void KnowledgeBaseImpl::close_transport(void)
     MADARA_GUARD_TYPE guard(transport_mutex_);
     using std::swap;
     swap(old_transports, transports_);
+    send_routes_.clear();
   }
 
   for (auto& transport : old_transports)
@@ -337,11 +371,17 @@ KnowledgeRecord KnowledgeBaseImpl::evaluate(
 
   // lock the context from being updated by any ongoing threads
   {
+    MADARA_LOCK_CATEGORY(EVALUATE);
     MADARA_GUARD_TYPE guard(map_.mutex_);
 
     // interpret the current expression and then evaluate it
     // tree = interpreter_.interpret (map_, expression);
-    last_value = ce.expression.evaluate(settings);
+    {
+      MADARA_TRACE_SPAN("karl_evaluate");
+      last_value = ce.expression.evaluate(settings);
+    }
+
+    map_.evaluations_metric_.add();
 
     send_modifieds("KnowledgeBaseImpl:evaluate", settings);
 
@@ -389,11 +429,25 @@ KnowledgeRecord KnowledgeBaseImpl::evaluate(
 
 #endif  // _MADARA_NO_KARL_
 
+void KnowledgeBaseImpl::compile_send_routes(void)
+{
+  send_routes_.clear();
+
+  for (size_t i = 0; i < transports_.size(); ++i)
+  {
+    send_routes_.add(i, transports_[i]->settings().send_prefixes);
+  }
+
+  send_routes_.compile();
+}
+
 int KnowledgeBaseImpl::send_modifieds(
     const std::string& prefix, const EvalSettings& settings)
 {
   int result = 0;
 
+  MADARA_LOCK_CATEGORY(TRANSPORT_SEND);
+
   MADARA_GUARD_TYPE guard(transport_mutex_);
 
   if (transports_.size() > 0 && !settings.delay_sending_modifieds)
@@ -408,11 +462,7 @@ int KnowledgeBaseImpl::send_modifieds(
 
     if (modified.size() > 0)
     {
-      // send across each transport
-      for (auto& transport : transports_)
-      {
-        transport->send_data(modified);
-      }
+      send_data(modified);
 
       map_.inc_clock(settings);
 
@@ -447,5 +497,160 @@ int KnowledgeBaseImpl::send_modifieds(
 
   return result;
 }
+
+void KnowledgeBaseImpl::send_data(const KnowledgeMap& modified)
+{
+  if (send_routes_.empty())
+  {
+    // send across each transport
+    for (auto& transport : transports_)
+    {
+      transport->send_data(modified);
+    }
+  }
+  else
+  {
+    // split the modifieds between routed transports in one pass
+    std::vector<KnowledgeMap> routed;
+    send_routes_.partition(modified, routed);
+
+    for (size_t i = 0; i < transports_.size(); ++i)
+    {
+      if (!send_routes_.is_routed(i))
+      {
+        transports_[i]->send_data(modified);
+      }
+      else if (routed[i].size() > 0)
+      {
+        transports_[i]->send_data(routed[i]);
+      }
+    }
+  }
+}
+
+void KnowledgeBaseImpl::set_send_rate(const std::string& prefix, double hertz)
+{
+  if (hertz > 0)
+  {
+    // registered before locking the flusher, since the listener is
+    // called with the context locked and locks the flusher
+    map_.set_send_held_listener([this]() { wake_send_flusher(); });
+  }
+
+  map_.set_send_rate(prefix, hertz);
+
+  std::lock_guard<std::mutex> guard(send_flusher_mutex_);
+
+  /**
+   * The flusher is a plain thread rather than a threads::Threader thread.
+   * A Threader needs a KnowledgeBase for its data and control planes,
+   * which this implementation sits beneath, and runs at fixed hertz
+   * rates, while the flusher sleeps until a held variable is due.
+   **/
+  if (hertz > 0 && !send_flusher_.joinable())
+  {
+    send_flusher_ = std::thread(send_flusher_main, this);
+  }
+
+  send_flusher_woken_ = true;
+  send_flusher_changed_.notify_all();
+}
+
+void KnowledgeBaseImpl::clear_send_rates(void)
+{
+  map_.clear_send_rates();
+}
+
+uint64_t KnowledgeBaseImpl::send_held_modifieds(void)
+{
+  MADARA_LOCK_CATEGORY(TRANSPORT_SEND);
+
+  /**
+   * evaluate, wait and apply_modified lock the context before calling
+   * send_modifieds, which locks the transports, while this thread locks
+   * the transports first. std::lock never blocks on one of the locks
+   * while holding the other, so the two orders cannot deadlock.
+   **/
+  std::unique_lock<MADARA_LOCK_TYPE> transport_lock(
+      transport_mutex_, std::defer_lock);
+  std::unique_lock<MADARA_LOCK_TYPE> context_lock(
+      map_.mutex_, std::defer_lock);
+  std::lock(transport_lock, context_lock);
+
+  // without transports, held variables stay modified for a later send
+  KnowledgeMap due;
+  uint64_t wake = map_.get_held_modifieds(due, transports_.size() > 0);
+
+  if (transports_.size() > 0 && due.size() > 0)
+  {
+    madara_logger_log(map_.get_logger(), logger::LOG_DETAILED,
+        "KnowledgeBaseImpl::send_held_modifieds:"
+        " flushing %d held variables\n",
+        (int)due.size());
+
+    send_data(due);
+
+    map_.inc_clock(EvalSettings::SEND);
+    map_.signal(false);
+  }
+
+  return wake;
+}
+
+void KnowledgeBaseImpl::wake_send_flusher(void)
+{
+  {
+    std::lock_guard<std::mutex> guard(send_flusher_mutex_);
+    send_flusher_woken_ = true;
+  }
+
+  send_flusher_changed_.notify_all();
+}
+
+void KnowledgeBaseImpl::stop_send_flusher(void)
+{
+  {
+    std::lock_guard<std::mutex> guard(send_flusher_mutex_);
+    send_flusher_stopping_ = true;
+  }
+
+  send_flusher_changed_.notify_all();
+
+  if (send_flusher_.joinable())
+  {
+    send_flusher_.join();
+  }
+}
+
+void KnowledgeBaseImpl::send_flusher_main(KnowledgeBaseImpl* self)
+{
+  std::unique_lock<std::mutex> lock(self->send_flusher_mutex_);
+
+  while (!self->send_flusher_stopping_)
+  {
+    self->send_flusher_woken_ = false;
+
+    lock.unlock();
+    uint64_t wake = self->send_held_modifieds();
+    lock.lock();
+
+    auto changed = [self]() {
+      return self->send_flusher_stopping_ || self->send_flusher_woken_;
+    };
+
+    uint64_t now = utility::get_time();
+
+    if (wake == 0)
+    {
+      // nothing is held, so wait for a variable to be held
+      self->send_flusher_changed_.wait(lock, changed);
+    }
+    else if (wake > now)
+    {
+      self->send_flusher_changed_.wait_for(
+          lock, std::chrono::nanoseconds(wake - now), changed);
+    }
+  }
+}
 }
 }
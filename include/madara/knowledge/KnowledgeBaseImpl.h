@@ -10,6 +10,9 @@
 
 #include <string>
 #include <map>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include <ostream>
 #include <vector>
@@ -23,6 +26,7 @@
 #include "madara/MadaraExport.h"
 #include "madara/knowledge/ThreadSafeContext.h"
 #include "madara/transport/Transport.h"
+#include "madara/transport/PrefixRoutes.h"
 #include "madara/expression/Interpreter.h"
 
 namespace madara
@@ -167,6 +171,38 @@ public:
       const std::string& key, const KnowledgeReferenceSettings& settings =
                                   KnowledgeReferenceSettings());
 
+  /**
+   * Atomically returns references to many variables
+   * @param   keys      unique identifiers of the variables
+   * @param settings    settings for referring to knowledge variables
+   * @return            references in the same order as the keys
+   **/
+  VariableReferences get_refs(const std::vector<std::string>& keys,
+      const KnowledgeReferenceSettings& settings =
+          KnowledgeReferenceSettings());
+
+  /**
+   * Atomically gets the current values of many variables
+   * @param   variables  references to the variables (@see get_refs)
+   * @param   values     filled with one value per variable
+   * @param   settings   settings for referring to knowledge variables
+   **/
+  void get_batch(const VariableReferences& variables,
+      std::vector<KnowledgeRecord>& values,
+      const KnowledgeReferenceSettings& settings =
+          KnowledgeReferenceSettings());
+
+  /**
+   * Atomically gets the current values of many variables
+   * @param   keys       unique identifiers of the variables
+   * @param   values     filled with one value per key
+   * @param   settings   settings for referring to knowledge variables
+   **/
+  void get_batch(const std::vector<std::string>& keys,
+      std::vector<KnowledgeRecord>& values,
+      const KnowledgeReferenceSettings& settings =
+          KnowledgeReferenceSettings());
+
   /**
    * Returns a shared_ptr, sharing with the internal one.
    * If this record is not a string, returns NULL shared_ptr
@@ -532,6 +568,17 @@ public:
     return result;
   }
 
+  template<typename Keys, typename V>
+  int set_batch(const Keys& keys, const std::vector<V>& values,
+      const EvalSettings& settings)
+  {
+    int result = map_.set_batch(keys, values, settings);
+
+    send_modifieds("KnowledgeBaseImpl:set_batch", settings);
+
+    return result;
+  }
+
   /**
    * Atomically reads a file into a variable
    * @param   variable  reference to a variable (@see get_ref)
@@ -1042,6 +1089,20 @@ public:
   MADARA_EXPORT int send_modifieds(const std::string& prefix,
       const EvalSettings& settings = EvalSettings::SEND);
 
+  /**
+   * Caps how often variables are sent. Held values are flushed by the
+   * next send_modifieds or by a send thread once their caps allow it.
+   * @see ThreadSafeContext::set_send_rate
+   * @param prefix  a variable name or a prefix of variable names
+   * @param hertz   the most sends per second. 0 or less removes the cap.
+   **/
+  void set_send_rate(const std::string& prefix, double hertz);
+
+  /**
+   * Removes all caps set by set_send_rate
+   **/
+  void clear_send_rates(void);
+
   /**
    * Wait for a change to happen to the context (e.g., from transports)
    **/
@@ -1128,6 +1189,39 @@ public:
   }
 
 private:
+  /**
+   * Compiles the send prefixes of the attached transports. Callers must
+   * hold the transport mutex.
+   **/
+  void compile_send_routes(void);
+
+  /**
+   * Sends modified variables across the transports, split by their
+   * send prefixes. Callers must hold the transport mutex.
+   * @param  modified  the variables to send
+   **/
+  void send_data(const KnowledgeMap& modified);
+
+  /**
+   * Sends the held variables whose send rate caps allow it
+   * @return  when to check again, in nanoseconds. 0 if nothing is capped.
+   **/
+  uint64_t send_held_modifieds(void);
+
+  /**
+   * Wakes the thread that flushes held variables, e.g., when a variable
+   * is held or a transport is attached
+   **/
+  void wake_send_flusher(void);
+
+  /**
+   * Stops the thread that flushes held variables
+   **/
+  void stop_send_flusher(void);
+
+  /// flushes held variables once set_send_rate caps allow it
+  static void send_flusher_main(KnowledgeBaseImpl* self);
+
   ThreadSafeContext map_;
   std::string id_;
   transport::QoSTransportSettings settings_;
@@ -1135,6 +1229,24 @@ private:
   mutable MADARA_LOCK_TYPE transport_mutex_;
 
   std::vector<std::unique_ptr<transport::Base>> transports_;
+
+  /// routes modified variables to transports with send prefixes
+  transport::PrefixRoutes send_routes_;
+
+  /// sends held variables when no send_modifieds comes to flush them
+  std::thread send_flusher_;
+
+  /// protects the send flusher state
+  std::mutex send_flusher_mutex_;
+
+  /// signaled when the flusher is woken or stops
+  std::condition_variable send_flusher_changed_;
+
+  /// true when the flusher was woken since it last checked
+  bool send_flusher_woken_ = false;
+
+  /// true when the send flusher should exit
+  bool send_flusher_stopping_ = false;
 };
 }
 }
@@ -57,8 +57,10 @@ inline KnowledgeBaseImpl::KnowledgeBaseImpl(
 
 inline KnowledgeBaseImpl::~KnowledgeBaseImpl()
 {
+  stop_send_flusher();
   close_transport();
 }
+
 inline KnowledgeRecord KnowledgeBaseImpl::get(
     const std::string& t_key, const KnowledgeReferenceSettings& settings)
 {
@@ -77,6 +79,27 @@ inline VariableReference KnowledgeBaseImpl::get_ref(
   return map_.get_ref(t_key, settings);
 }
 
+inline VariableReferences KnowledgeBaseImpl::get_refs(
+    const std::vector<std::string>& keys,
+    const KnowledgeReferenceSettings& settings)
+{
+  return map_.get_refs(keys, settings);
+}
+
+inline void KnowledgeBaseImpl::get_batch(const VariableReferences& variables,
+    std::vector<KnowledgeRecord>& values,
+    const KnowledgeReferenceSettings& settings)
+{
+  map_.get_batch(variables, values, settings);
+}
+
+inline void KnowledgeBaseImpl::get_batch(const std::vector<std::string>& keys,
+    std::vector<KnowledgeRecord>& values,
+    const KnowledgeReferenceSettings& settings)
+{
+  map_.get_batch(keys, values, settings);
+}
+
 inline int KnowledgeBaseImpl::get_log_level(void)
 {
   return map_.get_log_level();
@@ -392,10 +415,18 @@ inline KnowledgeRecord KnowledgeBaseImpl::evaluate(
 
 inline size_t KnowledgeBaseImpl::attach_transport(transport::Base* transport)
 {
-  MADARA_GUARD_TYPE guard(transport_mutex_);
+  size_t size = 0;
+  {
+    MADARA_GUARD_TYPE guard(transport_mutex_);
 
-  transports_.emplace_back(transport);
-  return transports_.size();
+    transports_.emplace_back(transport);
+    compile_send_routes();
+    size = transports_.size();
+  }
+
+  // held variables may have been waiting for a transport
+  wake_send_flusher();
+  return size;
 }
 
 inline size_t KnowledgeBaseImpl::get_num_transports(void)
@@ -418,6 +449,7 @@ inline size_t KnowledgeBaseImpl::remove_transport(size_t index)
       using std::swap;
       swap(transport, transports_[index]);
       transports_.erase(transports_.begin() + index);
+      compile_send_routes();
       size = transports_.size();
     }
   }
@@ -3,6 +3,7 @@
 
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/SharedBuffer.h"
 
 #include "madara/utility/Utility.h"
 #include <sstream>
@@ -340,7 +341,29 @@ std::string KnowledgeRecord::to_string(const std::string& delimiter) const
 
   if (type_ == ANY)
   {
-    return any_value_->to_json();
+    if (const ConstAny* any = try_decoded_any())
+    {
+      return any->to_json();
+    }
+
+    // relays need not register the types they forward, so printing and
+    // saving show a placeholder instead of throwing
+    const LazyAny* lazy = lazy_any();
+    std::string tag;
+
+    try
+    {
+      AnyRegistry::read_tag(lazy->data(), lazy->size(), tag);
+    }
+    catch (const exceptions::BadAnyAccess&)
+    {
+      tag = "unknown type";
+    }
+
+    std::stringstream buffer;
+    buffer << "\"<" << tag << ": " << lazy->size()
+           << " bytes, not registered here>\"";
+    return buffer.str();
   }
 
   if (!is_string_type(type_))
@@ -1334,7 +1357,8 @@ bool KnowledgeRecord::is_true(void) const
   }
   else if (is_any_type(type_))
   {
-    return !any_value_->empty();
+    // an encoded Any is never empty, so there is no need to unserialize it
+    return lazy_any() != nullptr || !any_value_->empty();
   }
   else if (has_history())
   {
@@ -1345,6 +1369,34 @@ bool KnowledgeRecord::is_true(void) const
     return false;
   }
 }
+
+std::shared_ptr<const char> KnowledgeRecord::share_capn(
+    const char* buffer, uint32_t size)
+{
+  std::shared_ptr<const char> shared = SharedBuffer::share(buffer, size);
+  if (!shared)
+  {
+    return nullptr;
+  }
+
+  try
+  {
+    std::string tag;
+    size_t len = AnyRegistry::read_tag(buffer, size, tag);
+
+    if ((uintptr_t)(buffer + len) % sizeof(capnp::word) == 0 &&
+        AnyRegistry::is_capn_tag(tag.c_str()))
+    {
+      return shared;
+    }
+  }
+  catch (const exceptions::BadAnyAccess&)
+  {
+    // copied, so the error is reported when the value is accessed
+  }
+
+  return nullptr;
+}
 }
 }
 
@@ -14,6 +14,8 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <exception>
 #include <type_traits>
 #include "madara/MadaraExport.h"
 #include "madara/utility/StdInt.h"
@@ -164,6 +166,23 @@ public:
     }
   }
 
+private:
+  /**
+   * context-wide modification version, assigned each time the record is
+   * marked as modified in a context. Not copied between records.
+   **/
+  uint64_t version_ = 0;
+
+public:
+  uint64_t version() const
+  {
+    return version_;
+  }
+  void set_version(uint64_t new_version)
+  {
+    version_ = new_version;
+  }
+
   /**
    * priority of the update
    **/
@@ -202,6 +221,101 @@ private:
    **/
   mutable bool shared_ = OWNED;
 
+  /**
+   * An Any read from a transport or checkpoint, kept as its tagged
+   * encoding until first accessed. Records that are only rebroadcast or
+   * saved write the encoding back without unserializing it.
+   **/
+  struct LazyAny
+  {
+    /// the value, unserialized from bytes on first access
+    ConstAny value;
+
+    /// the tagged encoding of the value, which is never modified
+    std::vector<char> bytes;
+
+    /// the encoding instead of bytes, if it is in a SharedBuffer
+    std::shared_ptr<const char> shared;
+
+    /// the size of shared
+    size_t shared_size = 0;
+
+    /// set once value has been unserialized, or has failed to be
+    std::once_flag decoded;
+
+    /// why value could not be unserialized, e.g., an unregistered tag
+    std::exception_ptr error;
+
+    /// the tagged encoding
+    const char* data(void) const
+    {
+      return shared ? shared.get() : bytes.data();
+    }
+
+    /// the size of the tagged encoding
+    size_t size(void) const
+    {
+      return shared ? shared_size : bytes.size();
+    }
+  };
+
+  /**
+   * Deleter of an any_value_ that points into a LazyAny, which also lets
+   * the record find the LazyAny through std::get_deleter
+   **/
+  struct LazyAnyDeleter
+  {
+    LazyAny* holder;
+
+    void operator()(const ConstAny*) const
+    {
+      delete holder;
+    }
+  };
+
+  /**
+   * Returns the tagged encoding of an Any value that was read but may
+   * not have been unserialized yet
+   * @return  the encoding, or nullptr if the value was not read lazily
+   **/
+  const LazyAny* lazy_any(void) const;
+
+  /**
+   * References a tagged Cap'n Proto encoding in the SharedBuffer being
+   * read, if its message is word aligned, so it is never copied
+   * @param  buffer  the tagged encoding
+   * @param  size    the size of the encoding
+   * @return  the shared encoding, or null if it must be copied
+   **/
+  static std::shared_ptr<const char> share_capn(
+      const char* buffer, uint32_t size);
+
+  /**
+   * Keeps a tagged encoding as the value, to be unserialized on first
+   * access
+   * @param  data    the tagged encoding, copied unless shared is set
+   * @param  size    the size of the encoding
+   * @param  shared  the encoding in a SharedBuffer, or null to copy data
+   **/
+  void emplace_lazy_any(const char* data, size_t size,
+      std::shared_ptr<const char> shared = nullptr);
+
+  /**
+   * Returns the Any value, unserializing it first if it was read lazily.
+   * The type must be ANY.
+   * @return  the unserialized value, or nullptr if it cannot be
+   *          unserialized, e.g., because its tag is not registered here
+   **/
+  const ConstAny* try_decoded_any(void) const;
+
+  /**
+   * Returns the Any value, unserializing it first if it was read lazily.
+   * The type must be ANY.
+   * @return  the unserialized value
+   * @throw exceptions::BadAnyAccess  if the tag is not a registered type
+   **/
+  const ConstAny& decoded_any(void) const;
+
 public:
   /* default constructor */
   KnowledgeRecord() noexcept : KnowledgeRecord(*logger::global_logger.get()) {}
@@ -939,7 +1053,7 @@ public:
   {
     if (type_ == ANY)
     {
-      return *any_value_;
+      return decoded_any();
     }
     else
     {
@@ -1063,7 +1177,7 @@ public:
   {
     if (type_ == ANY)
     {
-      return *any_value_;
+      return decoded_any();
     }
     else if (type_ == INTEGER)
     {
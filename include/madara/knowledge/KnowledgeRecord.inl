@@ -10,6 +10,7 @@
 
 #include "madara/utility/Utility.h"
 #include "madara/exceptions/MemoryException.h"
+#include "madara/knowledge/SharedBuffer.h"
 
 /**
  * @file KnowledgeRecord.inl
@@ -727,7 +728,17 @@ inline void KnowledgeRecord::unshare(void)
     }
     else if (type_ == ANY)
     {
-      emplace_any(*any_value_);
+      if (const ConstAny* any = try_decoded_any())
+      {
+        emplace_any(*any);
+      }
+      else
+      {
+        // relays need not register the types they forward, so copy the
+        // encoding instead
+        const LazyAny* lazy = lazy_any();
+        emplace_lazy_any(lazy->data(), lazy->size());
+      }
     }
     else if (type_ == BUFFER)
     {
@@ -804,9 +815,11 @@ inline uint32_t KnowledgeRecord::size(void) const
   }
   else if (type_ == ANY)
   {
-    if (any_value_->supports_size())
+    const ConstAny* any = try_decoded_any();
+
+    if (any && any->supports_size())
     {
-      return any_value_->size();
+      return any->size();
     }
   }
   else if (type_ == BUFFER)
@@ -871,8 +884,15 @@ inline int64_t KnowledgeRecord::get_encoded_size(void) const
   }
   else if (type_ == ANY)
   {
-    // TODO calculate real size
-    buffer_size += 1024;
+    if (const LazyAny* lazy = lazy_any())
+    {
+      buffer_size += lazy->size();
+    }
+    else
+    {
+      // TODO calculate real size
+      buffer_size += 1024;
+    }
   }
   else if (type_ == BUFFER && !buf_->empty())
   {
@@ -1169,9 +1189,9 @@ inline const char* KnowledgeRecord::read(
     {
       // madara_logger_ptr_log (logger_, logger::LOG_TRACE,
       //"KnowledgeRecord::read: reading Any type of size %d\n", size);
-      Any any;
-      any.tagged_unserialize(buffer, size);
-      emplace_any(std::move(any));
+
+      // keep the tagged encoding, which is unserialized on first access
+      emplace_lazy_any(buffer, size, share_capn(buffer, size));
     }
 
     else
@@ -1632,10 +1652,85 @@ KnowledgeRecord::share_binary() const
   return nullptr;
 }
 
+inline const KnowledgeRecord::LazyAny* KnowledgeRecord::lazy_any(void) const
+{
+  if (type_ != ANY)
+  {
+    return nullptr;
+  }
+
+  const LazyAnyDeleter* deleter = std::get_deleter<LazyAnyDeleter>(any_value_);
+
+  return deleter ? deleter->holder : nullptr;
+}
+
+inline void KnowledgeRecord::emplace_lazy_any(
+    const char* data, size_t size, std::shared_ptr<const char> shared)
+{
+  LazyAny* lazy = new LazyAny;
+
+  if (shared)
+  {
+    lazy->shared = std::move(shared);
+    lazy->shared_size = size;
+  }
+  else
+  {
+    lazy->bytes.assign(data, data + size);
+  }
+
+  emplace_shared_val<ConstAny, ANY, &KnowledgeRecord::any_value_>(
+      std::shared_ptr<const ConstAny>(&lazy->value, LazyAnyDeleter{lazy}));
+}
+
+inline const ConstAny* KnowledgeRecord::try_decoded_any(void) const
+{
+  if (const LazyAnyDeleter* deleter =
+          std::get_deleter<LazyAnyDeleter>(any_value_))
+  {
+    // copies of the record share the LazyAny, so only one unserializes it
+    LazyAny& lazy = *deleter->holder;
+
+    std::call_once(lazy.decoded, [&lazy]() {
+      // the error is kept, since call_once would retry after a throw
+      try
+      {
+        // Cap'n Proto values keep referencing a shared encoding
+        SharedBuffer::Scope scope(lazy.shared, lazy.shared_size);
+        lazy.value.tagged_unserialize(lazy.data(), lazy.size());
+      }
+      catch (...)
+      {
+        lazy.error = std::current_exception();
+      }
+    });
+
+    if (lazy.error)
+    {
+      return nullptr;
+    }
+  }
+
+  return any_value_.get();
+}
+
+inline const ConstAny& KnowledgeRecord::decoded_any(void) const
+{
+  const ConstAny* any = try_decoded_any();
+
+  if (!any)
+  {
+    std::rethrow_exception(lazy_any()->error);
+  }
+
+  return *any;
+}
+
 inline std::shared_ptr<const ConstAny> KnowledgeRecord::share_any() const
 {
   if (is_any_type(type_))
   {
+    decoded_any();
     shared_ = SHARED;
     return any_value_;
   }
@@ -1689,7 +1784,8 @@ inline char* KnowledgeRecord::write(
   uint32_t uint32_temp;
   Integer integer_temp;
   double double_temp;
-  uint32_t size = this->size();
+  // the size of an Any is the length of its encoding, set below
+  uint32_t size = type_ == ANY ? 0 : this->size();
 
   int64_t encoded_size = get_encoded_size();
 
@@ -1815,6 +1911,17 @@ inline char* KnowledgeRecord::write(
         memcpy(buffer, &(*file_value_)[0], size);
       }
     }
+    else if (const LazyAny* lazy = lazy_any())
+    {
+      // resend the encoding that was read, without serializing again
+      if (buffer_remaining >= (int64_t)lazy->size())
+      {
+        memcpy(buffer, lazy->data(), lazy->size());
+
+        size_intermediate = (uint32_t)lazy->size();
+        size = size_intermediate;
+      }
+    }
     else if (is_any_type(type_))
     {
       // madara_logger_ptr_log (logger_, logger::LOG_TRACE,
@@ -0,0 +1,109 @@
+/**
+ * @file MetricsPublisher.cpp
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the MetricsPublisher class, which periodically
+ * publishes the metrics of a context as knowledge and to a Prometheus
+ * text file.
+ **/
+
+#include <chrono>
+
+#include "MetricsPublisher.h"
+
+#include "madara/logger/Logger.h"
+#include "madara/knowledge/ContextGuard.h"
+
+namespace sc = std::chrono;
+
+namespace madara
+{
+namespace knowledge
+{
+MetricsPublisher::MetricsPublisher(ThreadSafeContext& context, double hertz,
+    const std::string& prefix, const std::string& filename)
+  : context_(&context), hertz_(hertz), prefix_(prefix), filename_(filename)
+{
+  thread_ = std::thread(thread_main, this);
+}
+
+MetricsPublisher::~MetricsPublisher()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+
+  stopped_.notify_all();
+
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+}
+
+void MetricsPublisher::publish(void)
+{
+  publish(*context_, prefix_, filename_);
+}
+
+void MetricsPublisher::publish(ThreadSafeContext& context,
+    const std::string& prefix, const std::string& filename)
+{
+  context.sample_metrics();
+
+  utility::Metrics& metrics = context.get_metrics();
+
+  if (prefix != "")
+  {
+    std::vector<std::pair<std::string, int64_t>> samples = metrics.samples();
+
+    ContextGuard guard(context);
+
+    for (auto& sample : samples)
+    {
+      context.set(prefix + "." + sample.first,
+          (KnowledgeRecord::Integer)sample.second);
+    }
+  }
+
+  if (filename != "" && !metrics.save_prometheus(filename))
+  {
+    madara_logger_log(context.get_logger(), logger::LOG_ERROR,
+        "MetricsPublisher::publish:"
+        " unable to write metrics to %s\n",
+        filename.c_str());
+  }
+}
+
+void MetricsPublisher::thread_main(MetricsPublisher* self)
+{
+  auto period = sc::microseconds(
+      int64_t(1000000 / (self->hertz_ > 0 ? self->hertz_ : 1)));
+  auto wakeup = sc::steady_clock::now() + period;
+
+  madara_logger_log(self->context_->get_logger(), logger::LOG_MINOR,
+      "MetricsPublisher::thread_main:"
+      " created thread at %f hertz\n",
+      self->hertz_);
+
+  std::unique_lock<std::mutex> lock(self->mutex_);
+
+  while (!self->stopping_)
+  {
+    if (self->stopped_.wait_until(lock, wakeup) == std::cv_status::timeout)
+    {
+      lock.unlock();
+      self->publish();
+      lock.lock();
+
+      wakeup += period;
+    }
+  }
+
+  // leave the final values for anyone reading after we stop
+  lock.unlock();
+  self->publish();
+}
+}
+}  // namespace madara::knowledge
@@ -0,0 +1,121 @@
+#ifndef MADARA_KNOWLEDGE_METRICS_PUBLISHER_H_
+#define MADARA_KNOWLEDGE_METRICS_PUBLISHER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+
+/**
+ * @file MetricsPublisher.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the MetricsPublisher class, which periodically
+ * publishes the metrics of a context as knowledge and to a Prometheus
+ * text file.
+ **/
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * Publishes the metrics registry of a context at a fixed hertz. Each
+ * metric is set as an integer variable under a prefix, e.g.,
+ * .metrics.transport.sent_bytes. Histograms publish .count, .sum, .max,
+ * .p50, .p90 and .p99 variables. If a file is given, the metrics are
+ * also written there in the Prometheus text format, e.g., for the
+ * textfile collector of the node exporter.
+ **/
+class MADARA_EXPORT MetricsPublisher
+{
+public:
+  /**
+   * Constructor. Starts publishing.
+   *
+   * @param context   the context whose metrics are published
+   * @param hertz     hertz rate for publishing
+   * @param prefix    the variable prefix. Use a . prefix to keep the
+   *                  metrics local. If empty, no variables are set.
+   * @param filename  the Prometheus text file. If empty, no file is
+   *                  written.
+   **/
+  MetricsPublisher(ThreadSafeContext& context, double hertz = 1,
+      const std::string& prefix = ".metrics",
+      const std::string& filename = "");
+
+  /**
+   * Constructor. Starts publishing.
+   *
+   * @param kb        the knowledge base whose metrics are published
+   * @param hertz     hertz rate for publishing
+   * @param prefix    the variable prefix. Use a . prefix to keep the
+   *                  metrics local. If empty, no variables are set.
+   * @param filename  the Prometheus text file. If empty, no file is
+   *                  written.
+   **/
+  MetricsPublisher(KnowledgeBase& kb, double hertz = 1,
+      const std::string& prefix = ".metrics",
+      const std::string& filename = "")
+    : MetricsPublisher(kb.get_context(), hertz, prefix, filename)
+  {
+  }
+
+  // This object spawns a thread which holds a pointer back to this object,
+  // so it cannot be safely copied or moved.
+  MetricsPublisher(const MetricsPublisher&) = delete;
+  MetricsPublisher(MetricsPublisher&&) = delete;
+  MetricsPublisher& operator=(const MetricsPublisher&) = delete;
+  MetricsPublisher& operator=(MetricsPublisher&&) = delete;
+
+  /**
+   * Destructor. Stops publishing.
+   **/
+  ~MetricsPublisher();
+
+  /**
+   * Publishes the metrics now
+   **/
+  void publish(void);
+
+  /**
+   * Publishes the metrics of a context once
+   *
+   * @param context   the context whose metrics are published
+   * @param prefix    the variable prefix. If empty, no variables are set.
+   * @param filename  the Prometheus text file. If empty, no file is
+   *                  written.
+   **/
+  static void publish(ThreadSafeContext& context,
+      const std::string& prefix = ".metrics",
+      const std::string& filename = "");
+
+private:
+  static void thread_main(MetricsPublisher* self);
+
+  ThreadSafeContext* context_;
+
+  double hertz_;
+
+  std::string prefix_;
+
+  std::string filename_;
+
+  /// protects stopping_
+  std::mutex mutex_;
+
+  /// signaled when the publisher stops
+  std::condition_variable stopped_;
+
+  /// true when the thread should exit
+  bool stopping_ = false;
+
+  std::thread thread_;
+};
+}
+}  // namespace madara::knowledge
+
+#endif  // MADARA_KNOWLEDGE_METRICS_PUBLISHER_H_
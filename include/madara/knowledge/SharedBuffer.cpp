@@ -0,0 +1,95 @@
+#include "SharedBuffer.h"
+
+namespace madara
+{
+namespace knowledge
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+namespace
+{
+/// the innermost scope of this thread
+thread_local const SharedBuffer::Scope* current_scope = nullptr;
+}
+#endif
+
+SharedBuffer::SharedBuffer(size_t size) : size_(size) {}
+
+char* SharedBuffer::prepare(void)
+{
+  // records from the last message still point into the buffer
+  if (!data_ || data_.use_count() > 1)
+  {
+    // allocate words, so Cap'n Proto messages in the buffer can be aligned
+    data_ = std::shared_ptr<char>(
+        reinterpret_cast<char*>(new uint64_t[(size_ + 7) / 8]),
+        [](char* data) { delete[] reinterpret_cast<uint64_t*>(data); });
+  }
+
+  return data_.get();
+}
+
+#ifndef MADARA_NO_THREAD_LOCAL
+
+SharedBuffer::Scope::Scope(const SharedBuffer* buffer, size_t size)
+  : data_(buffer ? buffer->data_ : nullptr),
+    size_(size),
+    previous_(current_scope)
+{
+  current_scope = this;
+}
+
+SharedBuffer::Scope::Scope(
+    const std::shared_ptr<const char>& data, size_t size)
+  : data_(data), size_(size), previous_(current_scope)
+{
+  current_scope = this;
+}
+
+SharedBuffer::Scope::~Scope()
+{
+  current_scope = previous_;
+}
+
+#else
+
+// without thread local storage, scopes cannot be found, so nothing is
+// shared and received records copy their values
+
+SharedBuffer::Scope::Scope(const SharedBuffer*, size_t)
+  : size_(0), previous_(nullptr)
+{
+}
+
+SharedBuffer::Scope::Scope(const std::shared_ptr<const char>&, size_t)
+  : size_(0), previous_(nullptr)
+{
+}
+
+SharedBuffer::Scope::~Scope() {}
+
+#endif  // MADARA_NO_THREAD_LOCAL
+
+std::shared_ptr<const char> SharedBuffer::share(const char* data, size_t size)
+{
+#ifdef MADARA_NO_THREAD_LOCAL
+  (void)data;
+  (void)size;
+  return nullptr;
+#else
+  if (current_scope == nullptr || !current_scope->data_)
+  {
+    return nullptr;
+  }
+
+  const char* begin = current_scope->data_.get();
+  if (data < begin || data + size > begin + current_scope->size_)
+  {
+    return nullptr;
+  }
+
+  // aliases the buffer, so the buffer lives while data is referenced
+  return std::shared_ptr<const char>(current_scope->data_, data);
+#endif
+}
+}
+}
@@ -0,0 +1,120 @@
+#ifndef _MADARA_KNOWLEDGE_SHARED_BUFFER_H_
+#define _MADARA_KNOWLEDGE_SHARED_BUFFER_H_
+
+/**
+ * @file SharedBuffer.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the SharedBuffer class, a reference counted receive
+ * buffer that received records may point into instead of copying from
+ **/
+
+#include <memory>
+#include "madara/MadaraExport.h"
+#include "madara/utility/IntTypes.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class SharedBuffer
+ * @brief A word aligned receive buffer that records read from it may keep
+ *        referencing. A transport receives into prepare(), and reads the
+ *        message within a Scope. Records read in the scope call share()
+ *        to reference the buffer. The next prepare() allocates a new
+ *        buffer only if records still reference the previous one.
+ *
+ *        Every record that references a buffer keeps the whole buffer
+ *        allocated, however few of its bytes the record uses. Without
+ *        thread local storage (MADARA_NO_THREAD_LOCAL), scopes are not
+ *        tracked and share() always returns null, so records copy.
+ **/
+class MADARA_EXPORT SharedBuffer
+{
+public:
+  /**
+   * Constructor
+   * @param  size   the size of each buffer
+   **/
+  explicit SharedBuffer(size_t size);
+
+  /**
+   * Gets a buffer to receive the next message into
+   * @return  a word aligned buffer of size() bytes
+   **/
+  char* prepare(void);
+
+  /**
+   * Gets the size of each buffer
+   **/
+  size_t size(void) const
+  {
+    return size_;
+  }
+
+  /**
+   * Makes the current buffer available to share() on this thread for the
+   * lifetime of the scope
+   **/
+  class MADARA_EXPORT Scope
+  {
+  public:
+    /**
+     * Constructor
+     * @param  buffer  the buffer a message was received into. If null,
+     *                 no buffer is shared in this scope
+     * @param  size    the number of bytes received
+     **/
+    Scope(const SharedBuffer* buffer, size_t size);
+
+    /**
+     * Constructor
+     * @param  data    the shared bytes. If null, no buffer is shared in
+     *                 this scope
+     * @param  size    the number of bytes
+     **/
+    Scope(const std::shared_ptr<const char>& data, size_t size);
+
+    /**
+     * Destructor, which restores the buffer of the enclosing scope
+     **/
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    friend class SharedBuffer;
+
+    /// the shared bytes
+    std::shared_ptr<const char> data_;
+
+    /// the number of bytes
+    size_t size_;
+
+    /// the scope this one replaced
+    const Scope* previous_;
+  };
+
+  /**
+   * References bytes of the buffer in the current scope
+   * @param  data   the first byte
+   * @param  size   the number of bytes
+   * @return  a pointer to data that keeps the whole buffer alive, or
+   *          null if the bytes are not within the buffer of the current
+   *          scope
+   **/
+  static std::shared_ptr<const char> share(const char* data, size_t size);
+
+private:
+  /// the current buffer
+  std::shared_ptr<char> data_;
+
+  /// the size of each buffer
+  size_t size_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_SHARED_BUFFER_H_
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <iterator>
 #include <memory>
+#include <algorithm>
 
 #include <string.h>
 
@@ -14,6 +15,8 @@
 #include "madara/exceptions/FileException.h"
 #include "madara/exceptions/FilterException.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Tracer.h"
+#include "madara/utility/LockProfiler.h"
 
 #include "madara/knowledge/ThreadSafeContext.h"
 #include "madara/knowledge/ContextGuard.h"
@@ -39,7 +42,13 @@ ThreadSafeContext::ThreadSafeContext()
     interpreter_(new madara::expression::Interpreter())
 #endif  // _MADARA_NO_KARL_
     ,
-    logger_(logger::global_logger.get())
+    logger_(logger::global_logger.get()),
+    lock_wait_metric_(metrics_.histogram("context.lock_wait_ns",
+        "Nanoseconds spent waiting for contended context locks")),
+    evaluations_metric_(metrics_.counter(
+        "context.evaluations", "Compiled KaRL expressions evaluated")),
+    map_size_metric_(
+        metrics_.gauge("context.map_size", "Variables in the context"))
 {
   expansion_splitters_.push_back("{");
   expansion_splitters_.push_back("}");
@@ -78,7 +87,7 @@ KnowledgeRecord* ThreadSafeContext::get_record(
 
   // if the variable doesn't exist, hash maps create a record automatically
   // when used in this manner
-  return &map_[*key_ptr];
+  return &find_or_create_unsafe(*key_ptr)->second;
 }
 
 VariableReference ThreadSafeContext::get_ref(
@@ -102,14 +111,7 @@ VariableReference ThreadSafeContext::get_ref(
     return {};
   }
 
-  auto iter = map_.lower_bound(*key_ptr);
-  if (iter == map_.end() || iter->first != *key_ptr)
-  {
-    iter = map_.emplace_hint(iter, std::piecewise_construct,
-        std::forward_as_tuple(*key_ptr), std::forward_as_tuple());
-  }
-
-  return &*iter;
+  return &*find_or_create_unsafe(*key_ptr);
 }
 
 VariableReference ThreadSafeContext::get_ref(
@@ -139,6 +141,106 @@ VariableReference ThreadSafeContext::get_ref(
   return {const_cast<VariableReference::pair_ptr>(&*found)};
 }
 
+VariableReferences ThreadSafeContext::get_refs(
+    const std::vector<std::string>& keys,
+    const KnowledgeReferenceSettings& settings)
+{
+  VariableReferences refs;
+  refs.reserve(keys.size());
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (const std::string& key : keys)
+  {
+    if (settings.expand_variables)
+    {
+      std::string key_actual = expand_statement(key);
+
+      if (key_actual != "")
+        refs.emplace_back(&*find_or_create_unsafe(key_actual));
+      else
+        refs.emplace_back();
+    }
+    else if (key != "")
+      refs.emplace_back(&*find_or_create_unsafe(key));
+    else
+      refs.emplace_back();
+  }
+
+  return refs;
+}
+
+void ThreadSafeContext::get_batch(const VariableReferences& variables,
+    std::vector<KnowledgeRecord>& values,
+    const KnowledgeReferenceSettings& settings) const
+{
+  values.clear();
+  values.reserve(variables.size());
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (const VariableReference& variable : variables)
+  {
+    const KnowledgeRecord* record = variable.get_record_unsafe();
+
+    if (record == nullptr)
+    {
+      values.emplace_back();
+      continue;
+    }
+
+    if (settings.exception_on_unitialized && !record->exists())
+    {
+      std::stringstream buffer;
+      buffer << "ERROR: settings do not allow reads of unset vars and ";
+      buffer << variable.get_name() << " is uninitialized";
+      throw exceptions::UninitializedException(buffer.str());
+    }
+
+    if (record->has_history())
+      values.push_back(record->get_newest());
+    else
+      values.push_back(*record);
+  }
+}
+
+void ThreadSafeContext::get_batch(const std::vector<std::string>& keys,
+    std::vector<KnowledgeRecord>& values,
+    const KnowledgeReferenceSettings& settings) const
+{
+  values.clear();
+  values.reserve(keys.size());
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (const std::string& key : keys)
+  {
+    KnowledgeMap::const_iterator found;
+
+    if (settings.expand_variables)
+      found = map_.find(expand_statement(key));
+    else
+      found = map_.find(key);
+
+    if (found == map_.end() || !found->second.exists())
+    {
+      if (settings.exception_on_unitialized)
+      {
+        std::stringstream buffer;
+        buffer << "ERROR: settings do not allow reads of unset vars and ";
+        buffer << key << " is uninitialized";
+        throw exceptions::UninitializedException(buffer.str());
+      }
+
+      values.emplace_back();
+    }
+    else if (found->second.has_history())
+      values.push_back(found->second.get_newest());
+    else
+      values.push_back(found->second);
+  }
+}
+
 // set the value of a variable
 int ThreadSafeContext::set_xml(const VariableReference& variable,
     const char* value, size_t size, const KnowledgeUpdateSettings& settings)
@@ -363,11 +465,14 @@ uint32_t ThreadSafeContext::set_quality(const std::string& key,
   // create the variable if it has never been written to before
   // and update its current value quality to the quality parameter
 
-  if (found == map_.end() || force_update || quality > found->second.quality)
-    map_[*key_ptr].quality = quality;
+  if (found == map_.end())
+    found = find_or_create_unsafe(*key_ptr);
+
+  if (force_update || quality > found->second.quality)
+    found->second.quality = quality;
 
   // return current quality
-  return map_[*key_ptr].quality;
+  return found->second.quality;
 }
 
 /// Set quality of this process writing to a variable
@@ -389,7 +494,7 @@ void ThreadSafeContext::set_write_quality(const std::string& key,
 
   // create the variable if it has never been written to before
   // and update its local process write quality to the quality parameter
-  map_[*key_ptr].write_quality = quality;
+  find_or_create_unsafe(*key_ptr)->second.write_quality = quality;
 }
 
 /// Set if the variable value will be different. Always updates clock to
@@ -445,9 +550,7 @@ int ThreadSafeContext::set_if_unequal(const std::string& key,
   }
   else
   {
-    auto ret = map_.emplace(std::piecewise_construct,
-        std::forward_as_tuple(*key_ptr), std::make_tuple());
-    found = ret.first;
+    found = find_or_create_unsafe(*key_ptr);
   }
 
   KnowledgeRecord& record = found->second;
@@ -531,9 +634,7 @@ int ThreadSafeContext::set_if_unequal(const std::string& key, double value,
   }
   else
   {
-    auto ret = map_.emplace(std::piecewise_construct,
-        std::forward_as_tuple(*key_ptr), std::make_tuple());
-    found = ret.first;
+    found = find_or_create_unsafe(*key_ptr);
   }
 
   KnowledgeRecord& record = found->second;
@@ -617,9 +718,7 @@ int ThreadSafeContext::set_if_unequal(const std::string& key,
   }
   else
   {
-    auto ret = map_.emplace(std::piecewise_construct,
-        std::forward_as_tuple(*key_ptr), std::make_tuple());
-    found = ret.first;
+    found = find_or_create_unsafe(*key_ptr);
   }
 
   KnowledgeRecord& record = found->second;
@@ -706,7 +805,11 @@ int ThreadSafeContext::update_record_from_external(const std::string& key,
         std::forward_as_tuple(*key_ptr), std::forward_as_tuple(rhs));
     found = ret.first;
 
-    if (!ret.second)
+    if (ret.second)
+    {
+      journal_key_unsafe(found);
+    }
+    else
     {
       ret.first->second = rhs;
     }
@@ -1072,6 +1175,9 @@ CompiledExpression ThreadSafeContext::compile(const std::string& expression)
 KnowledgeRecord ThreadSafeContext::evaluate(
     CompiledExpression expression, const KnowledgeUpdateSettings& settings)
 {
+  MADARA_TRACE_SPAN("karl_evaluate");
+  MADARA_LOCK_CATEGORY(EVALUATE);
+  evaluations_metric_.add();
   MADARA_GUARD_TYPE guard(mutex_);
   return expression.expression.evaluate(settings);
 }
@@ -1079,6 +1185,9 @@ KnowledgeRecord ThreadSafeContext::evaluate(
 KnowledgeRecord ThreadSafeContext::evaluate(
     expression::ComponentNode* root, const KnowledgeUpdateSettings& settings)
 {
+  MADARA_TRACE_SPAN("karl_evaluate");
+  MADARA_LOCK_CATEGORY(EVALUATE);
+  evaluations_metric_.add();
   MADARA_GUARD_TYPE guard(mutex_);
   if (root)
     return root->evaluate(settings);
@@ -1307,6 +1416,8 @@ void ThreadSafeContext::delete_prefix(
       get_prefix_range(prefix));
 
   map_.erase(iters.first, iters.second);
+  reset_key_journal_unsafe();
+  erase_array_deltas_prefix_unsafe(prefix);
 
   {
     // check the changed map
@@ -1431,6 +1542,43 @@ KnowledgeMap ThreadSafeContext::to_map_stripped(const std::string& prefix) const
   return ret;
 }
 
+bool ThreadSafeContext::get_new_keys(const std::string& prefix,
+    uint64_t& position, std::vector<std::string>& names) const
+{
+  // enter the mutex
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  uint64_t end = key_journal_begin_ + key_journal_.size();
+  bool journaled = position >= key_journal_begin_ && position <= end;
+
+  if (journaled)
+  {
+    for (auto i = key_journal_.begin() + (position - key_journal_begin_);
+         i != key_journal_.end(); ++i)
+    {
+      if ((*i)->compare(0, prefix.size(), prefix) == 0)
+      {
+        names.push_back(**i);
+      }
+    }
+  }
+  else
+  {
+    // the journal has lost names since position, so list every name
+    std::pair<KnowledgeMap::const_iterator, KnowledgeMap::const_iterator>
+        iters(get_prefix_range(prefix));
+
+    for (; iters.first != iters.second; ++iters.first)
+    {
+      names.push_back(iters.first->first);
+    }
+  }
+
+  position = end;
+
+  return journaled;
+}
+
 void ThreadSafeContext::copy(const ThreadSafeContext& source,
     const KnowledgeRequirements& reqs, const KnowledgeUpdateSettings& settings)
 {
@@ -1551,6 +1699,9 @@ void ThreadSafeContext::copy(const ThreadSafeContext& source,
       mark_modified(iters.first->first, settings);
     }
   }
+
+  // copied variables are not journaled, so callers rescan
+  reset_key_journal_unsafe();
 }
 
 void ThreadSafeContext::copy(const ThreadSafeContext& source,
@@ -1588,6 +1739,9 @@ void ThreadSafeContext::copy(const ThreadSafeContext& source,
       }
     }
   }
+
+  // copied variables are not journaled, so callers rescan
+  reset_key_journal_unsafe();
 }
 
 int64_t ThreadSafeContext::save_context(
@@ -1603,6 +1757,7 @@ int64_t ThreadSafeContext::save_context(
 int64_t ThreadSafeContext::save_context(
     const CheckpointSettings& settings) const
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
   madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
       "ThreadSafeContext::save_context:"
       " opening file %s\n",
@@ -1780,6 +1935,7 @@ int64_t ThreadSafeContext::save_as_karl(const std::string& filename) const
 int64_t ThreadSafeContext::save_as_karl(
     const CheckpointSettings& settings) const
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
   madara_logger_ptr_log(logger_, logger::LOG_MINOR,
       "ThreadSafeContext::save_as_karl:"
       " opening file %s\n",
@@ -1952,6 +2108,7 @@ int64_t ThreadSafeContext::save_as_json(const std::string& filename) const
 int64_t ThreadSafeContext::save_as_json(
     const CheckpointSettings& settings) const
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
   madara_logger_ptr_log(logger_, logger::LOG_MINOR,
       "ThreadSafeContext::save_as_json:"
       " opening file %s\n",
@@ -2125,6 +2282,7 @@ int64_t ThreadSafeContext::load_context(const std::string& filename,
 int64_t ThreadSafeContext::load_context(const std::string& filename,
     FileHeader& meta, const KnowledgeUpdateSettings& settings)
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
   madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
       "ThreadSafeContext::load_context:"
       " opening file %s for just header info\n",
@@ -2266,6 +2424,7 @@ std::string ThreadSafeContext::file_to_string(
 int64_t ThreadSafeContext::load_context(CheckpointSettings& checkpoint_settings,
     const KnowledgeUpdateSettings& update_settings)
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
   CheckpointReader reader(checkpoint_settings);
 
   reader.start();
@@ -2772,6 +2931,7 @@ static void checkpoint_do_initial(const ThreadSafeContext& context,
 int64_t ThreadSafeContext::save_checkpoint(
     const CheckpointSettings& settings) const
 {
+  MADARA_LOCK_CATEGORY(CHECKPOINT);
   madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
       "ThreadSafeContext::save_checkpoint:"
       " opening file %s\n",
@@ -2831,5 +2991,523 @@ int64_t ThreadSafeContext::save_checkpoint(
 
   return save_checkpoint(settings);
 }
+
+void ThreadSafeContext::set_time_series_capacity(
+    const std::string& key, size_t capacity, bool compressed)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (capacity == 0)
+  {
+    time_series_.erase(key);
+    return;
+  }
+
+  std::unique_ptr<TimeSeries>& series = time_series_[key];
+
+  if (series && series->capacity() == capacity &&
+      series->is_compressed() == compressed)
+  {
+    return;
+  }
+
+  series.reset(new TimeSeries(capacity, compressed));
+
+  auto found = map_.find(key);
+
+  if (found != map_.end() && found->second.exists())
+  {
+    const KnowledgeRecord* record = &found->second;
+    if (record->has_history())
+    {
+      record = &record->ref_newest();
+    }
+
+    series->add(record->toi(), *record);
+  }
+}
+
+size_t ThreadSafeContext::get_time_series_size(const std::string& key) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = time_series_.find(key);
+
+  return found != time_series_.end() ? found->second->size() : 0;
+}
+
+std::vector<TimeSeries::Sample> ThreadSafeContext::get_time_series(
+    const std::string& key, uint64_t start, uint64_t end) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = time_series_.find(key);
+
+  if (found == time_series_.end())
+  {
+    return std::vector<TimeSeries::Sample>();
+  }
+
+  return found->second->get(start, end);
+}
+
+TimeSeries::Window ThreadSafeContext::summarize_time_series(
+    const std::string& key, uint64_t start, uint64_t end) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = time_series_.find(key);
+
+  if (found == time_series_.end())
+  {
+    TimeSeries::Window result = {start, 0, 0, 0, 0, 0};
+    return result;
+  }
+
+  return found->second->summarize(start, end);
+}
+
+std::vector<TimeSeries::Window> ThreadSafeContext::aggregate_time_series(
+    const std::string& key, uint64_t window, uint64_t start,
+    uint64_t end) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = time_series_.find(key);
+
+  if (found == time_series_.end())
+  {
+    return std::vector<TimeSeries::Window>();
+  }
+
+  return found->second->aggregate(window, start, end);
+}
+
+void ThreadSafeContext::enable_array_deltas(uint32_t full_interval)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  array_deltas_enabled_ = true;
+  array_delta_full_interval_ = full_interval;
+}
+
+void ThreadSafeContext::set_send_rate(const std::string& prefix, double hertz)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (hertz > 0)
+  {
+    send_periods_[prefix] = (uint64_t)(1000000000.0 / hertz);
+  }
+  else
+  {
+    send_periods_.erase(prefix);
+
+    // forget the send times of variables that are no longer capped
+    for (auto i = send_times_.lower_bound(prefix);
+         i != send_times_.end() &&
+         i->first.compare(0, prefix.size(), prefix) == 0;)
+    {
+      if (find_send_period_unsafe(i->first.c_str()) == nullptr)
+      {
+        send_held_.erase(i->first);
+        i = send_times_.erase(i);
+      }
+      else
+      {
+        ++i;
+      }
+    }
+  }
+}
+
+void ThreadSafeContext::set_send_held_listener(SendHeldListener listener)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  send_held_listener_ = std::move(listener);
+}
+
+void ThreadSafeContext::clear_send_rates(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  send_periods_.clear();
+  send_times_.clear();
+  send_held_.clear();
+}
+
+const uint64_t* ThreadSafeContext::find_send_period_unsafe(
+    const char* name) const
+{
+  /**
+   * Every cap that the name starts with sorts between that cap and the
+   * name, so the first match walking back from the name is the longest.
+   * Caps with a different first character cannot match, except an empty
+   * cap, which sorts first.
+   **/
+  auto cap = send_periods_.upper_bound(name);
+
+  while (cap != send_periods_.begin())
+  {
+    --cap;
+
+    const std::string& prefix = cap->first;
+
+    if (strncmp(prefix.c_str(), name, prefix.size()) == 0)
+    {
+      return &cap->second;
+    }
+    else if (prefix[0] != name[0])
+    {
+      cap = send_periods_.begin();
+
+      return cap->first.empty() ? &cap->second : nullptr;
+    }
+  }
+
+  return nullptr;
+}
+
+bool ThreadSafeContext::is_send_due_unsafe(
+    const char* name, uint64_t now, bool reset)
+{
+  const uint64_t* period = find_send_period_unsafe(name);
+
+  if (period == nullptr)
+  {
+    return true;
+  }
+
+  uint64_t& last_sent = send_times_[name];
+
+  if (last_sent != 0 && now < last_sent + *period)
+  {
+    // remember the held variable so the send thread can flush it
+    if (send_held_.insert(name).second && send_held_listener_)
+    {
+      send_held_listener_();
+    }
+
+    return false;
+  }
+
+  if (reset)
+  {
+    last_sent = now;
+
+    if (!send_held_.empty())
+    {
+      send_held_.erase(name);
+    }
+  }
+
+  return true;
+}
+
+uint64_t ThreadSafeContext::get_held_modifieds(KnowledgeMap& due, bool reset)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (send_periods_.empty())
+  {
+    send_held_.clear();
+    return 0;
+  }
+
+  uint64_t now = utility::get_time();
+
+  // with nothing held, sleep until the send held listener is called
+  uint64_t wake = 0;
+
+  for (auto i = send_held_.begin(); i != send_held_.end();)
+  {
+    auto found = changed_map_.find(i->c_str());
+    const uint64_t* period = find_send_period_unsafe(i->c_str());
+
+    // sent since it was held, or no longer capped
+    if (found == changed_map_.end() || period == nullptr)
+    {
+      i = send_held_.erase(i);
+      continue;
+    }
+
+    uint64_t& last_sent = send_times_[*i];
+    uint64_t due_time = last_sent + *period;
+
+    if (now >= due_time)
+    {
+      due.emplace_hint(
+          due.end(), found->first, *found->second.get_record_unsafe());
+
+      if (reset)
+      {
+        last_sent = now;
+        changed_map_.erase(found);
+        i = send_held_.erase(i);
+        continue;
+      }
+    }
+    else if (wake == 0 || due_time < wake)
+    {
+      wake = due_time;
+    }
+
+    ++i;
+  }
+
+  if (reset && array_deltas_enabled_ && !due.empty())
+  {
+    prepare_array_deltas_unsafe(due);
+  }
+
+  return wake;
+}
+
+bool ThreadSafeContext::get_array_delta(const std::string& key,
+    const KnowledgeRecord& record, ArrayDelta& delta) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = array_deltas_.find(key);
+
+  // send filters may have replaced the array since the delta was made
+  if (found == array_deltas_.end() || record.has_history() ||
+      found->second.toi != record.toi() ||
+      found->second.type != record.type() ||
+      found->second.size != record.size())
+  {
+    return false;
+  }
+
+  delta = found->second;
+
+  return true;
+}
+
+void ThreadSafeContext::track_array_index_unsafe(const char* name,
+    size_t index, uint64_t prev_toi, uint32_t prev_type, uint32_t prev_size,
+    const KnowledgeRecord& record)
+{
+  ArrayDeltaTracker& tracker = array_delta_trackers_[name];
+
+  if (tracker.ranges.empty())
+  {
+    // the first change since the array was sent
+    tracker.complete = tracker.sent && prev_toi == tracker.sent_toi;
+  }
+  else
+  {
+    // any untracked change in between would have changed the toi
+    tracker.complete = tracker.complete && prev_toi == tracker.toi;
+  }
+
+  // deltas cannot resize an array or change its type
+  if (prev_type != record.type() || prev_size != record.size() ||
+      index >= UINT32_MAX)
+  {
+    tracker.complete = false;
+  }
+
+  if (tracker.complete)
+  {
+    ArrayDelta::add_index(tracker.ranges, (uint32_t)index);
+  }
+  else
+  {
+    tracker.ranges.clear();
+  }
+
+  tracker.toi = record.toi();
+}
+
+void ThreadSafeContext::prepare_array_deltas_unsafe(
+    const KnowledgeMap& modifieds)
+{
+  array_deltas_.clear();
+
+  for (const auto& modified : modifieds)
+  {
+    const KnowledgeRecord& record = modified.second;
+
+    if ((record.type() != KnowledgeRecord::INTEGER_ARRAY &&
+            record.type() != KnowledgeRecord::DOUBLE_ARRAY) ||
+        record.has_history())
+    {
+      continue;
+    }
+
+    // arrays set in full are tracked from their first send
+    ArrayDeltaTracker& tracker = array_delta_trackers_[modified.first];
+
+    // a delta is worth sending if it is under half the size of the array
+    size_t encoded = tracker.ranges.size() + ArrayDelta::count(tracker.ranges);
+
+    if (tracker.complete && !tracker.ranges.empty() &&
+        tracker.toi == record.toi() && encoded * 2 <= record.size() &&
+        (array_delta_full_interval_ == 0 ||
+            tracker.deltas_sent < array_delta_full_interval_))
+    {
+      ArrayDelta& delta = array_deltas_[modified.first];
+      delta.type = record.type();
+      delta.size = record.size();
+      delta.base_toi = tracker.sent_toi;
+      delta.toi = record.toi();
+      delta.ranges.swap(tracker.ranges);
+
+      ++tracker.deltas_sent;
+    }
+    else
+    {
+      tracker.deltas_sent = 0;
+    }
+
+    // receivers of this send hold the array as it is now
+    tracker.ranges.clear();
+    tracker.complete = false;
+    tracker.sent = true;
+    tracker.sent_toi = record.toi();
+  }
+}
+
+void ThreadSafeContext::set_array_delta_base(
+    const std::string& key, uint64_t sent_toi)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = map_.find(key);
+
+  if (found != map_.end())
+  {
+    ArrayDeltaBase& base = array_delta_bases_[key];
+    base.sent_toi = sent_toi;
+    base.local_toi = found->second.toi();
+  }
+}
+
+KnowledgeMap::iterator ThreadSafeContext::find_array_delta_base_unsafe(
+    const std::string& key, const ArrayDelta& delta)
+{
+  auto base = array_delta_bases_.find(key);
+
+  if (base == array_delta_bases_.end() ||
+      base->second.sent_toi != delta.base_toi)
+  {
+    return map_.end();
+  }
+
+  auto found = map_.find(key);
+
+  // a local change or a full update from elsewhere changes the toi
+  if (found == map_.end() || found->second.toi() != base->second.local_toi)
+  {
+    return map_.end();
+  }
+
+  return found;
+}
+
+int ThreadSafeContext::apply_array_delta(const std::string& key,
+    const ArrayDelta& delta, uint32_t quality, uint64_t clock, uint64_t now)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = find_array_delta_base_unsafe(key, delta);
+
+  if (found == map_.end())
+  {
+    return -4;
+  }
+
+  KnowledgeRecord& record = found->second;
+
+  // the same checks as update_record_from_external
+  if (quality < record.quality)
+  {
+    return -2;
+  }
+  else if (quality == record.quality && clock < record.clock)
+  {
+    return -3;
+  }
+
+  if (!delta.patch(record))
+  {
+    return -4;
+  }
+
+  record.quality = quality;
+  record.clock = clock;
+  record.set_toi(now);
+
+  ArrayDeltaBase& base = array_delta_bases_[key];
+  base.sent_toi = delta.toi;
+  base.local_toi = now;
+
+  mark_and_signal(&*found,
+      knowledge::KnowledgeUpdateSettings::GLOBAL_AS_LOCAL_NO_EXPAND);
+
+  if (clock >= clock_)
+  {
+    clock_ = clock + 1;
+  }
+
+  return 1;
+}
+
+bool ThreadSafeContext::copy_array_delta(
+    const std::string& key, const ArrayDelta& delta, KnowledgeRecord& result)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = find_array_delta_base_unsafe(key, delta);
+
+  if (found == map_.end())
+  {
+    return false;
+  }
+
+  result.set_value(found->second);
+
+  if (!delta.patch(result))
+  {
+    return false;
+  }
+
+  result.set_toi(delta.toi);
+
+  return true;
+}
+
+void ThreadSafeContext::erase_array_deltas_unsafe(const std::string& key)
+{
+  if (!array_delta_trackers_.empty())
+  {
+    array_delta_trackers_.erase(key);
+  }
+
+  if (!array_delta_bases_.empty())
+  {
+    array_delta_bases_.erase(key);
+  }
+}
+
+void ThreadSafeContext::erase_array_deltas_prefix_unsafe(
+    const std::string& prefix)
+{
+  for (auto i = array_delta_trackers_.lower_bound(prefix);
+       i != array_delta_trackers_.end() &&
+       i->first.compare(0, prefix.size(), prefix) == 0;)
+  {
+    i = array_delta_trackers_.erase(i);
+  }
+
+  for (auto i = array_delta_bases_.lower_bound(prefix);
+       i != array_delta_bases_.end() &&
+       i->first.compare(0, prefix.size(), prefix) == 0;)
+  {
+    i = array_delta_bases_.erase(i);
+  }
+}
 }
 }
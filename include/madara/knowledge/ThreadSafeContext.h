@@ -11,11 +11,15 @@
 #include "madara/knowledge/FileHeader.h"
 #include "madara/logger/Logger.h"
 
+#include <deque>
+#include <functional>
 #include <string>
 #include <map>
+#include <set>
 #include <memory>
 #include <fstream>
 #include "madara/utility/IntTypes.h"
+#include "madara/utility/Metrics.h"
 
 #include "madara/MadaraExport.h"
 #include "madara/LockType.h"
@@ -28,6 +32,8 @@
 #include "madara/knowledge/CompiledExpression.h"
 #include "madara/knowledge/CheckpointSettings.h"
 #include "madara/knowledge/BaseStreamer.h"
+#include "madara/knowledge/TimeSeries.h"
+#include "madara/knowledge/ArrayDelta.h"
 #include "madara/transport/MessageHeader.h"
 
 #ifdef _MADARA_JAVA_
@@ -388,6 +394,41 @@ public:
       const std::string& key, const KnowledgeReferenceSettings& settings =
                                   KnowledgeReferenceSettings()) const;
 
+  /**
+   * Atomically returns references to many variables, creating those
+   * that do not exist. The context is locked once for all keys.
+   * @param   keys      unique identifiers of the variables
+   * @param settings    settings for referring to knowledge variables
+   * @return            references in the same order as the keys
+   **/
+  VariableReferences get_refs(const std::vector<std::string>& keys,
+      const KnowledgeReferenceSettings& settings =
+          KnowledgeReferenceSettings());
+
+  /**
+   * Atomically gets the current values of many variables. The context is
+   * locked once, so the values are a consistent snapshot.
+   * @param   variables  references to the variables (@see get_refs)
+   * @param   values     filled with one value per variable
+   * @param   settings   settings for referring to knowledge variables
+   **/
+  void get_batch(const VariableReferences& variables,
+      std::vector<KnowledgeRecord>& values,
+      const KnowledgeReferenceSettings& settings =
+          KnowledgeReferenceSettings()) const;
+
+  /**
+   * Atomically gets the current values of many variables. Variables that
+   * do not exist are returned as empty records.
+   * @param   keys       unique identifiers of the variables
+   * @param   values     filled with one value per key
+   * @param   settings   settings for referring to knowledge variables
+   **/
+  void get_batch(const std::vector<std::string>& keys,
+      std::vector<KnowledgeRecord>& values,
+      const KnowledgeReferenceSettings& settings =
+          KnowledgeReferenceSettings()) const;
+
   /**
    * Retrieves a value at a specified index within a knowledge array
    * @param key              knowledge location
@@ -553,6 +594,36 @@ public:
       T&& value,
       const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
 
+  /**
+   * NON-Atomically sets several array indices of a variable, marking the
+   * variable modified and signaling changes once for the whole update.
+   * THIS IS NOT A THREAD-SAFE FUNCTION.
+   * @param   variable  reference to a variable (@see get_ref)
+   * @param   indices   indices within the array
+   * @param   values    new values of the indices, one per index
+   * @param   settings  settings for applying the update
+   * @return   0 if the values were set. -2 if quality was too low
+   **/
+  template<typename T>
+  int set_indices_unsafe(const VariableReference& variable,
+      const std::vector<size_t>& indices, const std::vector<T>& values,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * NON-Atomically sets several array indices of a variable to one value,
+   * marking the variable modified and signaling changes once.
+   * THIS IS NOT A THREAD-SAFE FUNCTION.
+   * @param   variable  reference to a variable (@see get_ref)
+   * @param   indices   indices within the array
+   * @param   value     new value of every index
+   * @param   settings  settings for applying the update
+   * @return   0 if the values were set. -2 if quality was too low
+   **/
+  template<typename T>
+  int fill_indices_unsafe(const VariableReference& variable,
+      const std::vector<size_t>& indices, const T& value,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
   /**
    * Atomically sets the value of a variable to the specific record.
    * Note, this does not copy meta information (e.g. quality, clock).
@@ -713,6 +784,34 @@ public:
   int set(const VariableReference& variable, const T* value, uint32_t size,
       const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
 
+  /**
+   * Atomically sets many variables. The context is locked once, and
+   * waiting threads are signaled once after all values are set.
+   * @param   variables  references to the variables (@see get_refs)
+   * @param   values     new values, one per variable
+   * @param   settings   settings for applying the update
+   * @return   0 if all values were set. -1 if the sizes differ or a
+   *           reference is null. -2 if a write quality was too low.
+   **/
+  template<typename T>
+  int set_batch(const VariableReferences& variables,
+      const std::vector<T>& values,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * Atomically sets many variables. The context is locked once, and
+   * waiting threads are signaled once after all values are set.
+   * @param   keys       unique identifiers of the variables
+   * @param   values     new values, one per key
+   * @param   settings   settings for applying the update
+   * @return   0 if all values were set. -1 if the sizes differ or a
+   *           key is null. -2 if a write quality was too low.
+   **/
+  template<typename T>
+  int set_batch(const std::vector<std::string>& keys,
+      const std::vector<T>& values,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
   /**
    * NON-Atomically sets the value of a variable to the specific value.
    * THIS IS NOT A THREAD-SAFE FUNCTION.
@@ -884,7 +983,8 @@ public:
   const VariableReferenceMap& get_modifieds(void) const;
 
   /**
-   * Retrieves the current modifieds map
+   * Retrieves the current modifieds map. Variables held back by
+   * set_send_rate are left out and stay modified.
    * @param   send_list map of variables that limit what will be sent
    * @param   reset     reset modifieds atomically
    * @return  the modified knowledge records
@@ -1519,6 +1619,19 @@ public:
    **/
   void attach_logger(logger::Logger& logger) const;
 
+  /**
+   * Gets the metrics of this context and the transports, interpreter
+   * and threaders that use it
+   * @return the context's metrics registry
+   **/
+  utility::Metrics& get_metrics(void) const;
+
+  /**
+   * Updates metrics that are sampled rather than counted, such as the
+   * number of variables. Called before metrics are published.
+   **/
+  void sample_metrics(void) const;
+
   /**
    * Fills a variable map with list of keys according to a matching prefix,
    * suffix, and delimiter hierarchy. This is useful for understanding the
@@ -1563,6 +1676,25 @@ public:
    **/
   knowledge::KnowledgeMap to_map_stripped(const std::string& prefix) const;
 
+  /**
+   * Gets the names of variables created since an earlier call, without
+   * copying any values. The context journals the most recently created
+   * names, so a caller that is up to date only looks at new names.
+   *
+   * @param   prefix      Prefix the returned names must start with
+   * @param   position    The position returned by the last call, or 0 for
+   *                      the first call. Set to the current position.
+   * @param   names       Appended with the names starting with prefix
+   * @return              true if names holds only the variables created
+   *                      since position. false if the journal no longer
+   *                      reaches back to position, e.g., because variables
+   *                      were deleted or copied in bulk since then. In this
+   *                      case, names holds all variables starting with
+   *                      prefix.
+   **/
+  bool get_new_keys(const std::string& prefix, uint64_t& position,
+      std::vector<std::string>& names) const;
+
   /**
    * Saves the context to a file
    * @param   filename    name of the file to open
@@ -1717,6 +1849,208 @@ public:
     return streamer;
   }
 
+  /**
+   * Callback for record modifications. Receives the name of the record.
+   **/
+  typedef std::function<void(const char*)> ChangeListener;
+
+  /**
+   * Registers a callback that is invoked with the name of each record
+   * modified through this context, including updates applied by
+   * transports. Callbacks are invoked while the context is locked, so
+   * they should only note the change and return quickly.
+   * @param listener  the callback to invoke on modifications
+   * @return an id that can be passed to remove_change_listener
+   **/
+  uint64_t add_change_listener(ChangeListener listener);
+
+  /**
+   * Unregisters a callback added with add_change_listener. The callback
+   * will not be invoked after this returns.
+   * @param id   the id returned by add_change_listener
+   **/
+  void remove_change_listener(uint64_t id);
+
+  /**
+   * Keeps a columnar history of the integer or double values of a
+   * variable, sampled with the toi of each modification. This is much
+   * smaller than set_history_capacity on the record, and supports time
+   * range queries. The current value, if any, is the first sample.
+   * @param key         the variable name
+   * @param capacity    the number of samples to keep. 0 removes the
+   *                    history.
+   * @param compressed  true to compress samples
+   **/
+  void set_time_series_capacity(
+      const std::string& key, size_t capacity, bool compressed = false);
+
+  /**
+   * Returns the number of samples in the columnar history of a variable
+   * @param key         the variable name
+   * @return  the number of samples, or 0 if the variable has no history
+   **/
+  size_t get_time_series_size(const std::string& key) const;
+
+  /**
+   * Returns samples from the columnar history of a variable
+   * @param key         the variable name
+   * @param start       the earliest toi to include
+   * @param end         the latest toi to include
+   * @return  the samples, oldest first
+   **/
+  std::vector<TimeSeries::Sample> get_time_series(const std::string& key,
+      uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+  /**
+   * Returns statistics of the columnar history of a variable
+   * @param key         the variable name
+   * @param start       the earliest toi to include
+   * @param end         the latest toi to include
+   * @return  the statistics. count is 0 if there are no samples.
+   **/
+  TimeSeries::Window summarize_time_series(const std::string& key,
+      uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+  /**
+   * Downsamples the columnar history of a variable into windows
+   * @param key         the variable name
+   * @param window      the duration of each window in nanoseconds. If 0,
+   *                    the range is one window.
+   * @param start       the earliest toi to include. Windows begin here.
+   * @param end         the latest toi to include
+   * @return  statistics for each window that has samples
+   **/
+  std::vector<TimeSeries::Window> aggregate_time_series(
+      const std::string& key, uint64_t window, uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+  /**
+   * Calls a function with samples from the columnar history of a
+   * variable without copying them. The context is locked during the
+   * calls.
+   * @param key         the variable name
+   * @param func        called with (uint64_t toi, double value)
+   * @param start       the earliest toi to include
+   * @param end         the latest toi to include
+   * @return  the number of samples visited
+   **/
+  template<typename Func>
+  size_t for_time_series(const std::string& key, Func&& func,
+      uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    auto found = time_series_.find(key);
+
+    if (found == time_series_.end())
+    {
+      return 0;
+    }
+
+    return found->second->for_each(std::forward<Func>(func), start, end);
+  }
+
+  /**
+   * Tracks the elements of integer and double arrays changed through
+   * set_index, so that transports with send_array_deltas can send only
+   * those elements. Tracking starts with the next change to each array.
+   * @param full_interval  maximum number of consecutive deltas of an
+   *                       array before it is sent in full. 0 never forces
+   *                       a full update.
+   **/
+  void enable_array_deltas(uint32_t full_interval);
+
+  /**
+   * Returns the delta of an array that is being sent. Deltas are made
+   * by get_modifieds_current when it resets the modifieds.
+   * @param key     the variable name
+   * @param record  the array being sent
+   * @param delta   set to the changed elements of the record
+   * @return  true if the record can be sent as the delta
+   **/
+  bool get_array_delta(const std::string& key, const KnowledgeRecord& record,
+      ArrayDelta& delta) const;
+
+  /**
+   * Remembers the sender's toi of an array applied from a transport, so
+   * that deltas made from it can be applied. Transports call this after
+   * applying a full update of an integer or double array.
+   * @param key       the variable name
+   * @param sent_toi  the toi the sender gave the array
+   **/
+  void set_array_delta_base(const std::string& key, uint64_t sent_toi);
+
+  /**
+   * Applies a received delta to an array in place, with the same quality
+   * and clock checks as a full update from a transport
+   * @param key      the variable name
+   * @param delta    the decoded delta
+   * @param quality  the quality of the update
+   * @param clock    the clock of the update
+   * @param now      the local toi to give the array
+   * @return  1 if the array was changed, -2 if the quality was too low,
+   *          -3 if the clock was too old, -4 if the local array is not
+   *          the one the delta was made from
+   **/
+  int apply_array_delta(const std::string& key, const ArrayDelta& delta,
+      uint32_t quality, uint64_t clock, uint64_t now);
+
+  /**
+   * Copies an array and applies a received delta to the copy, e.g., so
+   * that receive filters see the whole array. The context is unchanged.
+   * @param key     the variable name
+   * @param delta   the decoded delta
+   * @param result  set to the array after the changes, with the toi of
+   *                the sender
+   * @return  false if the local array is not the one the delta was made
+   *          from
+   **/
+  bool copy_array_delta(const std::string& key, const ArrayDelta& delta,
+      KnowledgeRecord& result);
+
+  /**
+   * Caps how often variables are sent. Changes to a capped variable
+   * between sends are coalesced: it stays modified, and its latest value
+   * is sent by the first get_modifieds_current (and so send_modifieds)
+   * after the cap allows it. Other variables are sent as usual, so a
+   * noisy variable does not crowd them out of the transports' limits.
+   * A variable follows the cap of the longest prefix it starts with.
+   * @param prefix  a variable name or a prefix of variable names
+   * @param hertz   the most sends per second. 0 or less removes the cap
+   *                and forgets when the variables it covered were sent.
+   **/
+  void set_send_rate(const std::string& prefix, double hertz);
+
+  /// callback for a capped variable being held back
+  typedef std::function<void(void)> SendHeldListener;
+
+  /**
+   * Registers a callback made when a capped variable is held back and
+   * was not already held. The callback is made while the context lock is
+   * held, so it must not block on locks held while locking the context.
+   * @param listener  the callback, or an empty function to remove it
+   **/
+  void set_send_held_listener(SendHeldListener listener);
+
+  /**
+   * Removes all caps set by set_send_rate
+   **/
+  void clear_send_rates(void);
+
+  /**
+   * Retrieves the modified variables held back by set_send_rate that
+   * their caps now allow to be sent. Used by the knowledge base's send
+   * thread to flush held values when their producers stop changing them.
+   * @param   due    the held variables that may be sent now
+   * @param   reset  mark the due variables as sent atomically
+   * @return  when the next held variable is due, in nanoseconds. 0 if
+   *          nothing is held or only variables waiting for a transport.
+   **/
+  uint64_t get_held_modifieds(KnowledgeMap& due, bool reset);
+
   /**
    * NOT THREAD SAFE!
    *
@@ -1730,6 +2064,9 @@ public:
    **/
   KnowledgeMap& get_map_unsafe(void)
   {
+    // the caller may add or remove variables behind the journal's back
+    reset_key_journal_unsafe();
+
     return map_;
   }
 
@@ -1860,12 +2197,96 @@ private:
       T&& value,
       const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
 
+  /**
+   * Adds a change made by set_index to the tracked changes of an array
+   * @param  name       the variable name
+   * @param  index      the changed index
+   * @param  prev_toi   the toi of the record before the change
+   * @param  prev_type  the type of the record before the change
+   * @param  prev_size  the size of the record before the change
+   * @param  record     the record after the change
+   **/
+  void track_array_index_unsafe(const char* name, size_t index,
+      uint64_t prev_toi, uint32_t prev_type, uint32_t prev_size,
+      const KnowledgeRecord& record);
+
+  /**
+   * Makes the deltas of the arrays about to be sent and records the
+   * state of each tracked array as sent
+   * @param  modifieds  the records about to be sent
+   **/
+  void prepare_array_deltas_unsafe(const KnowledgeMap& modifieds);
+
+  /**
+   * Finds the array a received delta was made from
+   * @param  key    the variable name
+   * @param  delta  the decoded delta
+   * @return  the entry of the local array, or map_.end() if it is missing
+   *          or has changed since the update the delta was made from was
+   *          applied
+   **/
+  KnowledgeMap::iterator find_array_delta_base_unsafe(
+      const std::string& key, const ArrayDelta& delta);
+
+  /**
+   * Forgets the delta state of an array, e.g., when it is deleted or
+   * cleared
+   * @param  key    the variable name
+   **/
+  void erase_array_deltas_unsafe(const std::string& key);
+
+  /**
+   * Forgets the delta state of the arrays with names starting with a
+   * prefix
+   * @param  prefix  the name prefix
+   **/
+  void erase_array_deltas_prefix_unsafe(const std::string& prefix);
+
   std::pair<KnowledgeMap::const_iterator, KnowledgeMap::const_iterator>
   get_prefix_range(const std::string& prefix) const;
 
   std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator> get_prefix_range(
       const std::string& prefix);
 
+  /**
+   * Finds a variable, creating it and adding it to the key journal if
+   * it does not exist. Skips all safety checks and variable expansions.
+   * @param  key   the name of the variable
+   * @return  the entry of the variable
+   **/
+  KnowledgeMap::iterator find_or_create_unsafe(const std::string& key);
+
+  /**
+   * Adds a created variable to the key journal
+   * @param  entry   the entry of the created variable
+   **/
+  void journal_key_unsafe(KnowledgeMap::iterator entry);
+
+  /**
+   * Empties the key journal, so callers of get_new_keys rescan the
+   * context. Called when variables are deleted or copied in bulk.
+   **/
+  void reset_key_journal_unsafe(void);
+
+  /// the most names the key journal holds before dropping the oldest
+  static const size_t MAX_KEY_JOURNAL = 65536;
+
+  /**
+   * Checks if a modified variable may be sent under the send rate caps
+   * @param  name   the variable name
+   * @param  now    the current time in nanoseconds
+   * @param  reset  true if the variable will be sent now
+   * @return  true if the variable is not capped or its cap allows a send
+   **/
+  bool is_send_due_unsafe(const char* name, uint64_t now, bool reset);
+
+  /**
+   * Finds the cap of the longest prefix that a variable starts with
+   * @param  name   the variable name
+   * @return  the minimum nanoseconds between sends, or null if uncapped
+   **/
+  const uint64_t* find_send_period_unsafe(const char* name) const;
+
   /// Hash table containing variable names and values.
   madara::knowledge::KnowledgeMap map_;
   mutable MADARA_LOCK_TYPE mutex_;
@@ -1886,6 +2307,65 @@ private:
 
   /// Streaming provider for saving all updates
   std::unique_ptr<BaseStreamer> streamer_ = nullptr;
+
+  /// callbacks for record modifications, by id
+  std::map<uint64_t, ChangeListener> change_listeners_;
+
+  /// the id of the next change listener
+  uint64_t next_change_listener_ = 0;
+
+  /// the last version assigned to a modified record
+  uint64_t modification_version_ = 0;
+
+  /// names of the most recently created variables, oldest first. The
+  /// names are the keys of map_, which live until the journal is reset
+  std::deque<const std::string*> key_journal_;
+
+  /// the position of the first name in key_journal_
+  uint64_t key_journal_begin_ = 0;
+
+  /// columnar histories, by variable name
+  std::map<std::string, std::unique_ptr<TimeSeries>> time_series_;
+
+  /// true if changes made by set_index to arrays are tracked
+  bool array_deltas_enabled_ = false;
+
+  /// maximum consecutive deltas of an array, or 0 for no limit
+  uint32_t array_delta_full_interval_ = 0;
+
+  /// changes to arrays since they were last sent, by variable name
+  std::map<std::string, ArrayDeltaTracker> array_delta_trackers_;
+
+  /// deltas of the arrays being sent, by variable name
+  std::map<std::string, ArrayDelta> array_deltas_;
+
+  /// arrays applied from transports that deltas can be applied to, by
+  /// variable name
+  std::map<std::string, ArrayDeltaBase> array_delta_bases_;
+
+  /// minimum nanoseconds between sends, by variable name prefix
+  std::map<std::string, uint64_t> send_periods_;
+
+  /// when capped variables were last sent, by variable name
+  std::map<std::string, uint64_t> send_times_;
+
+  /// capped variables left modified until their caps allow a send
+  std::set<std::string> send_held_;
+
+  /// called when a capped variable is first held back
+  SendHeldListener send_held_listener_;
+
+  /// metrics of this context and its users
+  mutable utility::Metrics metrics_;
+
+  /// time spent waiting for contended locks
+  utility::Metrics::Histogram& lock_wait_metric_;
+
+  /// compiled expressions evaluated
+  utility::Metrics::Counter& evaluations_metric_;
+
+  /// the number of variables, updated by sample_metrics
+  utility::Metrics::Gauge& map_size_metric_;
 };
 }
 }
@@ -347,6 +347,55 @@ inline int ThreadSafeContext::set(const VariableReference& variable,
     return -1;
 }
 
+template<typename T>
+inline int ThreadSafeContext::set_batch(const VariableReferences& variables,
+    const std::vector<T>& values, const KnowledgeUpdateSettings& settings)
+{
+  if (variables.size() != values.size())
+    return -1;
+
+  // waiting threads are woken once, after the whole batch is set
+  KnowledgeUpdateSettings batch_settings(settings);
+  batch_settings.signal_changes = false;
+
+  int result = 0;
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (size_t i = 0; i < variables.size(); ++i)
+  {
+    if (!variables[i].is_valid())
+    {
+      result = -1;
+      continue;
+    }
+
+    int ret = set_unsafe_impl(variables[i], settings, values[i]);
+
+    if (ret == 0)
+      mark_and_signal(variables[i], batch_settings);
+    else if (result == 0)
+      result = ret;
+  }
+
+  if (settings.signal_changes)
+    changed_.MADARA_CONDITION_NOTIFY_ALL();
+
+  return result;
+}
+
+template<typename T>
+inline int ThreadSafeContext::set_batch(const std::vector<std::string>& keys,
+    const std::vector<T>& values, const KnowledgeUpdateSettings& settings)
+{
+  if (keys.size() != values.size())
+    return -1;
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  return set_batch(get_refs(keys, settings), values, settings);
+}
+
 template<typename... Args>
 inline int ThreadSafeContext::set_unsafe_impl(const VariableReference& variable,
     const KnowledgeUpdateSettings& settings, Args&&... args)
@@ -508,11 +557,21 @@ inline int ThreadSafeContext::set_index_unsafe_impl(
   else
     record->quality = 0;
 
+  uint64_t prev_toi = record->toi();
+  uint32_t prev_type = record->type();
+  uint32_t prev_size = array_deltas_enabled_ ? record->size() : 0;
+
   record->set_index(index, std::forward<T>(value));
   record->quality = record->write_quality;
   record->clock = clock_;
   record->set_toi(utility::get_time());
 
+  if (array_deltas_enabled_)
+  {
+    track_array_index_unsafe(variable.get_name(), index, prev_toi, prev_type,
+        prev_size, *record);
+  }
+
   return 0;
 }
 
@@ -530,6 +589,48 @@ inline int ThreadSafeContext::set_index_unsafe(
   return ret;
 }
 
+template<typename T>
+inline int ThreadSafeContext::set_indices_unsafe(
+    const VariableReference& variable, const std::vector<size_t>& indices,
+    const std::vector<T>& values, const KnowledgeUpdateSettings& settings)
+{
+  int result = 0;
+  bool changed = false;
+
+  for (size_t i = 0; i < indices.size() && result == 0; ++i)
+  {
+    result = set_index_unsafe_impl(variable, indices[i], values[i], settings);
+    changed = changed || result == 0;
+  }
+
+  // the variable is marked and waiting threads woken once per update
+  if (changed)
+    mark_and_signal(variable, settings);
+
+  return result;
+}
+
+template<typename T>
+inline int ThreadSafeContext::fill_indices_unsafe(
+    const VariableReference& variable, const std::vector<size_t>& indices,
+    const T& value, const KnowledgeUpdateSettings& settings)
+{
+  int result = 0;
+  bool changed = false;
+
+  for (size_t i = 0; i < indices.size() && result == 0; ++i)
+  {
+    result = set_index_unsafe_impl(variable, indices[i], value, settings);
+    changed = changed || result == 0;
+  }
+
+  // the variable is marked and waiting threads woken once per update
+  if (changed)
+    mark_and_signal(variable, settings);
+
+  return result;
+}
+
 inline KnowledgeRecord ThreadSafeContext::inc(
     const std::string& key, const KnowledgeUpdateSettings& settings)
 {
@@ -603,6 +704,7 @@ inline bool ThreadSafeContext::clear(
   if (found)
   {
     record->second.clear_value();
+    erase_array_deltas_unsafe(record->first);
   }
 
   return found;
@@ -619,6 +721,7 @@ inline bool ThreadSafeContext::clear(const VariableReference& variable)
     // local_changed_map_.erase (variable.entry_->first.c_str ());
 
     variable.entry_->second.clear_value();
+    erase_array_deltas_unsafe(variable.entry_->first);
 
     return true;
   }
@@ -654,6 +757,12 @@ inline bool ThreadSafeContext::delete_variable(
   // erase the map
   result = map_.erase(*key_ptr) == 1;
 
+  if (result)
+  {
+    reset_key_journal_unsafe();
+    erase_array_deltas_unsafe(*key_ptr);
+  }
+
   return result;
 }
 
@@ -668,8 +777,17 @@ inline bool ThreadSafeContext::delete_variable(
   changed_map_.erase(var.entry_->first.c_str());
   local_changed_map_.erase(var.entry_->first.c_str());
 
+  // the name is owned by the entry being erased
+  erase_array_deltas_unsafe(var.entry_->first);
+
   // erase the map
-  return map_.erase(var.entry_->first.c_str()) == 1;
+  if (map_.erase(var.entry_->first.c_str()) == 1)
+  {
+    reset_key_journal_unsafe();
+    return true;
+  }
+
+  return false;
 }
 
 inline void ThreadSafeContext::delete_variables(KnowledgeMap::iterator begin,
@@ -679,8 +797,43 @@ inline void ThreadSafeContext::delete_variables(KnowledgeMap::iterator begin,
   {
     changed_map_.erase(cur->first.c_str());
     local_changed_map_.erase(cur->first.c_str());
+    erase_array_deltas_unsafe(cur->first);
   }
   map_.erase(begin, end);
+  reset_key_journal_unsafe();
+}
+
+inline KnowledgeMap::iterator ThreadSafeContext::find_or_create_unsafe(
+    const std::string& key)
+{
+  auto iter = map_.lower_bound(key);
+  if (iter == map_.end() || iter->first != key)
+  {
+    iter = map_.emplace_hint(iter, std::piecewise_construct,
+        std::forward_as_tuple(key), std::forward_as_tuple());
+    journal_key_unsafe(iter);
+  }
+
+  return iter;
+}
+
+inline void ThreadSafeContext::journal_key_unsafe(KnowledgeMap::iterator entry)
+{
+  key_journal_.push_back(&entry->first);
+
+  if (key_journal_.size() > MAX_KEY_JOURNAL)
+  {
+    key_journal_.pop_front();
+    ++key_journal_begin_;
+  }
+}
+
+inline void ThreadSafeContext::reset_key_journal_unsafe(void)
+{
+  // skips past the current position too, so callers that are up to date
+  // also rescan
+  key_journal_begin_ += key_journal_.size() + 1;
+  key_journal_.clear();
 }
 
 // return whether or not the key exists
@@ -779,7 +932,7 @@ inline uint64_t ThreadSafeContext::set_clock(const std::string& key,
     return 0;
 
   // create the key if it didn't exist
-  knowledge::KnowledgeRecord& record = map_[*key_ptr];
+  knowledge::KnowledgeRecord& record = find_or_create_unsafe(*key_ptr)->second;
 
   // check for value already set
   if (record.clock < clock)
@@ -816,7 +969,7 @@ inline uint64_t ThreadSafeContext::inc_clock(
     return 0;
 
   // create the key if it didn't exist
-  knowledge::KnowledgeRecord& record = map_[*key_ptr];
+  knowledge::KnowledgeRecord& record = find_or_create_unsafe(*key_ptr)->second;
 
   return record.clock += settings.clock_increment;
 }
@@ -837,6 +990,11 @@ inline uint64_t ThreadSafeContext::get_clock(void) const
   return clock_;
 }
 
+inline utility::Metrics& ThreadSafeContext::get_metrics(void) const
+{
+  return metrics_;
+}
+
 inline madara::logger::Logger& ThreadSafeContext::get_logger(void) const
 {
   MADARA_GUARD_TYPE guard(mutex_);
@@ -849,6 +1007,12 @@ inline void ThreadSafeContext::attach_logger(logger::Logger& logger) const
   logger_ = &logger;
 }
 
+inline void ThreadSafeContext::sample_metrics(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  map_size_metric_.set((int64_t)map_.size());
+}
+
 /// get the lamport clock for a particular variable
 inline uint64_t ThreadSafeContext::get_clock(
     const std::string& key, const KnowledgeReferenceSettings& settings) const
@@ -887,7 +1051,13 @@ inline uint64_t ThreadSafeContext::get_clock(
 /// all operations to block until the unlock call is made.
 inline void ThreadSafeContext::lock(void) const
 {
-  mutex_.lock();
+  // only contended locks are timed, so uncontended locks stay cheap
+  if (!mutex_.try_lock())
+  {
+    int64_t start = utility::get_time();
+    mutex_.lock();
+    lock_wait_metric_.record(utility::get_time() - start);
+  }
 }
 
 inline bool ThreadSafeContext::try_lock(void) const
@@ -918,10 +1088,13 @@ inline void ThreadSafeContext::clear(bool erase)
 
   changed_map_.clear();
   local_changed_map_.clear();
+  array_delta_trackers_.clear();
+  array_delta_bases_.clear();
 
   if (erase)
   {
     map_.clear();
+    reset_key_journal_unsafe();
   }
   else
   {
@@ -1013,6 +1186,10 @@ inline void ThreadSafeContext::mark_to_checkpoint_unsafe(
 inline void ThreadSafeContext::mark_and_signal(
     VariableReference ref, const KnowledgeUpdateSettings& settings)
 {
+  // versions are never reused, so readers can cache them to skip records
+  // that were not modified since they last looked
+  ref.get_record_unsafe()->set_version(++modification_version_);
+
   // otherwise set the value
   if (ref.get_name()[0] != '.' || settings.treat_locals_as_globals)
   {
@@ -1039,10 +1216,51 @@ inline void ThreadSafeContext::mark_and_signal(
     streamer_->enqueue(ref.get_name(), *rec_ptr);
   }
 
+  if (!time_series_.empty())
+  {
+    auto found = time_series_.find(ref.get_name());
+
+    if (found != time_series_.end())
+    {
+      const KnowledgeRecord* rec_ptr = ref.get_record_unsafe();
+      if (rec_ptr->has_history())
+      {
+        rec_ptr = &rec_ptr->ref_newest();
+      }
+
+      // records changed without a toi are sampled at the current time
+      uint64_t toi = rec_ptr->toi();
+      found->second->add(toi != 0 ? toi : utility::get_time(), *rec_ptr);
+    }
+  }
+
+  for (auto& listener : change_listeners_)
+  {
+    listener.second(ref.get_name());
+  }
+
   if (settings.signal_changes)
     changed_.MADARA_CONDITION_NOTIFY_ALL();
 }
 
+inline uint64_t ThreadSafeContext::add_change_listener(
+    ChangeListener listener)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  uint64_t id = next_change_listener_++;
+  change_listeners_[id] = std::move(listener);
+
+  return id;
+}
+
+inline void ThreadSafeContext::remove_change_listener(uint64_t id)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  change_listeners_.erase(id);
+}
+
 inline void ThreadSafeContext::mark_modified(
     const std::string& key, const KnowledgeUpdateSettings& settings)
 {
@@ -1124,12 +1342,22 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
 
   KnowledgeMap map;
 
+  // capped variables that are not due stay modified until they are
+  bool capped = !send_periods_.empty();
+  uint64_t now = capped ? utility::get_time() : 0;
+
   // if there are no limiting prefixes, iterate through and reset
   if (send_list.size() == 0)
   {
     for (auto i = changed_map_.begin();
          i != changed_map_.end(); )
     {
+      if (capped && !is_send_due_unsafe(i->first, now, reset))
+      {
+        ++i;
+        continue;
+      }
+
       map.emplace_hint (map.end(),
         i->first, *i->second.get_record_unsafe());
 
@@ -1137,6 +1365,10 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
       {
         i = changed_map_.erase(i);
       }
+      else
+      {
+        ++i;
+      }
     }
   }
   // if there are limiting prefixes, only copy over the prefixes
@@ -1149,11 +1381,16 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
       {
         auto found = changed_map_.find(var.first.c_str());
 
-        if (found != changed_map_.end())
+        if (found != changed_map_.end() &&
+            (!capped || is_send_due_unsafe(found->first, now, reset)))
         {
           map.emplace_hint(
             map.end(), found->first, *found->second.get_record_unsafe());
-          changed_map_.erase(found);
+
+          if (reset)
+          {
+            changed_map_.erase(found);
+          }
         }
       }
     }
@@ -1162,7 +1399,8 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
     {
       for (auto i = changed_map_.begin(); i != changed_map_.end();)
       {
-        if (send_list.find (i->first) != send_list.end())
+        if (send_list.find (i->first) != send_list.end() &&
+            (!capped || is_send_due_unsafe(i->first, now, reset)))
         {
           map.emplace_hint (map.end(),
             i->first, *i->second.get_record_unsafe());
@@ -1170,12 +1408,20 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
           if (reset)
           {
             i = changed_map_.erase (i);
+            continue;
           }
         }
+
+        ++i;
       }
     }
   }
 
+  if (reset && array_deltas_enabled_)
+  {
+    prepare_array_deltas_unsafe(map);
+  }
+
   return map;
 }
 
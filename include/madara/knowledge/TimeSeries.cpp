@@ -0,0 +1,314 @@
+#include "TimeSeries.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace
+{
+/// appends an unsigned LEB128 integer
+inline void write_varint(std::vector<unsigned char>& bytes, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    bytes.push_back((unsigned char)(value | 0x80));
+    value >>= 7;
+  }
+
+  bytes.push_back((unsigned char)value);
+}
+
+/// returns the number of zero bytes at the low end of a nonzero value
+inline size_t trailing_zero_bytes(uint64_t value)
+{
+  size_t result = 0;
+
+  while ((value & 0xff) == 0)
+  {
+    value >>= 8;
+    ++result;
+  }
+
+  return result;
+}
+
+/// returns the number of bytes up to the highest nonzero byte
+inline size_t significant_bytes(uint64_t value)
+{
+  size_t result = 0;
+
+  while (value != 0)
+  {
+    value >>= 8;
+    ++result;
+  }
+
+  return result;
+}
+
+/// adds a value to the statistics of a window
+inline void accumulate(TimeSeries::Window& window, double value)
+{
+  if (window.count == 0 || value < window.min)
+  {
+    window.min = value;
+  }
+
+  if (window.count == 0 || value > window.max)
+  {
+    window.max = value;
+  }
+
+  window.sum += value;
+  ++window.count;
+}
+
+/// returns a window without samples
+inline TimeSeries::Window empty_window(uint64_t start)
+{
+  TimeSeries::Window result;
+  result.start = start;
+  result.count = 0;
+  result.min = 0;
+  result.max = 0;
+  result.sum = 0;
+  result.mean = 0;
+
+  return result;
+}
+}
+
+TimeSeries::TimeSeries(size_t capacity, bool compressed)
+  : capacity_(capacity > 0 ? capacity : 1), compressed_(compressed)
+{
+  if (!compressed_)
+  {
+    times_.reserve(capacity_);
+    values_.reserve(capacity_);
+  }
+}
+
+bool TimeSeries::add(uint64_t toi, const KnowledgeRecord& record)
+{
+  if (record.type() != KnowledgeRecord::INTEGER &&
+      record.type() != KnowledgeRecord::DOUBLE)
+  {
+    return false;
+  }
+
+  if (type_ == KnowledgeRecord::EMPTY)
+  {
+    type_ = record.type();
+  }
+
+  if (type_ == KnowledgeRecord::INTEGER)
+  {
+    add_bits(toi, (uint64_t)record.to_integer());
+  }
+  else
+  {
+    double value = record.to_double();
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    add_bits(toi, bits);
+  }
+
+  return true;
+}
+
+void TimeSeries::add(uint64_t toi, double value)
+{
+  if (type_ == KnowledgeRecord::EMPTY)
+  {
+    type_ = KnowledgeRecord::DOUBLE;
+  }
+
+  uint64_t bits;
+
+  if (type_ == KnowledgeRecord::INTEGER)
+  {
+    bits = (uint64_t)(int64_t)value;
+  }
+  else
+  {
+    memcpy(&bits, &value, sizeof(bits));
+  }
+
+  add_bits(toi, bits);
+}
+
+void TimeSeries::add_bits(uint64_t toi, uint64_t bits)
+{
+  // keep the time column sorted for range queries
+  if (size_ > 0 && toi < newest_toi_)
+  {
+    toi = newest_toi_;
+  }
+
+  newest_toi_ = toi;
+
+  if (!compressed_)
+  {
+    times_.push_back(toi);
+    values_.push_back(bits);
+    size_ = times_.size();
+    return;
+  }
+
+  if (blocks_.empty() || blocks_.back().count == block_size)
+  {
+    if (!blocks_.empty())
+    {
+      blocks_.back().bytes.shrink_to_fit();
+    }
+
+    blocks_.emplace_back();
+
+    Block& block = blocks_.back();
+    block.first_toi = block.last_toi = toi;
+    block.first_bits = block.last_bits = bits;
+    block.last_delta = 0;
+    block.count = 1;
+  }
+  else
+  {
+    Block& block = blocks_.back();
+
+    int64_t delta = (int64_t)(toi - block.last_toi);
+    int64_t dod = delta - block.last_delta;
+    write_varint(block.bytes, ((uint64_t)dod << 1) ^ (uint64_t)(dod >> 63));
+
+    uint64_t changed = bits ^ block.last_bits;
+
+    if (changed == 0)
+    {
+      block.bytes.push_back(0);
+    }
+    else
+    {
+      size_t trailing = trailing_zero_bytes(changed);
+      changed >>= 8 * trailing;
+      size_t length = significant_bytes(changed);
+
+      block.bytes.push_back((unsigned char)((trailing << 4) | length));
+
+      for (size_t i = 0; i < length; ++i, changed >>= 8)
+      {
+        block.bytes.push_back((unsigned char)changed);
+      }
+    }
+
+    block.last_toi = toi;
+    block.last_bits = bits;
+    block.last_delta = delta;
+    ++block.count;
+  }
+
+  ++size_;
+
+  // evict whole blocks once the rest still hold the capacity
+  while (blocks_.size() > 1 && size_ - blocks_.front().count >= capacity_)
+  {
+    size_ -= blocks_.front().count;
+    blocks_.pop_front();
+  }
+}
+
+void TimeSeries::clear(void)
+{
+  times_.clear();
+  values_.clear();
+  blocks_.clear();
+  size_ = 0;
+  newest_toi_ = 0;
+}
+
+size_t TimeSeries::memory_size(void) const
+{
+  if (!compressed_)
+  {
+    return (times_.capacity() + values_.capacity()) * sizeof(uint64_t);
+  }
+
+  size_t result = 0;
+
+  for (const Block& block : blocks_)
+  {
+    result += sizeof(Block) + block.bytes.capacity();
+  }
+
+  return result;
+}
+
+std::vector<TimeSeries::Sample> TimeSeries::get(
+    uint64_t start, uint64_t end) const
+{
+  std::vector<Sample> result;
+
+  for_each(
+      [&result](uint64_t toi, double value) {
+        Sample sample;
+        sample.toi = toi;
+        sample.value = value;
+        result.push_back(sample);
+      },
+      start, end);
+
+  return result;
+}
+
+TimeSeries::Window TimeSeries::summarize(uint64_t start, uint64_t end) const
+{
+  Window result = empty_window(start);
+
+  for_each([&result](uint64_t, double value) { accumulate(result, value); },
+      start, end);
+
+  if (result.count > 0)
+  {
+    result.mean = result.sum / result.count;
+  }
+
+  return result;
+}
+
+std::vector<TimeSeries::Window> TimeSeries::aggregate(
+    uint64_t window, uint64_t start, uint64_t end) const
+{
+  if (window == 0)
+  {
+    std::vector<Window> result;
+    Window all = summarize(start, end);
+
+    if (all.count > 0)
+    {
+      result.push_back(all);
+    }
+
+    return result;
+  }
+
+  std::vector<Window> result;
+
+  for_each(
+      [&](uint64_t toi, double value) {
+        uint64_t window_start = start + (toi - start) / window * window;
+
+        if (result.empty() || result.back().start != window_start)
+        {
+          result.push_back(empty_window(window_start));
+        }
+
+        accumulate(result.back(), value);
+      },
+      start, end);
+
+  for (Window& current : result)
+  {
+    current.mean = current.sum / current.count;
+  }
+
+  return result;
+}
+}
+}
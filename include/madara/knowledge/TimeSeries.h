@@ -0,0 +1,307 @@
+#ifndef _MADARA_KNOWLEDGE_TIME_SERIES_H_
+#define _MADARA_KNOWLEDGE_TIME_SERIES_H_
+
+/**
+ * @file TimeSeries.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the TimeSeries class, a compact columnar history of
+ * the numeric values of a record
+ **/
+
+#include <string.h>
+#include <deque>
+#include <limits>
+#include <vector>
+#include "madara/MadaraExport.h"
+#include "madara/utility/IntTypes.h"
+#include "madara/utility/CircularBuffer.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class TimeSeries
+ * @brief Stores the history of an integer or double record as a column of
+ *        timestamps and a column of values. Each sample costs 16 bytes,
+ *        or usually 2 to 6 bytes when compressed, instead of the full
+ *        KnowledgeRecord kept by KnowledgeRecord::set_history_capacity.
+ *
+ *        Compressed series store samples in blocks, encoding timestamps
+ *        as delta-of-deltas and values as the XOR of the previous value.
+ *        Compressed series evict whole blocks, so they may hold up to
+ *        block_size - 1 samples beyond their capacity.
+ *
+ *        Timestamps are expected to be nondecreasing, e.g., the toi of
+ *        the record. Earlier timestamps are stored as the newest one so
+ *        that the time column stays sorted. The column type is set by
+ *        the first sample, and later samples are converted to it.
+ **/
+class MADARA_EXPORT TimeSeries
+{
+public:
+  /**
+   * A timestamped value
+   **/
+  struct Sample
+  {
+    /// the time of the sample, usually in nanoseconds
+    uint64_t toi;
+
+    /// the value
+    double value;
+  };
+
+  /**
+   * Statistics of the samples within a window of time
+   **/
+  struct Window
+  {
+    /// the start of the window
+    uint64_t start;
+
+    /// the number of samples in the window
+    uint64_t count;
+
+    /// the smallest value
+    double min;
+
+    /// the largest value
+    double max;
+
+    /// the sum of the values
+    double sum;
+
+    /// the mean of the values
+    double mean;
+  };
+
+  /// samples per block of a compressed series
+  static const size_t block_size = 128;
+
+  /**
+   * Constructor
+   * @param  capacity    the number of samples to keep. Must be positive.
+   * @param  compressed  true to compress samples
+   **/
+  explicit TimeSeries(size_t capacity, bool compressed = false);
+
+  TimeSeries(const TimeSeries&) = delete;
+  TimeSeries& operator=(const TimeSeries&) = delete;
+
+  /**
+   * Adds a sample
+   * @param  toi     the time of the sample
+   * @param  record  the value. Only integer and double records are
+   *                 stored.
+   * @return  true if the sample was added
+   **/
+  bool add(uint64_t toi, const KnowledgeRecord& record);
+
+  /**
+   * Adds a sample
+   * @param  toi     the time of the sample
+   * @param  value   the value, converted to the column type
+   **/
+  void add(uint64_t toi, double value);
+
+  /**
+   * Removes all samples. The column type is kept.
+   **/
+  void clear(void);
+
+  /**
+   * Returns the number of samples
+   * @return  the number of stored samples
+   **/
+  inline size_t size(void) const
+  {
+    return size_;
+  }
+
+  /**
+   * Returns the number of samples kept
+   * @return  the capacity
+   **/
+  inline size_t capacity(void) const
+  {
+    return capacity_;
+  }
+
+  /**
+   * Checks if samples are compressed
+   * @return  true if compressed
+   **/
+  inline bool is_compressed(void) const
+  {
+    return compressed_;
+  }
+
+  /**
+   * Checks if the values are stored as integers
+   * @return  true if the first sample was an integer
+   **/
+  inline bool is_integer(void) const
+  {
+    return type_ == KnowledgeRecord::INTEGER;
+  }
+
+  /**
+   * Returns the time of the newest sample
+   * @return  the newest toi, or 0 if empty
+   **/
+  inline uint64_t newest_toi(void) const
+  {
+    return newest_toi_;
+  }
+
+  /**
+   * Returns the bytes used to store samples
+   * @return  the approximate memory used by the columns
+   **/
+  size_t memory_size(void) const;
+
+  /**
+   * Calls a function with each sample in a time range, oldest first,
+   * without copying the series.
+   * @param  func    called with (uint64_t toi, double value)
+   * @param  start   the earliest time to include
+   * @param  end     the latest time to include
+   * @return  the number of samples visited
+   **/
+  template<typename Func>
+  size_t for_each(Func&& func, uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+  /**
+   * Returns the samples in a time range, oldest first
+   * @param  start   the earliest time to include
+   * @param  end     the latest time to include
+   * @return  the samples
+   **/
+  std::vector<Sample> get(uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+  /**
+   * Returns statistics of the samples in a time range
+   * @param  start   the earliest time to include
+   * @param  end     the latest time to include
+   * @return  the statistics. count is 0 if no samples are in the range.
+   **/
+  Window summarize(uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+  /**
+   * Downsamples a time range into windows of fixed duration
+   * @param  window  the duration of each window. If 0, the range is one
+   *                 window.
+   * @param  start   the earliest time to include. Windows begin here.
+   * @param  end     the latest time to include
+   * @return  the statistics of each window that has samples
+   **/
+  std::vector<Window> aggregate(uint64_t window, uint64_t start = 0,
+      uint64_t end = std::numeric_limits<uint64_t>::max()) const;
+
+private:
+  /**
+   * A run of compressed samples
+   **/
+  struct Block
+  {
+    /// the time of the first sample
+    uint64_t first_toi;
+
+    /// the value bits of the first sample
+    uint64_t first_bits;
+
+    /// the time of the last sample
+    uint64_t last_toi;
+
+    /// the value bits of the last sample
+    uint64_t last_bits;
+
+    /// the difference between the last two times
+    int64_t last_delta;
+
+    /// the number of samples
+    size_t count;
+
+    /// encoded samples after the first
+    std::vector<unsigned char> bytes;
+  };
+
+  /**
+   * Adds the bits of a value
+   * @param  toi     the time of the sample
+   * @param  bits    the value in the column type
+   **/
+  void add_bits(uint64_t toi, uint64_t bits);
+
+  /**
+   * Converts value bits in the column type to a double
+   * @param  bits    the value bits
+   * @return  the value
+   **/
+  inline double to_double(uint64_t bits) const
+  {
+    if (type_ == KnowledgeRecord::INTEGER)
+    {
+      return (double)(int64_t)bits;
+    }
+
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+
+  /**
+   * Decodes an unsigned LEB128 integer
+   * @param  pos     the next byte, advanced past the integer
+   * @return  the integer
+   **/
+  static inline uint64_t read_varint(const unsigned char*& pos)
+  {
+    uint64_t result = 0;
+    int shift = 0;
+
+    while (*pos & 0x80)
+    {
+      result |= (uint64_t)(*pos++ & 0x7f) << shift;
+      shift += 7;
+    }
+
+    return result | ((uint64_t)*pos++ << shift);
+  }
+
+  /// the maximum number of samples
+  size_t capacity_;
+
+  /// true if samples are stored in compressed blocks
+  bool compressed_;
+
+  /// the column type, INTEGER or DOUBLE, or EMPTY before the first sample
+  uint32_t type_ = KnowledgeRecord::EMPTY;
+
+  /// the number of stored samples
+  size_t size_ = 0;
+
+  /// the time of the newest sample
+  uint64_t newest_toi_ = 0;
+
+  /// the time column of an uncompressed series
+  utility::CircularBuffer<uint64_t> times_;
+
+  /// the value column of an uncompressed series
+  utility::CircularBuffer<uint64_t> values_;
+
+  /// the blocks of a compressed series, oldest first
+  std::deque<Block> blocks_;
+};
+}
+}
+
+#include "TimeSeries.inl"
+
+#endif  // _MADARA_KNOWLEDGE_TIME_SERIES_H_
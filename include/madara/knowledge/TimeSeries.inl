@@ -0,0 +1,116 @@
+#ifndef _MADARA_KNOWLEDGE_TIME_SERIES_INL_
+#define _MADARA_KNOWLEDGE_TIME_SERIES_INL_
+
+/**
+ * @file TimeSeries.inl
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the inlined functions for the TimeSeries class
+ */
+
+#include <algorithm>
+
+namespace madara
+{
+namespace knowledge
+{
+template<typename Func>
+inline size_t TimeSeries::for_each(
+    Func&& func, uint64_t start, uint64_t end) const
+{
+  size_t visited = 0;
+
+  if (!compressed_)
+  {
+    // times are sorted, so binary search for the first sample in range
+    size_t first = times_.front_index();
+    size_t last = first + times_.size();
+    size_t low = first;
+    size_t high = last;
+
+    while (low < high)
+    {
+      size_t mid = low + (high - low) / 2;
+
+      if (times_[mid] < start)
+      {
+        low = mid + 1;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+
+    for (size_t i = low; i < last && times_[i] <= end; ++i, ++visited)
+    {
+      func(times_[i], to_double(values_[i]));
+    }
+
+    return visited;
+  }
+
+  for (const Block& block : blocks_)
+  {
+    if (block.last_toi < start)
+    {
+      continue;
+    }
+
+    if (block.first_toi > end)
+    {
+      break;
+    }
+
+    uint64_t toi = block.first_toi;
+    uint64_t bits = block.first_bits;
+    int64_t delta = 0;
+    const unsigned char* pos = block.bytes.data();
+
+    for (size_t i = 0; i < block.count; ++i)
+    {
+      if (i > 0)
+      {
+        // times are zigzag encoded delta-of-deltas
+        uint64_t encoded = read_varint(pos);
+        delta += (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+        toi += delta;
+
+        // values are the XOR of the previous value, with zero bytes
+        // trimmed from both ends. A control byte of 0 means no change.
+        unsigned char control = *pos++;
+
+        if (control != 0)
+        {
+          size_t length = control & 0x0f;
+          uint64_t changed = 0;
+
+          for (size_t j = 0; j < length; ++j)
+          {
+            changed |= (uint64_t)pos[j] << (8 * j);
+          }
+
+          pos += length;
+          bits ^= changed << (8 * (control >> 4));
+        }
+      }
+
+      if (toi > end)
+      {
+        return visited;
+      }
+
+      if (toi >= start)
+      {
+        func(toi, to_double(bits));
+        ++visited;
+      }
+    }
+  }
+
+  return visited;
+}
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_TIME_SERIES_INL_
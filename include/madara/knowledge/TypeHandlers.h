@@ -59,6 +59,7 @@
 #include "madara/utility/IntTypes.h"
 #include "madara/exceptions/BadAnyAccess.h"
 #include "AnyRegistry.h"
+#include "BufferArchive.h"
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -188,6 +189,9 @@ struct TypeHandlers
   typedef void (*load_fn_type)(const char*, size_t, void*, const char*);
   load_fn_type load;
 
+  typedef size_t (*save_buffer_fn_type)(char*, size_t, const void*);
+  save_buffer_fn_type save_buffer;
+
   typedef void (*save_json_fn_type)(std::ostream&, const void*);
   save_json_fn_type save_json;
 
@@ -311,6 +315,16 @@ constexpr TypeHandlers::load_fn_type get_type_handler_load(
   return nullptr;
 }
 
+/// Creates a function for serializing the given type directly to a buffer,
+/// in the same format as save. If null, Any serializes through save.
+/// Specialize this function to customize otherwise.
+template<typename T>
+constexpr TypeHandlers::save_buffer_fn_type get_type_handler_save_buffer(
+    type<T>, overload_priority_weakest)
+{
+  return nullptr;
+}
+
 // template<typename T>
 // constexpr TypeHandlers::save_capn_fn_type get_type_handler_save_capn(type<T>,
 // overload_priority_weakest)
@@ -420,6 +434,7 @@ inline const TypeHandlers& get_type_handler(type<T> t)
       get_type_handler_clone(t, select_overload()),
       get_type_handler_save(type<T>{}, select_overload()),
       get_type_handler_load(type<T>{}, select_overload()),
+      get_type_handler_save_buffer(type<T>{}, select_overload()),
       get_type_handler_save_json(t, select_overload()),
       get_type_handler_load_json(t, select_overload()),
       get_type_handler_list_fields(t, select_overload()),
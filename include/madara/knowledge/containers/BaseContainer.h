@@ -9,6 +9,11 @@
 #include "madara/knowledge/ThreadSafeContext.h"
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 
+#ifdef _MADARA_PROFILE_LOCK_
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/utility/LockProfiler.h"
+#endif
+
 /**
  * @file BaseContainer.h
  * @author James Edmondson <jedmondson@gmail.com>
@@ -26,6 +31,34 @@ namespace containers
 /// forward declare Collection class for friending
 class Collection;
 
+#ifdef _MADARA_PROFILE_LOCK_
+/**
+ * @class ContextGuard
+ * @brief A knowledge::ContextGuard that attributes its lock to the
+ *        container category of utility::LockProfiler. Container code uses
+ *        ContextGuard unqualified, so it picks this class up when lock
+ *        profiling is enabled.
+ **/
+class ContextGuard : private utility::LockCategoryScope,
+                     public knowledge::ContextGuard
+{
+public:
+  template<typename... Args>
+  ContextGuard(const KnowledgeBase& knowledge, Args&&... args)
+    : utility::LockCategoryScope(utility::LockProfiler::CONTAINER),
+      knowledge::ContextGuard(knowledge, std::forward<Args>(args)...)
+  {
+  }
+
+  template<typename... Args>
+  ContextGuard(const ThreadSafeContext& context, Args&&... args)
+    : utility::LockCategoryScope(utility::LockProfiler::CONTAINER),
+      knowledge::ContextGuard(context, std::forward<Args>(args)...)
+  {
+  }
+};
+#endif  // _MADARA_PROFILE_LOCK_
+
 /**
  * @class BaseContainer
  * @brief This class is an abstract base class for all containers
@@ -5,7 +5,10 @@
 
 madara::knowledge::containers::Map::Map(
     const KnowledgeUpdateSettings& settings, const std::string& delimiter)
-  : BaseContainer("", settings), context_(0), delimiter_(delimiter)
+  : BaseContainer("", settings),
+    context_(0),
+    delimiter_(delimiter),
+    key_position_(0)
 {
 }
 
@@ -14,23 +17,10 @@ madara::knowledge::containers::Map::Map(const std::string& name,
     const std::string& delimiter)
   : BaseContainer(name, settings),
     context_(&(knowledge.get_context())),
-    delimiter_(delimiter)
+    delimiter_(delimiter),
+    key_position_(0)
 {
-  std::map<std::string, knowledge::KnowledgeRecord> contents;
-  std::string common = name + delimiter_;
-  context_->to_map(common, contents);
-
-  KnowledgeUpdateSettings keep_local(true);
-  if (contents.size() > 0)
-  {
-    for (std::map<std::string, knowledge::KnowledgeRecord>::iterator i =
-             contents.begin();
-         i != contents.end(); ++i)
-    {
-      map_[i->first.substr(common.size())] =
-          knowledge.get_ref(i->first, keep_local);
-    }
-  }
+  sync_keys();
 }
 
 madara::knowledge::containers::Map::Map(const std::string& name,
@@ -38,30 +28,18 @@ madara::knowledge::containers::Map::Map(const std::string& name,
     const std::string& delimiter)
   : BaseContainer(name, settings),
     context_(knowledge.get_context()),
-    delimiter_(delimiter)
+    delimiter_(delimiter),
+    key_position_(0)
 {
-  std::map<std::string, knowledge::KnowledgeRecord> contents;
-  std::string common = name + delimiter_;
-  context_->to_map(common, contents);
-
-  KnowledgeUpdateSettings keep_local(true);
-  if (contents.size() > 0)
-  {
-    for (std::map<std::string, knowledge::KnowledgeRecord>::iterator i =
-             contents.begin();
-         i != contents.end(); ++i)
-    {
-      map_[i->first.substr(common.size())] =
-          knowledge.get_ref(i->first, keep_local);
-    }
-  }
+  sync_keys();
 }
 
 madara::knowledge::containers::Map::Map(const Map& rhs)
   : BaseContainer(rhs),
     context_(rhs.context_),
     map_(rhs.map_),
-    delimiter_(rhs.delimiter_)
+    delimiter_(rhs.delimiter_),
+    key_position_(rhs.key_position_)
 {
 }
 
@@ -156,6 +134,7 @@ void madara::knowledge::containers::Map::operator=(const Map& rhs)
     this->name_ = rhs.name_;
     this->settings_ = rhs.settings_;
     this->map_ = rhs.map_;
+    this->key_position_ = rhs.key_position_;
   }
 }
 
@@ -212,23 +191,41 @@ std::vector<std::string> madara::knowledge::containers::Map::sync_keys(void)
     ContextGuard context_guard(*context_);
     MADARA_GUARD_TYPE guard(mutex_);
 
-    clear(false);
-
-    std::map<std::string, knowledge::KnowledgeRecord> contents;
+    std::vector<std::string> names;
     std::string common = name_ + delimiter_;
-    context_->to_map(common, contents);
     KnowledgeUpdateSettings keep_local(true);
 
-    for (std::map<std::string, knowledge::KnowledgeRecord>::iterator i =
-             contents.begin();
-         i != contents.end(); ++i)
+    if (context_->get_new_keys(common, key_position_, names))
     {
-      std::string key = i->first.substr(common.size());
+      // only the names created since the last sync are listed
+      for (size_t i = 0; i < names.size(); ++i)
+      {
+        std::string key = names[i].substr(common.size());
+
+        if (map_.find(key) == map_.end())
+        {
+          additions.push_back(key);
+          map_[key] = context_->get_ref(names[i], keep_local);
+        }
+      }
+    }
+    else
+    {
+      // variables may have been deleted, so rebuild from all the names
+      InternalMap previous;
+      previous.swap(map_);
 
-      if (map_.find(key) == map_.end())
+      for (size_t i = 0; i < names.size(); ++i)
       {
-        additions.push_back(key);
-        map_[key] = context_->get_ref(i->first, keep_local);
+        std::string key = names[i].substr(common.size());
+
+        if (previous.find(key) == previous.end())
+        {
+          additions.push_back(key);
+        }
+
+        map_.emplace_hint(
+            map_.end(), key, context_->get_ref(names[i], keep_local));
       }
     }
   }
@@ -366,12 +363,14 @@ void madara::knowledge::containers::Map::clear(bool clear_knowledge)
       this->erase(keys[i]);
 
     map_.clear();
+    key_position_ = 0;
   }
 
   else if (context_)
   {
     MADARA_GUARD_TYPE guard(mutex_);
     map_.clear();
+    key_position_ = 0;
   }
 }
 
@@ -386,6 +385,7 @@ void madara::knowledge::containers::Map::reset(void)
       context_->clear(entry.first);
 
     map_.clear();
+    key_position_ = 0;
   }
 }
 
@@ -128,6 +128,8 @@ public:
   /**
    * Syncs the keys from the knowledge base. This can be useful
    * if you expect other knowledge bases to add variables to the map.
+   * Only variables created since the last sync are looked at, unless
+   * variables have been deleted from the knowledge base since then.
    * @return a vector of the keys that were added during the sync
    **/
   std::vector<std::string> sync_keys(void);
@@ -584,6 +586,11 @@ private:
    * Delimiter for the prefix to subvars
    **/
   std::string delimiter_;
+
+  /**
+   * Position in the context's journal of new keys at the last sync
+   **/
+  uint64_t key_position_;
 };
 }
 }
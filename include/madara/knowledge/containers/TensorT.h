@@ -0,0 +1,491 @@
+#ifndef _MADARA_KNOWLEDGE_CONTAINERS_TENSORT_H_
+#define _MADARA_KNOWLEDGE_CONTAINERS_TENSORT_H_
+
+#include <vector>
+#include <string>
+#include "madara/LockType.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/KnowledgeUpdateSettings.h"
+#include "BaseContainer.h"
+
+/**
+ * @file TensorT.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a C++ object that manages interactions for a dense,
+ * multi-dimensional array of doubles or integers stored in one record
+ **/
+
+namespace madara
+{
+namespace knowledge
+{
+namespace containers
+{
+/**
+ * @class TensorT
+ * @brief This class stores a dense N-dimensional array inside of KaRL.
+ *        Unlike DoubleVector2D and friends, which use a variable per
+ *        element, all elements are stored in row-major order in a single
+ *        native array record at {name}, and the dimensions are stored in
+ *        an integer array at {name}{delimiter}size. Changes to single
+ *        elements and views are made with set_index, so transports that
+ *        send array deltas only send the changed elements.
+ *        T must be double or KnowledgeRecord::Integer.
+ */
+template<typename T>
+class MADARA_EXPORT TensorT : public BaseContainer
+{
+public:
+  /// convenience typedef for element type
+  typedef T type;
+
+  /// the size of each dimension, outermost first
+  typedef std::vector<size_t> Dimensions;
+
+  /// an index in each dimension, outermost first
+  typedef std::vector<size_t> Indices;
+
+  /**
+   * @class View
+   * @brief A strided view of some of the elements of a tensor, e.g., a
+   *        row, column or slice. Views refer to the tensor's record, so
+   *        they see and make changes to the tensor. A view is only valid
+   *        until the tensor is resized.
+   */
+  class View
+  {
+  public:
+    /**
+     * Default constructor, which views nothing
+     **/
+    View();
+
+    /**
+     * Returns the size of each dimension of the view
+     * @return the dimensions, outermost first
+     **/
+    Dimensions size(void) const;
+
+    /**
+     * Returns the number of elements in the view
+     * @return the product of the dimensions
+     **/
+    size_t elements(void) const;
+
+    /**
+     * Retrieves an element of the view
+     * @param  index  the index in each dimension of the view
+     * @return the value of the element
+     * @throw exceptions::IndexException  index is out of range
+     **/
+    type operator[](const Indices& index) const;
+
+    /**
+     * Sets an element of the view
+     * @param  index  the index in each dimension of the view
+     * @param  value  the value to set
+     * @return 0 if successful, -1 if the tensor has no context,
+     *         -2 if quality isn't high enough
+     * @throw exceptions::IndexException  index is out of range
+     **/
+    int set(const Indices& index, type value);
+
+    /**
+     * Sets all elements of the view, in row-major order, while holding
+     * the context lock and marking the tensor changed once
+     * @param  values  the values to set, one per element of the view
+     * @return 0 if successful, -1 if the tensor has no context,
+     *         -2 if quality isn't high enough
+     * @throw exceptions::IndexException  values is not elements() long
+     **/
+    int set(const std::vector<type>& values);
+
+    /**
+     * Sets all elements of the view to a value, marking the tensor
+     * changed once
+     * @param  value  the value to set
+     * @return 0 if successful, -1 if the tensor has no context,
+     *         -2 if quality isn't high enough
+     **/
+    int fill(type value);
+
+    /**
+     * Copies the elements of the view, in row-major order
+     * @param  target  the vector to copy into
+     **/
+    void copy_to(std::vector<type>& target) const;
+
+    /**
+     * Copies the elements of the view, in row-major order
+     * @return the elements
+     **/
+    std::vector<type> to_vector(void) const;
+
+    /**
+     * Views the elements with one index fixed, removing a dimension
+     * @param  dimension  the dimension to fix
+     * @param  index      the index within dimension
+     * @return the view of the remaining dimensions
+     * @throw exceptions::IndexException  dimension or index out of range
+     **/
+    View slice(size_t dimension, size_t index) const;
+
+  private:
+    friend class TensorT;
+
+    /**
+     * Gets the position of an element in the tensor's record
+     * @param  index  the index in each dimension of the view
+     * @return the position in the record
+     * @throw exceptions::IndexException  index is out of range
+     **/
+    size_t position(const Indices& index) const;
+
+    /**
+     * Gets the positions of all elements in the tensor's record
+     * @param  positions  the positions, in row-major order
+     **/
+    void positions(std::vector<size_t>& positions) const;
+
+    /// the context of the tensor
+    ThreadSafeContext* context_;
+
+    /// the tensor's record
+    VariableReference vector_;
+
+    /// settings for updating the tensor
+    KnowledgeUpdateSettings settings_;
+
+    /// the position of the first element in the record
+    size_t offset_;
+
+    /// the size of each dimension of the view
+    Dimensions dimensions_;
+
+    /// the distance in the record between consecutive indices of each
+    /// dimension
+    std::vector<size_t> strides_;
+  };
+
+  /**
+   * Default constructor
+   * @param  settings   settings for evaluating the tensor
+   * @param  delimiter  the delimiter for the size variable of the tensor
+   **/
+  TensorT(const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings(),
+      const std::string& delimiter = ".");
+
+  /**
+   * Constructor
+   * @param  name        name of the tensor in the knowledge base
+   * @param  knowledge   the knowledge base that will contain the tensor
+   * @param  dimensions  size of the tensor. Empty to check for size.
+   * @param  settings    settings for evaluating the tensor
+   * @param  delimiter   the delimiter for the size variable of the tensor
+   **/
+  TensorT(const std::string& name, KnowledgeBase& knowledge,
+      const Dimensions& dimensions = Dimensions(),
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings(),
+      const std::string& delimiter = ".");
+
+  /**
+   * Constructor
+   * @param  name        name of the tensor in the knowledge base
+   * @param  knowledge   the knowledge base that will contain the tensor
+   * @param  dimensions  size of the tensor. Empty to check for size.
+   * @param  settings    settings for evaluating the tensor
+   * @param  delimiter   the delimiter for the size variable of the tensor
+   **/
+  TensorT(const std::string& name, Variables& knowledge,
+      const Dimensions& dimensions = Dimensions(),
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings(),
+      const std::string& delimiter = ".");
+
+  /**
+   * Copy constructor
+   **/
+  TensorT(const TensorT& rhs);
+
+  /**
+   * Destructor
+   **/
+  virtual ~TensorT();
+
+  /**
+   * Mark the tensor as modified. The tensor retains the same values
+   * but will resend its values as if they had been modified.
+   **/
+  void modify(void);
+
+  /**
+   * Assignment operator
+   * @param  rhs    value to copy
+   **/
+  void operator=(const TensorT& rhs);
+
+  /**
+   * Resizes the tensor. If the number of elements changes, all elements
+   * are reset to zero. Otherwise, the elements are kept in place.
+   * @param  dimensions  size of the tensor. Empty to read the size from
+   *                     the knowledge base, e.g., after another process
+   *                     resized the tensor
+   **/
+  void resize(const Dimensions& dimensions = Dimensions());
+
+  /**
+   * Returns the size of each dimension of the tensor. Call resize()
+   * without arguments first to ensure the size matches the knowledge base.
+   * @return the dimensions, outermost first
+   **/
+  Dimensions size(void) const;
+
+  /**
+   * Returns the number of elements in the tensor
+   * @return the product of the dimensions
+   **/
+  size_t elements(void) const;
+
+  /**
+   * Sets the variable name that this refers to
+   * @param var_name    the name of the variable in the knowledge base
+   * @param knowledge   the knowledge base the variable is housed in
+   * @param dimensions  size of the tensor. Empty to check for size.
+   **/
+  void set_name(const std::string& var_name, KnowledgeBase& knowledge,
+      const Dimensions& dimensions = Dimensions());
+
+  /**
+   * Sets the variable name that this refers to
+   * @param var_name    the name of the variable in the knowledge base
+   * @param knowledge   the knowledge base the variable is housed in
+   * @param dimensions  size of the tensor. Empty to check for size.
+   **/
+  void set_name(const std::string& var_name, Variables& knowledge,
+      const Dimensions& dimensions = Dimensions());
+
+  /**
+   * Sets the variable name that this refers to
+   * @param var_name    the name of the variable in the knowledge base
+   * @param knowledge   the knowledge base the variable is housed in
+   * @param dimensions  size of the tensor. Empty to check for size.
+   **/
+  void set_name(const std::string& var_name, ThreadSafeContext& knowledge,
+      const Dimensions& dimensions = Dimensions());
+
+  /**
+   * Retrieves an element of the tensor
+   * @param  index  the index in each dimension
+   * @return the value of the element
+   * @throw exceptions::IndexException  index is out of range
+   **/
+  type operator[](const Indices& index) const;
+
+  /**
+   * Sets an element of the tensor
+   * @param index           the index in each dimension
+   * @param value           value to set at location
+   * @return                0 if successful, -1 if key is null, and
+   *                        -2 if quality isn't high enough
+   * @throw exceptions::IndexException  index is out of range
+   **/
+  int set(const Indices& index, type value);
+
+  /**
+   * Sets an element of the tensor
+   * @param index           the index in each dimension
+   * @param value           value to set at location
+   * @param settings        settings for applying the update
+   * @return                0 if successful, -1 if key is null, and
+   *                        -2 if quality isn't high enough
+   * @throw exceptions::IndexException  index is out of range
+   **/
+  int set(const Indices& index, type value,
+      const KnowledgeUpdateSettings& settings);
+
+  /**
+   * Replaces all elements of the tensor with one update
+   * @param values          the elements in row-major order
+   * @return                0 if successful, -1 if key is null, and
+   *                        -2 if quality isn't high enough
+   * @throw exceptions::IndexException  values is not elements() long
+   **/
+  int set(const std::vector<type>& values);
+
+  /**
+   * Replaces all elements of the tensor with one update
+   * @param values          the elements in row-major order
+   * @param settings        settings for applying the update
+   * @return                0 if successful, -1 if key is null, and
+   *                        -2 if quality isn't high enough
+   * @throw exceptions::IndexException  values is not elements() long
+   **/
+  int set(const std::vector<type>& values,
+      const KnowledgeUpdateSettings& settings);
+
+  /**
+   * Copies all elements of the tensor, in row-major order
+   * @param  target  the vector to copy into
+   **/
+  void copy_to(std::vector<type>& target) const;
+
+  /**
+   * Views all elements of the tensor
+   * @return the view
+   **/
+  View view(void) const;
+
+  /**
+   * Views the elements with one index fixed, removing a dimension
+   * @param  dimension  the dimension to fix
+   * @param  index      the index within dimension
+   * @return the view of the remaining dimensions
+   * @throw exceptions::IndexException  dimension or index out of range
+   **/
+  View slice(size_t dimension, size_t index) const;
+
+  /**
+   * Views a row, i.e., the elements with the outermost index fixed
+   * @param  index  the row
+   * @return the view of the row
+   * @throw exceptions::IndexException  index out of range
+   **/
+  View row(size_t index) const;
+
+  /**
+   * Views a column, i.e., the elements with the innermost index fixed
+   * @param  index  the column
+   * @return the view of the column
+   * @throw exceptions::IndexException  index out of range
+   **/
+  View column(size_t index) const;
+
+  /**
+   * Retrieves all elements as a native array in a record
+   * @return the record of the tensor
+   **/
+  knowledge::KnowledgeRecord to_record(void) const;
+
+  /**
+   * Returns a reference to the size field of the current name
+   * @return reference to the size field
+   **/
+  VariableReference get_size_ref(void);
+
+  /**
+   * Returns the type of the container along with name and any other
+   * useful information. The provided information should be useful
+   * for developers wishing to debug container operations, especially
+   * as it pertains to pending network operations (i.e., when used
+   * in conjunction with modify)
+   *
+   * @return info in format {container}: {name}{ = value, if appropriate}
+   **/
+  std::string get_debug_info(void);
+
+  /**
+   * Clones this container
+   * @return  a deep copy of the container that must be managed
+   *          by the user (i.e., you have to delete the return value)
+   **/
+  virtual BaseContainer* clone(void) const;
+
+  /**
+   * Determines if all values in the tensor are true
+   * @return true if all values are true
+   **/
+  bool is_true(void) const;
+
+  /**
+   * Determines if the value of the tensor is false
+   * @return true if at least one value is false
+   **/
+  bool is_false(void) const;
+
+private:
+  /**
+   * Polymorphic is true method which can be used to determine if
+   * all values in the container are true
+   **/
+  virtual bool is_true_(void) const;
+
+  /**
+   * Polymorphic is false method which can be used to determine if
+   * at least one value in the container is false
+   **/
+  virtual bool is_false_(void) const;
+
+  /**
+   * Polymorphic modify method used by collection containers. This
+   * method calls the modify method for this class. We separate the
+   * faster version (modify) from this version (modify_) to allow
+   * users the opportunity to have a fastery version that does not
+   * use polymorphic functions (generally virtual functions are half
+   * as efficient as normal function calls)
+   **/
+  virtual void modify_(void);
+
+  /**
+   * Returns the type of the container along with name and any other
+   * useful information. The provided information should be useful
+   * for developers wishing to debug container operations, especially
+   * as it pertains to pending network operations (i.e., when used
+   * in conjunction with modify)
+   *
+   * @return info in format {container}: {name}{ = value, if appropriate}
+   **/
+  virtual std::string get_debug_info_(void);
+
+  /**
+   * Points the tensor at the current name and resizes it
+   * @param  dimensions  size of the tensor. Empty to check for size.
+   **/
+  void attach(const Dimensions& dimensions);
+
+  /**
+   * Gets the position of an element in the record
+   * @param  index  the index in each dimension
+   * @return the position in the record
+   * @throw exceptions::IndexException  index is out of range
+   **/
+  size_t position(const Indices& index) const;
+
+  /**
+   * Variable context that we are modifying
+   **/
+  ThreadSafeContext* context_;
+
+  /**
+   * Reference to the elements of the tensor
+   **/
+  VariableReference vector_;
+
+  /**
+   * Reference to the size of the tensor
+   **/
+  VariableReference size_;
+
+  /**
+   * Size of each dimension, as of the last resize
+   **/
+  Dimensions dimensions_;
+
+  /**
+   * Delimiter for the prefix to subvars
+   **/
+  std::string delimiter_;
+};
+
+/// a tensor of doubles
+typedef TensorT<double> DoubleTensor;
+
+/// a tensor of integers
+typedef TensorT<KnowledgeRecord::Integer> IntegerTensor;
+}
+}
+}
+
+#include "TensorT.inl"
+
+#endif  // _MADARA_KNOWLEDGE_CONTAINERS_TENSORT_H_
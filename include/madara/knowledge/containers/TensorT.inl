@@ -0,0 +1,708 @@
+#ifndef _MADARA_KNOWLEDGE_CONTAINERS_TENSORT_INL_
+#define _MADARA_KNOWLEDGE_CONTAINERS_TENSORT_INL_
+
+#include <sstream>
+#include <type_traits>
+
+#include "TensorT.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/knowledge/KnowledgeCast.h"
+#include "madara/exceptions/IndexException.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace containers
+{
+template<typename T>
+inline TensorT<T>::View::View()
+  : context_(0), offset_(0), dimensions_(1, 0), strides_(1, 1)
+{
+}
+
+template<typename T>
+inline typename TensorT<T>::Dimensions TensorT<T>::View::size(void) const
+{
+  return dimensions_;
+}
+
+template<typename T>
+inline size_t TensorT<T>::View::elements(void) const
+{
+  size_t result = 1;
+  for (size_t i = 0; i < dimensions_.size(); ++i)
+  {
+    result *= dimensions_[i];
+  }
+  return result;
+}
+
+template<typename T>
+inline size_t TensorT<T>::View::position(const Indices& index) const
+{
+  if (index.size() != dimensions_.size())
+  {
+    std::stringstream message;
+    message << "TensorT<T>::View::position: " << index.size()
+            << " indices given for " << dimensions_.size() << " dimensions\n";
+    throw exceptions::IndexException(message.str());
+  }
+
+  size_t result = offset_;
+  for (size_t i = 0; i < index.size(); ++i)
+  {
+    if (index[i] >= dimensions_[i])
+    {
+      std::stringstream message;
+      message << "TensorT<T>::View::position: index " << index[i]
+              << " of dimension " << i << " is out of range [0,"
+              << dimensions_[i] << ")\n";
+      throw exceptions::IndexException(message.str());
+    }
+
+    result += index[i] * strides_[i];
+  }
+
+  return result;
+}
+
+template<typename T>
+inline void TensorT<T>::View::positions(std::vector<size_t>& positions) const
+{
+  positions.clear();
+
+  size_t count = elements();
+  if (count == 0)
+  {
+    return;
+  }
+
+  positions.reserve(count);
+
+  // walk the view like an odometer, innermost dimension fastest
+  Indices index(dimensions_.size(), 0);
+  size_t current = offset_;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    positions.push_back(current);
+
+    for (size_t d = dimensions_.size(); d > 0; --d)
+    {
+      ++index[d - 1];
+      current += strides_[d - 1];
+
+      if (index[d - 1] < dimensions_[d - 1])
+      {
+        break;
+      }
+
+      current -= strides_[d - 1] * dimensions_[d - 1];
+      index[d - 1] = 0;
+    }
+  }
+}
+
+template<typename T>
+inline typename TensorT<T>::type TensorT<T>::View::operator[](
+    const Indices& index) const
+{
+  size_t where = position(index);
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+
+    return knowledge_cast<type>(
+        vector_.get_record_unsafe()->retrieve_index(where));
+  }
+
+  return type();
+}
+
+template<typename T>
+inline int TensorT<T>::View::set(const Indices& index, type value)
+{
+  size_t where = position(index);
+
+  if (context_)
+  {
+    return context_->set_index(vector_, where, value, settings_);
+  }
+
+  return -1;
+}
+
+template<typename T>
+inline int TensorT<T>::View::set(const std::vector<type>& values)
+{
+  if (values.size() != elements())
+  {
+    std::stringstream message;
+    message << "TensorT<T>::View::set: " << values.size()
+            << " values given for " << elements() << " elements\n";
+    throw exceptions::IndexException(message.str());
+  }
+
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+
+    std::vector<size_t> where;
+    positions(where);
+
+    result = context_->set_indices_unsafe(vector_, where, values, settings_);
+  }
+
+  return result;
+}
+
+template<typename T>
+inline int TensorT<T>::View::fill(type value)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+
+    std::vector<size_t> where;
+    positions(where);
+
+    result = context_->fill_indices_unsafe(vector_, where, value, settings_);
+  }
+
+  return result;
+}
+
+template<typename T>
+inline void TensorT<T>::View::copy_to(std::vector<type>& target) const
+{
+  target.clear();
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+
+    std::vector<size_t> where;
+    positions(where);
+
+    // reads the record in place, since sharing its array would make the
+    // next change to an element copy the whole array
+    const KnowledgeRecord* record = vector_.get_record_unsafe();
+
+    target.resize(where.size());
+    for (size_t i = 0; i < where.size(); ++i)
+    {
+      target[i] = knowledge_cast<type>(record->retrieve_index(where[i]));
+    }
+  }
+}
+
+template<typename T>
+inline std::vector<typename TensorT<T>::type> TensorT<T>::View::to_vector(
+    void) const
+{
+  std::vector<type> result;
+  copy_to(result);
+  return result;
+}
+
+template<typename T>
+inline typename TensorT<T>::View TensorT<T>::View::slice(
+    size_t dimension, size_t index) const
+{
+  if (dimension >= dimensions_.size() || index >= dimensions_[dimension])
+  {
+    std::stringstream message;
+    message << "TensorT<T>::View::slice: index " << index << " of dimension "
+            << dimension << " is out of range\n";
+    throw exceptions::IndexException(message.str());
+  }
+
+  View result(*this);
+  result.offset_ += index * strides_[dimension];
+  result.dimensions_.erase(result.dimensions_.begin() + dimension);
+  result.strides_.erase(result.strides_.begin() + dimension);
+
+  return result;
+}
+
+template<typename T>
+inline TensorT<T>::TensorT(
+    const KnowledgeUpdateSettings& settings, const std::string& delimiter)
+  : BaseContainer("", settings), context_(0), delimiter_(delimiter)
+{
+}
+
+template<typename T>
+inline TensorT<T>::TensorT(const std::string& name, KnowledgeBase& knowledge,
+    const Dimensions& dimensions, const KnowledgeUpdateSettings& settings,
+    const std::string& delimiter)
+  : BaseContainer(name, settings),
+    context_(&(knowledge.get_context())),
+    delimiter_(delimiter)
+{
+  attach(dimensions);
+}
+
+template<typename T>
+inline TensorT<T>::TensorT(const std::string& name, Variables& knowledge,
+    const Dimensions& dimensions, const KnowledgeUpdateSettings& settings,
+    const std::string& delimiter)
+  : BaseContainer(name, settings),
+    context_(knowledge.get_context()),
+    delimiter_(delimiter)
+{
+  attach(dimensions);
+}
+
+template<typename T>
+inline TensorT<T>::TensorT(const TensorT& rhs)
+  : BaseContainer(rhs),
+    context_(rhs.context_),
+    vector_(rhs.vector_),
+    size_(rhs.size_),
+    dimensions_(rhs.dimensions_),
+    delimiter_(rhs.delimiter_)
+{
+}
+
+template<typename T>
+inline TensorT<T>::~TensorT()
+{
+}
+
+template<typename T>
+inline void TensorT<T>::attach(const Dimensions& dimensions)
+{
+  if (context_ && name_ != "")
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    vector_ = context_->get_ref(name_, settings_);
+    size_ = get_size_ref();
+    dimensions_.clear();
+
+    resize(dimensions);
+  }
+}
+
+template<typename T>
+inline void TensorT<T>::modify(void)
+{
+  if (context_ && name_ != "")
+  {
+    ContextGuard context_guard(*context_);
+
+    context_->mark_modified(vector_);
+    context_->mark_modified(size_);
+  }
+}
+
+template<typename T>
+inline void TensorT<T>::operator=(const TensorT& rhs)
+{
+  if (this != &rhs)
+  {
+    MADARA_GUARD_TYPE guard(mutex_), guard2(rhs.mutex_);
+
+    this->context_ = rhs.context_;
+    this->name_ = rhs.name_;
+    this->settings_ = rhs.settings_;
+    this->vector_ = rhs.vector_;
+    this->size_ = rhs.size_;
+    this->dimensions_ = rhs.dimensions_;
+    this->delimiter_ = rhs.delimiter_;
+  }
+}
+
+template<typename T>
+inline void TensorT<T>::resize(const Dimensions& dimensions)
+{
+  if (context_ && name_ != "")
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (!size_.is_valid())
+    {
+      size_ = get_size_ref();
+    }
+
+    if (dimensions.empty())
+    {
+      madara_logger_log(context_->get_logger(), logger::LOG_MINOR,
+          "TensorT::resize: %s: reading size from the knowledge base\n",
+          name_.c_str());
+
+      std::vector<KnowledgeRecord::Integer> stored(
+          size_.get_record_unsafe()->to_integers());
+
+      dimensions_.assign(stored.begin(), stored.end());
+    }
+    else
+    {
+      madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
+          "TensorT::resize: %s: resizing to %d dimensions\n", name_.c_str(),
+          (int)dimensions.size());
+
+      dimensions_ = dimensions;
+
+      std::vector<KnowledgeRecord::Integer> update(
+          dimensions.begin(), dimensions.end());
+      context_->set(size_, update, settings_);
+
+      const KnowledgeRecord* record = vector_.get_record_unsafe();
+      uint32_t array_type = std::is_floating_point<type>::value
+                                ? KnowledgeRecord::DOUBLE_ARRAY
+                                : KnowledgeRecord::INTEGER_ARRAY;
+
+      // elements are only kept if they still fit the tensor
+      if (record->type() != array_type || record->size() != elements())
+      {
+        context_->set(vector_, std::vector<type>(elements()), settings_);
+      }
+    }
+  }
+}
+
+template<typename T>
+inline typename TensorT<T>::Dimensions TensorT<T>::size(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return dimensions_;
+}
+
+template<typename T>
+inline size_t TensorT<T>::elements(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (dimensions_.empty())
+  {
+    return 0;
+  }
+
+  size_t result = 1;
+  for (size_t i = 0; i < dimensions_.size(); ++i)
+  {
+    result *= dimensions_[i];
+  }
+  return result;
+}
+
+template<typename T>
+inline void TensorT<T>::set_name(const std::string& var_name,
+    KnowledgeBase& knowledge, const Dimensions& dimensions)
+{
+  set_name(var_name, knowledge.get_context(), dimensions);
+}
+
+template<typename T>
+inline void TensorT<T>::set_name(const std::string& var_name,
+    Variables& knowledge, const Dimensions& dimensions)
+{
+  set_name(var_name, *knowledge.get_context(), dimensions);
+}
+
+template<typename T>
+inline void TensorT<T>::set_name(const std::string& var_name,
+    ThreadSafeContext& knowledge, const Dimensions& dimensions)
+{
+  if (context_ != &knowledge || name_ != var_name)
+  {
+    context_ = &knowledge;
+
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    name_ = var_name;
+
+    attach(dimensions);
+  }
+}
+
+template<typename T>
+inline size_t TensorT<T>::position(const Indices& index) const
+{
+  if (index.size() != dimensions_.size())
+  {
+    std::stringstream message;
+    message << "TensorT<T>::position: " << index.size()
+            << " indices given for " << dimensions_.size() << " dimensions\n";
+    throw exceptions::IndexException(message.str());
+  }
+
+  // row-major, so each index scales every dimension inside it
+  size_t result = 0;
+  for (size_t i = 0; i < index.size(); ++i)
+  {
+    if (index[i] >= dimensions_[i])
+    {
+      std::stringstream message;
+      message << "TensorT<T>::position: index " << index[i]
+              << " of dimension " << i << " is out of range [0,"
+              << dimensions_[i] << ")\n";
+      throw exceptions::IndexException(message.str());
+    }
+
+    result = result * dimensions_[i] + index[i];
+  }
+
+  return result;
+}
+
+template<typename T>
+inline typename TensorT<T>::type TensorT<T>::operator[](
+    const Indices& index) const
+{
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    return knowledge_cast<type>(
+        vector_.get_record_unsafe()->retrieve_index(position(index)));
+  }
+
+  return type();
+}
+
+template<typename T>
+inline int TensorT<T>::set(const Indices& index, type value)
+{
+  return set(index, value, settings_);
+}
+
+template<typename T>
+inline int TensorT<T>::set(
+    const Indices& index, type value, const KnowledgeUpdateSettings& settings)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    result = context_->set_index(vector_, position(index), value, settings);
+  }
+
+  return result;
+}
+
+template<typename T>
+inline int TensorT<T>::set(const std::vector<type>& values)
+{
+  return set(values, settings_);
+}
+
+template<typename T>
+inline int TensorT<T>::set(
+    const std::vector<type>& values, const KnowledgeUpdateSettings& settings)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (values.size() != elements())
+    {
+      std::stringstream message;
+      message << "TensorT<T>::set: " << values.size() << " values given for "
+              << elements() << " elements\n";
+      throw exceptions::IndexException(message.str());
+    }
+
+    result = context_->set(vector_, values, settings);
+  }
+
+  return result;
+}
+
+template<typename T>
+inline void TensorT<T>::copy_to(std::vector<type>& target) const
+{
+  target.clear();
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    knowledge_cast(*vector_.get_record_unsafe(), target);
+  }
+}
+
+template<typename T>
+inline typename TensorT<T>::View TensorT<T>::view(void) const
+{
+  View result;
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (!dimensions_.empty())
+  {
+    result.context_ = context_;
+    result.vector_ = vector_;
+    result.settings_ = settings_;
+    result.dimensions_ = dimensions_;
+    result.strides_.assign(dimensions_.size(), 1);
+
+    for (size_t i = dimensions_.size() - 1; i > 0; --i)
+    {
+      result.strides_[i - 1] = result.strides_[i] * dimensions_[i];
+    }
+  }
+
+  return result;
+}
+
+template<typename T>
+inline typename TensorT<T>::View TensorT<T>::slice(
+    size_t dimension, size_t index) const
+{
+  return view().slice(dimension, index);
+}
+
+template<typename T>
+inline typename TensorT<T>::View TensorT<T>::row(size_t index) const
+{
+  return view().slice(0, index);
+}
+
+template<typename T>
+inline typename TensorT<T>::View TensorT<T>::column(size_t index) const
+{
+  View all = view();
+  return all.slice(all.size().size() - 1, index);
+}
+
+template<typename T>
+inline KnowledgeRecord TensorT<T>::to_record(void) const
+{
+  KnowledgeRecord result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    result = context_->get(vector_, settings_);
+  }
+
+  return result;
+}
+
+template<typename T>
+inline VariableReference TensorT<T>::get_size_ref(void)
+{
+  VariableReference ref;
+
+  if (context_ && name_ != "")
+  {
+    KnowledgeUpdateSettings keep_local(true);
+    std::stringstream buffer;
+
+    ContextGuard context_guard(*context_);
+
+    buffer << name_;
+    buffer << delimiter_;
+    buffer << "size";
+
+    ref = context_->get_ref(buffer.str(), keep_local);
+  }
+
+  return ref;
+}
+
+template<typename T>
+inline std::string TensorT<T>::get_debug_info(void)
+{
+  std::stringstream result;
+
+  result << "Tensor: ";
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    result << this->name_;
+    result << " [";
+
+    for (size_t i = 0; i < dimensions_.size(); ++i)
+    {
+      if (i > 0)
+      {
+        result << "x";
+      }
+      result << dimensions_[i];
+    }
+
+    result << "]";
+    result << " = " << vector_.get_record_unsafe()->to_string();
+  }
+
+  return result.str();
+}
+
+template<typename T>
+inline BaseContainer* TensorT<T>::clone(void) const
+{
+  return new TensorT(*this);
+}
+
+template<typename T>
+inline bool TensorT<T>::is_true(void) const
+{
+  bool result(false);
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    result = vector_.get_record_unsafe()->is_true();
+  }
+
+  return result;
+}
+
+template<typename T>
+inline bool TensorT<T>::is_false(void) const
+{
+  return !is_true();
+}
+
+template<typename T>
+inline bool TensorT<T>::is_true_(void) const
+{
+  return is_true();
+}
+
+template<typename T>
+inline bool TensorT<T>::is_false_(void) const
+{
+  return is_false();
+}
+
+template<typename T>
+inline void TensorT<T>::modify_(void)
+{
+  modify();
+}
+
+template<typename T>
+inline std::string TensorT<T>::get_debug_info_(void)
+{
+  return get_debug_info();
+}
+}
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_CONTAINERS_TENSORT_INL_
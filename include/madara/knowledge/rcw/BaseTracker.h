@@ -72,9 +72,30 @@ private:
   /// Reference to tracked variable
   VariableReference ref_;
 
+  /// Version of the record @ref_ when it was last pulled or pushed
+  uint64_t version_ = 0;
+
+  /// True once version_ has been recorded
+  bool synced_ = false;
+
   /// Constructor from a VariableReference
   BaseTracker(VariableReference ref) : ref_(ref) {}
 
+  /// Checks if record @ref_ is unmodified since the last sync(). No
+  /// locking, so be careful!
+  bool unchanged() const
+  {
+    return synced_ && get().version() == version_;
+  }
+
+  /// Records the version of @ref_, after pulling or pushing it. No
+  /// locking, so be careful!
+  void sync()
+  {
+    version_ = get().version();
+    synced_ = true;
+  }
+
   /// Override to implement pulling logic (from ref_)
   virtual void pull() = 0;
   /// Override to implement pushing logic (into ref_)
@@ -197,6 +218,53 @@ MADARA_MAKE_SUPPORT_TEST(knowledge_cast, p,
 /// Trait to test if type supports equality testing (values of same type)
 MADARA_MAKE_SUPPORT_TEST(self_eq, p,
     (get_value(*p) == get_value(*p), get_value(*p) != get_value(*p)));
+
+/// Checks if a tracked object still holds the value it was last synced
+/// with. Types that track their own modification status are unmodified
+/// if they are not dirty.
+template<class T, class V>
+auto is_unmodified(const T& t, const V&) ->
+    typename std::enable_if<supports_is_dirty<T>::value, bool>::type
+{
+  return !is_dirty(t);
+}
+
+/// Checks if a tracked object still holds the value it was last synced
+/// with, by comparing to a copy of that value.
+template<class T, class V>
+auto is_unmodified(const T& t, const V& orig) ->
+    typename std::enable_if<!supports_is_dirty<T>::value &&
+                                supports_self_eq<T>::value,
+        bool>::type
+{
+  return get_value(t) == get_value(orig);
+}
+
+/// Fallback for types that can neither report modification nor be
+/// compared. They are always treated as modified.
+template<class T, class V>
+auto is_unmodified(const T&, const V&) ->
+    typename std::enable_if<!supports_is_dirty<T>::value &&
+                                !supports_self_eq<T>::value,
+        bool>::type
+{
+  return false;
+}
+
+/// Clears modification status for types that track it
+template<class T>
+auto clear_if_dirty(T& t) ->
+    typename std::enable_if<supports_is_dirty<T>::value>::type
+{
+  clear_dirty(t);
+}
+
+/// No-op for types that don't track modification status
+template<class T>
+auto clear_if_dirty(T&) ->
+    typename std::enable_if<!supports_is_dirty<T>::value>::type
+{
+}
 }
 }
 }  // end namespace madara::knowledge::rcw
@@ -16,6 +16,7 @@
 #include <list>
 #include <type_traits>
 #include <initializer_list>
+#include <limits>
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/knowledge/Functions.h"
 #include "madara/utility/StdInt.h"
@@ -70,6 +71,10 @@ private:
   /// vector of references to elements of vector in knowledge base
   std::vector<VariableReference> elems_;
 
+  /// versions of elems_ when last pulled or pushed. Elements that were
+  /// never pulled or pushed hold a version no record can have.
+  std::vector<uint64_t> versions_;
+
   typedef
       typename std::decay<decltype(get_value(std::declval<T>()[0]))>::type V;
 
@@ -81,7 +86,8 @@ private:
       tracked_(tracked),
       prefix_(prefix),
       kb_(kb),
-      elems_()
+      elems_(),
+      versions_()
   {
     update_elems();
   }
@@ -99,6 +105,7 @@ private:
         get_mut(elems_[i]).clear_value();
       }
       elems_.resize(n);
+      versions_.resize(n);
       return;
     }
     std::ostringstream name;
@@ -109,6 +116,7 @@ private:
     {
       name << i;
       elems_.push_back(kb_.get_ref(name.str()));
+      versions_.push_back(std::numeric_limits<uint64_t>::max());
       name.seekp(pos);
     }
   }
@@ -116,14 +124,32 @@ private:
   virtual void pull()
   {
     const size_t n = get().to_integer();
-    tracked_->resize(n);
+
+    // after local resizes or assignments, any element may differ
+    const bool all = tracked_->size() != n || is_all_dirty(*tracked_) ||
+                     is_size_dirty(*tracked_);
+
+    if (tracked_->size() != n)
+    {
+      tracked_->resize(n);
+    }
     update_elems();
     for (size_t i = 0; i < n; ++i)
     {
       if (can_read)
       {
-        V val = knowledge_cast<V>(get(elems_[i]));
+        const KnowledgeRecord& rec = get(elems_[i]);
+
+        // skip elements unmodified both here and in the knowledge base
+        if (!all && !is_dirty(*tracked_, i) &&
+            versions_[i] == rec.version())
+        {
+          continue;
+        }
+
+        V val = knowledge_cast<V>(rec);
         set_value(*tracked_, i, val);
+        versions_[i] = rec.version();
       }
       else
       {
@@ -155,6 +181,7 @@ private:
         {
           set(kb, elems_[i], knowledge_cast(get_value(*tracked_, i)));
           post_set(kb, elems_[i]);
+          versions_[i] = get(elems_[i]).version();
         }
       }
     }
@@ -173,6 +200,7 @@ private:
       {
         set(kb, elems_[i], knowledge_cast(tracked_->at(i)));
         post_set(kb, elems_[i]);
+        versions_[i] = get(elems_[i]).version();
       }
     }
   }
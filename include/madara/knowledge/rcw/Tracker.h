@@ -74,8 +74,15 @@ private:
 
   virtual void pull()
   {
+    // neither the record nor our copy changed, so there is nothing to copy
+    if (unchanged() && get_value(*tracked_) == get_value(orig_))
+    {
+      return;
+    }
+
     orig_ = knowledge_cast<V>(get());
     set_value(*tracked_, orig_);
+    sync();
   }
 
   virtual void push(KnowledgeBase& kb)
@@ -90,6 +97,8 @@ private:
   {
     set(kb, knowledge_cast(get_value(*tracked_)));
     post_set(kb);
+    orig_ = get_value(*tracked_);
+    sync();
   }
 
   virtual const char* get_name() const
@@ -116,18 +125,27 @@ private:
   typedef typename std::decay<decltype(get_value(std::declval<T>()))>::type V;
 
   T* tracked_;  /// Pointer to tracked object
+  V orig_;      /// Pulled value, to detect local changes to revert
 
   static const bool can_read = true;
   static const bool can_write = false;
 
   Tracker(T* tracked, VariableReference ref)
-    : BaseTracker(ref), tracked_(tracked)
+    : BaseTracker(ref), tracked_(tracked), orig_()
   {
   }
 
   virtual void pull()
   {
-    set_value(*tracked_, knowledge_cast<V>(get()));
+    if (unchanged() && is_unmodified(*tracked_, orig_))
+    {
+      return;
+    }
+
+    orig_ = knowledge_cast<V>(get());
+    set_value(*tracked_, orig_);
+    clear_if_dirty(*tracked_);
+    sync();
   }
 
   virtual void push(KnowledgeBase&) {}
@@ -228,9 +246,15 @@ private:
 
   virtual void pull()
   {
+    if (unchanged() && !is_dirty(*tracked_))
+    {
+      return;
+    }
+
     V val = knowledge_cast<V>(get());
     set_value(*tracked_, val);
     clear_dirty(*tracked_);
+    sync();
   }
 
   virtual void push(KnowledgeBase& kb)
@@ -245,6 +269,7 @@ private:
   {
     set(kb, knowledge_cast(get_value(*tracked_)));
     post_set(kb);
+    sync();
   }
 
   virtual const char* get_name() const
@@ -343,8 +368,26 @@ private:
   {
   }
 
+  /// Checks if any element was modified locally
+  bool any_dirty() const
+  {
+    for (size_t i = 0; i < tracked_->size(); ++i)
+    {
+      if (is_dirty(*tracked_, i))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
   virtual void pull()
   {
+    if (unchanged() && tracked_->size() == orig_size_ && !any_dirty())
+    {
+      return;
+    }
+
     std::vector<double> val = get().to_doubles();
     orig_size_ = val.size();
     size_t n = orig_size_;
@@ -354,6 +397,7 @@ private:
       set_value(*tracked_, i, (V)val[i]);
       clear_dirty(*tracked_, i);
     }
+    sync();
   }
 
   virtual void push(KnowledgeBase& kb)
@@ -361,18 +405,27 @@ private:
     if (can_write)
     {
       size_t n = tracked_->size();
+      bool changed = false;
       if (tracked_->size() != orig_size_)
       {
         get_mut().resize(n);
+        changed = true;
       }
       for (size_t i = 0; i < n; ++i)
       {
         if (is_dirty(*tracked_, i))
         {
           set_index(kb, i, get_value(*tracked_, i));
+          changed = true;
         }
       }
-      post_set(kb);
+
+      // untouched containers are not marked, so they are not resent
+      if (changed)
+      {
+        post_set(kb);
+        sync();
+      }
     }
   }
 
@@ -390,6 +443,7 @@ private:
         set_index(kb, i, get_value(*tracked_, i));
       }
       post_set(kb);
+      sync();
     }
   }
 
@@ -432,6 +486,11 @@ private:
 
   virtual void pull()
   {
+    if (unchanged() && !is_dirty(*tracked_) && !is_size_dirty(*tracked_))
+    {
+      return;
+    }
+
     if (can_read)
     {
       V val = knowledge_cast<V>(get());
@@ -442,12 +501,18 @@ private:
       set_value(*tracked_, V());
     }
     clear_dirty(*tracked_);
+    sync();
   }
 
   virtual void push(KnowledgeBase& kb)
   {
     if (can_write)
     {
+      // untouched containers are not marked, so they are not resent
+      if (!is_dirty(*tracked_) && !is_size_dirty(*tracked_))
+      {
+        return;
+      }
       if (is_all_dirty(*tracked_))
       {
         return Tracker::force_push(kb);
@@ -465,6 +530,7 @@ private:
         }
       }
       post_set(kb);
+      sync();
     }
   }
 
@@ -474,6 +540,7 @@ private:
     {
       set(kb, knowledge_cast(get_value(*tracked_)));
       post_set(kb);
+      sync();
     }
   }
 
@@ -0,0 +1,214 @@
+#ifndef _MADARA_LOGGER_LOG_RING_H_
+#define _MADARA_LOGGER_LOG_RING_H_
+
+/**
+ * @file LogRing.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the LogRing class, a single-producer,
+ * single-consumer byte ring used by asynchronous loggers
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "madara/utility/IntTypes.h"
+
+namespace madara
+{
+namespace logger
+{
+/**
+ * @class LogRing
+ * @brief A lock-free ring of formatted log messages. One thread pushes
+ *        messages and one writer thread drains them. Messages are stored
+ *        back to back as a header followed by the text, and may wrap
+ *        around the end of the buffer.
+ **/
+class LogRing
+{
+public:
+  /**
+   * Header stored before each message
+   **/
+  struct Header
+  {
+    /// the logging level of the message
+    int32_t level;
+
+    /// the number of bytes of text that follow
+    uint32_t length;
+
+    /// when the message was logged, in nanoseconds
+    int64_t time;
+  };
+
+  /**
+   * Constructor
+   * @param  ring_session  the async session of the logger that owns us
+   * @param  capacity      the size of the ring in bytes
+   **/
+  LogRing(uint64_t ring_session, size_t capacity)
+    : session(ring_session), buffer_(capacity)
+  {
+  }
+
+  LogRing(const LogRing&) = delete;
+  LogRing& operator=(const LogRing&) = delete;
+
+  /**
+   * Pushes a message. Only call from the producing thread.
+   * @param  level   the logging level
+   * @param  time    when the message was logged, in nanoseconds
+   * @param  text    the formatted message
+   * @param  length  the number of bytes in text
+   * @return true if the message fit, false if it was dropped
+   **/
+  inline bool push(int level, int64_t time, const char* text, size_t length)
+  {
+    size_t size = sizeof(Header) + length;
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+
+    if (buffer_.size() - (tail - head) < size)
+    {
+      return false;
+    }
+
+    Header header;
+    header.level = level;
+    header.length = (uint32_t)length;
+    header.time = time;
+
+    write(tail, &header, sizeof(Header));
+    write(tail + sizeof(Header), text, length);
+
+    tail_.store(tail + size, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * Returns the position after the newest message. Messages pushed later
+   * are after this position. Only call from the writer thread.
+   * @return  the position after the newest message
+   **/
+  inline size_t end(void) const
+  {
+    return tail_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Reads the header of the oldest message. Only call from the writer
+   * thread.
+   * @param  header  receives the header of the oldest message
+   * @param  end     a position returned by end. Messages after it are
+   *                 ignored.
+   * @return true if a message before end is queued
+   **/
+  inline bool front(Header& header, size_t end) const
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+
+    if (head >= end)
+    {
+      return false;
+    }
+
+    read(head, &header, sizeof(Header));
+
+    return true;
+  }
+
+  /**
+   * Removes the oldest message. Only call from the writer thread after
+   * front returned true.
+   * @param  header  the header returned by front
+   * @param  text    receives the text of the message
+   **/
+  inline void pop(const Header& header, std::string& text)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+
+    text.resize(header.length);
+    read(head + sizeof(Header), &text[0], header.length);
+
+    head_.store(head + sizeof(Header) + header.length,
+        std::memory_order_release);
+  }
+
+  /**
+   * Returns the number of bytes waiting to be drained
+   * @return  the queued bytes
+   **/
+  inline size_t used(void) const
+  {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Returns the size of the ring
+   * @return  the size of the ring in bytes
+   **/
+  inline size_t capacity(void) const
+  {
+    return buffer_.size();
+  }
+
+  /// the async session of the logger that owns this ring
+  const uint64_t session;
+
+  /// the producing thread
+  const std::thread::id owner = std::this_thread::get_id();
+
+  /// true while the producer is between checking open and pushing
+  std::atomic<bool> busy{false};
+
+  /// true after the producer woke the writer, until the writer drains
+  std::atomic<bool> waking{false};
+
+  /// false once the owning logger stops accepting messages in the ring
+  std::atomic<bool> open{true};
+
+private:
+  /**
+   * Copies bytes into the ring, wrapping at the end of the buffer
+   **/
+  inline void write(size_t pos, const void* source, size_t size)
+  {
+    size_t index = pos % buffer_.size();
+    size_t first = std::min(size, buffer_.size() - index);
+
+    std::memcpy(&buffer_[index], source, first);
+    std::memcpy(&buffer_[0], (const char*)source + first, size - first);
+  }
+
+  /**
+   * Copies bytes out of the ring, wrapping at the end of the buffer
+   **/
+  inline void read(size_t pos, void* dest, size_t size) const
+  {
+    size_t index = pos % buffer_.size();
+    size_t first = std::min(size, buffer_.size() - index);
+
+    std::memcpy(dest, &buffer_[index], first);
+    std::memcpy((char*)dest + first, &buffer_[0], size - first);
+  }
+
+  /// the message bytes
+  std::vector<char> buffer_;
+
+  /// total bytes ever pushed
+  std::atomic<size_t> tail_{0};
+
+  /// total bytes ever drained
+  std::atomic<size_t> head_{0};
+};
+}
+}
+
+#endif  // _MADARA_LOGGER_LOG_RING_H_
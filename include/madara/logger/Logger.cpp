@@ -1,11 +1,26 @@
 #include "Logger.h"
+#include "LogRing.h"
 #include <stdio.h>
 #include <stdarg.h>
 #include <time.h>
 #include <madara/utility/Utility.h>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <chrono>
 #include <iomanip>
 
+namespace
+{
+/// the last async session started by any logger
+std::atomic<uint64_t> last_session(0);
+
+#ifndef MADARA_NO_THREAD_LOCAL
+/// rings of the calling thread, for every logger it logs to
+thread_local std::vector<std::shared_ptr<madara::logger::LogRing>>
+    thread_rings;
+#endif
+}
+
 #ifndef MADARA_NO_THREAD_LOCAL
 thread_local int madara::logger::Logger::thread_level_(
     madara::logger::TLS_THREAD_LEVEL_DEFAULT);
@@ -32,6 +47,7 @@ madara::logger::Logger::Logger(bool log_to_terminal)
 
 madara::logger::Logger::~Logger()
 {
+  disable_async();
   clear();
 }
 
@@ -188,42 +204,285 @@ void madara::logger::Logger::log(int level, const char* message, ...)
 
     va_end(argptr);
 
+    if (async_.load(std::memory_order_acquire))
+    {
+      LogRing* ring = thread_ring();
+
+      if (ring)
+      {
+        // disable_async waits for busy rings after closing them, so a
+        // message pushed into an open ring is always written
+        ring->busy.store(true);
+
+        if (ring->open.load())
+        {
+          if (!ring->push(level, utility::get_time(), buffer,
+                  strnlen(buffer, sizeof(buffer))))
+          {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+          }
+          else if (ring->used() > ring->capacity() / 2 &&
+                   !ring->waking.exchange(true))
+          {
+            // wake the writer once as the ring passes half full
+            wake_.notify_one();
+          }
+
+          ring->busy.store(false, std::memory_order_release);
+          return;
+        }
+
+        ring->busy.store(false, std::memory_order_release);
+      }
+    }
+
     MADARA_GUARD_TYPE guard(mutex_);
 
+    write_unsafe(level, buffer);
+  }
+}
+
+void madara::logger::Logger::write_unsafe(int level, const char* buffer)
+{
 #ifdef _MADARA_ANDROID_
-    if (this->term_added_ || this->syslog_added_)
+  if (this->term_added_ || this->syslog_added_)
+  {
+    if (level == LOG_ERROR)
     {
-      if (level == LOG_ERROR)
-      {
-        __android_log_write(ANDROID_LOG_ERROR, tag_.c_str(), buffer);
-      }
-      else if (level == LOG_WARNING)
-      {
-        __android_log_write(ANDROID_LOG_WARN, tag_.c_str(), buffer);
-      }
-      else
-      {
-        __android_log_write(ANDROID_LOG_INFO, tag_.c_str(), buffer);
-      }
+      __android_log_write(ANDROID_LOG_ERROR, tag_.c_str(), buffer);
     }
+    else if (level == LOG_WARNING)
+    {
+      __android_log_write(ANDROID_LOG_WARN, tag_.c_str(), buffer);
+    }
+    else
+    {
+      __android_log_write(ANDROID_LOG_INFO, tag_.c_str(), buffer);
+    }
+  }
 #else  // end if _USING_ANDROID_
-    if (this->term_added_ || this->syslog_added_)
+  if (this->term_added_ || this->syslog_added_)
+  {
+    fprintf(stderr, "%s", buffer);
+  }
+#endif
+
+  int file_num = 0;
+  for (FileVectors::iterator i = files_.begin(); i != files_.end(); ++i)
+  {
+    if (level >= LOG_DETAILED)
     {
-      fprintf(stderr, "%s", buffer);
+      fprintf(stderr, "Logger::log: writing to file num %d", file_num);
+
+      // file_num is only important if logging is detailed
+      ++file_num;
     }
+    fprintf(*i, "%s", buffer);
+  }
+}
+
+madara::logger::LogRing* madara::logger::Logger::thread_ring(void)
+{
+  uint64_t session = session_.load(std::memory_order_acquire);
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  for (auto& ring : thread_rings)
+  {
+    if (ring->session == session)
+    {
+      return ring.get();
+    }
+  }
+
+  // forget rings of sessions that have ended
+  thread_rings.erase(std::remove_if(thread_rings.begin(), thread_rings.end(),
+                         [](const std::shared_ptr<LogRing>& ring) {
+                           return !ring->open.load();
+                         }),
+      thread_rings.end());
 #endif
 
-    int file_num = 0;
-    for (FileVectors::iterator i = files_.begin(); i != files_.end(); ++i)
+  std::lock_guard<std::mutex> guard(rings_mutex_);
+
+  if (!async_ || session_ != session)
+  {
+    return nullptr;
+  }
+
+#ifdef MADARA_NO_THREAD_LOCAL
+  for (auto& ring : rings_)
+  {
+    if (ring->owner == std::this_thread::get_id())
     {
-      if (level >= LOG_DETAILED)
+      return ring.get();
+    }
+  }
+#endif
+
+  std::shared_ptr<LogRing> ring(new LogRing(session, ring_size_));
+  rings_.push_back(ring);
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  thread_rings.push_back(ring);
+#endif
+
+  return ring.get();
+}
+
+void madara::logger::Logger::drain(void)
+{
+  std::vector<std::shared_ptr<LogRing>> rings;
+
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+
+#ifndef MADARA_NO_THREAD_LOCAL
+    // rings only we hold belong to threads that have exited
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                     [](const std::shared_ptr<LogRing>& ring) {
+                       return ring.use_count() == 1 && ring->used() == 0;
+                     }),
+        rings_.end());
+#endif
+
+    rings = rings_;
+  }
+
+  // only drain what is queued now, so busy loggers cannot starve flush
+  std::vector<size_t> ends(rings.size());
+  std::vector<LogRing::Header> fronts(rings.size());
+  std::vector<bool> ready(rings.size());
+
+  for (size_t i = 0; i < rings.size(); ++i)
+  {
+    rings[i]->waking = false;
+    ends[i] = rings[i]->end();
+    ready[i] = rings[i]->front(fronts[i], ends[i]);
+  }
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  // each ring is in order, so merge the threads by time
+  for (;;)
+  {
+    size_t oldest = rings.size();
+
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+      if (ready[i] &&
+          (oldest == rings.size() || fronts[i].time < fronts[oldest].time))
       {
-        fprintf(stderr, "Logger::log: writing to file num %d", file_num);
+        oldest = i;
+      }
+    }
+
+    if (oldest == rings.size())
+    {
+      break;
+    }
+
+    rings[oldest]->pop(fronts[oldest], drain_text_);
+    write_unsafe(fronts[oldest].level, drain_text_.c_str());
+
+    ready[oldest] = rings[oldest]->front(fronts[oldest], ends[oldest]);
+  }
+}
+
+void madara::logger::Logger::run_writer(void)
+{
+  std::unique_lock<std::mutex> guard(rings_mutex_);
+
+  while (!stopping_)
+  {
+    guard.unlock();
+    drain();
+    guard.lock();
+
+    ++passes_;
+    drained_.notify_all();
+
+    if (!stopping_)
+    {
+      wake_.wait_for(guard, std::chrono::nanoseconds(period_));
+    }
+  }
+}
+
+void madara::logger::Logger::enable_async(size_t ring_size, double period)
+{
+  std::lock_guard<std::mutex> guard(rings_mutex_);
+
+  if (async_)
+  {
+    return;
+  }
+
+  ring_size_ = ring_size;
+  period_ = (int64_t)(period * 1000000000);
+  session_ = ++last_session;
+  stopping_ = false;
+  async_ = true;
+
+  writer_ = std::thread(&Logger::run_writer, this);
+}
+
+void madara::logger::Logger::disable_async(void)
+{
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+
+    if (!async_)
+    {
+      return;
+    }
+
+    async_ = false;
+    stopping_ = true;
+
+    for (auto& ring : rings_)
+    {
+      ring->open = false;
+    }
+  }
+
+  wake_.notify_all();
+  writer_.join();
 
-        // file_num is only important if logging is detailed
-        ++file_num;
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+
+    for (auto& ring : rings_)
+    {
+      while (ring->busy.load())
+      {
+        std::this_thread::yield();
       }
-      fprintf(*i, "%s", buffer);
     }
   }
+
+  drain();
+
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    rings_.clear();
+    ++passes_;
+  }
+
+  drained_.notify_all();
+}
+
+void madara::logger::Logger::flush(void)
+{
+  std::unique_lock<std::mutex> guard(rings_mutex_);
+
+  if (!async_)
+  {
+    return;
+  }
+
+  // a pass already in progress may have missed our messages
+  uint64_t target = passes_ + 2;
+
+  wake_.notify_one();
+  drained_.wait(guard, [this, target] { return passes_ >= target || !async_; });
 }
@@ -5,7 +5,11 @@
 #include "madara/LockType.h"
 #include <vector>
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <stdio.h>
 #include "madara/utility/IntTypes.h"
 
@@ -17,17 +21,17 @@
  * @param  logger  the logger instance to use
  * @param  level   the logging level
  **/
-#define madara_logger_log(loggering, level, ...)             \
-  if (madara::logger::Logger::get_thread_level() >= 0)       \
-  {                                                          \
-    if (level <= madara::logger::Logger::get_thread_level()) \
-    {                                                        \
-      loggering.log(level, __VA_ARGS__);                     \
-    }                                                        \
-  }                                                          \
-  else if (level <= loggering.get_level())                   \
-  {                                                          \
-    loggering.log(level, __VA_ARGS__);                       \
+#define madara_logger_log(loggering, level, ...)               \
+  if (madara::logger::Logger::get_thread_level() >= 0)         \
+  {                                                            \
+    if ((level) <= madara::logger::Logger::get_thread_level()) \
+    {                                                          \
+      loggering.log(level, __VA_ARGS__);                       \
+    }                                                          \
+  }                                                            \
+  else if ((level) <= loggering.get_level())                   \
+  {                                                            \
+    loggering.log(level, __VA_ARGS__);                         \
   }
 
 /**
@@ -41,12 +45,12 @@
 #define madara_logger_ptr_log(loggering, level, ...)                  \
   if (loggering && (madara::logger::Logger::get_thread_level() >= 0)) \
   {                                                                   \
-    if (level <= madara::logger::Logger::get_thread_level())          \
+    if ((level) <= madara::logger::Logger::get_thread_level())        \
     {                                                                 \
       loggering->log(level, __VA_ARGS__);                             \
     }                                                                 \
   }                                                                   \
-  else if (loggering && (level <= loggering->get_level()))            \
+  else if (loggering && ((level) <= loggering->get_level()))          \
   {                                                                   \
     loggering->log(level, __VA_ARGS__);                               \
   }
@@ -59,27 +63,27 @@
  *                         not null)
  * @param  level           the logging level
  **/
-#define madara_logger_cond_log_ptrs(                                      \
-    conditional, logger_ptr, alt_logger_ptr, level, ...)                  \
-  if (conditional && logger_ptr &&                                        \
-      (madara::logger::Logger::get_thread_level() >= 0))                  \
-  {                                                                       \
-    if (level <= madara::logger::Logger::get_thread_level())              \
-    {                                                                     \
-      logger_ptr->log(level, __VA_ARGS__);                                \
-    }                                                                     \
-    else                                                                  \
-    {                                                                     \
-      alt_logger_ptr->log(level, __VA_ARGS__);                            \
-    }                                                                     \
-  }                                                                       \
-  else if (conditional && logger_ptr && level <= logger_ptr->get_level()) \
-  {                                                                       \
-    logger_ptr->log(level, __VA_ARGS__);                                  \
-  }                                                                       \
-  else                                                                    \
-  {                                                                       \
-    alt_logger_ptr->log(level, __VA_ARGS__);                              \
+#define madara_logger_cond_log_ptrs(                                        \
+    conditional, logger_ptr, alt_logger_ptr, level, ...)                    \
+  if (conditional && logger_ptr &&                                          \
+      (madara::logger::Logger::get_thread_level() >= 0))                    \
+  {                                                                         \
+    if ((level) <= madara::logger::Logger::get_thread_level())              \
+    {                                                                       \
+      logger_ptr->log(level, __VA_ARGS__);                                  \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+      alt_logger_ptr->log(level, __VA_ARGS__);                              \
+    }                                                                       \
+  }                                                                         \
+  else if (conditional && logger_ptr && (level) <= logger_ptr->get_level()) \
+  {                                                                         \
+    logger_ptr->log(level, __VA_ARGS__);                                    \
+  }                                                                         \
+  else                                                                      \
+  {                                                                         \
+    alt_logger_ptr->log(level, __VA_ARGS__);                                \
   }
 
 /**
@@ -94,7 +98,7 @@
     conditional, loggering, alt_logger_ptr, level, ...)                 \
   if (conditional && (madara::logger::Logger::get_thread_level() >= 0)) \
   {                                                                     \
-    if (level <= madara::logger::Logger::get_thread_level())            \
+    if ((level) <= madara::logger::Logger::get_thread_level())          \
     {                                                                   \
       loggering.log(level, __VA_ARGS__);                                \
     }                                                                   \
@@ -103,7 +107,7 @@
       alt_logger_ptr->log(level, __VA_ARGS__);                          \
     }                                                                   \
   }                                                                     \
-  else if (conditional && level <= loggering.get_level())               \
+  else if (conditional && (level) <= loggering.get_level())             \
   {                                                                     \
     loggering.log(level, __VA_ARGS__);                                  \
   }                                                                     \
@@ -116,6 +120,8 @@ namespace madara
 {
 namespace logger
 {
+class LogRing;
+
 /**
  * Logging levels available for MADARA library
  **/
@@ -215,6 +221,40 @@ public:
    **/
   void set_timestamp_format(const std::string& format = "%x %X: ");
 
+  /**
+   * Switches to asynchronous logging. Calls to log format the message and
+   * push it into a lock-free ring owned by the calling thread, and a
+   * background thread writes the messages to the log outputs. Messages
+   * that do not fit in a full ring are dropped and counted.
+   * @param  ring_size  the size in bytes of each thread's ring
+   * @param  period     the maximum seconds between writes
+   **/
+  void enable_async(size_t ring_size = 262144, double period = 0.01);
+
+  /**
+   * Switches back to synchronous logging, after writing every message
+   * that was already logged
+   **/
+  void disable_async(void);
+
+  /**
+   * Checks if logging is asynchronous
+   * @return true if enable_async is in effect
+   **/
+  bool is_async(void) const;
+
+  /**
+   * Blocks until every message logged before this call is written.
+   * Returns immediately if logging is synchronous.
+   **/
+  void flush(void);
+
+  /**
+   * Returns the number of messages dropped because a ring was full
+   * @return  the number of dropped messages
+   **/
+  uint64_t get_dropped(void) const;
+
   /**
    * Fetches thread local storage value for thread level
    * @return the log level of the local thread
@@ -281,6 +321,30 @@ private:
   std::string strip_custom_tstamp(
       const std::string in_str, const std::string ts_str);
 
+  /**
+   * Writes a formatted message to the log outputs. Requires mutex_.
+   * @param  level   the logging level
+   * @param  buffer  the formatted message
+   **/
+  void write_unsafe(int level, const char* buffer);
+
+  /**
+   * Returns the calling thread's ring for the current async session,
+   * creating it if necessary
+   * @return the ring, or null if logging is synchronous
+   **/
+  LogRing* thread_ring(void);
+
+  /**
+   * Drains every ring and writes the messages in time order
+   **/
+  void drain(void);
+
+  /**
+   * Entry point of the async writer thread
+   **/
+  void run_writer(void);
+
   /// guard for access and changes
 
   /// vector of file handles
@@ -307,6 +371,45 @@ private:
   /// the timestamp format.
   std::string timestamp_format_;
 
+  /// true while logging is asynchronous
+  std::atomic<bool> async_{false};
+
+  /// the current async session, unique across loggers
+  std::atomic<uint64_t> session_{0};
+
+  /// the size of new rings in bytes
+  size_t ring_size_ = 0;
+
+  /// the maximum time between writes, in nanoseconds
+  int64_t period_ = 0;
+
+  /// messages dropped because a ring was full
+  std::atomic<uint64_t> dropped_{0};
+
+  /// protects rings_ and writer state
+  std::mutex rings_mutex_;
+
+  /// rings of the current async session, one per logging thread
+  std::vector<std::shared_ptr<LogRing>> rings_;
+
+  /// signaled to wake the writer
+  std::condition_variable wake_;
+
+  /// signaled when the writer finishes a pass
+  std::condition_variable drained_;
+
+  /// the number of completed writer passes
+  uint64_t passes_ = 0;
+
+  /// true when the writer should exit
+  bool stopping_ = false;
+
+  /// the async writer thread
+  std::thread writer_;
+
+  /// reused by the writer for the text of each message
+  std::string drain_text_;
+
   /// constants for the thread local keystrings
 
   /// key string constant for clock seconds for local thread
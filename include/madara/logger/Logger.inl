@@ -117,6 +117,9 @@ inline void madara::logger::Logger::add_syslog(void)
 
 inline void madara::logger::Logger::clear(void)
 {
+  // write queued messages before their outputs are closed
+  flush();
+
   MADARA_GUARD_TYPE guard(mutex_);
 
   this->term_added_ = false;
@@ -141,4 +144,14 @@ inline void madara::logger::Logger::set_timestamp_format(
   this->timestamp_format_ = format;
 }
 
+inline bool madara::logger::Logger::is_async(void) const
+{
+  return async_;
+}
+
+inline uint64_t madara::logger::Logger::get_dropped(void) const
+{
+  return dropped_.load(std::memory_order_relaxed);
+}
+
 #endif  // _MADARA_LOGGER_LOGGER_INL_
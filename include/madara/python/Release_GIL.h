@@ -0,0 +1,45 @@
+#ifdef _MADARA_PYTHON_CALLBACKS_
+
+#ifndef _MADARA_PYTHON_RELEASE_GIL_H_
+#define _MADARA_PYTHON_RELEASE_GIL_H_
+
+#include <boost/python.hpp>
+
+/**
+ * @file Release_GIL.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains helper classes for releasing the GIL.
+ **/
+
+namespace madara
+{
+namespace python
+{
+/**
+ * @class Release_GIL
+ * @brief This class releases the global interpreter lock for its lifetime
+ *        so that other Python threads may run during blocking calls. Any
+ *        Python callbacks made in the meantime must use Acquire_GIL.
+ **/
+class Release_GIL
+{
+public:
+  Release_GIL()
+  {
+    state_ = PyEval_SaveThread();
+  }
+
+  ~Release_GIL()
+  {
+    PyEval_RestoreThread(state_);
+  }
+
+private:
+  PyThreadState* state_;
+};
+}
+}
+#endif  // not defined _MADARA_PYTHON_RELEASE_GIL_H_
+
+#endif  // defined _MADARA_PYTHON_CALLBACKS_
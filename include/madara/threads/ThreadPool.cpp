@@ -0,0 +1,306 @@
+#include "ThreadPool.h"
+#include "WorkerThread.h"
+#include "madara/logger/GlobalLogger.h"
+
+#ifdef _MADARA_JAVA_
+#include <jni.h>
+#include "madara_jni.h"
+#include "madara/utility/java/Acquire_VM.h"
+#endif
+
+#include <algorithm>
+
+namespace madara
+{
+namespace threads
+{
+const size_t ThreadPool::wheel_slots;
+const int64_t ThreadPool::tick_nanoseconds;
+
+ThreadPool::ThreadPool(size_t threads, const ThreadSettings& settings)
+  : settings_(settings),
+    next_queue_(0),
+    epoch_(utility::get_time_value()),
+    wheel_(wheel_slots)
+{
+  if (threads == 0)
+  {
+    threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "ThreadPool::ThreadPool:"
+      " starting %d pool threads\n",
+      (int)threads);
+
+  for (size_t i = 0; i < threads; ++i)
+  {
+    queues_.emplace_back(new Queue());
+  }
+
+  for (size_t i = 0; i < threads; ++i)
+  {
+    threads_.emplace_back(&ThreadPool::work, this, i);
+  }
+
+  timer_ = std::thread(&ThreadPool::tick, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    timer_stopping_ = true;
+  }
+  timer_changed_.notify_all();
+
+  if (timer_.joinable())
+  {
+    timer_.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    stopping_ = true;
+  }
+  idle_.notify_all();
+
+  for (auto& thread : threads_)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+}
+
+size_t ThreadPool::size(void) const
+{
+  return threads_.size();
+}
+
+void ThreadPool::submit(WorkerThread* worker)
+{
+  push(next_queue_++ % queues_.size(), worker);
+}
+
+void ThreadPool::schedule(
+    WorkerThread* worker, const utility::TimeValue& deadline)
+{
+  int64_t tick = to_tick(deadline);
+
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+
+    if (tick > last_tick_)
+    {
+      wheel_[tick % wheel_slots].emplace_back(tick, worker);
+
+      if (++timers_ == 1 || tick < earliest_tick_)
+      {
+        earliest_tick_ = tick;
+        timer_changed_.notify_one();
+      }
+
+      return;
+    }
+  }
+
+  // the deadline has already passed
+  submit(worker);
+}
+
+void ThreadPool::push(size_t index, WorkerThread* worker)
+{
+  // count the worker before it becomes visible so idle threads never
+  // miss it
+  {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    ++pending_;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(worker);
+  }
+
+  idle_.notify_one();
+}
+
+WorkerThread* ThreadPool::pop(size_t index)
+{
+  WorkerThread* worker = 0;
+
+  {
+    Queue& own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+
+    if (!own.tasks.empty())
+    {
+      worker = own.tasks.front();
+      own.tasks.pop_front();
+    }
+  }
+
+  // steal from the back of the other queues
+  for (size_t i = 1; !worker && i < queues_.size(); ++i)
+  {
+    Queue& victim = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+
+    if (!victim.tasks.empty())
+    {
+      worker = victim.tasks.back();
+      victim.tasks.pop_back();
+    }
+  }
+
+  if (worker)
+  {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    --pending_;
+  }
+
+  return worker;
+}
+
+void ThreadPool::work(size_t index)
+{
+#ifdef _MADARA_JAVA_
+  // stay attached to the VM for all of the Java threads we execute
+  utility::java::Acquire_VM jvm(false);
+#endif
+
+  if (settings_.is_set())
+  {
+    settings_.apply();
+  }
+
+  utility::TimeValue next_run;
+
+  for (;;)
+  {
+    WorkerThread* worker = pop(index);
+
+    if (!worker)
+    {
+      std::unique_lock<std::mutex> lock(idle_mutex_);
+      idle_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+
+      if (stopping_)
+      {
+        break;
+      }
+
+      continue;
+    }
+
+    if (worker->step(next_run) && next_run != utility::TimeValue::max())
+    {
+      if (next_run <= utility::get_time_value())
+      {
+        // blasters and late workers go to the back of our own queue
+        push(index, worker);
+      }
+      else
+      {
+        schedule(worker, next_run);
+      }
+    }
+  }
+}
+
+void ThreadPool::tick(void)
+{
+  std::vector<WorkerThread*> expired;
+  std::unique_lock<std::mutex> lock(timer_mutex_);
+
+  while (!timer_stopping_)
+  {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      utility::get_time_value() - epoch_)
+                      .count() /
+                  tick_nanoseconds;
+
+    if (now > last_tick_)
+    {
+      bool earliest_expired = earliest_tick_ <= now;
+      int64_t slots = std::min<int64_t>(now - last_tick_, wheel_slots);
+
+      for (int64_t i = 1; i <= slots; ++i)
+      {
+        auto& slot = wheel_[(last_tick_ + i) % wheel_slots];
+
+        for (size_t j = 0; j < slot.size();)
+        {
+          if (slot[j].first <= now)
+          {
+            expired.push_back(slot[j].second);
+            slot[j] = slot.back();
+            slot.pop_back();
+          }
+          else
+          {
+            ++j;
+          }
+        }
+      }
+
+      last_tick_ = now;
+      timers_ -= expired.size();
+
+      if (timers_ > 0 && earliest_expired)
+      {
+        earliest_tick_ = INT64_MAX;
+
+        for (auto& slot : wheel_)
+        {
+          for (auto& timer : slot)
+          {
+            earliest_tick_ = std::min(earliest_tick_, timer.first);
+          }
+        }
+      }
+    }
+
+    if (!expired.empty())
+    {
+      lock.unlock();
+
+      for (auto worker : expired)
+      {
+        submit(worker);
+      }
+      expired.clear();
+
+      lock.lock();
+      continue;
+    }
+
+    if (timers_ == 0)
+    {
+      timer_changed_.wait(lock);
+    }
+    else
+    {
+      timer_changed_.wait_until(lock,
+          epoch_ + std::chrono::nanoseconds(earliest_tick_ * tick_nanoseconds));
+    }
+  }
+}
+
+int64_t ThreadPool::to_tick(const utility::TimeValue& time) const
+{
+  int64_t elapsed =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch_)
+          .count();
+
+  if (elapsed <= 0)
+  {
+    return 0;
+  }
+
+  return (elapsed + tick_nanoseconds - 1) / tick_nanoseconds;
+}
+}
+}
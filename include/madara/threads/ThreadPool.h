@@ -0,0 +1,186 @@
+
+
+#ifndef _MADARA_THREADS_THREAD_POOL_H_
+#define _MADARA_THREADS_THREAD_POOL_H_
+
+/**
+ * @file ThreadPool.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ThreadPool class, which multiplexes the
+ * executions of many WorkerThreads onto a fixed set of OS threads
+ **/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "madara/utility/Utility.h"
+#include "ThreadSettings.h"
+
+namespace madara
+{
+namespace threads
+{
+class WorkerThread;
+
+/**
+ * @class ThreadPool
+ * @brief Runs WorkerThread executions on a fixed set of OS threads.
+ *        Each pool thread owns a deque of ready workers and steals from
+ *        the back of other deques when its own is empty. Periodic workers
+ *        wait for their next epoch in a timer wheel with millisecond ticks
+ *        instead of sleeping in their own thread.
+ **/
+class ThreadPool
+{
+public:
+  /// the number of slots in the timer wheel
+  static const size_t wheel_slots = 1024;
+
+  /// the timer wheel resolution in nanoseconds
+  static const int64_t tick_nanoseconds = 1000000;
+
+  /**
+   * Constructor
+   * @param  threads   the number of OS threads. 0 uses one per core.
+   * @param  settings  affinity and scheduling applied by each OS thread
+   **/
+  ThreadPool(
+      size_t threads = 0, const ThreadSettings& settings = ThreadSettings());
+
+  /**
+   * Destructor. Stops the OS threads. Workers still queued are dropped,
+   * so terminate and wait on them first.
+   **/
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Queues a worker to execute as soon as a pool thread is free
+   * @param  worker   the worker to execute
+   **/
+  void submit(WorkerThread* worker);
+
+  /**
+   * Queues a worker to execute no earlier than a deadline
+   * @param  worker    the worker to execute
+   * @param  deadline  the earliest time to execute the worker
+   **/
+  void schedule(WorkerThread* worker, const utility::TimeValue& deadline);
+
+  /**
+   * Returns the number of OS threads in the pool
+   * @return  the number of OS threads
+   **/
+  size_t size(void) const;
+
+private:
+  /**
+   * A deque of ready workers owned by one pool thread
+   **/
+  struct Queue
+  {
+    /// protects tasks
+    std::mutex mutex;
+
+    /// ready workers. The owner pops the front, thieves the back.
+    std::deque<WorkerThread*> tasks;
+  };
+
+  /**
+   * Pushes a ready worker onto a queue and wakes an idle pool thread
+   * @param  index    the queue to push onto
+   * @param  worker   the ready worker
+   **/
+  void push(size_t index, WorkerThread* worker);
+
+  /**
+   * Takes a ready worker from our own queue or steals one
+   * @param  index    the queue owned by the calling pool thread
+   * @return  a ready worker, or 0 if every queue is empty
+   **/
+  WorkerThread* pop(size_t index);
+
+  /**
+   * Entry point of a pool thread
+   * @param  index    the queue owned by this pool thread
+   **/
+  void work(size_t index);
+
+  /**
+   * Entry point of the timer thread, which moves expired workers from
+   * the timer wheel to the ready queues
+   **/
+  void tick(void);
+
+  /**
+   * Converts a time to a timer wheel tick, rounding up so that workers
+   * never execute before their deadline
+   * @param  time     the time to convert
+   * @return  the tick at or after the time
+   **/
+  int64_t to_tick(const utility::TimeValue& time) const;
+
+  /// settings applied by each pool thread when it starts
+  ThreadSettings settings_;
+
+  /// ready queues, one per pool thread
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  /// the pool threads
+  std::vector<std::thread> threads_;
+
+  /// the queue that receives the next submission from outside the pool
+  std::atomic<size_t> next_queue_;
+
+  /// protects pending_ and stopping_ for idle pool threads
+  std::mutex idle_mutex_;
+
+  /// signaled when workers are queued or the pool stops
+  std::condition_variable idle_;
+
+  /// the number of queued ready workers
+  int64_t pending_ = 0;
+
+  /// true when the pool is shutting down
+  bool stopping_ = false;
+
+  /// the start of tick 0
+  utility::TimeValue epoch_;
+
+  /// protects the timer wheel
+  std::mutex timer_mutex_;
+
+  /// signaled when an earlier deadline is scheduled or the pool stops
+  std::condition_variable timer_changed_;
+
+  /// the timer wheel of (deadline tick, worker) pairs
+  std::vector<std::vector<std::pair<int64_t, WorkerThread*>>> wheel_;
+
+  /// the number of workers in the timer wheel
+  size_t timers_ = 0;
+
+  /// the last tick that the timer thread expired
+  int64_t last_tick_ = 0;
+
+  /// the earliest deadline tick in the timer wheel
+  int64_t earliest_tick_ = 0;
+
+  /// true when the timer thread should stop
+  bool timer_stopping_ = false;
+
+  /// the timer thread
+  std::thread timer_;
+};
+}
+}
+
+#endif  // _MADARA_THREADS_THREAD_POOL_H_
@@ -0,0 +1,106 @@
+
+
+#ifndef _MADARA_THREADS_THREAD_SETTINGS_H_
+#define _MADARA_THREADS_THREAD_SETTINGS_H_
+
+/**
+ * @file ThreadSettings.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ThreadSettings class, which configures the
+ * CPU placement and scheduling of threads started by a Threader
+ **/
+
+#include <vector>
+
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace threads
+{
+/**
+ * @class ThreadSettings
+ * @brief CPU affinity, scheduling and memory locking applied by a thread
+ *        to itself when it starts. Settings that the OS rejects, usually
+ *        for lack of privileges, are logged and otherwise ignored.
+ **/
+class ThreadSettings
+{
+public:
+  /**
+   * Scheduling policies
+   **/
+  enum SchedulingPolicy
+  {
+    /// leave the OS default policy (SCHED_OTHER on POSIX)
+    POLICY_DEFAULT = 0,
+    /// real-time first-in, first-out (SCHED_FIFO)
+    POLICY_FIFO = 1,
+    /// real-time round robin (SCHED_RR)
+    POLICY_RR = 2
+  };
+
+  /**
+   * Checks if any setting differs from the defaults
+   * @return true if apply would change the calling thread or process
+   **/
+  bool is_set(void) const
+  {
+    return !cores.empty() || policy != POLICY_DEFAULT || lock_memory;
+  }
+
+  /**
+   * Applies the settings to the calling thread
+   * @return true if every requested setting was applied
+   **/
+  bool apply(void) const
+  {
+    bool result = true;
+
+    if (lock_memory)
+    {
+      result = utility::lock_memory() && result;
+    }
+
+    if (!cores.empty())
+    {
+      result = utility::set_thread_affinity(cores) && result;
+    }
+
+    if (policy != POLICY_DEFAULT)
+    {
+      result = utility::set_thread_scheduling(policy, priority) && result;
+    }
+
+    return result;
+  }
+
+  /**
+   * CPU cores the thread may run on. Pinning to cores of one NUMA node
+   * also keeps memory first touched by the thread on that node. If
+   * empty, the thread may run on any core.
+   **/
+  std::vector<int> cores;
+
+  /**
+   * The scheduling policy, one of SchedulingPolicy
+   **/
+  int policy = POLICY_DEFAULT;
+
+  /**
+   * The priority within a real-time policy (1-99 on Linux)
+   **/
+  int priority = 0;
+
+  /**
+   * If true, lock all current and future process memory with mlockall
+   * when the first such thread starts, so page faults cannot stall it.
+   * Later threads reuse the process-wide lock.
+   **/
+  bool lock_memory = false;
+};
+}
+}
+
+#endif  // _MADARA_THREADS_THREAD_SETTINGS_H_
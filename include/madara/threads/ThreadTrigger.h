@@ -0,0 +1,109 @@
+#ifndef _MADARA_THREADS_THREAD_TRIGGER_H_
+#define _MADARA_THREADS_THREAD_TRIGGER_H_
+
+/**
+ * @file ThreadTrigger.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ThreadTrigger class, which describes the
+ * knowledge changes that execute an event-triggered thread
+ **/
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace madara
+{
+namespace threads
+{
+/**
+ * @class ThreadTrigger
+ * @brief Describes when an event-triggered thread should execute. The
+ *        thread runs once after init and then whenever a record matching
+ *        keys or prefixes is modified in the data plane, locally or by a
+ *        transport. If keys and prefixes are both empty, any modification
+ *        triggers the thread.
+ **/
+class ThreadTrigger
+{
+public:
+  /**
+   * Default constructor
+   **/
+  ThreadTrigger() {}
+
+  /**
+   * Constructor
+   * @param  trigger_prefixes  prefixes of records that trigger execution
+   * @param  trigger_condition KaRL logic that must be true to execute
+   **/
+  ThreadTrigger(const std::vector<std::string>& trigger_prefixes,
+      const std::string& trigger_condition = "")
+    : prefixes(trigger_prefixes), condition(trigger_condition)
+  {
+  }
+
+  /**
+   * Checks if a modified record should trigger execution
+   * @param  key   the name of the modified record
+   * @return true if the record matches keys or prefixes
+   **/
+  bool matches(const char* key) const
+  {
+    if (keys.empty() && prefixes.empty())
+    {
+      return true;
+    }
+
+    for (const auto& cur : keys)
+    {
+      if (cur == key)
+      {
+        return true;
+      }
+    }
+
+    for (const auto& cur : prefixes)
+    {
+      if (std::strncmp(key, cur.c_str(), cur.size()) == 0)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Names of records that trigger execution when modified
+   **/
+  std::vector<std::string> keys;
+
+  /**
+   * Prefixes of records that trigger execution when modified
+   **/
+  std::vector<std::string> prefixes;
+
+  /**
+   * KaRL logic evaluated against the data plane after a trigger. If not
+   * empty, the thread only executes while the logic is true.
+   **/
+  std::string condition;
+
+  /**
+   * Seconds without a matching change to wait before executing. Bursts
+   * of changes within this window result in one execution.
+   **/
+  double debounce = 0;
+
+  /**
+   * Maximum executions per second. Changes that arrive faster are
+   * coalesced. 0 means unlimited.
+   **/
+  double max_hertz = 0;
+};
+}
+}
+
+#endif  // _MADARA_THREADS_THREAD_TRIGGER_H_
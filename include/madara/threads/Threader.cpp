@@ -2,6 +2,8 @@
 #include "madara/utility/Utility.h"
 #include "madara/exceptions/ThreadException.h"
 
+#include <fstream>
+
 #ifdef _MADARA_JAVA_
 
 #include "java/JavaThread.h"
@@ -28,6 +30,7 @@ void madara::threads::Threader::pause(const std::string name)
   if (found != threads_.end())
   {
     control_.set(name + ".paused", knowledge::KnowledgeRecord::Integer(1));
+    found->second->pause_requested_ = true;
   }
 }
 
@@ -37,6 +40,7 @@ void madara::threads::Threader::pause(void)
        ++i)
   {
     control_.set(i->first + ".paused", knowledge::KnowledgeRecord::Integer(1));
+    i->second->pause_requested_ = true;
   }
 }
 
@@ -47,6 +51,7 @@ void madara::threads::Threader::resume(const std::string name)
   if (found != threads_.end())
   {
     control_.set(name + ".paused", knowledge::KnowledgeRecord::Integer(0));
+    found->second->pause_requested_ = false;
   }
 }
 
@@ -56,6 +61,7 @@ void madara::threads::Threader::resume(void)
        ++i)
   {
     control_.set(i->first + ".paused", knowledge::KnowledgeRecord::Integer(0));
+    i->second->pause_requested_ = false;
   }
 }
 
@@ -67,13 +73,7 @@ void madara::threads::Threader::run(
     std::unique_ptr<WorkerThread> worker(
         new WorkerThread(name, thread, control_, data_));
 
-    if (paused)
-      thread->paused = 1;
-
-    if (debug_)
-      worker->debug_ = 1;
-
-    (threads_[name] = std::move(worker))->run();
+    start(name, std::move(worker), paused);
   }
   else if (thread != 0 && name == "")
   {
@@ -137,13 +137,39 @@ void madara::threads::Threader::run(
     std::unique_ptr<WorkerThread> worker(
         new WorkerThread(name, thread, control_, data_, hertz));
 
-    if (paused)
-      thread->paused = 1;
+    start(name, std::move(worker), paused);
+  }
+  else if (thread != 0 && name == "")
+  {
+    delete thread;
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+        "Threader::run: named thread has an empty name. Deleting new thread.");
+
+    throw exceptions::ThreadException(
+        "Threader::run: named thread has an empty name. Deleting new thread.");
+  }
+  else
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+        "Threader::run: named thread has an empty name.");
+
+    throw exceptions::ThreadException(
+        "Threader::run: named thread has an empty name.");
+  }
+}
 
-    if (debug_)
-      worker->debug_ = 1;
+void madara::threads::Threader::run(const ThreadTrigger& trigger,
+    const std::string name, BaseThread* thread, bool paused)
+{
+  if (name != "" && thread != 0)
+  {
+    std::unique_ptr<WorkerThread> worker(
+        new WorkerThread(name, thread, control_, data_));
 
-    (threads_[name] = std::move(worker))->run();
+    worker->trigger_.reset(new ThreadTrigger(trigger));
+
+    start(name, std::move(worker), paused);
   }
   else if (thread != 0 && name == "")
   {
@@ -165,6 +191,108 @@ void madara::threads::Threader::run(
   }
 }
 
+void madara::threads::Threader::start(const std::string& name,
+    std::unique_ptr<WorkerThread> worker, bool paused)
+{
+  if (paused)
+    worker->thread_->paused = 1;
+
+  if (debug_)
+    worker->debug_ = 1;
+
+  auto settings = named_thread_settings_.find(name);
+  worker->settings_ = settings != named_thread_settings_.end()
+                          ? settings->second
+                          : thread_settings_;
+
+  WorkerThread* added = (threads_[name] = std::move(worker)).get();
+
+  if (pool_)
+  {
+    added->pool_ = pool_.get();
+    pool_->submit(added);
+  }
+  else
+  {
+    added->run();
+  }
+}
+
+int64_t madara::threads::Threader::save_latencies(
+    const std::string& filename) const
+{
+  std::ofstream file(filename.c_str());
+
+  if (!file)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+        "Threader::save_latencies: unable to open %s\n", filename.c_str());
+
+    return -1;
+  }
+
+  static const double published[] = {50, 90, 99, 99.9};
+
+  std::stringstream buffer;
+  buffer << "# thread histogram count p50 p90 p99 p99.9 max deadline_misses"
+         << " (nanoseconds)\n";
+
+  for (NamedWorkerThreads::const_iterator i = threads_.begin();
+       i != threads_.end(); ++i)
+  {
+    const WorkerThread& worker = *i->second;
+    const utility::LatencyHistogram* histograms[] = {
+        &worker.run_histogram_, &worker.lateness_histogram_};
+    const char* names[] = {"run", "lateness"};
+
+    for (size_t h = 0; h < 2; ++h)
+    {
+      if (histograms[h]->count() == 0)
+      {
+        continue;
+      }
+
+      int64_t results[4];
+      histograms[h]->percentiles(published, results, 4);
+
+      buffer << i->first << " " << names[h] << " " << histograms[h]->count();
+
+      for (int64_t result : results)
+      {
+        buffer << " " << result;
+      }
+
+      buffer << " " << histograms[h]->max() << " "
+             << (h == 1 ? worker.deadline_miss_count_.load() : 0) << "\n";
+    }
+  }
+
+  std::string contents = buffer.str();
+  file << contents;
+
+  return (int64_t)contents.size();
+}
+
+void madara::threads::Threader::set_thread_settings(
+    const ThreadSettings& settings)
+{
+  thread_settings_ = settings;
+}
+
+void madara::threads::Threader::set_thread_settings(
+    const std::string name, const ThreadSettings& settings)
+{
+  named_thread_settings_[name] = settings;
+}
+
+void madara::threads::Threader::use_pool(size_t workers)
+{
+  if (!pool_)
+  {
+    pool_.reset(new ThreadPool(workers, thread_settings_));
+  }
+}
+
 void madara::threads::Threader::set_data_plane(
     knowledge::KnowledgeBase data_plane)
 {
@@ -178,6 +306,7 @@ void madara::threads::Threader::terminate(const std::string name)
   if (found != threads_.end())
   {
     control_.set(name + ".terminated", knowledge::KnowledgeRecord::Integer(1));
+    found->second->terminate_requested_ = true;
   }
 }
 
@@ -188,6 +317,7 @@ void madara::threads::Threader::terminate(void)
   {
     control_.set(
         i->first + ".terminated", knowledge::KnowledgeRecord::Integer(1));
+    i->second->terminate_requested_ = true;
   }
 }
 
@@ -18,6 +18,8 @@
 #include "madara/knowledge/KnowledgeBase.h"
 #include "BaseThread.h"
 #include "WorkerThread.h"
+#include "ThreadPool.h"
+#include "ThreadSettings.h"
 #include "madara/MadaraExport.h"
 
 #ifdef _MADARA_JAVA_
@@ -142,6 +144,30 @@ public:
   void run(double hertz, const std::string name, BaseThread* thread,
       bool paused = false);
 
+  /**
+   * Starts a new thread that executes the provided user thread when
+   * knowledge in the data plane changes, instead of at a hertz rate.
+   * run is called once after init and then whenever a record matching
+   * the trigger is modified, locally or by a transport. The thread
+   * sleeps between triggers. Triggers that arrive while paused are
+   * dropped. change_hertz has no effect on triggered threads.
+   *
+   * <br>&nbsp;<br>The thread will be managed by the
+   * threader. Please do not pass the address of a thread
+   * on the stack and do not delete this memory yourself
+   * or your program will crash.
+   * @param trigger the keys, prefixes, condition, debounce and max
+   *                rate that determine when the thread executes
+   * @param name    unique thread name for the thread.
+   *                If possible, try to use one word or
+   *                words separated by underscores (_)
+   * @param thread  user-created thread implementation
+   * @param paused  create thread in a paused state.
+   * @throw exceptions::ThreadException  bad name (null)
+   **/
+  void run(const ThreadTrigger& trigger, const std::string name,
+      BaseThread* thread, bool paused = false);
+
 #ifdef _MADARA_JAVA_
 
   /**
@@ -184,6 +210,36 @@ public:
 
 #endif
 
+  /**
+   * Sets the CPU affinity, scheduling and memory locking of threads
+   * started after this call that have no named settings. Pool threads
+   * created by a later use_pool also apply these settings.
+   * @param  settings   the settings each new thread applies on start
+   **/
+  void set_thread_settings(const ThreadSettings& settings);
+
+  /**
+   * Sets the CPU affinity, scheduling and memory locking of a thread
+   * started after this call with the given name. Threads executed by a
+   * pool ignore named settings, since they share OS threads.
+   * @param  name       unique thread name for the thread
+   * @param  settings   the settings the thread applies on start
+   **/
+  void set_thread_settings(
+      const std::string name, const ThreadSettings& settings);
+
+  /**
+   * Runs threads started after this call on a fixed pool of OS threads
+   * instead of one OS thread per BaseThread. Idle pool threads steal work
+   * from busy ones, and periodic threads wait in a timer wheel rather
+   * than sleeping. Pause, resume, change_hertz and terminate work as in
+   * the default mode. Pool mode suits many short, non-blocking run
+   * methods: a run that blocks occupies a pool thread until it returns.
+   * Threads already started keep their own OS threads.
+   * @param  workers   the number of pool threads. 0 uses one per core.
+   **/
+  void use_pool(size_t workers = 0);
+
   /**
    * Sets the data plane for new threads
    * @param  data_plane   The data plane for threads to use
@@ -205,6 +261,17 @@ public:
    **/
   void debug_to_kb(const std::string prefix = ".threader");
 
+  /**
+   * Saves run duration and lateness percentiles of all debugged threads
+   * to a text file, one line per thread and histogram. Lateness is the
+   * time between the scheduled and actual start of periodic runs.
+   * Values are in nanoseconds.
+   * @param filename  the file to write
+   * @return  the number of bytes written, or -1 if the file could not
+   *          be opened
+   **/
+  int64_t save_latencies(const std::string& filename) const;
+
   /**
    * Requests a specific thread to disable debug mode. Debug mode
    * prints thread performance information such as durations
@@ -259,6 +326,15 @@ public:
   bool wait(const knowledge::WaitSettings& ws = knowledge::WaitSettings());
 
 private:
+  /**
+   * Applies the settings for a new worker thread and starts it
+   * @param name    the unique name of the thread
+   * @param worker  the worker thread to start
+   * @param paused  if true, start the thread paused
+   **/
+  void start(const std::string& name, std::unique_ptr<WorkerThread> worker,
+      bool paused);
+
   /**
    * The data plane used by threads
    **/
@@ -286,6 +362,22 @@ private:
    * go to the data plane at this prefix
    **/
   std::string debug_to_kb_prefix_;
+
+  /**
+   * settings applied by new threads without named settings
+   **/
+  ThreadSettings thread_settings_;
+
+  /**
+   * settings applied by new threads, by thread name
+   **/
+  std::map<std::string, ThreadSettings> named_thread_settings_;
+
+  /**
+   * if set, new threads are executed by this pool. Declared last so
+   * that it is stopped before the threads it executes are destroyed.
+   **/
+  std::unique_ptr<ThreadPool> pool_;
 };
 }
 }
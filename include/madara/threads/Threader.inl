@@ -16,16 +16,34 @@ inline void madara::threads::Threader::change_hertz(
     const std::string name, double hertz)
 {
   control_.set(name + ".hertz", hertz);
+
+  NamedWorkerThreads::iterator found = threads_.find(name);
+  if (found != threads_.end())
+  {
+    found->second->hertz_requested_ = hertz;
+  }
 }
 
 inline void madara::threads::Threader::enable_debug(const std::string name)
 {
   control_.set(name + ".debug", true);
+
+  NamedWorkerThreads::iterator found = threads_.find(name);
+  if (found != threads_.end())
+  {
+    found->second->debug_requested_ = true;
+  }
 }
 
 inline void madara::threads::Threader::disable_debug(const std::string name)
 {
   control_.set(name + ".debug", false);
+
+  NamedWorkerThreads::iterator found = threads_.find(name);
+  if (found != threads_.end())
+  {
+    found->second->debug_requested_ = false;
+  }
 }
 
 inline void madara::threads::Threader::debug_to_kb(const std::string prefix)
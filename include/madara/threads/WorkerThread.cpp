@@ -1,6 +1,8 @@
 #include "WorkerThread.h"
+#include "ThreadPool.h"
 #include "madara/logger/GlobalLogger.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Tracer.h"
 
 #ifdef _MADARA_JAVA_
 #include <jni.h>
@@ -19,6 +21,8 @@ namespace madara
 {
 namespace threads
 {
+const int64_t WorkerThread::control_sync_period;
+
 WorkerThread::WorkerThread(const std::string& name, BaseThread* thread,
     knowledge::KnowledgeBase control, knowledge::KnowledgeBase data,
     double hertz)
@@ -57,16 +61,34 @@ WorkerThread::WorkerThread(const std::string& name, BaseThread* thread,
     min_duration_.set_name(base_string.str() + ".min_duration", *kb);
     max_duration_.set_name(base_string.str() + ".max_duration", *kb);
 
+    run_p50_.set_name(base_string.str() + ".run_p50", *kb);
+    run_p99_.set_name(base_string.str() + ".run_p99", *kb);
+    run_p999_.set_name(base_string.str() + ".run_p999", *kb);
+    lateness_p50_.set_name(base_string.str() + ".lateness_p50", *kb);
+    lateness_p99_.set_name(base_string.str() + ".lateness_p99", *kb);
+    lateness_p999_.set_name(base_string.str() + ".lateness_p999", *kb);
+    deadline_misses_.set_name(base_string.str() + ".deadline_misses", *kb);
+
     debug_.set_name(base_string.str() + ".debug", control);
 
+    utility::Metrics& metrics = data_.get_context().get_metrics();
+    executions_metric_ = &metrics.counter(
+        "threads.executions", "Executions of thread run methods");
+    running_metric_ = &metrics.gauge(
+        "threads.running", "Threads that have started and not finished");
+
     finished_ = 0;
     started_ = 0;
     new_hertz_ = hertz_;
   }
+
+  hertz_requested_ = hertz_;
 }
 
 WorkerThread::~WorkerThread() noexcept
 {
+  stop_listening();
+
   try
   {
     if (me_.joinable())
@@ -155,192 +177,511 @@ int WorkerThread::svc(void)
 
   if (thread_)
   {
-    started_ = 1;
-
 #ifdef _MADARA_JAVA_
     // try detaching one more time, just to make sure.
     utility::java::Acquire_VM jvm(false);
 #endif
 
-#ifndef MADARA_NO_THREAD_LOCAL
-    madara::logger::Logger::set_thread_name(name_);
-#endif
+    if (settings_.is_set())
+    {
+      settings_.apply();
+    }
 
-    thread_->init(data_);
+    start();
 
+    for (;;)
     {
-      utility::TimeValue current = utility::get_time_value();
-      utility::TimeValue next_epoch;
-      utility::Duration frequency;
+      sync_control(control_changed_.exchange(false));
 
-      // only allow one-way communication of durations. We never read control
-      int64_t min_duration = -1;
-      int64_t max_duration = 0;
-      int64_t last_duration = 0;
-      bool max_duration_changed = true;
-      bool min_duration_changed = true;
+      if (terminate_requested_)
+        break;
 
-      bool one_shot = true;
-      bool blaster = false;
+      if (trigger_)
+      {
+        utility::TimeValue deadline;
 
-      bool debug = debug_.is_true();
+        if (trigger_ready(utility::get_time_value(), deadline))
+        {
+          if (trigger_condition_true())
+            execute();
+        }
+        else
+        {
+          wait_for_trigger(deadline);
+        }
 
-      knowledge::VariableReference terminated;
-      knowledge::VariableReference paused;
+        continue;
+      }
 
-      terminated = control_.get_ref(name_ + ".terminated");
-      paused = control_.get_ref(name_ + ".paused");
+      execute();
 
-      // change thread frequency
-      change_frequency(
-          hertz_, current, frequency, next_epoch, one_shot, blaster);
-#ifndef MADARA_NO_THREAD_LOCAL
-      madara::logger::Logger::set_thread_hertz(hertz_);
-#endif
+      if (one_shot_)
+        break;
 
-      if (debug)
+      // check for a change in frequency/hertz
+      double hertz = hertz_requested_;
+      if (hertz != hertz_)
       {
-        start_time_ = utility::get_time();
+        utility::TimeValue current = utility::get_time_value();
+        change_frequency(
+            hertz, current, frequency_, next_epoch_, one_shot_, blaster_);
       }
 
-      while (control_.get(terminated).is_false())
+      if (!blaster_)
       {
+        utility::TimeValue current = utility::get_time_value();
+
         madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
             "WorkerThread(%s)::svc:"
-            " thread checking for pause\n",
+            " thread checking for next hertz epoch\n",
             name_.c_str());
 
-        if (control_.get(paused).is_false())
-        {
-          madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-              "WorkerThread(%s)::svc:"
-              " thread calling run function\n",
-              name_.c_str());
+        if (current < next_epoch_)
+          utility::sleep(next_epoch_ - current);
 
-          try
+        madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+            "WorkerThread(%s)::svc:"
+            " thread past epoch\n",
+            name_.c_str());
+
+        next_epoch_ += frequency_;
+      }
+    }  // end while !terminated
+
+    finish();
+  }
+  else
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "WorkerThread(%s)::svc:"
+        " thread creation failed\n",
+        name_.c_str());
+  }
+
+  return 0;
+}
+
+void WorkerThread::start(void)
+{
+  started_ = 1;
+  running_metric_->add(1);
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  madara::logger::Logger::set_thread_name(name_);
+#endif
+
+  thread_->init(data_);
+
+  utility::TimeValue current = utility::get_time_value();
+
+  terminated_ = control_.get_ref(name_ + ".terminated");
+  paused_ = control_.get_ref(name_ + ".paused");
+
+  sync_control(true);
+
+  if (trigger_)
+  {
+#ifndef _MADARA_NO_KARL_
+    if (trigger_->condition != "")
+    {
+      trigger_condition_ = data_.compile(trigger_->condition);
+    }
+#endif
+
+    std::vector<std::string> control_keys = {terminated_.get_name(),
+        paused_.get_name(), new_hertz_.get_name(), debug_.get_name()};
+
+    data_listener_ = data_.get_context().add_change_listener(
+        [this](const char* key) {
+          if (trigger_->matches(key))
           {
-            int64_t start_time = 0, end_time = 0;
-            debug = debug_.is_true();
+            on_trigger();
+          }
+        });
 
-            if (debug)
+    control_listener_ = control_.get_context().add_change_listener(
+        [this, control_keys](const char* key) {
+          for (const auto& cur : control_keys)
+          {
+            if (cur == key)
             {
-              start_time = utility::get_time();
-              ++executions_;
+              control_changed_ = true;
+              wake();
+              break;
             }
+          }
+        });
 
-            thread_->run();
+    listening_ = true;
+  }
 
-            if (debug)
-            {
-              end_time = utility::get_time();
-
-              // update duration information
-              last_duration = end_time - start_time;
-              if (min_duration == -1 || last_duration < min_duration)
-              {
-                min_duration = last_duration;
-                min_duration_changed = true;
-              }
-              if (last_duration > max_duration)
-              {
-                max_duration = last_duration;
-                max_duration_changed = true;
-              }
-
-              // lock control plane and update
-              {
-                // write updates to control
-                knowledge::ContextGuard guard(control_);
-                last_start_time_ = start_time;
-                end_time_ = end_time;
-
-                last_duration_ = last_duration;
-                if (max_duration_changed)
-                {
-                  max_duration_ = max_duration;
-                }
-                if (min_duration_changed)
-                {
-                  min_duration_ = min_duration;
-                }
-              }  // end lock of control plane
-            }    // end if debug
-          }      // end try of the run
-          catch (const std::exception& e)
+  // change thread frequency
+  change_frequency(hertz_, current, frequency_, next_epoch_, one_shot_, blaster_);
+
+  if (debug_requested_)
+  {
+    start_time_ = utility::get_time();
+  }
+
+  initialized_ = true;
+}
+
+void WorkerThread::execute(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " thread checking for pause\n",
+      name_.c_str());
+
+  if (!pause_requested_)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "WorkerThread(%s)::svc:"
+        " thread calling run function\n",
+        name_.c_str());
+
+    try
+    {
+      int64_t start_time = 0;
+      utility::TimeValue start_value;
+      bool debug = debug_requested_;
+
+      if (debug)
+      {
+        start_time = utility::get_time();
+        start_value = utility::get_time_value();
+      }
+
+      {
+        MADARA_TRACE_SPAN("WorkerThread::run");
+        thread_->run();
+      }
+
+      executions_metric_->add();
+
+      if (debug)
+      {
+        utility::TimeValue end_value = utility::get_time_value();
+
+        // accumulate locally. sync_control publishes to the control plane.
+        ++execution_count_;
+        last_run_start_ = start_time;
+        last_run_end_ = utility::get_time();
+
+        run_histogram_.record(
+            std::chrono::duration_cast<utility::Duration>(
+                end_value - start_value)
+                .count());
+
+        // periodic runs were scheduled one period before next_epoch_
+        if (!one_shot_ && !blaster_ && !trigger_)
+        {
+          utility::TimeValue scheduled = next_epoch_ - frequency_;
+
+          lateness_histogram_.record(
+              std::chrono::duration_cast<utility::Duration>(
+                  start_value - scheduled)
+                  .count());
+
+          if (end_value > next_epoch_)
           {
-            madara_logger_ptr_log(logger::global_logger.get(),
-                logger::LOG_EMERGENCY,
-                "WorkerThread(%s)::svc:"
-                " exception thrown: %s\n",
-                name_.c_str(), e.what());
+            deadline_miss_count_.store(
+                deadline_miss_count_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
           }
         }
 
-        if (one_shot)
-          break;
-
-        // check for a change in frequency/hertz
-        if (new_hertz_ != hertz_)
+        last_run_duration_ = last_run_end_ - start_time;
+        if (min_run_duration_ == -1 || last_run_duration_ < min_run_duration_)
         {
-          change_frequency(
-              *new_hertz_, current, frequency, next_epoch, one_shot, blaster);
+          min_run_duration_ = last_run_duration_;
         }
-
-        if (!blaster)
+        if (last_run_duration_ > max_run_duration_)
         {
-          current = utility::get_time_value();
+          max_run_duration_ = last_run_duration_;
+        }
 
-          madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-              "WorkerThread(%s)::svc:"
-              " thread checking for next hertz epoch\n",
-              name_.c_str());
+        run_stats_changed_ = true;
+      }  // end if debug
+    }    // end try of the run
+    catch (const std::exception& e)
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_EMERGENCY,
+          "WorkerThread(%s)::svc:"
+          " exception thrown: %s\n",
+          name_.c_str(), e.what());
+    }
+  }
+}
 
-          if (current < next_epoch)
-            utility::sleep(next_epoch - current);
+void WorkerThread::on_trigger(void)
+{
+  ++triggers_;
+  last_trigger_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      utility::get_time_value().time_since_epoch())
+                      .count();
 
-          madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-              "WorkerThread(%s)::svc:"
-              " thread past epoch\n",
-              name_.c_str());
+  wake();
+}
 
-          next_epoch += frequency;
-        }
-      }  // end while !terminated
+void WorkerThread::wake(void)
+{
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+  }
+  wake_.notify_one();
 
-      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-          "WorkerThread(%s)::svc:"
-          " thread has been terminated\n",
-          name_.c_str());
+  if (pool_ && parked_.exchange(false))
+  {
+    pool_->submit(this);
+  }
+}
+
+bool WorkerThread::trigger_ready(
+    const utility::TimeValue& current, utility::TimeValue& deadline)
+{
+  seen_triggers_ = triggers_;
+
+  if (seen_triggers_ == handled_triggers_)
+  {
+    deadline = utility::TimeValue::max();
+    return false;
+  }
+
+  utility::TimeValue ready = current;
+
+  if (trigger_->debounce > 0)
+  {
+    utility::TimeValue last(
+        std::chrono::duration_cast<utility::Clock::duration>(
+            std::chrono::nanoseconds(last_trigger_)));
+
+    ready = std::max(
+        ready, last + utility::seconds_to_duration(trigger_->debounce));
+  }
+
+  if (trigger_->max_hertz > 0 && handled_triggers_ > 0)
+  {
+    ready = std::max(ready, last_triggered_run_ + utility::seconds_to_duration(
+                                                      1.0 / trigger_->max_hertz));
+  }
+
+  if (ready > current)
+  {
+    deadline = ready;
+    return false;
+  }
+
+  handled_triggers_ = seen_triggers_;
+  last_triggered_run_ = current;
+  return true;
+}
+
+bool WorkerThread::trigger_condition_true(void)
+{
+#ifndef _MADARA_NO_KARL_
+  if (trigger_->condition != "")
+  {
+    return data_.evaluate(trigger_condition_).is_true();
+  }
+#endif
+
+  return true;
+}
+
+void WorkerThread::wait_for_trigger(const utility::TimeValue& deadline)
+{
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+
+  auto changed = [this] {
+    return triggers_ != seen_triggers_ || control_changed_;
+  };
+
+  if (deadline == utility::TimeValue::max())
+  {
+    wake_.wait(lock, changed);
+  }
+  else
+  {
+    wake_.wait_until(lock, deadline, changed);
+  }
+}
+
+void WorkerThread::stop_listening(void)
+{
+  if (listening_)
+  {
+    data_.get_context().remove_change_listener(data_listener_);
+    control_.get_context().remove_change_listener(control_listener_);
+    listening_ = false;
+  }
+}
+
+void WorkerThread::sync_control(bool force)
+{
+  utility::TimeValue current = utility::get_time_value();
+
+  if (!force &&
+      current - last_sync_ < utility::Duration(control_sync_period))
+  {
+    return;
+  }
+
+  last_sync_ = current;
+
+  // lock control plane once for all reads and updates
+  knowledge::ContextGuard guard(control_);
+
+  terminate_requested_ = control_.get(terminated_).is_true();
+  pause_requested_ = control_.get(paused_).is_true();
+  hertz_requested_ = *new_hertz_;
+  debug_requested_ = debug_.is_true();
+
+  if (run_stats_changed_)
+  {
+    executions_ = execution_count_;
+    last_start_time_ = last_run_start_;
+    end_time_ = last_run_end_;
+
+    last_duration_ = last_run_duration_;
+    max_duration_ = max_run_duration_;
+    min_duration_ = min_run_duration_;
+
+    static const double published[] = {50, 99, 99.9};
+    int64_t results[3];
+
+    run_histogram_.percentiles(published, results, 3);
+    run_p50_ = results[0];
+    run_p99_ = results[1];
+    run_p999_ = results[2];
+
+    if (lateness_histogram_.count() > 0)
+    {
+      lateness_histogram_.percentiles(published, results, 3);
+      lateness_p50_ = results[0];
+      lateness_p99_ = results[1];
+      lateness_p999_ = results[2];
+      deadline_misses_ = (int64_t)deadline_miss_count_.load();
     }
 
-    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-        "WorkerThread(%s)::svc:"
-        " calling thread cleanup method\n",
-        name_.c_str());
+    run_stats_changed_ = false;
+  }
+}
 
-    thread_->cleanup();
+void WorkerThread::finish(void)
+{
+  stop_listening();
 
-    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-        "WorkerThread(%s)::svc:"
-        " deleting thread\n",
-        name_.c_str());
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " thread has been terminated\n",
+      name_.c_str());
 
-    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-        "WorkerThread(%s)::svc:"
-        " setting finished to 1\n",
-        finished_.get_name().c_str());
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " calling thread cleanup method\n",
+      name_.c_str());
+
+  thread_->cleanup();
+
+  // publish the final debug information
+  sync_control(true);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " setting finished to 1\n",
+      finished_.get_name().c_str());
+
+  running_metric_->add(-1);
+
+  // Threader::wait may destroy us as soon as this is set
+  finished_ = 1;
+}
+
+bool WorkerThread::step(utility::TimeValue& next_run)
+{
+  if (!thread_)
+  {
+    return false;
+  }
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  madara::logger::Logger::set_thread_name(name_);
+  madara::logger::Logger::set_thread_hertz(hertz_);
+#endif
+
+  if (!initialized_)
+  {
+    start();
+  }
+
+  sync_control(control_changed_.exchange(false));
+
+  if (terminate_requested_)
+  {
+    finish();
+    return false;
+  }
+
+  if (trigger_)
+  {
+    utility::TimeValue current = utility::get_time_value();
+
+    if (trigger_ready(current, next_run))
+    {
+      if (trigger_condition_true())
+        execute();
+
+      // step again to pick up changes made during the run
+      next_run = current;
+      return true;
+    }
 
-    finished_ = 1;
+    if (next_run == utility::TimeValue::max())
+    {
+      // park until on_trigger or a control change resubmits us. Once
+      // parked_ is set, another pool thread may be stepping us.
+      uint64_t seen = seen_triggers_;
+      parked_ = true;
+
+      if ((triggers_ != seen || control_changed_) && parked_.exchange(false))
+      {
+        next_run = current;
+      }
+    }
+
+    return true;
+  }
+
+  execute();
+
+  if (one_shot_)
+  {
+    finish();
+    return false;
+  }
+
+  utility::TimeValue current = utility::get_time_value();
+
+  // check for a change in frequency/hertz
+  double hertz = hertz_requested_;
+  if (hertz != hertz_)
+  {
+    change_frequency(
+        hertz, current, frequency_, next_epoch_, one_shot_, blaster_);
+  }
+
+  if (blaster_)
+  {
+    next_run = current;
   }
   else
   {
-    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-        "WorkerThread(%s)::svc:"
-        " thread creation failed\n",
-        name_.c_str());
+    next_run = next_epoch_;
+    next_epoch_ += frequency_;
   }
 
-  return 0;
+  return true;
 }
 }
 }
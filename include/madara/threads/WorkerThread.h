@@ -9,12 +9,18 @@
  * multicast transport for reading knowledge updates in KaRL
  **/
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <map>
 
 #include "madara/knowledge/KnowledgeBase.h"
 #include "BaseThread.h"
+#include "ThreadSettings.h"
+#include "ThreadTrigger.h"
 #include "madara/knowledge/containers/Double.h"
+#include "madara/utility/LatencyHistogram.h"
 #include "madara/utility/Utility.h"
 
 #include <thread>
@@ -24,6 +30,7 @@ namespace madara
 namespace threads
 {
 class Threader;
+class ThreadPool;
 
 /**
  * @class WorkerThread
@@ -32,9 +39,18 @@ class Threader;
 class WorkerThread
 {
 public:
+  /**
+   * The period at which the control plane is read for changes made
+   * outside of the Threader and debug information is published to it
+   **/
+  static const int64_t control_sync_period = 10000000;
+
   /// give access to our status flags to the Threader class
   friend class Threader;
 
+  /// give access to step to the pool that executes us in pool mode
+  friend class ThreadPool;
+
   /**
    * Default constructor
    **/
@@ -97,6 +113,81 @@ protected:
    **/
   void run(void);
 
+  /**
+   * Initializes the user thread and the loop state before the first
+   * execution
+   **/
+  void start(void);
+
+  /**
+   * Executes the user thread once, unless paused, and records debug
+   * information
+   **/
+  void execute(void);
+
+  /**
+   * Cleans up the user thread and marks it as finished. The worker must
+   * not be accessed by the executing thread after this call.
+   **/
+  void finish(void);
+
+  /**
+   * Performs one iteration of the task loop without sleeping. Used by
+   * ThreadPool to multiplex many workers onto a few OS threads.
+   * @param  next_run   the earliest time of the next iteration, or
+   *                    TimeValue::max if the worker is parked until a
+   *                    trigger resubmits it
+   * @return  true if the worker should be stepped again, false if it
+   *          has finished
+   **/
+  bool step(utility::TimeValue& next_run);
+
+  /**
+   * Records a modification that matches the trigger and wakes the thread
+   **/
+  void on_trigger(void);
+
+  /**
+   * Wakes the thread if it is waiting for a trigger. In pool mode,
+   * resubmits a parked thread to the pool.
+   **/
+  void wake(void);
+
+  /**
+   * Checks if a triggered thread should execute now
+   * @param  current   the current time
+   * @param  deadline  set to the earliest time the thread may execute
+   *                   if a trigger is pending, or TimeValue::max if not
+   * @return true if the thread should execute now
+   **/
+  bool trigger_ready(
+      const utility::TimeValue& current, utility::TimeValue& deadline);
+
+  /**
+   * Checks the trigger condition against the data plane
+   * @return true if there is no condition or the condition is true
+   **/
+  bool trigger_condition_true(void);
+
+  /**
+   * Blocks until a new trigger, a control plane change, or a deadline
+   * @param  deadline  the latest time to wake up
+   **/
+  void wait_for_trigger(const utility::TimeValue& deadline);
+
+  /**
+   * Stops listening for data and control plane changes
+   **/
+  void stop_listening(void);
+
+  /**
+   * Refreshes the cached control flags from the control plane and
+   * publishes debug information, at most once per control_sync_period
+   * unless forced
+   * @param  force   if true, synchronize regardless of the last sync
+   **/
+  void sync_control(bool force);
+
   /**
    * Changes the frequency given a hertz rate
    * @param  hertz      the new hertz rate
@@ -176,6 +267,41 @@ protected:
    **/
   knowledge::containers::Integer max_duration_;
 
+  /**
+   * median run duration
+   **/
+  knowledge::containers::Integer run_p50_;
+
+  /**
+   * 99th percentile run duration
+   **/
+  knowledge::containers::Integer run_p99_;
+
+  /**
+   * 99.9th percentile run duration
+   **/
+  knowledge::containers::Integer run_p999_;
+
+  /**
+   * median lateness of periodic runs past their scheduled start
+   **/
+  knowledge::containers::Integer lateness_p50_;
+
+  /**
+   * 99th percentile lateness of periodic runs
+   **/
+  knowledge::containers::Integer lateness_p99_;
+
+  /**
+   * 99.9th percentile lateness of periodic runs
+   **/
+  knowledge::containers::Integer lateness_p999_;
+
+  /**
+   * periodic runs that ended after the next scheduled start
+   **/
+  knowledge::containers::Integer deadline_misses_;
+
   /**
    * flag for whether or not to save debug information in control
    **/
@@ -185,6 +311,132 @@ protected:
    * hertz rate for worker thread executions
    **/
   double hertz_ = -1;
+
+  /// true if start has been called
+  bool initialized_ = false;
+
+  /// the next time to trigger execution
+  utility::TimeValue next_epoch_;
+
+  /// the period between executions
+  utility::Duration frequency_;
+
+  /// true if the thread runs once
+  bool one_shot_ = true;
+
+  /// true if the thread runs at infinite hertz
+  bool blaster_ = false;
+
+  /// minimum duration of all runs, kept locally to avoid reading control
+  int64_t min_run_duration_ = -1;
+
+  /// maximum duration of all runs, kept locally to avoid reading control
+  int64_t max_run_duration_ = 0;
+
+  /// reference to the terminated flag in control
+  knowledge::VariableReference terminated_;
+
+  /// reference to the paused flag in control
+  knowledge::VariableReference paused_;
+
+  /**
+   * Control flags read by the task loop without locking the control
+   * plane. The Threader writes through to these and the control plane.
+   * Writes made only to the control plane are picked up by sync_control.
+   **/
+  std::atomic<bool> terminate_requested_{false};
+
+  /// cached paused flag
+  std::atomic<bool> pause_requested_{false};
+
+  /// cached requested hertz rate
+  std::atomic<double> hertz_requested_{-1};
+
+  /// cached debug flag
+  std::atomic<bool> debug_requested_{false};
+
+  /// the last time sync_control read the control plane
+  utility::TimeValue last_sync_;
+
+  /// executions since start, published by sync_control
+  int64_t execution_count_ = 0;
+
+  /// timestamp of the last run start, published by sync_control
+  int64_t last_run_start_ = 0;
+
+  /// timestamp of the last run end, published by sync_control
+  int64_t last_run_end_ = 0;
+
+  /// duration of the last run, published by sync_control
+  int64_t last_run_duration_ = 0;
+
+  /// true if debug information changed since the last publish
+  bool run_stats_changed_ = false;
+
+  /// run durations in nanoseconds, recorded while debugging
+  utility::LatencyHistogram run_histogram_;
+
+  /// nanoseconds between scheduled and actual starts of periodic runs
+  utility::LatencyHistogram lateness_histogram_;
+
+  /// periodic runs that ended after the next scheduled start
+  std::atomic<uint64_t> deadline_miss_count_{0};
+
+  /// affinity and scheduling applied when the thread starts
+  ThreadSettings settings_;
+
+  /// executions of all threads of the data plane
+  utility::Metrics::Counter* executions_metric_ = nullptr;
+
+  /// started threads of the data plane that have not finished
+  utility::Metrics::Gauge* running_metric_ = nullptr;
+
+  /// if set, the thread runs on matching changes instead of at a hertz
+  std::unique_ptr<ThreadTrigger> trigger_;
+
+#ifndef _MADARA_NO_KARL_
+  /// the compiled trigger condition
+  knowledge::CompiledExpression trigger_condition_;
+#endif
+
+  /// the pool executing this thread, if any
+  ThreadPool* pool_ = nullptr;
+
+  /// protects waits for triggers
+  std::mutex wake_mutex_;
+
+  /// signaled on triggers and control plane changes
+  std::condition_variable wake_;
+
+  /// the number of matching changes. Starts at 1 to run once after init.
+  std::atomic<uint64_t> triggers_{1};
+
+  /// the triggers count at the last execution
+  uint64_t handled_triggers_ = 0;
+
+  /// the triggers count at the last call to trigger_ready
+  uint64_t seen_triggers_ = 0;
+
+  /// time of the last matching change, in nanoseconds since clock epoch
+  std::atomic<int64_t> last_trigger_{0};
+
+  /// time of the last triggered execution
+  utility::TimeValue last_triggered_run_;
+
+  /// true if a control flag changed in the control plane
+  std::atomic<bool> control_changed_{false};
+
+  /// true if the thread is idle in pool mode and must be resubmitted
+  std::atomic<bool> parked_{false};
+
+  /// true if change listeners are registered
+  bool listening_ = false;
+
+  /// the data plane change listener id
+  uint64_t data_listener_ = 0;
+
+  /// the control plane change listener id
+  uint64_t control_listener_ = 0;
 };
 
 /**
@@ -732,3 +732,124 @@ bool madara::transport::exists(const char* originator, uint64_t clock,
 
   return result;
 }
+
+bool madara::transport::missing_fragments(const char* originator,
+    uint64_t clock, OriginatorFragmentMap& map, std::vector<uint32_t>& missing)
+{
+  missing.clear();
+
+  OriginatorFragmentMap::iterator orig_map = map.find(originator);
+
+  if (orig_map == map.end())
+  {
+    return false;
+  }
+
+  ClockFragmentMap::iterator clock_found = orig_map->second.find(clock);
+
+  if (clock_found == orig_map->second.end() ||
+      clock_found->second.size() == 0)
+  {
+    return false;
+  }
+
+  // every fragment carries the total number of fragments in the message
+  FragmentMap& fragments = clock_found->second;
+  uint32_t updates =
+      FragmentMessageHeader::get_updates(fragments.begin()->second);
+
+  for (uint32_t i = 0; i < updates; ++i)
+  {
+    if (fragments.find(i) == fragments.end())
+    {
+      missing.push_back(i);
+    }
+  }
+
+  return missing.size() > 0;
+}
+
+uint64_t madara::transport::write_fragment_nack(char* buffer,
+    int64_t buffer_remaining, const char* originator, uint64_t clock,
+    const std::vector<uint32_t>& missing)
+{
+  uint64_t size =
+      FRAGMENT_NACK_HEADER_SIZE + sizeof(uint32_t) * missing.size();
+
+  if (buffer_remaining < 0 || (uint64_t)buffer_remaining < size)
+  {
+    return 0;
+  }
+
+  *(uint64_t*)buffer = madara::utility::endian_swap(size);
+  buffer += sizeof(uint64_t);
+
+  strncpy(buffer, FRAGMENT_NACK_MADARA_ID, MADARA_IDENTIFIER_LENGTH);
+  buffer += MADARA_IDENTIFIER_LENGTH;
+
+  strncpy(buffer, originator, MAX_ORIGINATOR_LENGTH);
+  buffer += MAX_ORIGINATOR_LENGTH;
+
+  *(uint64_t*)buffer = madara::utility::endian_swap(clock);
+  buffer += sizeof(uint64_t);
+
+  *(uint32_t*)buffer = madara::utility::endian_swap((uint32_t)missing.size());
+  buffer += sizeof(uint32_t);
+
+  for (size_t i = 0; i < missing.size(); ++i)
+  {
+    *(uint32_t*)buffer = madara::utility::endian_swap(missing[i]);
+    buffer += sizeof(uint32_t);
+  }
+
+  return size;
+}
+
+bool madara::transport::read_fragment_nack(const char* buffer,
+    int64_t buffer_remaining, std::string& originator, uint64_t& clock,
+    std::vector<uint32_t>& missing)
+{
+  const int64_t fixed_size = FRAGMENT_NACK_HEADER_SIZE;
+
+  missing.clear();
+
+  if (buffer_remaining < fixed_size ||
+      !fragment_nack_test(buffer, (uint64_t)buffer_remaining))
+  {
+    return false;
+  }
+
+  buffer += sizeof(uint64_t) + MADARA_IDENTIFIER_LENGTH;
+
+  char name[MAX_ORIGINATOR_LENGTH + 1];
+  strncpy(name, buffer, MAX_ORIGINATOR_LENGTH);
+  name[MAX_ORIGINATOR_LENGTH] = 0;
+  originator = name;
+  buffer += MAX_ORIGINATOR_LENGTH;
+
+  memcpy(&clock, buffer, sizeof(clock));
+  clock = madara::utility::endian_swap(clock);
+  buffer += sizeof(clock);
+
+  uint32_t count;
+  memcpy(&count, buffer, sizeof(count));
+  count = madara::utility::endian_swap(count);
+  buffer += sizeof(count);
+
+  if ((uint64_t)(buffer_remaining - fixed_size) <
+      (uint64_t)count * sizeof(uint32_t))
+  {
+    return false;
+  }
+
+  missing.resize(count);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    memcpy(&missing[i], buffer, sizeof(uint32_t));
+    missing[i] = madara::utility::endian_swap(missing[i]);
+    buffer += sizeof(uint32_t);
+  }
+
+  return true;
+}
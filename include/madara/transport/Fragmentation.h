@@ -12,6 +12,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <string.h>
 #include "madara/utility/StdInt.h"
 #include "madara/MadaraExport.h"
@@ -22,6 +23,10 @@ namespace madara
 namespace transport
 {
 #define FRAGMENTATION_MADARA_ID "KFRG1.3"
+#define FRAGMENT_NACK_MADARA_ID "KNAK1.3"
+
+/// size of a fragment NACK before the list of missing fragments
+#define FRAGMENT_NACK_HEADER_SIZE 92
 
 /**
  * @class FragmentMessageHeader
@@ -198,6 +203,66 @@ MADARA_EXPORT bool is_complete(
  **/
 MADARA_EXPORT bool exists(const char* originator, uint64_t clock,
     uint32_t update_number, OriginatorFragmentMap& map);
+
+/**
+ * Lists the fragments of a partially received message that have not
+ * arrived yet
+ * @param originator   the originator of the message
+ * @param clock        the clock of the message
+ * @param map          a map of existing message fragments
+ * @param missing      fragment identifiers that have not been received
+ * @return   true if the clock entry exists and is incomplete
+ **/
+MADARA_EXPORT bool missing_fragments(const char* originator, uint64_t clock,
+    OriginatorFragmentMap& map, std::vector<uint32_t>& missing);
+
+/**
+ * Writes a negative acknowledgement that asks the sender of a fragmented
+ * message to resend specific fragments.
+ *
+ *        Format:
+ *
+ *        [0] [64 bit unsigned size]<br />
+ *        [8] [8 byte transport id] (prefixed with 'KNAK')<br />
+ *        [16] [64 byte originator of the fragmented message]<br />
+ *        [80] [64 bit unsigned Lamport clock of the message]<br />
+ *        [88] [32 bit unsigned number of missing fragments]<br />
+ *        [92] [32 bit unsigned missing fragment identifiers]
+ *
+ * @param buffer       the buffer to write to
+ * @param buffer_remaining  the bytes available in the buffer
+ * @param originator   the originator of the fragmented message
+ * @param clock        the clock of the fragmented message
+ * @param missing      the fragment identifiers to request
+ * @return   the size of the NACK, or 0 if it does not fit in the buffer
+ **/
+MADARA_EXPORT uint64_t write_fragment_nack(char* buffer,
+    int64_t buffer_remaining, const char* originator, uint64_t clock,
+    const std::vector<uint32_t>& missing);
+
+/**
+ * Reads a negative acknowledgement written by write_fragment_nack
+ * @param buffer       the buffer to read from
+ * @param buffer_remaining  the bytes available in the buffer
+ * @param originator   the originator of the fragmented message
+ * @param clock        the clock of the fragmented message
+ * @param missing      the requested fragment identifiers
+ * @return   true if the buffer contained a valid NACK
+ **/
+MADARA_EXPORT bool read_fragment_nack(const char* buffer,
+    int64_t buffer_remaining, std::string& originator, uint64_t& clock,
+    std::vector<uint32_t>& missing);
+
+/**
+ * Tests the buffer for a fragment NACK identifier
+ * @param buffer       the buffer to test
+ * @param size         the number of bytes in the buffer
+ * @return   true if identifier indicates a fragment NACK
+ **/
+inline bool fragment_nack_test(const char* buffer, uint64_t size)
+{
+  return size >= 16 && strncmp(&(buffer[8]), FRAGMENT_NACK_MADARA_ID, 7) == 0;
+}
 }
 }
 
@@ -0,0 +1,166 @@
+#include "PrefixRoutes.h"
+
+#include <algorithm>
+
+namespace madara
+{
+namespace transport
+{
+namespace
+{
+bool starts_with(const std::string& key, const std::string& prefix)
+{
+  return key.compare(0, prefix.size(), prefix) == 0;
+}
+}
+
+const size_t PrefixRoutes::NO_PARENT;
+
+void PrefixRoutes::clear(void)
+{
+  routes_.clear();
+  routed_.clear();
+}
+
+void PrefixRoutes::add(
+    size_t transport, const std::vector<std::string>& prefixes)
+{
+  if (routed_.size() <= transport)
+  {
+    routed_.resize(transport + 1, false);
+  }
+
+  if (prefixes.empty())
+  {
+    return;
+  }
+
+  routed_[transport] = true;
+
+  for (const std::string& prefix : prefixes)
+  {
+    routes_.push_back(Route{prefix, NO_PARENT, Transports(1, transport)});
+  }
+}
+
+void PrefixRoutes::compile(void)
+{
+  std::sort(routes_.begin(), routes_.end(),
+      [](const Route& lhs, const Route& rhs) {
+        return lhs.prefix < rhs.prefix;
+      });
+
+  // merge the transports of repeated prefixes
+  std::vector<Route> merged;
+  merged.reserve(routes_.size());
+
+  for (Route& route : routes_)
+  {
+    if (!merged.empty() && merged.back().prefix == route.prefix)
+    {
+      merged.back().transports.insert(merged.back().transports.end(),
+          route.transports.begin(), route.transports.end());
+    }
+    else
+    {
+      merged.push_back(std::move(route));
+    }
+  }
+
+  routes_.swap(merged);
+
+  /**
+   * Every prefix that a route starts with sorts between it and the
+   * route, so the closest one is found by walking back from the
+   * previous route through its parents. Parents are compiled first,
+   * so each route inherits the transports of all its parents at once.
+   **/
+  for (size_t i = 0; i < routes_.size(); ++i)
+  {
+    Route& route = routes_[i];
+    size_t parent = i > 0 ? i - 1 : NO_PARENT;
+
+    while (parent != NO_PARENT &&
+           !starts_with(route.prefix, routes_[parent].prefix))
+    {
+      parent = routes_[parent].parent;
+    }
+
+    route.parent = parent;
+
+    if (parent != NO_PARENT)
+    {
+      route.transports.insert(route.transports.end(),
+          routes_[parent].transports.begin(),
+          routes_[parent].transports.end());
+    }
+
+    std::sort(route.transports.begin(), route.transports.end());
+    route.transports.erase(
+        std::unique(route.transports.begin(), route.transports.end()),
+        route.transports.end());
+  }
+}
+
+bool PrefixRoutes::empty(void) const
+{
+  return routes_.empty();
+}
+
+bool PrefixRoutes::is_routed(size_t transport) const
+{
+  return transport < routed_.size() && routed_[transport];
+}
+
+const PrefixRoutes::Transports* PrefixRoutes::match(
+    const std::string& key) const
+{
+  // the last route that sorts at or before the key
+  auto found = std::upper_bound(routes_.begin(), routes_.end(), key,
+      [](const std::string& lhs, const Route& rhs) {
+        return lhs < rhs.prefix;
+      });
+
+  size_t i = found == routes_.begin()
+                 ? NO_PARENT
+                 : (size_t)(found - routes_.begin()) - 1;
+
+  while (i != NO_PARENT)
+  {
+    if (starts_with(key, routes_[i].prefix))
+    {
+      return &routes_[i].transports;
+    }
+
+    i = routes_[i].parent;
+  }
+
+  return nullptr;
+}
+
+void PrefixRoutes::partition(const knowledge::KnowledgeMap& modifieds,
+    std::vector<knowledge::KnowledgeMap>& partitions) const
+{
+  partitions.resize(routed_.size());
+
+  for (auto& partition : partitions)
+  {
+    partition.clear();
+  }
+
+  for (const auto& modified : modifieds)
+  {
+    const Transports* transports = match(modified.first);
+
+    if (transports)
+    {
+      for (size_t transport : *transports)
+      {
+        partitions[transport].emplace_hint(
+            partitions[transport].end(), modified.first, modified.second);
+      }
+    }
+  }
+}
+}
+}
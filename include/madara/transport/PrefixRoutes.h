@@ -0,0 +1,108 @@
+#ifndef _MADARA_TRANSPORT_PREFIX_ROUTES_H_
+#define _MADARA_TRANSPORT_PREFIX_ROUTES_H_
+
+/**
+ * @file PrefixRoutes.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the PrefixRoutes class, which maps the names of
+ * modified variables to the transports that send them
+ **/
+
+#include <string>
+#include <vector>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class PrefixRoutes
+ * @brief Send prefixes of a knowledge base's transports, compiled into
+ *        a sorted table so each modified variable is routed with one
+ *        binary search. Transports without send prefixes are unrouted
+ *        and send every modified variable.
+ **/
+class MADARA_EXPORT PrefixRoutes
+{
+public:
+  /// indices of the transports that a route sends to
+  typedef std::vector<size_t> Transports;
+
+  /**
+   * Removes all routes
+   **/
+  void clear(void);
+
+  /**
+   * Adds the send prefixes of a transport. Call compile after adding
+   * the prefixes of every transport.
+   * @param  transport  the index of the transport
+   * @param  prefixes   the send prefixes of the transport
+   **/
+  void add(size_t transport, const std::vector<std::string>& prefixes);
+
+  /**
+   * Sorts the routes and resolves which transports each prefix, and the
+   * shorter prefixes it starts with, send to
+   **/
+  void compile(void);
+
+  /**
+   * Checks if any transport has send prefixes
+   * @return  true if all transports are unrouted
+   **/
+  bool empty(void) const;
+
+  /**
+   * Checks if a transport only sends variables matching its prefixes
+   * @param  transport  the index of the transport
+   * @return  true if the transport has send prefixes
+   **/
+  bool is_routed(size_t transport) const;
+
+  /**
+   * Finds the routed transports that send a variable
+   * @param  key   the name of the variable
+   * @return  the transports, or null if the variable matches no prefix
+   **/
+  const Transports* match(const std::string& key) const;
+
+  /**
+   * Splits modified variables between the routed transports in a single
+   * pass. Partitions of unrouted transports are left empty.
+   * @param  modifieds   the modified variables
+   * @param  partitions  the variables to send, indexed by transport
+   **/
+  void partition(const knowledge::KnowledgeMap& modifieds,
+      std::vector<knowledge::KnowledgeMap>& partitions) const;
+
+private:
+  /// index of a route without a shorter matching prefix
+  static const size_t NO_PARENT = (size_t)-1;
+
+  struct Route
+  {
+    /// the prefix of the variables sent on this route
+    std::string prefix;
+
+    /// the longest other prefix that this prefix starts with
+    size_t parent;
+
+    /// the transports that send this prefix or its parents
+    Transports transports;
+  };
+
+  /// the routes, sorted by prefix once compiled
+  std::vector<Route> routes_;
+
+  /// which transports have send prefixes, indexed by transport
+  std::vector<bool> routed_;
+};
+}
+}
+
+#endif  // _MADARA_TRANSPORT_PREFIX_ROUTES_H_
@@ -1,8 +1,11 @@
 #include "Transport.h"
 
 #include "madara/utility/Utility.h"
+#include "madara/utility/Tracer.h"
+#include "madara/utility/LockProfiler.h"
 #include "madara/expression/Interpreter.h"
 #include "madara/knowledge/ContextGuard.h"
+#include "madara/knowledge/ArrayDelta.h"
 
 #include <algorithm>
 
@@ -10,13 +13,33 @@ namespace madara
 {
 namespace transport
 {
+TransportMetrics::TransportMetrics(utility::Metrics& metrics)
+  : received_packets(metrics.counter(
+        "transport.received_packets", "Messages received by transports")),
+    received_bytes(metrics.counter(
+        "transport.received_bytes", "Bytes received by transports")),
+    rejected_packets(metrics.counter("transport.rejected_packets",
+        "Received messages that were dropped or rejected")),
+    received_updates(metrics.counter("transport.received_updates",
+        "Records applied from received messages")),
+    sends(metrics.counter("transport.sends", "Messages prepared for sending")),
+    sent_bytes(metrics.counter(
+        "transport.sent_bytes", "Bytes prepared for sending")),
+    failed_sends(metrics.counter(
+        "transport.failed_sends", "Sends that the network refused")),
+    modifieds_per_send(metrics.histogram("transport.modifieds_per_send",
+        "Modified records passed to each send"))
+{
+}
+
 Base::Base(const std::string& id, TransportSettings& new_settings,
     knowledge::ThreadSafeContext& context)
   : is_valid_(false),
     shutting_down_(false),
     id_(id),
     settings_(new_settings),
-    context_(context)
+    context_(context),
+    metrics_(context.get_metrics().bundle<TransportMetrics>())
 
 #ifndef _MADARA_NO_KARL_
     ,
@@ -98,6 +121,11 @@ int Base::setup(void)
         settings_.write_domain.c_str(), buffer.str().c_str());
   }
 
+  if(settings_.send_array_deltas)
+  {
+    context_.enable_array_deltas(settings_.array_delta_full_interval);
+  }
+
   return validate_transport();
 }
 
@@ -106,7 +134,15 @@ void Base::close(void)
   invalidate_transport();
 }
 
-int process_received_update(const char* buffer, uint32_t bytes_read,
+bool Base::schedules_datagrams(void) const
+{
+  return false;
+}
+
+/**
+ * Implements process_received_update, which adds metrics
+ **/
+static int receive_update(const char* buffer, uint32_t bytes_read,
     const std::string& id, knowledge::ThreadSafeContext& context,
     const QoSTransportSettings& settings, BandwidthMonitor& send_monitor,
     BandwidthMonitor& receive_monitor,
@@ -117,6 +153,7 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
 
     const char* print_prefix, const char* remote_host, MessageHeader*& header)
 {
+
   // reset header to 0, so it is safe to delete
   header = 0;
 
@@ -139,8 +176,11 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
       print_prefix, bytes_read);
 
   // call decodes, if applicable
-  bytes_read = (uint32_t)settings.filter_decode(
-      (char*)buffer, max_buffer_size, max_buffer_size);
+  {
+    MADARA_TRACE_SPAN("filter_decode");
+    bytes_read = (uint32_t)settings.filter_decode(
+        (char*)buffer, max_buffer_size, max_buffer_size);
+  }
 
   madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
       "%s:"
@@ -491,11 +531,47 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     }
   };
 
+  // deltas are applied to the local arrays in place, unless receive
+  // filters need to see the whole arrays
+  bool filter_deltas = settings.get_number_of_receive_filtered_types() > 0 ||
+                       settings.get_number_of_receive_aggregate_filters() > 0;
+  std::map<std::string, knowledge::ArrayDelta> deltas;
+
   // iterate over the updates
   for(uint32_t i = 0; i < header->updates; ++i)
   {
     // read converts everything into host format from the update stream
-    update = record.read(update, key, buffer_remaining);
+    if(knowledge::ArrayDelta::is_delta(update, buffer_remaining))
+    {
+      MADARA_TRACE_SPAN("record_decode");
+
+      knowledge::ArrayDelta delta;
+      update = delta.read(update, key, buffer_remaining);
+
+      if(buffer_remaining >= 0 && !filter_deltas)
+      {
+        // changed in place once the context is locked below
+        deltas[key] = std::move(delta);
+        continue;
+      }
+
+      // receive filters see the whole array, so patch a copy
+      if(buffer_remaining >= 0 &&
+          !context.copy_array_delta(key, delta, record))
+      {
+        madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " dropping delta of %s. Local array differs from its base.\n",
+            print_prefix, key.c_str());
+
+        continue;
+      }
+    }
+    else
+    {
+      MADARA_TRACE_SPAN("record_decode");
+      update = record.read(update, key, buffer_remaining);
+    }
 
     if(buffer_remaining < 0)
     {
@@ -516,7 +592,10 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
           print_prefix, key.c_str(), record.clock, record.quality,
           record.to_string().c_str());
 
-      record = settings.filter_receive(record, key, transport_context);
+      {
+        MADARA_TRACE_SPAN("filter_receive");
+        record = settings.filter_receive(record, key, transport_context);
+      }
 
       if(record.exists())
       {
@@ -570,6 +649,7 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         " Applying aggregate receive filters.\n",
         print_prefix);
 
+    MADARA_TRACE_SPAN("filter_receive_aggregate");
     settings.filter_receive(updates, transport_context);
   }
   else
@@ -586,6 +666,8 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
       print_prefix);
 
   {
+    // includes waiting for the context lock
+    MADARA_TRACE_SPAN("context_apply");
     knowledge::ContextGuard guard(context);
 
     madara_logger_log(context.get_logger(), logger::LOG_MINOR,
@@ -600,12 +682,21 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     {
       const auto apply = [&](knowledge::KnowledgeRecord& record) {
         int result = 0;
+        uint64_t sent_toi = record.toi();
 
         record.set_toi(now);
         result = record.apply(
             context, i->first, header->quality, header->clock, false);
         ++actual_updates;
 
+        // later deltas of the array are made from the sender's toi
+        if(result == 1 && !record.has_history() &&
+            (record.type() == knowledge::KnowledgeRecord::INTEGER_ARRAY ||
+                record.type() == knowledge::KnowledgeRecord::DOUBLE_ARRAY))
+        {
+          context.set_array_delta_base(i->first, sent_toi);
+        }
+
         if(result != 1)
         {
           madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
@@ -636,6 +727,32 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
 
       apply(i->second);
     }
+
+    for(const auto& delta : deltas)
+    {
+      int result = context.apply_array_delta(delta.first, delta.second,
+          header->quality, header->clock, now);
+      ++actual_updates;
+
+      if(result == 1)
+      {
+        madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " delta of %s was applied in place\n",
+            print_prefix, delta.first.c_str());
+
+        // rebroadcasts share the patched array instead of copying it
+        updates[delta.first] = context.get(delta.first);
+      }
+      else
+      {
+        madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " delta of %s was rejected (%d). Local array differs from its"
+            " base or is newer.\n",
+            print_prefix, delta.first.c_str(), result);
+      }
+    }
   }
 
   context.set_changed();
@@ -740,6 +857,48 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
   return actual_updates;
 }
 
+int process_received_update(const char* buffer, uint32_t bytes_read,
+    const std::string& id, knowledge::ThreadSafeContext& context,
+    const QoSTransportSettings& settings, BandwidthMonitor& send_monitor,
+    BandwidthMonitor& receive_monitor,
+    knowledge::KnowledgeMap& rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+    knowledge::CompiledExpression& on_data_received,
+#endif  // _MADARA_NO_KARL_
+
+    const char* print_prefix, const char* remote_host, MessageHeader*& header,
+    TransportMetrics* transport_metrics)
+{
+  MADARA_TRACE_SPAN("process_received_update");
+  MADARA_LOCK_CATEGORY(TRANSPORT_APPLY);
+
+  // transports pass their cached bundle to skip the registry lookup
+  TransportMetrics& metrics =
+      transport_metrics ? *transport_metrics
+                        : context.get_metrics().bundle<TransportMetrics>();
+
+  metrics.received_packets.add();
+  metrics.received_bytes.add(bytes_read);
+
+  int result = receive_update(buffer, bytes_read, id, context, settings,
+      send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, remote_host, header);
+
+  if (result < 0)
+  {
+    metrics.rejected_packets.add();
+  }
+  else
+  {
+    metrics.received_updates.add(result);
+  }
+
+  return result;
+}
+
 int prep_rebroadcast(knowledge::ThreadSafeContext& context, char* buffer,
     int64_t& buffer_remaining, const QoSTransportSettings& settings,
     const char* print_prefix, MessageHeader* header,
@@ -812,6 +971,15 @@ int prep_rebroadcast(knowledge::ThreadSafeContext& context, char* buffer,
 long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     const char* print_prefix)
 {
+  return prep_send(orig_updates, print_prefix, buffer_.get_ptr(),
+      (int64_t)settings_.queue_length);
+}
+
+long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
+    const char* print_prefix, char* buffer, int64_t buffer_size)
+{
+  MADARA_TRACE_SPAN("prep_send");
+
   // check to see if we are shutting down
   long ret = this->check_transport();
   if(-1 == ret)
@@ -829,6 +997,8 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     return ret;
   }
 
+  metrics_.modifieds_per_send.record((int64_t)orig_updates.size());
+
   // get the maximum quality from the updates
   uint32_t quality = knowledge::max_quality(orig_updates);
   uint64_t latest_toi = 0;
@@ -868,7 +1038,8 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
         print_prefix);
   }
 
-  if(!dropped && packet_scheduler_.add())
+  // transports that drop each datagram themselves are not dropped here
+  if(!dropped && (schedules_datagrams() || packet_scheduler_.add()))
   {
     if(settings_.get_number_of_send_filtered_types() > 0)
     {
@@ -876,14 +1047,14 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
        * filter the updates according to the filters specified by
        * the user in QoSTransportSettings (if applicable)
        **/
-      for(auto e : orig_updates)
+      for(const auto& e : orig_updates)
       {
         madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
             "%s:"
             " Calling filter chain of %s.\n",
             print_prefix, e.first.c_str());
 
-        const auto record = e.second;
+        const auto& record = e.second;
 
         if(record.toi() > latest_toi)
         {
@@ -938,9 +1109,9 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     }
     else
     {
-      for(auto e : orig_updates)
+      for(const auto& e : orig_updates)
       {
-        const auto record = e.second;
+        const auto& record = e.second;
 
         if(record.toi() > latest_toi)
         {
@@ -1019,16 +1190,14 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     return 0;
   }
 
-  // allocate a buffer to send
-  char* buffer = buffer_.get_ptr();
-  int64_t buffer_remaining = settings_.queue_length;
+  int64_t buffer_remaining = buffer_size;
 
   if(buffer == 0)
   {
     madara_logger_log(context_.get_logger(), logger::LOG_EMERGENCY,
         "%s:"
-        " Unable to allocate buffer of size " PRIu32 ". Exiting thread.\n",
-        print_prefix, settings_.queue_length);
+        " Unable to allocate buffer of size %" PRId64 ". Exiting thread.\n",
+        print_prefix, buffer_size);
 
     return -3;
   }
@@ -1154,7 +1323,25 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
       }
     };
 
-    if(!settings_.send_history || !rec.has_history())
+    knowledge::ArrayDelta delta;
+
+    if(settings_.send_array_deltas && rec.is_array_type() &&
+        context_.get_array_delta(key, rec, delta))
+    {
+      update = delta.write(update, key, rec, buffer_remaining);
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+          "%s:"
+          " update[%d] => encoding %" PRIu32 " changed elements of %s"
+          " @%" PRIu64 "\n",
+          print_prefix, j,
+          (uint32_t)knowledge::ArrayDelta::count(delta.ranges), key.c_str(),
+          delta.toi);
+
+      ++actual_updates;
+      ++j;
+    }
+    else if(!settings_.send_history || !rec.has_history())
     {
       do_write(rec);
     }
@@ -1182,7 +1369,7 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
 
   if(buffer_remaining > 0)
   {
-    size = (long)(settings_.queue_length - buffer_remaining);
+    size = (long)(buffer_size - buffer_remaining);
     header->size = size;
     *message_size = utility::endian_swap((uint64_t)size);
     header->updates = actual_updates;
@@ -1222,8 +1409,7 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
       print_prefix);
 
   // buffer is ready encoding
-  size = (long)settings_.filter_encode(
-      buffer_.get_ptr(), (int)size, max_buffer_size);
+  size = (long)settings_.filter_encode(buffer, (int)size, max_buffer_size);
 
   madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
       "%s:"
@@ -1234,6 +1420,12 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
 
   last_toi_sent_ = latest_toi;
 
+  if (size > 0)
+  {
+    metrics_.sends.add();
+    metrics_.sent_bytes.add(size);
+  }
+
   return size;
 }
 }
@@ -19,6 +19,7 @@
 #include <ostream>
 
 #include "madara/utility/ThreadSafeVector.h"
+#include "madara/utility/Metrics.h"
 #include "madara/MadaraExport.h"
 #include "madara/transport/QoSTransportSettings.h"
 
@@ -35,6 +36,43 @@ namespace madara
 {
 namespace transport
 {
+/**
+ * Metrics shared by the transports of a knowledge base. Obtain with
+ * utility::Metrics::bundle so each metric is looked up only once.
+ **/
+struct MADARA_EXPORT TransportMetrics
+{
+  /**
+   * Constructor
+   * @param  metrics   the registry to look up metrics in
+   **/
+  explicit TransportMetrics(utility::Metrics& metrics);
+
+  /// messages passed to process_received_update
+  utility::Metrics::Counter& received_packets;
+
+  /// bytes passed to process_received_update
+  utility::Metrics::Counter& received_bytes;
+
+  /// received messages that were rejected
+  utility::Metrics::Counter& rejected_packets;
+
+  /// records applied from received messages
+  utility::Metrics::Counter& received_updates;
+
+  /// messages prepared for sending
+  utility::Metrics::Counter& sends;
+
+  /// bytes prepared for sending
+  utility::Metrics::Counter& sent_bytes;
+
+  /// sends that the network refused
+  utility::Metrics::Counter& failed_sends;
+
+  /// modified records passed to each send
+  utility::Metrics::Histogram& modifieds_per_send;
+};
+
 /**
  * Base class from which all transports must be derived.
  * To support knowledge updates, only the send_multiassignment method
@@ -99,6 +137,23 @@ public:
   long prep_send(const knowledge::KnowledgeMap& orig_updates,
       const char* print_prefix);
 
+  /**
+   * Preps a message for sending into a caller-provided buffer, e.g.,
+   * a buffer that will be handed to a zero-copy send
+   * @param  orig_updates     updates before send filtering is applied
+   * @param  print_prefix     prefix to include before every log message,
+   *                          e.g., "MyTransport::svc"
+   * @param  buffer           buffer to encode the message into
+   * @param  buffer_size      size of the buffer in bytes
+   * @return       -1   Transport is shutting down<br />
+   *               -2   Transport is invalid<br />
+   *               -3   Unable to allocate send buffer<br />
+   *                0   No message to send
+   *               > 0  size of buffered message
+   **/
+  long prep_send(const knowledge::KnowledgeMap& orig_updates,
+      const char* print_prefix, char* buffer, int64_t buffer_size);
+
   /**
    * Sends a list of updates to the domain. This function must be
    * implemented by your transport
@@ -122,6 +177,13 @@ public:
   virtual void close(void);
 
 protected:
+  /**
+   * Checks if this transport applies the packet scheduler to each
+   * datagram it sends, in which case prep_send does not drop messages
+   * @return  true if drops are applied per datagram
+   **/
+  virtual bool schedules_datagrams(void) const;
+
   volatile bool is_valid_;
   volatile bool shutting_down_;
   HostsVector hosts;
@@ -134,6 +196,9 @@ protected:
   // context for knowledge base
   madara::knowledge::ThreadSafeContext& context_;
 
+  /// metrics shared with the other transports of the context
+  TransportMetrics& metrics_;
+
 #ifndef _MADARA_NO_KARL_
   /// data received rules, defined in Transport settings
   madara::expression::ExpressionTree on_data_received_;
@@ -180,6 +245,9 @@ protected:
  * @param  header           will contain the message header object from the
  *                          message received (you have to clean this up
  *                          delete--e.g., "delete header").
+ * @param  metrics          the transport metrics of the context, e.g., a
+ *                          transport's cached bundle. If null, the bundle
+ *                          is looked up in the context on each call.
  * @return       -1   Rejected: Non-MADARA Message<br />
  *               -2   Rejected: Message from Self<br />
  *               -3   Rejected: Untrusted Peer<br />
@@ -197,7 +265,8 @@ int MADARA_EXPORT process_received_update(const char* buffer,
     knowledge::CompiledExpression& on_data_received,
 #endif  // _MADARA_NO_KARL_
 
-    const char* print_prefix, const char* remote_host, MessageHeader*& header);
+    const char* print_prefix, const char* remote_host, MessageHeader*& header,
+    TransportMetrics* metrics = nullptr);
 
 /**
  * Preps a buffer for rebroadcasting records to other agents
@@ -27,7 +27,7 @@ std::string madara::transport::types_to_string(int id)
   }
   if (TCP == id)
   {
-    return "TCP (unsupported)";
+    return "TCP";
   }
   if (MULTICAST == id)
   {
@@ -49,6 +49,10 @@ std::string madara::transport::types_to_string(int id)
   {
     return "0MQ";
   }
+  if (SHMEM == id)
+  {
+    return "Shared Memory";
+  }
 
   // otherwise, it's a custom transport
   return "Custom";
@@ -64,6 +68,11 @@ madara::transport::TransportSettings::TransportSettings(
     resend_attempts(settings.resend_attempts),
     fragment_queue_length(settings.fragment_queue_length),
     reliability(settings.reliability),
+    reliable_fragments(settings.reliable_fragments),
+    fragment_nack_interval(settings.fragment_nack_interval),
+    send_array_deltas(settings.send_array_deltas),
+    array_delta_full_interval(settings.array_delta_full_interval),
+    zero_copy_receive(settings.zero_copy_receive),
     id(settings.id),
     processes(settings.processes),
     on_data_received_logic(settings.on_data_received_logic),
@@ -77,6 +86,14 @@ madara::transport::TransportSettings::TransportSettings(
     no_sending(settings.no_sending),
     no_receiving(settings.no_receiving),
     send_history(settings.send_history),
+    tcp_nodelay(settings.tcp_nodelay),
+    tcp_cork(settings.tcp_cork),
+    zmq_topics(settings.zmq_topics),
+    send_prefixes(settings.send_prefixes),
+    read_thread_cores(settings.read_thread_cores),
+    read_thread_policy(settings.read_thread_policy),
+    read_thread_priority(settings.read_thread_priority),
+    lock_memory(settings.lock_memory),
     debug_to_kb_prefix(settings.debug_to_kb_prefix),
     read_domains_(settings.read_domains_)
 {
@@ -97,6 +114,11 @@ void madara::transport::TransportSettings::operator=(
   resend_attempts = settings.resend_attempts;
   fragment_queue_length = settings.fragment_queue_length;
   reliability = settings.reliability;
+  reliable_fragments = settings.reliable_fragments;
+  fragment_nack_interval = settings.fragment_nack_interval;
+  send_array_deltas = settings.send_array_deltas;
+  array_delta_full_interval = settings.array_delta_full_interval;
+  zero_copy_receive = settings.zero_copy_receive;
   id = settings.id;
   processes = settings.processes;
 
@@ -118,6 +140,16 @@ void madara::transport::TransportSettings::operator=(
 
   send_history = settings.send_history;
 
+  tcp_nodelay = settings.tcp_nodelay;
+  tcp_cork = settings.tcp_cork;
+  zmq_topics = settings.zmq_topics;
+  send_prefixes = settings.send_prefixes;
+
+  read_thread_cores = settings.read_thread_cores;
+  read_thread_policy = settings.read_thread_policy;
+  read_thread_priority = settings.read_thread_priority;
+  lock_memory = settings.lock_memory;
+
   debug_to_kb_prefix = settings.debug_to_kb_prefix;
 }
 
@@ -151,6 +183,22 @@ void madara::transport::TransportSettings::load(
   fragment_queue_length =
       (uint32_t)knowledge.get(prefix + ".fragment_queue_length").to_integer();
   reliability = (uint32_t)knowledge.get(prefix + ".reliability").to_integer();
+  reliable_fragments =
+      knowledge.get(prefix + ".reliable_fragments").is_true();
+  // older configs without fragment_nack_interval keep the default
+  if (knowledge.exists(prefix + ".fragment_nack_interval"))
+  {
+    fragment_nack_interval =
+        knowledge.get(prefix + ".fragment_nack_interval").to_double();
+  }
+  send_array_deltas = knowledge.get(prefix + ".send_array_deltas").is_true();
+  // older configs without array_delta_full_interval keep the default
+  if (knowledge.exists(prefix + ".array_delta_full_interval"))
+  {
+    array_delta_full_interval = (uint32_t)knowledge
+        .get(prefix + ".array_delta_full_interval").to_integer();
+  }
+  zero_copy_receive = knowledge.get(prefix + ".zero_copy_receive").is_true();
   id = (uint32_t)knowledge.get(prefix + ".id").to_integer();
   processes = (uint32_t)knowledge.get(prefix + ".processes").to_integer();
 
@@ -183,6 +231,35 @@ void madara::transport::TransportSettings::load(
 
   no_sending = knowledge.get(prefix + ".no_sending").is_true();
   no_receiving = knowledge.get(prefix + ".no_receiving").is_true();
+  // tcp_nodelay defaults to true, so older configs without it keep that
+  if (knowledge.exists(prefix + ".tcp_nodelay"))
+  {
+    tcp_nodelay = knowledge.get(prefix + ".tcp_nodelay").is_true();
+  }
+  tcp_cork = knowledge.get(prefix + ".tcp_cork").is_true();
+
+  containers::StringVector kb_zmq_topics(prefix + ".zmq_topics", knowledge);
+
+  zmq_topics.resize(kb_zmq_topics.size());
+  for (unsigned int i = 0; i < zmq_topics.size(); ++i)
+    zmq_topics[i] = kb_zmq_topics[i];
+
+  containers::StringVector kb_send_prefixes(
+      prefix + ".send_prefixes", knowledge);
+
+  send_prefixes.resize(kb_send_prefixes.size());
+  for (unsigned int i = 0; i < send_prefixes.size(); ++i)
+    send_prefixes[i] = kb_send_prefixes[i];
+
+  std::vector<Integer> kb_cores =
+      knowledge.get(prefix + ".read_thread_cores").to_integers();
+  read_thread_cores.assign(kb_cores.begin(), kb_cores.end());
+  read_thread_policy =
+      (int)knowledge.get(prefix + ".read_thread_policy").to_integer();
+  read_thread_priority =
+      (int)knowledge.get(prefix + ".read_thread_priority").to_integer();
+  lock_memory = knowledge.get(prefix + ".lock_memory").is_true();
+
   debug_to_kb_prefix =
       knowledge.get(prefix + ".debug_to_kb_prefix").to_string();
 }
@@ -204,6 +281,22 @@ void madara::transport::TransportSettings::load_text(
   fragment_queue_length =
       (uint32_t)knowledge.get(prefix + ".fragment_queue_length").to_integer();
   reliability = (uint32_t)knowledge.get(prefix + ".reliability").to_integer();
+  reliable_fragments =
+      knowledge.get(prefix + ".reliable_fragments").is_true();
+  // older configs without fragment_nack_interval keep the default
+  if (knowledge.exists(prefix + ".fragment_nack_interval"))
+  {
+    fragment_nack_interval =
+        knowledge.get(prefix + ".fragment_nack_interval").to_double();
+  }
+  send_array_deltas = knowledge.get(prefix + ".send_array_deltas").is_true();
+  // older configs without array_delta_full_interval keep the default
+  if (knowledge.exists(prefix + ".array_delta_full_interval"))
+  {
+    array_delta_full_interval = (uint32_t)knowledge
+        .get(prefix + ".array_delta_full_interval").to_integer();
+  }
+  zero_copy_receive = knowledge.get(prefix + ".zero_copy_receive").is_true();
   id = (uint32_t)knowledge.get(prefix + ".id").to_integer();
   processes = (uint32_t)knowledge.get(prefix + ".processes").to_integer();
 
@@ -236,6 +329,35 @@ void madara::transport::TransportSettings::load_text(
 
   no_sending = knowledge.get(prefix + ".no_sending").is_true();
   no_receiving = knowledge.get(prefix + ".no_receiving").is_true();
+  // tcp_nodelay defaults to true, so older configs without it keep that
+  if (knowledge.exists(prefix + ".tcp_nodelay"))
+  {
+    tcp_nodelay = knowledge.get(prefix + ".tcp_nodelay").is_true();
+  }
+  tcp_cork = knowledge.get(prefix + ".tcp_cork").is_true();
+
+  containers::StringVector kb_zmq_topics(prefix + ".zmq_topics", knowledge);
+
+  zmq_topics.resize(kb_zmq_topics.size());
+  for (unsigned int i = 0; i < zmq_topics.size(); ++i)
+    zmq_topics[i] = kb_zmq_topics[i];
+
+  containers::StringVector kb_send_prefixes(
+      prefix + ".send_prefixes", knowledge);
+
+  send_prefixes.resize(kb_send_prefixes.size());
+  for (unsigned int i = 0; i < send_prefixes.size(); ++i)
+    send_prefixes[i] = kb_send_prefixes[i];
+
+  std::vector<Integer> kb_cores =
+      knowledge.get(prefix + ".read_thread_cores").to_integers();
+  read_thread_cores.assign(kb_cores.begin(), kb_cores.end());
+  read_thread_policy =
+      (int)knowledge.get(prefix + ".read_thread_policy").to_integer();
+  read_thread_priority =
+      (int)knowledge.get(prefix + ".read_thread_priority").to_integer();
+  lock_memory = knowledge.get(prefix + ".lock_memory").is_true();
+
   debug_to_kb_prefix =
       knowledge.get(prefix + ".debug_to_kb_prefix").to_string();
 }
@@ -260,6 +382,12 @@ void madara::transport::TransportSettings::save(
   knowledge.set(
       prefix + ".fragment_queue_length", Integer(fragment_queue_length));
   knowledge.set(prefix + ".reliability", Integer(reliability));
+  knowledge.set(prefix + ".reliable_fragments", Integer(reliable_fragments));
+  knowledge.set(prefix + ".fragment_nack_interval", fragment_nack_interval);
+  knowledge.set(prefix + ".send_array_deltas", Integer(send_array_deltas));
+  knowledge.set(prefix + ".array_delta_full_interval",
+      Integer(array_delta_full_interval));
+  knowledge.set(prefix + ".zero_copy_receive", Integer(zero_copy_receive));
   knowledge.set(prefix + ".id", Integer(id));
   knowledge.set(prefix + ".processes", Integer(processes));
 
@@ -278,6 +406,26 @@ void madara::transport::TransportSettings::save(
 
   knowledge.set(prefix + ".no_sending", Integer(no_sending));
   knowledge.set(prefix + ".no_receiving", Integer(no_receiving));
+  knowledge.set(prefix + ".tcp_nodelay", Integer(tcp_nodelay));
+  knowledge.set(prefix + ".tcp_cork", Integer(tcp_cork));
+
+  containers::StringVector kb_zmq_topics(
+      prefix + ".zmq_topics", knowledge, (int)zmq_topics.size());
+  for (size_t i = 0; i < zmq_topics.size(); ++i)
+    kb_zmq_topics.set(i, zmq_topics[i]);
+
+  containers::StringVector kb_send_prefixes(
+      prefix + ".send_prefixes", knowledge, (int)send_prefixes.size());
+  for (size_t i = 0; i < send_prefixes.size(); ++i)
+    kb_send_prefixes.set(i, send_prefixes[i]);
+
+  knowledge.set(prefix + ".read_thread_cores",
+      std::vector<Integer>(read_thread_cores.begin(), read_thread_cores.end()));
+  knowledge.set(prefix + ".read_thread_policy", Integer(read_thread_policy));
+  knowledge.set(
+      prefix + ".read_thread_priority", Integer(read_thread_priority));
+  knowledge.set(prefix + ".lock_memory", Integer(lock_memory));
+
   knowledge.set(prefix + ".debug_to_kb_prefix", debug_to_kb_prefix);
 
   knowledge::containers::Map kb_read_domains(
@@ -312,6 +460,12 @@ void madara::transport::TransportSettings::save_text(
   knowledge.set(
       prefix + ".fragment_queue_length", Integer(fragment_queue_length));
   knowledge.set(prefix + ".reliability", Integer(reliability));
+  knowledge.set(prefix + ".reliable_fragments", Integer(reliable_fragments));
+  knowledge.set(prefix + ".fragment_nack_interval", fragment_nack_interval);
+  knowledge.set(prefix + ".send_array_deltas", Integer(send_array_deltas));
+  knowledge.set(prefix + ".array_delta_full_interval",
+      Integer(array_delta_full_interval));
+  knowledge.set(prefix + ".zero_copy_receive", Integer(zero_copy_receive));
   knowledge.set(prefix + ".id", Integer(id));
   knowledge.set(prefix + ".processes", Integer(processes));
 
@@ -330,6 +484,26 @@ void madara::transport::TransportSettings::save_text(
 
   knowledge.set(prefix + ".no_sending", Integer(no_sending));
   knowledge.set(prefix + ".no_receiving", Integer(no_receiving));
+  knowledge.set(prefix + ".tcp_nodelay", Integer(tcp_nodelay));
+  knowledge.set(prefix + ".tcp_cork", Integer(tcp_cork));
+
+  containers::StringVector kb_zmq_topics(
+      prefix + ".zmq_topics", knowledge, (int)zmq_topics.size());
+  for (size_t i = 0; i < zmq_topics.size(); ++i)
+    kb_zmq_topics.set(i, zmq_topics[i]);
+
+  containers::StringVector kb_send_prefixes(
+      prefix + ".send_prefixes", knowledge, (int)send_prefixes.size());
+  for (size_t i = 0; i < send_prefixes.size(); ++i)
+    kb_send_prefixes.set(i, send_prefixes[i]);
+
+  knowledge.set(prefix + ".read_thread_cores",
+      std::vector<Integer>(read_thread_cores.begin(), read_thread_cores.end()));
+  knowledge.set(prefix + ".read_thread_policy", Integer(read_thread_policy));
+  knowledge.set(
+      prefix + ".read_thread_priority", Integer(read_thread_priority));
+  knowledge.set(prefix + ".lock_memory", Integer(lock_memory));
+
   knowledge.set(prefix + ".debug_to_kb_prefix", debug_to_kb_prefix);
 
   knowledge::containers::Map kb_read_domains(
@@ -26,6 +26,7 @@
 #include "madara/expression/Interpreter.h"
 #include "madara/MadaraExport.h"
 #include "madara/transport/Fragmentation.h"
+#include "madara/threads/ThreadSettings.h"
 
 namespace madara
 {
@@ -45,7 +46,8 @@ enum Types
   BROADCAST = 6,
   REGISTRY_SERVER = 7,
   REGISTRY_CLIENT = 8,
-  ZMQ = 9
+  ZMQ = 9,
+  SHMEM = 10
 };
 
 enum Reliabilities
@@ -241,6 +243,54 @@ public:
   /// See madara::transport::Reliabilities for options
   uint32_t reliability = DEFAULT_RELIABILITY;
 
+  /**
+   * If true, UDP-based transports keep the fragments of the last
+   * fragment_queue_length fragmented messages so that receivers can
+   * request missing fragments with a NACK instead of losing the whole
+   * message. NACKs and resent fragments go to the same hosts as updates
+   * and name the originator, which is the only peer that resends. When
+   * enabled, packet drop rates in QoSTransportSettings apply to each
+   * datagram of an update rather than to each message, and not to NACKs
+   * or resent fragments.
+   **/
+  bool reliable_fragments = false;
+
+  /**
+   * Seconds to wait without progress on an incomplete fragmented message
+   * before requesting its missing fragments again
+   **/
+  double fragment_nack_interval = 0.05;
+
+  /**
+   * If true, integer and double arrays that were changed only through
+   * set_index since they were last sent are sent as the changed elements
+   * instead of the whole array. Receivers apply a delta only if their
+   * copy of the array matches the one it was made from, and otherwise
+   * wait for the next full update. Receivers built before this setting
+   * existed reject messages with deltas.
+   **/
+  bool send_array_deltas = false;
+
+  /**
+   * Maximum number of consecutive deltas sent for an array before it is
+   * sent in full again, so receivers that missed an update recover.
+   * 0 never forces a full update.
+   **/
+  uint32_t array_delta_full_interval = 10;
+
+  /**
+   * If true, each message is received into a new buffer whenever records
+   * still reference the last one, and received Cap'n Proto values point
+   * into the buffer instead of copying it. Each buffer is queue_length
+   * bytes, and stays allocated while any record references it, so each
+   * zero-copy record kept alive, however small, holds on to a whole
+   * queue_length buffer. Keeping values from many messages, e.g., in
+   * histories, can hold many buffers; copy such values to release them.
+   * Only UDP, broadcast and multicast transports support this. Builds
+   * with the nothreadlocal feature always copy.
+   **/
+  bool zero_copy_receive = false;
+
   /// The id of this process (DEPRECATED). You do not need to set this
   uint32_t id = DEFAULT_ID;
 
@@ -305,6 +355,69 @@ public:
    **/
   bool send_history = false;
 
+  /**
+   * if true, disable Nagle's algorithm on TCP streams so small messages
+   * are written immediately
+   **/
+  bool tcp_nodelay = true;
+
+  /**
+   * if true, cork TCP streams while a batch of coalesced messages is
+   * written so the kernel emits full segments (Linux only)
+   **/
+  bool tcp_cork = false;
+
+  /**
+   * Topic prefixes for ZMQ transports. Publishers send each update in a
+   * topic frame named after the longest prefix matching its variable name
+   * (or an empty topic if none match), and subscribers only subscribe to
+   * these topics, so filtering happens at the publisher. If empty,
+   * messages are published without topic frames and subscribers receive
+   * everything. Publishers and subscribers must use the same list, since
+   * ZMQ matches subscriptions against topic frames, not variable names:
+   * a subscriber to agent.1 never receives updates published under
+   * agent.. Subscribers warn once for each topic missing from theirs,
+   * and publishers log variables that match no topic.
+   **/
+  std::vector<std::string> zmq_topics;
+
+  /**
+   * Prefixes of the variables this transport sends. Modified variables
+   * that match none of them are left out of this transport's sends, so
+   * agents can route, e.g., telemetry and commands over different
+   * transports. If empty, all modified variables are sent.
+   **/
+  std::vector<std::string> send_prefixes;
+
+  /**
+   * CPU cores that read threads may run on. If empty, read threads may
+   * run on any core.
+   **/
+  std::vector<int> read_thread_cores;
+
+  /**
+   * Scheduling policy of read threads, one of
+   * threads::ThreadSettings::SchedulingPolicy
+   **/
+  int read_thread_policy = threads::ThreadSettings::POLICY_DEFAULT;
+
+  /**
+   * Priority of read threads within a real-time read_thread_policy
+   **/
+  int read_thread_priority = 0;
+
+  /**
+   * if true, the first read thread to start locks all process memory
+   * with mlockall, so page faults cannot stall message handling
+   **/
+  bool lock_memory = false;
+
+  /**
+   * Returns the thread settings for read threads
+   * @return  the affinity, scheduling and memory locking of read threads
+   **/
+  threads::ThreadSettings read_thread_settings(void) const;
+
   /**
    * if not empty, save debug information to knowledge base at prefix
    **/
@@ -333,7 +446,7 @@ inline std::string type_name(const TransportSettings& settings)
       name = "RTI DDS";
       break;
     case 3:
-      name = "TCP (unsupported)";
+      name = "TCP";
       break;
     case 4:
       name = "UDP Unicast";
@@ -353,6 +466,9 @@ inline std::string type_name(const TransportSettings& settings)
     case 9:
       name = "ZeroMQ Pub/Sub";
       break;
+    case 10:
+      name = "Shared Memory";
+      break;
   }
 
   return name;
@@ -49,4 +49,15 @@ inline size_t madara::transport::TransportSettings::num_read_domains(void) const
   return read_domains_.size();
 }
 
+inline madara::threads::ThreadSettings
+madara::transport::TransportSettings::read_thread_settings(void) const
+{
+  threads::ThreadSettings result;
+  result.cores = read_thread_cores;
+  result.policy = read_thread_policy;
+  result.priority = read_thread_priority;
+  result.lock_memory = lock_memory;
+  return result;
+}
+
 #endif  // _MADARA_TRANSPORT_SETTINGS_INL_
@@ -0,0 +1,426 @@
+#include "madara/transport/shmem/SharedMemoryTransport.h"
+#include "madara/transport/shmem/SharedMemoryTransportReadThread.h"
+#include "madara/transport/TransportContext.h"
+
+#include "madara/transport/ReducedMessageHeader.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/IntTypes.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace madara
+{
+namespace transport
+{
+namespace
+{
+/// room reserved in the segment for the segment manager and named objects
+const uint64_t SEGMENT_OVERHEAD = 65536;
+
+/// attempts to attach before giving up on a segment that keeps being removed
+const int ATTACH_ATTEMPTS = 3;
+
+/// returns the id of this process
+int64_t process_id(void)
+{
+#ifdef _WIN32
+  return _getpid();
+#else
+  return (int64_t)getpid();
+#endif
+}
+
+/// returns false only if the process is known to have exited
+bool process_exists(int64_t pid)
+{
+#ifdef _WIN32
+  (void)pid;
+  return true;
+#else
+  return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+#endif
+}
+}
+
+SharedMemoryTransport::SharedMemoryTransport(const std::string& id,
+    knowledge::ThreadSafeContext& context, TransportSettings& config,
+    bool launch_transport)
+  : Base(id, config, context)
+{
+  // create a reference to the knowledge base for threading
+  knowledge_.use(context);
+
+  // set the data plane for the read threads
+  read_threads_.set_data_plane(knowledge_);
+
+  if (launch_transport)
+    setup();
+
+  if (config.debug_to_kb_prefix != "")
+  {
+    knowledge::KnowledgeBase kb;
+    kb.use(context);
+
+    sent_packets.set_name(config.debug_to_kb_prefix + ".sent_packets", kb);
+    failed_sends.set_name(config.debug_to_kb_prefix + ".failed_sends", kb);
+    sent_data_max.set_name(config.debug_to_kb_prefix + ".sent_data_max", kb);
+    sent_data_min.set_name(config.debug_to_kb_prefix + ".sent_data_min", kb);
+    sent_data.set_name(config.debug_to_kb_prefix + ".sent_data", kb);
+  }
+}
+
+SharedMemoryTransport::~SharedMemoryTransport()
+{
+  SharedMemoryTransport::close();
+}
+
+void SharedMemoryTransport::close(void)
+{
+  this->invalidate_transport();
+
+  read_threads_.terminate();
+
+  // wake up any read threads blocked on the ring so they see termination
+  if (ring_)
+  {
+    ring_->changed.notify_all();
+  }
+
+  read_threads_.wait();
+
+  if (ring_)
+  {
+    {
+      ipc::scoped_lock<ipc::interprocess_mutex> guard(ring_->mutex);
+
+      for (uint32_t i = 0; i < ring_->attached; ++i)
+      {
+        if (ring_->attached_pids[i] == pid_)
+        {
+          ring_->attached_pids[i] = ring_->attached_pids[--ring_->attached];
+          break;
+        }
+      }
+
+      // remove while holding the mutex so that no transport can attach
+      // between the last detach and the removal
+      if (ring_->attached == 0)
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+            "SharedMemoryTransport::close:"
+            " last transport detached. Removing segment %s\n",
+            segment_name_.c_str());
+
+        ring_->removed = true;
+        ipc::shared_memory_object::remove(segment_name_.c_str());
+      }
+    }
+
+    ring_ = nullptr;
+    data_ = nullptr;
+    segment_.reset();
+  }
+}
+
+void SharedMemoryTransport::prune_detached_unsafe(void)
+{
+  for (uint32_t i = 0; i < ring_->attached;)
+  {
+    if (!process_exists(ring_->attached_pids[i]))
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_WARNING,
+          "SharedMemoryTransport::prune_detached_unsafe:"
+          " process %" PRId64 " exited without detaching from segment %s\n",
+          ring_->attached_pids[i], segment_name_.c_str());
+
+      ring_->attached_pids[i] = ring_->attached_pids[--ring_->attached];
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+int SharedMemoryTransport::reliability(void) const
+{
+  return RELIABLE;
+}
+
+int SharedMemoryTransport::reliability(const int&)
+{
+  return RELIABLE;
+}
+
+const std::string& SharedMemoryTransport::segment_name(void) const
+{
+  return segment_name_;
+}
+
+int SharedMemoryTransport::setup(void)
+{
+  // call base setup method to initialize certain common variables
+  if (Base::setup() < 0)
+  {
+    return -1;
+  }
+
+  if (settings_.hosts.size() > 0 && settings_.hosts[0] != "")
+  {
+    segment_name_ = settings_.hosts[0];
+  }
+  else
+  {
+    segment_name_ = "madara_" + settings_.write_domain;
+  }
+
+  uint64_t capacity = settings_.queue_length;
+
+  if (capacity <= sizeof(uint32_t))
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_ERROR,
+        "SharedMemoryTransport::setup:"
+        " queue_length (%d) is too small for a shared memory ring\n",
+        (int)settings_.queue_length);
+
+    this->invalidate_transport();
+    return -1;
+  }
+
+  pid_ = process_id();
+
+  for (int attempt = 0; ring_ == nullptr; ++attempt)
+  {
+    if (attempt == ATTACH_ATTEMPTS)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_ERROR,
+          "SharedMemoryTransport::setup:"
+          " segment %s was removed on each of %d attempts to attach\n",
+          segment_name_.c_str(), ATTACH_ATTEMPTS);
+
+      this->invalidate_transport();
+      return -1;
+    }
+
+    try
+    {
+      segment_.reset(new ipc::managed_shared_memory(ipc::open_or_create,
+          segment_name_.c_str(), capacity + SEGMENT_OVERHEAD));
+
+      // the first process to attach decides the ring capacity
+      ring_ = segment_->find_or_construct<SharedMemoryRing>("ring")(capacity);
+      data_ = segment_->find_or_construct<char>("data")[ring_->capacity](0);
+    }
+    catch (const ipc::interprocess_exception& e)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_ERROR,
+          "SharedMemoryTransport::setup:"
+          " unable to attach to segment %s: %s\n",
+          segment_name_.c_str(), e.what());
+
+      ring_ = nullptr;
+      data_ = nullptr;
+      segment_.reset();
+
+      this->invalidate_transport();
+      return -1;
+    }
+
+    ipc::scoped_lock<ipc::interprocess_mutex> guard(ring_->mutex);
+
+    prune_detached_unsafe();
+
+    bool full = ring_->attached == SharedMemoryRing::MAX_ATTACHED;
+
+    if (ring_->removed || full)
+    {
+      guard.unlock();
+
+      ring_ = nullptr;
+      data_ = nullptr;
+      segment_.reset();
+
+      if (full)
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_ERROR,
+            "SharedMemoryTransport::setup:"
+            " segment %s already has %d transports attached\n",
+            segment_name_.c_str(), (int)SharedMemoryRing::MAX_ATTACHED);
+
+        this->invalidate_transport();
+        return -1;
+      }
+
+      // the last transport removed the segment after we opened it
+      continue;
+    }
+
+    ring_->attached_pids[ring_->attached++] = pid_;
+
+    // only deliver messages written after we attached
+    read_pos_ = ring_->write_pos;
+  }
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "SharedMemoryTransport::setup:"
+      " attached to segment %s with ring capacity %" PRIu64 " bytes\n",
+      segment_name_.c_str(), ring_->capacity);
+
+  if (!settings_.no_receiving)
+  {
+    double hertz = settings_.read_thread_hertz;
+    if (hertz < 0.0)
+    {
+      hertz = 0.0;
+    }
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "SharedMemoryTransport::setup:"
+        " starting %d threads at %f hertz\n",
+        settings_.read_threads, hertz);
+
+    read_threads_.set_thread_settings(settings_.read_thread_settings());
+
+    for (uint32_t i = 0; i < settings_.read_threads; ++i)
+    {
+      std::stringstream thread_name;
+      thread_name << "read";
+      thread_name << i;
+
+      read_threads_.run(hertz, thread_name.str(),
+          new SharedMemoryTransportReadThread(*this));
+    }
+  }
+
+  return this->validate_transport();
+}
+
+void SharedMemoryTransport::copy_in(
+    uint64_t pos, const void* source, size_t size)
+{
+  size_t offset = (size_t)(pos % ring_->capacity);
+  size_t first = std::min(size, (size_t)(ring_->capacity - offset));
+
+  memcpy(data_ + offset, source, first);
+
+  if (first < size)
+  {
+    memcpy(data_, (const char*)source + first, size - first);
+  }
+}
+
+void SharedMemoryTransport::copy_out(
+    uint64_t pos, void* dest, size_t size) const
+{
+  size_t offset = (size_t)(pos % ring_->capacity);
+  size_t first = std::min(size, (size_t)(ring_->capacity - offset));
+
+  memcpy(dest, data_ + offset, first);
+
+  if (first < size)
+  {
+    memcpy((char*)dest + first, data_, size - first);
+  }
+}
+
+long SharedMemoryTransport::send_message(const char* buf, size_t size)
+{
+  static const char print_prefix[] = "SharedMemoryTransport::send_message";
+
+  if (ring_ == nullptr)
+  {
+    return -1;
+  }
+
+  uint64_t frame = sizeof(uint32_t) + size;
+
+  if (frame > ring_->capacity)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " message of %d bytes does not fit in ring of %" PRIu64 " bytes\n",
+        print_prefix, (int)size, ring_->capacity);
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      ++failed_sends;
+    }
+
+    return -3;
+  }
+
+  {
+    ipc::scoped_lock<ipc::interprocess_mutex> guard(ring_->mutex);
+
+    // evict the oldest messages until the new message fits
+    while (ring_->write_pos + frame - ring_->oldest_pos > ring_->capacity)
+    {
+      uint32_t old_size = 0;
+      copy_out(ring_->oldest_pos, &old_size, sizeof(old_size));
+      ring_->oldest_pos += sizeof(uint32_t) + old_size;
+    }
+
+    uint32_t size32 = (uint32_t)size;
+    copy_in(ring_->write_pos, &size32, sizeof(size32));
+    copy_in(ring_->write_pos + sizeof(size32), buf, size);
+    ring_->write_pos += frame;
+  }
+
+  ring_->changed.notify_all();
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " wrote %d byte message to segment %s\n",
+      print_prefix, (int)size, segment_name_.c_str());
+
+  send_monitor_.add((uint32_t)size);
+
+  if (settings_.debug_to_kb_prefix != "")
+  {
+    long result = (long)size;
+
+    sent_data += result;
+    ++sent_packets;
+    if (sent_data_max < result)
+    {
+      sent_data_max = result;
+    }
+    if (sent_data_min > result || sent_data_min == 0)
+    {
+      sent_data_min = result;
+    }
+  }
+
+  return (long)size;
+}
+
+long SharedMemoryTransport::send_data(
+    const knowledge::KnowledgeMap& orig_updates)
+{
+  long result(0);
+  const char* print_prefix = "SharedMemoryTransport::send_data";
+
+  if (!settings_.no_sending)
+  {
+    result = prep_send(orig_updates, print_prefix);
+
+    if (result > 0)
+    {
+      result = send_message(buffer_.get_ptr(), result);
+    }
+  }
+
+  return result;
+}
+}
+}
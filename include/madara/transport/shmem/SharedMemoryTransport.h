@@ -0,0 +1,240 @@
+#ifndef _MADARA_SHARED_MEMORY_TRANSPORT_H_
+#define _MADARA_SHARED_MEMORY_TRANSPORT_H_
+
+/**
+ * @file SharedMemoryTransport.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the SharedMemoryTransport class, which provides a
+ * same-host transport for sending knowledge updates in KaRL through a
+ * shared memory ring buffer, bypassing the kernel network stack
+ **/
+
+#include <string>
+
+#include "madara/MadaraExport.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/transport/Transport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Integer.h"
+#include "madara/threads/Threader.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif  // __GNUC__
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif  // __GNUC__
+
+namespace madara
+{
+namespace transport
+{
+namespace ipc = boost::interprocess;
+
+/**
+ * Control block that lives at the front of the shared memory segment
+ * and is shared by every process attached to the same segment. All
+ * positions are monotonically increasing byte offsets; the physical
+ * offset into the data area is the position modulo capacity.
+ **/
+struct SharedMemoryRing
+{
+  /**
+   * Constructor
+   * @param  ring_capacity  size of the data area in bytes
+   **/
+  explicit SharedMemoryRing(uint64_t ring_capacity) : capacity(ring_capacity)
+  {
+  }
+
+  /// guards all fields and the data area
+  ipc::interprocess_mutex mutex;
+
+  /// signaled by writers whenever a new message is available
+  ipc::interprocess_condition changed;
+
+  /// size of the data area in bytes
+  uint64_t capacity;
+
+  /// position where the next message will be written
+  uint64_t write_pos = 0;
+
+  /// position of the oldest message that has not been overwritten
+  uint64_t oldest_pos = 0;
+
+  /// most transports that may be attached to one segment at once
+  static const uint32_t MAX_ATTACHED = 256;
+
+  /// number of transports currently attached to the segment
+  uint32_t attached = 0;
+
+  /// process id of each attached transport, used to prune transports
+  /// of processes that exited without closing
+  int64_t attached_pids[MAX_ATTACHED] = {};
+
+  /// set by the last transport to detach once the segment is removed,
+  /// so processes that opened it just before removal attach again
+  bool removed = false;
+};
+
+/**
+ * @class SharedMemoryTransport
+ * @brief Shared memory transport for agents on the same host. Every
+ *        message is appended to a ring buffer in a named shared memory
+ *        segment and readers are woken through a process-shared
+ *        condition, so delivery does not touch the network stack. This
+ *        transport currently supports the following transport settings:<br
+ *        />
+ *        1) a segment name in hosts[0] (defaults to madara_{write_domain})<br
+ *        />
+ *        2) the reduced message header<br />
+ *        3) the normal message header<br />
+ *        4) domain differentiation<br />
+ *        5) on data received logic<br />
+ *        6) multi-assignment of records<br />
+ *        7) rebroadcasting<br />
+ *        The ring size is taken from settings.queue_length. Readers that
+ *        fall more than a full ring behind lose the oldest messages.
+ *        The last transport to close removes the segment. On POSIX hosts,
+ *        transports of processes that exited without closing are pruned
+ *        by the next transport to attach, but a process that dies while
+ *        holding the ring mutex leaves the segment unusable until it is
+ *        removed by hand.
+ **/
+class MADARA_EXPORT SharedMemoryTransport : public Base
+{
+public:
+  /**
+   * Constructor
+   * @param   id   unique identifer - usually a combination of host:port
+   * @param   context  knowledge context
+   * @param   config   transport configuration settings
+   * @param   launch_transport  whether or not to launch this transport
+   **/
+  SharedMemoryTransport(const std::string& id,
+      madara::knowledge::ThreadSafeContext& context, TransportSettings& config,
+      bool launch_transport);
+
+  /**
+   * Destructor
+   **/
+  virtual ~SharedMemoryTransport();
+
+  /**
+   * Sends a list of knowledge updates to listeners
+   * @param   updates listing of all updates that must be sent
+   * @return  result of write operation or -1 if we are shutting down
+   **/
+  long send_data(const madara::knowledge::KnowledgeMap& updates) override;
+
+  /**
+   * Closes the transport and detaches from the segment. The last
+   * transport to detach removes the segment.
+   **/
+  void close(void) override;
+
+  /**
+   * Accesses reliability setting
+   * @return  whether we are using reliable dissemination or not
+   **/
+  int reliability(void) const;
+
+  /**
+   * Sets the reliability setting
+   * @return  the changed setting
+   **/
+  int reliability(const int& setting);
+
+  /**
+   * Initializes the transport
+   * @return  0 if success
+   **/
+  int setup(void) override;
+
+  /**
+   * Returns the name of the shared memory segment
+   * @return  the segment name
+   **/
+  const std::string& segment_name(void) const;
+
+  /// sent packets
+  knowledge::containers::Integer sent_packets;
+
+  /// failed sends
+  knowledge::containers::Integer failed_sends;
+
+  /// sent data
+  knowledge::containers::Integer sent_data;
+
+  /// max data sent
+  knowledge::containers::Integer sent_data_max;
+
+  /// min data sent
+  knowledge::containers::Integer sent_data_min;
+
+protected:
+  /**
+   * Appends a message to the ring and wakes up readers
+   * @param  buf    the message to write
+   * @param  size   the size of the message
+   * @return  bytes written or a negative number on error
+   **/
+  long send_message(const char* buf, size_t size);
+
+  /**
+   * Removes transports of processes that have exited from the ring's
+   * attached list. The ring mutex must be held.
+   **/
+  void prune_detached_unsafe(void);
+
+  /**
+   * Copies bytes into the ring, wrapping around the end of the data area.
+   * The ring mutex must be held.
+   **/
+  void copy_in(uint64_t pos, const void* source, size_t size);
+
+  /**
+   * Copies bytes out of the ring, wrapping around the end of the data area.
+   * The ring mutex must be held.
+   **/
+  void copy_out(uint64_t pos, void* dest, size_t size) const;
+
+  /// knowledge base for threads to use
+  knowledge::KnowledgeBase knowledge_;
+
+  /// threads for reading knowledge updates
+  threads::Threader read_threads_;
+
+  /// name of the shared memory segment
+  std::string segment_name_;
+
+  /// the mapped segment
+  std::unique_ptr<ipc::managed_shared_memory> segment_;
+
+  /// control block inside the segment
+  SharedMemoryRing* ring_ = nullptr;
+
+  /// data area inside the segment
+  char* data_ = nullptr;
+
+  /// next position to read, shared by all local read threads and
+  /// guarded by the ring mutex
+  uint64_t read_pos_ = 0;
+
+  /// the process id recorded in the ring for this transport
+  int64_t pid_ = 0;
+
+  friend class SharedMemoryTransportReadThread;
+};
+}
+}
+
+#endif  // _MADARA_SHARED_MEMORY_TRANSPORT_H_
@@ -0,0 +1,256 @@
+#include "madara/transport/shmem/SharedMemoryTransportReadThread.h"
+
+#include "madara/utility/Utility.h"
+#include "madara/transport/ReducedMessageHeader.h"
+
+#include <algorithm>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace madara
+{
+namespace transport
+{
+const int64_t SharedMemoryTransportReadThread::wait_timeout_ms;
+
+SharedMemoryTransportReadThread::SharedMemoryTransportReadThread(
+    SharedMemoryTransport& transport)
+  : transport_(transport)
+{
+}
+
+void SharedMemoryTransportReadThread::init(knowledge::KnowledgeBase& knowledge)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  context_ = &(knowledge.get_context());
+
+  // setup the receive buffer
+  if (settings_.queue_length > 0)
+    buffer_ = new char[settings_.queue_length];
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+      "SharedMemoryTransportReadThread::init:"
+      " SharedMemoryTransportReadThread started with queue length %d\n",
+      settings_.queue_length);
+
+  if (context_)
+  {
+    // check for an on_data_received ruleset
+    if (settings_.on_data_received_logic.length() != 0)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "SharedMemoryTransportReadThread::init:"
+          " setting rules to %s\n",
+          settings_.on_data_received_logic.c_str());
+
+#ifndef _MADARA_NO_KARL_
+      on_data_received_ = context_->compile(settings_.on_data_received_logic);
+#endif  // _MADARA_NO_KARL_
+    }
+    else
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "SharedMemoryTransportReadThread::init:"
+          " no permanent rules were set\n");
+    }
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      knowledge::KnowledgeBase kb;
+      kb.use(*context_);
+      received_packets_.set_name(
+          settings_.debug_to_kb_prefix + ".received_packets", kb);
+      failed_receives_.set_name(
+          settings_.debug_to_kb_prefix + ".failed_receives", kb);
+      received_data_max_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data_max", kb);
+      received_data_min_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data_min", kb);
+      received_data_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data", kb);
+      overruns_.set_name(settings_.debug_to_kb_prefix + ".overruns", kb);
+    }
+  }
+}
+
+void SharedMemoryTransportReadThread::cleanup(void) {}
+
+void SharedMemoryTransportReadThread::rebroadcast(const char* print_prefix,
+    MessageHeader* header, const knowledge::KnowledgeMap& records)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  int64_t buffer_remaining = (int64_t)settings_.queue_length;
+  char* buffer = buffer_.get_ptr();
+  int result(0);
+
+  if (!settings_.no_sending)
+  {
+    result = prep_rebroadcast(*context_, buffer, buffer_remaining, settings_,
+        print_prefix, header, records, transport_.packet_scheduler_);
+
+    if (result > 0)
+    {
+      // send_message updates the send monitor and debug counters
+      transport_.send_message(buffer, result);
+    }
+  }
+}
+
+void SharedMemoryTransportReadThread::run(void)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+  SharedMemoryRing* ring = transport_.ring_;
+
+  if (settings_.no_receiving || ring == nullptr)
+  {
+    return;
+  }
+
+  char* buffer = buffer_.get_ptr();
+  static const char print_prefix[] = "SharedMemoryTransportReadThread::run";
+
+  if (buffer == 0)
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_EMERGENCY,
+        "%s:"
+        " Unable to allocate buffer of size %" PRIu32 ". Exiting thread.\n",
+        print_prefix, settings_.queue_length);
+
+    return;
+  }
+
+  uint32_t bytes_read = 0;
+  bool overrun = false;
+  bool too_large = false;
+
+  {
+    ipc::scoped_lock<ipc::interprocess_mutex> guard(ring->mutex);
+
+    if (transport_.read_pos_ == ring->write_pos)
+    {
+      boost::posix_time::ptime deadline =
+          boost::posix_time::microsec_clock::universal_time() +
+          boost::posix_time::milliseconds(wait_timeout_ms);
+
+      ring->changed.timed_wait(guard, deadline);
+    }
+
+    // if writers lapped us, skip to the oldest message still in the ring
+    if (transport_.read_pos_ < ring->oldest_pos)
+    {
+      transport_.read_pos_ = ring->oldest_pos;
+      overrun = true;
+    }
+
+    if (transport_.read_pos_ != ring->write_pos)
+    {
+      uint32_t size = 0;
+      transport_.copy_out(transport_.read_pos_, &size, sizeof(size));
+
+      if (size <= settings_.queue_length)
+      {
+        transport_.copy_out(
+            transport_.read_pos_ + sizeof(size), buffer, (size_t)size);
+        bytes_read = size;
+      }
+      else
+      {
+        too_large = true;
+      }
+
+      transport_.read_pos_ += sizeof(size) + size;
+    }
+  }
+
+  if (overrun)
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " reader fell behind the ring. Skipping to oldest message\n",
+        print_prefix);
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      ++overruns_;
+    }
+  }
+
+  if (too_large)
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " message larger than queue length %" PRIu32 ". Dropping.\n",
+        print_prefix, settings_.queue_length);
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      ++failed_receives_;
+    }
+
+    return;
+  }
+
+  if (bytes_read == 0)
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
+        "%s: no messages in ring. Proceeding to next wait\n", print_prefix);
+
+    return;
+  }
+
+  if (settings_.debug_to_kb_prefix != "")
+  {
+    received_data_ += bytes_read;
+    ++received_packets_;
+
+    if (received_data_max_ < bytes_read)
+    {
+      received_data_max_ = bytes_read;
+    }
+    if (received_data_min_ > bytes_read || received_data_min_ == 0)
+    {
+      received_data_min_ = bytes_read;
+    }
+  }
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " read a %d byte message from segment %s\n",
+      print_prefix, (int)bytes_read, transport_.segment_name_.c_str());
+
+  MessageHeader* header = 0;
+  knowledge::KnowledgeMap rebroadcast_records;
+
+  process_received_update(buffer, bytes_read, transport_.id_, *context_,
+      settings_, transport_.send_monitor_, transport_.receive_monitor_,
+      rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received_,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, transport_.segment_name_.c_str(), header,
+      &transport_.metrics_);
+
+  if (header)
+  {
+    if (header->ttl > 0 && rebroadcast_records.size() > 0 &&
+        settings_.get_participant_ttl() > 0)
+    {
+      --header->ttl;
+      header->ttl = std::min(settings_.get_participant_ttl(), header->ttl);
+
+      rebroadcast(print_prefix, header, rebroadcast_records);
+    }
+
+    // delete header
+    delete header;
+  }
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " finished iteration.\n",
+      print_prefix);
+}
+}
+}
@@ -0,0 +1,105 @@
+#ifndef _MADARA_SHARED_MEMORY_TRANSPORT_READ_THREAD_H_
+#define _MADARA_SHARED_MEMORY_TRANSPORT_READ_THREAD_H_
+
+/**
+ * @file SharedMemoryTransportReadThread.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the SharedMemoryTransportReadThread class, which
+ * reads knowledge updates from a shared memory ring in KaRL
+ **/
+
+#include <string>
+
+#include "madara/utility/ScopedArray.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/expression/ExpressionTree.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/MessageHeader.h"
+#include "madara/transport/shmem/SharedMemoryTransport.h"
+#include "madara/threads/BaseThread.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class SharedMemoryTransportReadThread
+ * @brief Thread for reading knowledge updates from a shared memory ring
+ **/
+class SharedMemoryTransportReadThread : public threads::BaseThread
+{
+public:
+  /**
+   * Constructor
+   * @param  transport  the transport that owns the ring
+   **/
+  SharedMemoryTransportReadThread(SharedMemoryTransport& transport);
+
+  /**
+   * Initializes MADARA context-related items
+   * @param   knowledge   context for querying current program state
+   **/
+  void init(knowledge::KnowledgeBase& knowledge) override;
+
+  /**
+   * Cleanup function called by thread manager
+   **/
+  void cleanup(void) override;
+
+  /**
+   * The main loop internals for the read thread. Blocks on the ring
+   * for a short period if no message is available.
+   **/
+  void run(void) override;
+
+  /**
+   * Sends a rebroadcast packet.
+   * @param  print_prefix     prefix to include before every log message,
+   *                          e.g., "MyTransport::svc"
+   * @param   header   header for the rebroadcasted packet
+   * @param   records  records to rebroadcast (already filtered for
+   *                   rebroadcast)
+   **/
+  void rebroadcast(const char* print_prefix, MessageHeader* header,
+      const knowledge::KnowledgeMap& records);
+
+  /// maximum time in milliseconds to block on the ring per run
+  static const int64_t wait_timeout_ms = 100;
+
+protected:
+  SharedMemoryTransport& transport_;
+
+  knowledge::ThreadSafeContext* context_ = nullptr;
+
+#ifndef _MADARA_NO_KARL_
+  /// data received rules, defined in Transport settings
+  madara::knowledge::CompiledExpression on_data_received_;
+#endif  // _MADARA_NO_KARL_
+
+  /// buffer for receiving
+  madara::utility::ScopedArray<char> buffer_;
+
+  /// received packets
+  knowledge::containers::Integer received_packets_;
+
+  /// bad receives
+  knowledge::containers::Integer failed_receives_;
+
+  /// received data
+  knowledge::containers::Integer received_data_;
+
+  /// max data received
+  knowledge::containers::Integer received_data_max_;
+
+  /// min data received
+  knowledge::containers::Integer received_data_min_;
+
+  /// times this reader fell a full ring behind and skipped ahead
+  knowledge::containers::Integer overruns_;
+};
+}
+}
+
+#endif  // _MADARA_SHARED_MEMORY_TRANSPORT_READ_THREAD_H_
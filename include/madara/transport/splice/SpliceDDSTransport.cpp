@@ -379,6 +379,8 @@ int madara::transport::SpliceDDSTransport::setup(void)
         " starting %d threads at %f hertz\n",
         settings_.read_threads, hertz);
 
+    read_threads_.set_thread_settings(settings_.read_thread_settings());
+
     for (uint32_t i = 0; i < settings_.read_threads; ++i)
     {
       std::stringstream thread_name;
@@ -0,0 +1,766 @@
+#include "madara/transport/tcp/TcpTransport.h"
+#include "madara/transport/tcp/TcpTransportReadThread.h"
+#include "madara/transport/TransportContext.h"
+
+#include "madara/transport/ReducedMessageHeader.h"
+#include "madara/utility/ScopedArray.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Tracer.h"
+#include "madara/utility/IntTypes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace madara
+{
+namespace transport
+{
+const double TcpTransport::reconnect_interval = 1.0;
+
+TcpConnection::TcpConnection(TcpTransport& transport, bool outgoing)
+  : socket(transport.io_service_),
+    transport_(transport),
+    outgoing_(outgoing),
+    strand_(transport.io_service_),
+    reconnect_timer_(transport.io_service_)
+{
+}
+
+void TcpConnection::connect(const tcp::endpoint& endpoint)
+{
+  endpoint_ = endpoint;
+
+  std::stringstream buffer;
+  buffer << endpoint_.address().to_string() << ":" << endpoint_.port();
+  remote_host_ = buffer.str();
+
+  asio::post(strand_, std::bind(&TcpConnection::start_connect,
+                          shared_from_this()));
+}
+
+void TcpConnection::start(void)
+{
+  boost::system::error_code ec;
+  tcp::endpoint remote = socket.remote_endpoint(ec);
+
+  if (!ec)
+  {
+    std::stringstream buffer;
+    buffer << remote.address().to_string() << ":" << remote.port();
+    remote_host_ = buffer.str();
+  }
+
+  socket.set_option(tcp::no_delay(transport_.settings_.tcp_nodelay), ec);
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    connected_ = true;
+  }
+
+  madara_logger_log(transport_.context_.get_logger(), logger::LOG_MAJOR,
+      "TcpConnection::start:"
+      " accepted connection from %s\n",
+      remote_host_.c_str());
+
+  asio::post(
+      strand_, std::bind(&TcpConnection::read_header, shared_from_this()));
+}
+
+bool TcpConnection::is_connected(void)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return connected_;
+}
+
+const std::string& TcpConnection::remote_host(void) const
+{
+  return remote_host_;
+}
+
+long TcpConnection::send(const char* buf, uint32_t size)
+{
+  MADARA_TRACE_SPAN("socket_send");
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  if (!connected_)
+  {
+    return 0;
+  }
+
+  // bound the bytes buffered for a slow peer by the queue length,
+  // counting the write in progress, which holds its own buffer
+  if (in_flight_.size() + pending_.size() + sizeof(size) + size >
+      transport_.settings_.queue_length)
+  {
+    return -2;
+  }
+
+  uint32_t prefix = utility::endian_swap(size);
+  const char* prefix_bytes = (const char*)&prefix;
+
+  pending_.insert(pending_.end(), prefix_bytes, prefix_bytes + sizeof(prefix));
+  pending_.insert(pending_.end(), buf, buf + size);
+
+  // if a write is in flight, its completion handler picks up this frame
+  if (!writing_)
+  {
+    writing_ = true;
+    asio::post(
+        strand_, std::bind(&TcpConnection::start_write, shared_from_this()));
+  }
+
+  return (long)size;
+}
+
+void TcpConnection::close(void)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  closed_ = true;
+  connected_ = false;
+  writing_ = false;
+  pending_.clear();
+
+  boost::system::error_code ec;
+  reconnect_timer_.cancel(ec);
+  socket.close(ec);
+}
+
+void TcpConnection::start_connect(void)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (closed_)
+    {
+      return;
+    }
+  }
+
+  auto self = shared_from_this();
+
+  socket.async_connect(endpoint_,
+      asio::bind_executor(strand_, [self](const boost::system::error_code& ec) {
+        if (ec)
+        {
+          madara_logger_log(self->transport_.context_.get_logger(),
+              logger::LOG_MINOR,
+              "TcpConnection::start_connect:"
+              " unable to connect to %s: %s\n",
+              self->remote_host_.c_str(), ec.message().c_str());
+
+          self->schedule_reconnect();
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> guard(self->mutex_);
+          if (self->closed_)
+          {
+            return;
+          }
+          self->connected_ = true;
+        }
+
+        boost::system::error_code option_ec;
+        self->socket.set_option(
+            tcp::no_delay(self->transport_.settings_.tcp_nodelay), option_ec);
+        self->socket.set_option(
+            asio::socket_base::keep_alive(true), option_ec);
+
+        madara_logger_log(self->transport_.context_.get_logger(),
+            logger::LOG_MAJOR,
+            "TcpConnection::start_connect:"
+            " connected to %s\n",
+            self->remote_host_.c_str());
+
+        // peers never write on this stream, but a pending read tells us
+        // promptly when the peer goes away
+        self->read_header();
+      }));
+}
+
+void TcpConnection::schedule_reconnect(void)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (closed_)
+    {
+      return;
+    }
+  }
+
+  boost::system::error_code ec;
+  socket.close(ec);
+
+  auto self = shared_from_this();
+
+  reconnect_timer_.expires_after(std::chrono::milliseconds(
+      (int64_t)(TcpTransport::reconnect_interval * 1000)));
+  reconnect_timer_.async_wait(
+      asio::bind_executor(strand_, [self](const boost::system::error_code& ec) {
+        if (!ec)
+        {
+          self->start_connect();
+        }
+      }));
+}
+
+void TcpConnection::set_cork(bool enabled)
+{
+#ifdef TCP_CORK
+  if (transport_.settings_.tcp_cork)
+  {
+    int value = enabled ? 1 : 0;
+    setsockopt(socket.native_handle(), IPPROTO_TCP, TCP_CORK, &value,
+        sizeof(value));
+  }
+#else
+  (void)enabled;
+#endif
+}
+
+void TcpConnection::start_write(void)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    if (!connected_ || pending_.empty())
+    {
+      writing_ = false;
+      return;
+    }
+
+    // everything queued so far goes out in a single write
+    in_flight_.swap(pending_);
+    pending_.clear();
+  }
+
+  set_cork(true);
+
+  auto self = shared_from_this();
+
+  asio::async_write(socket, asio::buffer(in_flight_),
+      asio::bind_executor(strand_,
+          [self](const boost::system::error_code& ec, size_t bytes) {
+            if (ec)
+            {
+              self->handle_error("start_write", ec);
+              return;
+            }
+
+            madara_logger_log(self->transport_.context_.get_logger(),
+                logger::LOG_MINOR,
+                "TcpConnection::start_write:"
+                " wrote %d bytes to %s\n",
+                (int)bytes, self->remote_host_.c_str());
+
+            bool more = false;
+
+            {
+              std::lock_guard<std::mutex> guard(self->mutex_);
+              self->in_flight_.clear();
+              more = !self->pending_.empty();
+
+              if (!more)
+              {
+                self->writing_ = false;
+              }
+            }
+
+            if (more)
+            {
+              self->start_write();
+            }
+            else
+            {
+              // flush whatever the kernel held back while corked
+              self->set_cork(false);
+            }
+          }));
+}
+
+void TcpConnection::read_header(void)
+{
+  auto self = shared_from_this();
+
+  asio::async_read(socket, asio::buffer(&read_size_, sizeof(read_size_)),
+      asio::bind_executor(
+          strand_, [self](const boost::system::error_code& ec, size_t) {
+            if (ec)
+            {
+              self->handle_error("read_header", ec);
+              return;
+            }
+
+            self->read_body();
+          }));
+}
+
+void TcpConnection::read_body(void)
+{
+  uint32_t size = utility::endian_swap(read_size_);
+
+  if (size == 0 || size > transport_.settings_.queue_length)
+  {
+    madara_logger_log(transport_.context_.get_logger(), logger::LOG_MAJOR,
+        "TcpConnection::read_body:"
+        " frame of %" PRIu32 " bytes from %s exceeds queue length %" PRIu32
+        ". Closing stream.\n",
+        size, remote_host_.c_str(), transport_.settings_.queue_length);
+
+    handle_error("read_body", asio::error::message_size);
+    return;
+  }
+
+  read_buffer_.resize(size);
+
+  auto self = shared_from_this();
+
+  asio::async_read(socket, asio::buffer(read_buffer_),
+      asio::bind_executor(
+          strand_, [self](const boost::system::error_code& ec, size_t bytes) {
+            if (ec)
+            {
+              self->handle_error("read_body", ec);
+              return;
+            }
+
+            self->transport_.receive_message(self->read_buffer_.data(),
+                (uint32_t)bytes, self->remote_host_);
+
+            self->read_header();
+          }));
+}
+
+void TcpConnection::handle_error(
+    const char* operation, const boost::system::error_code& ec)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    // another handler already tore the stream down
+    if (closed_ || !connected_)
+    {
+      return;
+    }
+
+    connected_ = false;
+    writing_ = false;
+    pending_.clear();
+
+    // the failed write no longer counts toward queue_length. clear keeps
+    // the capacity, so a write still completing never sees it freed.
+    in_flight_.clear();
+  }
+
+  madara_logger_log(transport_.context_.get_logger(), logger::LOG_MAJOR,
+      "TcpConnection::%s:"
+      " connection to %s lost: %s\n",
+      operation, remote_host_.c_str(), ec.message().c_str());
+
+  if (outgoing_)
+  {
+    schedule_reconnect();
+  }
+  else
+  {
+    boost::system::error_code close_ec;
+    socket.close(close_ec);
+
+    transport_.remove_accepted(shared_from_this());
+  }
+}
+
+TcpTransport::TcpTransport(const std::string& id,
+    knowledge::ThreadSafeContext& context, TransportSettings& config,
+    bool launch_transport)
+  : Base(id, config, context)
+{
+  // create a reference to the knowledge base for threading
+  knowledge_.use(context);
+
+  // set the data plane for the read threads
+  read_threads_.set_data_plane(knowledge_);
+
+  if (config.debug_to_kb_prefix != "")
+  {
+    knowledge::KnowledgeBase kb;
+    kb.use(context);
+
+    sent_packets.set_name(config.debug_to_kb_prefix + ".sent_packets", kb);
+    failed_sends.set_name(config.debug_to_kb_prefix + ".failed_sends", kb);
+    sent_data_max.set_name(config.debug_to_kb_prefix + ".sent_data_max", kb);
+    sent_data_min.set_name(config.debug_to_kb_prefix + ".sent_data_min", kb);
+    sent_data.set_name(config.debug_to_kb_prefix + ".sent_data", kb);
+    received_packets_.set_name(
+        config.debug_to_kb_prefix + ".received_packets", kb);
+    received_data_.set_name(config.debug_to_kb_prefix + ".received_data", kb);
+  }
+
+  if (launch_transport)
+    setup();
+}
+
+TcpTransport::~TcpTransport()
+{
+  TcpTransport::close();
+}
+
+void TcpTransport::close(void)
+{
+  this->invalidate_transport();
+
+  read_threads_.terminate();
+
+  work_.reset();
+  io_service_.stop();
+
+  read_threads_.wait();
+
+  // no handlers can run now, so the sockets can be closed safely
+  boost::system::error_code ec;
+  acceptor_.close(ec);
+
+  for (auto& peer : peers_)
+  {
+    peer->close();
+  }
+  peers_.clear();
+
+  std::lock_guard<std::mutex> guard(accepted_mutex_);
+
+  for (auto& connection : accepted_)
+  {
+    connection->close();
+  }
+  accepted_.clear();
+}
+
+int TcpTransport::reliability(void) const
+{
+  return RELIABLE;
+}
+
+int TcpTransport::reliability(const int&)
+{
+  return RELIABLE;
+}
+
+size_t TcpTransport::connected_peers(void)
+{
+  size_t result = 0;
+
+  for (auto& peer : peers_)
+  {
+    if (peer->is_connected())
+    {
+      ++result;
+    }
+  }
+
+  return result;
+}
+
+int TcpTransport::setup(void)
+{
+  // call base setup method to initialize certain common variables
+  if (Base::setup() < 0)
+  {
+    return -1;
+  }
+
+  if (settings_.hosts.size() == 0)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "TcpTransport::setup:"
+        " No host addresses. Aborting setup.\n");
+    this->invalidate_transport();
+    return -1;
+  }
+
+  std::vector<tcp::endpoint> endpoints;
+
+  // convert the string host:port into an asio address
+  for (unsigned int i = 0; i < settings_.hosts.size(); ++i)
+  {
+    try
+    {
+      auto addr_parts = utility::parse_address(settings_.hosts[i]);
+
+      auto addr = asio::ip::address::from_string(addr_parts.first);
+      endpoints.emplace_back(addr, addr_parts.second);
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " settings address[%d] to %s:%d\n",
+          i, endpoints.back().address().to_string().c_str(),
+          endpoints.back().port());
+    }
+    catch (const boost::system::system_error& e)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " Error parsing address %s: %s\n",
+          settings_.hosts[i].c_str(), e.what());
+
+      if (i == 0)
+      {
+        this->invalidate_transport();
+        return -1;
+      }
+    }
+  }
+
+  work_.reset(new asio::io_service::work(io_service_));
+
+  if (!settings_.no_receiving)
+  {
+    try
+    {
+      acceptor_.open(endpoints[0].protocol());
+      acceptor_.set_option(tcp::acceptor::reuse_address(true));
+      acceptor_.bind(tcp::endpoint(endpoints[0].protocol(),
+          endpoints[0].port()));
+      acceptor_.listen();
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " Listening on port: %d\n",
+          (int)endpoints[0].port());
+    }
+    catch (const boost::system::system_error& e)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " Error setting up listening socket: %s\n",
+          e.what());
+
+      this->invalidate_transport();
+      return -1;
+    }
+
+    start_accept();
+  }
+
+  if (!settings_.no_sending)
+  {
+    for (size_t i = 1; i < endpoints.size(); ++i)
+    {
+      std::shared_ptr<TcpConnection> peer =
+          std::make_shared<TcpConnection>(*this, true);
+      peer->connect(endpoints[i]);
+      peers_.push_back(peer);
+    }
+  }
+
+#ifndef _MADARA_NO_KARL_
+  if (settings_.on_data_received_logic.length() != 0)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "TcpTransport::setup:"
+        " setting rules to %s\n",
+        settings_.on_data_received_logic.c_str());
+
+    on_data_received_compiled_ =
+        context_.compile(settings_.on_data_received_logic);
+  }
+#endif  // _MADARA_NO_KARL_
+
+  double hertz = settings_.read_thread_hertz;
+  if (hertz < 0.0)
+  {
+    hertz = 0.0;
+  }
+
+  // outgoing connections need the io_service even if we never receive
+  uint32_t num_threads = std::max<uint32_t>(settings_.read_threads, 1);
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "TcpTransport::setup:"
+      " starting %d threads at %f hertz\n",
+      (int)num_threads, hertz);
+
+  read_threads_.set_thread_settings(settings_.read_thread_settings());
+
+  for (uint32_t i = 0; i < num_threads; ++i)
+  {
+    std::stringstream thread_name;
+    thread_name << "read";
+    thread_name << i;
+
+    read_threads_.run(
+        hertz, thread_name.str(), new TcpTransportReadThread(*this));
+  }
+
+  return this->validate_transport();
+}
+
+void TcpTransport::start_accept(void)
+{
+  std::shared_ptr<TcpConnection> connection =
+      std::make_shared<TcpConnection>(*this, false);
+
+  acceptor_.async_accept(
+      connection->socket, [this, connection](
+                              const boost::system::error_code& ec) {
+        if (!ec)
+        {
+          {
+            std::lock_guard<std::mutex> guard(accepted_mutex_);
+            accepted_.insert(connection);
+          }
+
+          connection->start();
+        }
+        else
+        {
+          madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+              "TcpTransport::start_accept:"
+              " Error accepting connection: %s\n",
+              ec.message().c_str());
+        }
+
+        if (ec != asio::error::operation_aborted && acceptor_.is_open())
+        {
+          start_accept();
+        }
+      });
+}
+
+void TcpTransport::remove_accepted(
+    const std::shared_ptr<TcpConnection>& connection)
+{
+  std::lock_guard<std::mutex> guard(accepted_mutex_);
+  accepted_.erase(connection);
+}
+
+void TcpTransport::receive_message(
+    const char* buf, uint32_t size, const std::string& remote_host)
+{
+  static const char print_prefix[] = "TcpTransport::receive_message";
+
+  if (settings_.debug_to_kb_prefix != "")
+  {
+    received_data_ += size;
+    ++received_packets_;
+  }
+
+  MessageHeader* header = 0;
+  knowledge::KnowledgeMap rebroadcast_records;
+
+  process_received_update(buf, size, id_, context_, settings_, send_monitor_,
+      receive_monitor_, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received_compiled_,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, remote_host.c_str(), header, &metrics_);
+
+  if (header)
+  {
+    if (header->ttl > 0 && rebroadcast_records.size() > 0 &&
+        settings_.get_participant_ttl() > 0)
+    {
+      --header->ttl;
+      header->ttl = std::min(settings_.get_participant_ttl(), header->ttl);
+
+      int64_t buffer_remaining = (int64_t)settings_.queue_length;
+      utility::ScopedArray<char> buffer(new char[settings_.queue_length]);
+
+      int result = prep_rebroadcast(context_, buffer.get_ptr(),
+          buffer_remaining, settings_, print_prefix, header,
+          rebroadcast_records, packet_scheduler_);
+
+      if (result > 0)
+      {
+        send_message(buffer.get_ptr(), result);
+      }
+    }
+
+    // delete header
+    delete header;
+  }
+}
+
+long TcpTransport::send_message(const char* buf, size_t size)
+{
+  static const char print_prefix[] = "TcpTransport::send_message";
+
+  uint64_t bytes_sent = 0;
+
+  for (size_t i = 0; i < peers_.size(); ++i)
+  {
+    long result = peers_[i]->send(buf, (uint32_t)size);
+
+    if (result > 0)
+    {
+      bytes_sent += result;
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++sent_packets;
+        sent_data += result;
+        if (sent_data_max < result)
+        {
+          sent_data_max = result;
+        }
+        if (sent_data_min > result || sent_data_min == 0)
+        {
+          sent_data_min = result;
+        }
+      }
+    }
+    else if (result < 0)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " write queue for %s is full. Dropping %d byte message\n",
+          print_prefix, peers_[i]->remote_host().c_str(), (int)size);
+
+      metrics_.failed_sends.add();
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++failed_sends;
+      }
+    }
+  }
+
+  if (bytes_sent > 0)
+  {
+    send_monitor_.add((uint32_t)bytes_sent);
+  }
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " queued %" PRIu64 " bytes across %d peers\n",
+      print_prefix, bytes_sent, (int)peers_.size());
+
+  return (long)bytes_sent;
+}
+
+long TcpTransport::send_data(const knowledge::KnowledgeMap& orig_updates)
+{
+  long result(0);
+  const char* print_prefix = "TcpTransport::send_data";
+
+  if (!settings_.no_sending)
+  {
+    result = prep_send(orig_updates, print_prefix);
+
+    if (peers_.size() > 0 && result > 0)
+    {
+      result = send_message(buffer_.get_ptr(), result);
+    }
+  }
+
+  return result;
+}
+}
+}
@@ -0,0 +1,302 @@
+#ifndef _MADARA_TCP_TRANSPORT_H_
+#define _MADARA_TCP_TRANSPORT_H_
+
+/**
+ * @file TcpTransport.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the TcpTransport class, which provides a
+ * connection-oriented transport for sending knowledge updates in KaRL
+ **/
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+
+#include "madara/MadaraExport.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/transport/Transport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Integer.h"
+#include "madara/threads/Threader.h"
+#include "madara/Boost.h"
+
+namespace madara
+{
+namespace transport
+{
+namespace asio = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+class TcpTransport;
+
+/**
+ * @class TcpConnection
+ * @brief A single persistent TCP stream owned by a TcpTransport. Each
+ *        MADARA message is framed with a 4 byte length prefix. Messages
+ *        queued while a write is in flight are coalesced and written
+ *        together once the previous write completes.
+ **/
+class MADARA_EXPORT TcpConnection
+  : public std::enable_shared_from_this<TcpConnection>
+{
+public:
+  /**
+   * Constructor
+   * @param  transport  the transport that owns this connection
+   * @param  outgoing   true if this process initiated the connection
+   **/
+  TcpConnection(TcpTransport& transport, bool outgoing);
+
+  /**
+   * Starts connecting to a peer, reconnecting whenever the stream breaks
+   * @param  endpoint   the peer to connect to
+   **/
+  void connect(const tcp::endpoint& endpoint);
+
+  /**
+   * Starts reading frames from an accepted connection
+   **/
+  void start(void);
+
+  /**
+   * Queues a framed message for writing. If no write is in flight, the
+   * write starts immediately.
+   * @param  buf    the message to send
+   * @param  size   the size of the message
+   * @return  size if queued, 0 if not connected, -2 if the queue is full
+   **/
+  long send(const char* buf, uint32_t size);
+
+  /**
+   * Closes the socket and stops reconnecting. Must only be called once
+   * the transport's io_service has been stopped.
+   **/
+  void close(void);
+
+  /**
+   * Checks if the connection is currently established
+   * @return  true if connected
+   **/
+  bool is_connected(void);
+
+  /**
+   * Returns the peer of this connection
+   * @return  the printable ip:port of the peer
+   **/
+  const std::string& remote_host(void) const;
+
+  /// the underlying stream
+  tcp::socket socket;
+
+private:
+  void start_connect(void);
+  void schedule_reconnect(void);
+  void start_write(void);
+  void read_header(void);
+  void read_body(void);
+  void handle_error(
+      const char* operation, const boost::system::error_code& ec);
+  void set_cork(bool enabled);
+
+  /// the owning transport
+  TcpTransport& transport_;
+
+  /// true if this process initiated the connection
+  bool outgoing_;
+
+  /// the peer endpoint for outgoing connections
+  tcp::endpoint endpoint_;
+
+  /// serializes all handlers that touch the socket
+  asio::io_service::strand strand_;
+
+  /// timer for reconnect attempts
+  asio::steady_timer reconnect_timer_;
+
+  /// guards connection state and the write queues
+  std::mutex mutex_;
+
+  /// true when the stream is established
+  bool connected_ = false;
+
+  /// true while an async write is in flight
+  bool writing_ = false;
+
+  /// true after close has been called
+  bool closed_ = false;
+
+  /// frames waiting for the next write
+  std::vector<char> pending_;
+
+  /// frames currently being written
+  std::vector<char> in_flight_;
+
+  /// length prefix of the frame being read
+  uint32_t read_size_ = 0;
+
+  /// body of the frame being read
+  std::vector<char> read_buffer_;
+
+  /// printable ip:port of the peer
+  std::string remote_host_;
+};
+
+/**
+ * @class TcpTransport
+ * @brief TCP-based transport for knowledge. The first host is the
+ *        address this transport listens on and all other hosts are peers
+ *        that this transport keeps persistent connections to. Messages are
+ *        length-prefixed on the stream, so max_fragment_size does not
+ *        apply. This transport currently supports the following transport
+ *        settings:<br />
+ *        1) multiple host:port pairing with self first in vector<br />
+ *        2) the reduced message header<br />
+ *        3) the normal message header<br />
+ *        4) domain differentiation<br />
+ *        5) on data received logic<br />
+ *        6) multi-assignment of records<br />
+ *        7) rebroadcasting<br />
+ *        8) tcp_nodelay and tcp_cork socket controls<br />
+ **/
+class MADARA_EXPORT TcpTransport : public Base
+{
+public:
+  /**
+   * Constructor
+   * @param   id   unique identifer - usually a combination of host:port
+   * @param   context  knowledge context
+   * @param   config   transport configuration settings
+   * @param   launch_transport  whether or not to launch this transport
+   **/
+  TcpTransport(const std::string& id,
+      madara::knowledge::ThreadSafeContext& context, TransportSettings& config,
+      bool launch_transport);
+
+  /**
+   * Destructor
+   **/
+  virtual ~TcpTransport();
+
+  /**
+   * Sends a list of knowledge updates to listeners
+   * @param   updates listing of all updates that must be sent
+   * @return  result of write operation or -1 if we are shutting down
+   **/
+  long send_data(const madara::knowledge::KnowledgeMap& updates) override;
+
+  /**
+   * Closes the transport and all of its connections
+   **/
+  void close(void) override;
+
+  /**
+   * Accesses reliability setting
+   * @return  whether we are using reliable dissemination or not
+   **/
+  int reliability(void) const;
+
+  /**
+   * Sets the reliability setting
+   * @return  the changed setting
+   **/
+  int reliability(const int& setting);
+
+  /**
+   * Initializes the transport
+   * @return  0 if success
+   **/
+  int setup(void) override;
+
+  /**
+   * Returns the number of established outgoing connections
+   * @return  the number of connected peers
+   **/
+  size_t connected_peers(void);
+
+  /// seconds between attempts to reconnect to a peer
+  static const double reconnect_interval;
+
+  /// sent packets
+  knowledge::containers::Integer sent_packets;
+
+  /// failed sends
+  knowledge::containers::Integer failed_sends;
+
+  /// sent data
+  knowledge::containers::Integer sent_data;
+
+  /// max data sent
+  knowledge::containers::Integer sent_data_max;
+
+  /// min data sent
+  knowledge::containers::Integer sent_data_min;
+
+protected:
+  /**
+   * Writes a message to every connected peer
+   * @param  buf    the message to send
+   * @param  size   the size of the message
+   * @return  bytes queued across all peers
+   **/
+  long send_message(const char* buf, size_t size);
+
+  /**
+   * Processes a complete frame read from a connection
+   * @param  buf          the message
+   * @param  size         the size of the message
+   * @param  remote_host  ip:port of the peer
+   **/
+  void receive_message(
+      const char* buf, uint32_t size, const std::string& remote_host);
+
+  /// starts an asynchronous accept on the listening socket
+  void start_accept(void);
+
+  /// forgets an accepted connection after it has closed
+  void remove_accepted(const std::shared_ptr<TcpConnection>& connection);
+
+  /// knowledge base for threads to use
+  knowledge::KnowledgeBase knowledge_;
+
+  /// Boost::ASIO IO context
+  asio::io_service io_service_;
+
+  /// keeps io_service_ running while there is no pending work
+  std::unique_ptr<asio::io_service::work> work_;
+
+  /// listening socket
+  tcp::acceptor acceptor_{io_service_};
+
+  /// connections to peers initiated by this transport
+  std::vector<std::shared_ptr<TcpConnection>> peers_;
+
+  /// connections accepted from peers
+  std::set<std::shared_ptr<TcpConnection>> accepted_;
+
+  /// guards accepted_
+  std::mutex accepted_mutex_;
+
+  /// threads for driving io_service_
+  threads::Threader read_threads_;
+
+#ifndef _MADARA_NO_KARL_
+  /// compiled data received rules, defined in Transport settings
+  knowledge::CompiledExpression on_data_received_compiled_;
+#endif  // _MADARA_NO_KARL_
+
+  /// received packets
+  knowledge::containers::Integer received_packets_;
+
+  /// received data
+  knowledge::containers::Integer received_data_;
+
+  friend class TcpConnection;
+  friend class TcpTransportReadThread;
+};
+}
+}
+
+#endif  // _MADARA_TCP_TRANSPORT_H_
@@ -0,0 +1,21 @@
+#include "madara/transport/tcp/TcpTransportReadThread.h"
+
+#include <chrono>
+
+namespace madara
+{
+namespace transport
+{
+const int64_t TcpTransportReadThread::run_timeout_ms;
+
+TcpTransportReadThread::TcpTransportReadThread(TcpTransport& transport)
+  : transport_(transport)
+{
+}
+
+void TcpTransportReadThread::run(void)
+{
+  transport_.io_service_.run_for(std::chrono::milliseconds(run_timeout_ms));
+}
+}
+}
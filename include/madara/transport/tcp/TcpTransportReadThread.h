@@ -0,0 +1,48 @@
+#ifndef _MADARA_TCP_TRANSPORT_READ_THREAD_H_
+#define _MADARA_TCP_TRANSPORT_READ_THREAD_H_
+
+/**
+ * @file TcpTransportReadThread.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the TcpTransportReadThread class, which drives the
+ * asynchronous reads and writes of a TcpTransport
+ **/
+
+#include "madara/transport/tcp/TcpTransport.h"
+#include "madara/threads/BaseThread.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class TcpTransportReadThread
+ * @brief Thread for running the io_service of a TcpTransport. Frames are
+ *        read, processed and written from within the io_service handlers.
+ **/
+class TcpTransportReadThread : public threads::BaseThread
+{
+public:
+  /**
+   * Constructor
+   * @param  transport  the transport that owns the io_service
+   **/
+  TcpTransportReadThread(TcpTransport& transport);
+
+  /**
+   * Runs io_service handlers for a short period so that termination
+   * requests are seen promptly
+   **/
+  void run(void) override;
+
+  /// maximum time in milliseconds to run handlers per run
+  static const int64_t run_timeout_ms = 100;
+
+protected:
+  TcpTransport& transport_;
+};
+}
+}
+
+#endif  // _MADARA_TCP_TRANSPORT_READ_THREAD_H_
@@ -5,7 +5,10 @@
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/transport/ReducedMessageHeader.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Tracer.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 namespace madara
@@ -31,17 +34,40 @@ UdpTransport::UdpTransport(const std::string& id,
     sent_data_max.set_name(config.debug_to_kb_prefix + ".sent_data_max", kb);
     sent_data_min.set_name(config.debug_to_kb_prefix + ".sent_data_min", kb);
     sent_data.set_name(config.debug_to_kb_prefix + ".sent_data", kb);
+    resent_fragments.set_name(
+        config.debug_to_kb_prefix + ".resent_fragments", kb);
   }
 }
 
+UdpTransport::~UdpTransport()
+{
+  // read threads may be resending from the window until they are stopped
+  close();
+
+  std::lock_guard<std::mutex> guard(retransmit_mutex_);
+
+  for (auto& entry : retransmit_window_)
+  {
+    delete_fragments(entry.second);
+  }
+  retransmit_window_.clear();
+  retransmit_order_.clear();
+}
+
 int UdpTransport::reliability(void) const
 {
-  return BEST_EFFORT;
+  return settings_.reliable_fragments ? RELIABLE : BEST_EFFORT;
 }
 
-int UdpTransport::reliability(const int&)
+int UdpTransport::reliability(const int& setting)
 {
-  return BEST_EFFORT;
+  settings_.reliable_fragments = setting == RELIABLE;
+  return reliability();
+}
+
+bool UdpTransport::schedules_datagrams(void) const
+{
+  return settings_.reliable_fragments;
 }
 
 int UdpTransport::setup_read_thread(double hertz, const std::string& name)
@@ -97,11 +123,22 @@ int UdpTransport::setup_write_socket(void)
   return 0;
 }
 
-long UdpTransport::send_buffer(
-    const udp::endpoint& target, const char* buf, size_t size)
+long UdpTransport::send_buffer(const udp::endpoint& target, const char* buf,
+    size_t size, bool control)
 {
   uint64_t bytes_sent = 0;
 
+  // with reliable fragments, drop rates simulate loss of each datagram
+  if (settings_.reliable_fragments && !control && !packet_scheduler_.add())
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "UdpTransport::send_buffer:"
+        " Packet scheduler has dropped %d byte datagram to %s:%d\n",
+        (int)size, target.address().to_string().c_str(), (int)target.port());
+
+    return 0;
+  }
+
   int send_attempts = -1;
   ssize_t actual_sent = -1;
 
@@ -116,6 +153,7 @@ long UdpTransport::send_buffer(
     // send the fragment
     try
     {
+      MADARA_TRACE_SPAN("socket_send");
       actual_sent = socket_.send_to(asio::buffer(buf, size), target);
     }
     catch (const boost::system::system_error& e)
@@ -159,6 +197,8 @@ long UdpTransport::send_buffer(
     }
     else
     {
+      metrics_.failed_sends.add();
+
       if (settings_.debug_to_kb_prefix != "")
       {
         ++failed_sends;
@@ -169,6 +209,32 @@ long UdpTransport::send_buffer(
   return (long)bytes_sent;
 }
 
+long UdpTransport::send_datagram(const char* buf, size_t size, bool control)
+{
+  static const char print_prefix[] = "UdpTransport::send_datagram";
+
+  uint64_t bytes_sent = 0;
+
+  for (const auto& address : addresses_)
+  {
+    size_t addr_index = &address - &*addresses_.begin();
+    bool should_send = pre_send_buffer(addr_index);
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Deciding to send to %s:%d (index %d): %d\n",
+        print_prefix, address.address().to_string().c_str(),
+        (int)address.port(), addr_index, should_send);
+
+    if (should_send)
+    {
+      bytes_sent += send_buffer(address, buf, size, control);
+    }
+  }
+
+  return (long)bytes_sent;
+}
+
 long UdpTransport::send_message(const char* buf, size_t packet_size)
 {
   static const char print_prefix[] = "UdpTransport::send_message";
@@ -196,14 +262,8 @@ long UdpTransport::send_message(const char* buf, size_t packet_size)
           " Sending fragment %d\n",
           print_prefix, j);
 
-      for (const auto& address : addresses_)
-      {
-        if (pre_send_buffer(&address - &*addresses_.begin()))
-        {
-          bytes_sent += send_buffer(
-              address, i->second, (size_t)MessageHeader::get_size(i->second));
-        }
-      }
+      bytes_sent += send_datagram(
+          i->second, (size_t)MessageHeader::get_size(i->second));
 
       // sleep between fragments, if such a slack time is specified
       if (settings_.slack_time > 0)
@@ -215,7 +275,14 @@ long UdpTransport::send_message(const char* buf, size_t packet_size)
         " Sent fragments totalling %" PRIu64 " bytes\n",
         print_prefix, bytes_sent);
 
-    delete_fragments(map);
+    if (settings_.reliable_fragments)
+    {
+      keep_fragments(map);
+    }
+    else
+    {
+      delete_fragments(map);
+    }
   }
   else
   {
@@ -224,20 +291,107 @@ long UdpTransport::send_message(const char* buf, size_t packet_size)
         " Sending packet of size %ld\n",
         print_prefix, packet_size);
 
-    for (const auto& address : addresses_)
+    bytes_sent += send_datagram(buf, (size_t)packet_size);
+  }
+
+  if (bytes_sent > 0)
+  {
+    send_monitor_.add((uint32_t)bytes_sent);
+  }
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " Send bandwidth = %" PRIu64 " B/s\n",
+      print_prefix, send_monitor_.get_bytes_per_second());
+
+  return (long)bytes_sent;
+}
+
+void UdpTransport::keep_fragments(FragmentMap& map)
+{
+  if (map.size() == 0)
+  {
+    return;
+  }
+
+  FragmentMessageHeader header;
+  int64_t buffer_remaining = header.encoded_size();
+  header.read(map.begin()->second, buffer_remaining);
+
+  FragmentKey key(std::string(header.originator,
+                      strnlen(header.originator, MAX_ORIGINATOR_LENGTH)),
+      header.clock);
+
+  std::lock_guard<std::mutex> guard(retransmit_mutex_);
+
+  auto found = retransmit_window_.find(key);
+
+  if (found != retransmit_window_.end())
+  {
+    // the same message was sent again, e.g., as a rebroadcast
+    delete_fragments(found->second);
+    found->second.swap(map);
+    return;
+  }
+
+  retransmit_window_[key].swap(map);
+  retransmit_order_.push_back(key);
+
+  size_t window = std::max<size_t>(settings_.fragment_queue_length, 1);
+
+  while (retransmit_order_.size() > window)
+  {
+    auto oldest = retransmit_window_.find(retransmit_order_.front());
+
+    if (oldest != retransmit_window_.end())
     {
-      size_t addr_index = &address - &*addresses_.begin();
-      bool should_send = pre_send_buffer(addr_index);
+      delete_fragments(oldest->second);
+      retransmit_window_.erase(oldest);
+    }
+
+    retransmit_order_.pop_front();
+  }
+}
+
+long UdpTransport::resend_fragments(const std::string& originator,
+    uint64_t clock,
+    const std::vector<uint32_t>& missing)
+{
+  static const char print_prefix[] = "UdpTransport::resend_fragments";
+
+  uint64_t bytes_sent = 0;
+
+  std::lock_guard<std::mutex> guard(retransmit_mutex_);
+
+  auto found = retransmit_window_.find(FragmentKey(originator, clock));
+
+  if (found == retransmit_window_.end())
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " %s:%" PRIu64 " is no longer in the retransmit window\n",
+        print_prefix, originator.c_str(), clock);
+
+    return 0;
+  }
+
+  for (uint32_t update_number : missing)
+  {
+    auto fragment = found->second.find(update_number);
 
-      madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+    if (fragment != found->second.end())
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
           "%s:"
-          " Deciding to send to %s:%d (index %d): %d\n",
-          print_prefix, address.address().to_string().c_str(),
-          (int)address.port(), addr_index, should_send);
+          " resending fragment %" PRIu32 " of %s:%" PRIu64 "\n",
+          print_prefix, update_number, originator.c_str(), clock);
+
+      bytes_sent += send_datagram(fragment->second,
+          (size_t)MessageHeader::get_size(fragment->second), true);
 
-      if (should_send)
+      if (settings_.debug_to_kb_prefix != "")
       {
-        bytes_sent += send_buffer(address, buf, (size_t)packet_size);
+        ++resent_fragments;
       }
     }
   }
@@ -247,11 +401,6 @@ long UdpTransport::send_message(const char* buf, size_t packet_size)
     send_monitor_.add((uint32_t)bytes_sent);
   }
 
-  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
-      "%s:"
-      " Send bandwidth = %" PRIu64 " B/s\n",
-      print_prefix, send_monitor_.get_bytes_per_second());
-
   return (long)bytes_sent;
 }
 
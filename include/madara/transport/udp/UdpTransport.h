@@ -12,7 +12,11 @@
 
 #include <string>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <vector>
 
+#include "madara/transport/Fragmentation.h"
 #include "madara/Boost.h"
 
 namespace madara
@@ -34,6 +38,7 @@ using udp = boost::asio::ip::udp;
  *        5) on data received logic<br />
  *        6) multi-assignment of records<br />
  *        7) rebroadcasting<br />
+ *        8) NACK-based recovery of lost fragments (reliable_fragments)<br />
  **/
 class MADARA_EXPORT UdpTransport : public BasicASIOTransport
 {
@@ -42,6 +47,11 @@ public:
       madara::knowledge::ThreadSafeContext& context, TransportSettings& config,
       bool launch_transport);
 
+  /**
+   * Destructor
+   **/
+  virtual ~UdpTransport();
+
   /**
    * Accesses reliability setting
    * @return  whether we are using reliable dissemination or not
@@ -49,7 +59,8 @@ public:
   int reliability(void) const;
 
   /**
-   * Sets the reliability setting
+   * Sets the reliability setting. RELIABLE enables NACK-based recovery
+   * of lost fragments (see TransportSettings::reliable_fragments).
    * @return  the changed setting
    **/
   int reliability(const int& setting);
@@ -77,21 +88,84 @@ public:
   /// min data sent
   knowledge::containers::Integer sent_data_min;
 
+  /// fragments resent in response to NACKs
+  knowledge::containers::Integer resent_fragments;
+
 protected:
   int setup_read_socket() override;
   int setup_write_socket() override;
   int setup_read_thread(double hertz, const std::string& name) override;
 
+  /**
+   * With reliable fragments, drops simulate the loss of each datagram
+   * @return  true if reliable fragments are enabled
+   **/
+  bool schedules_datagrams(void) const override;
+
   long send_message(const char* buf, size_t size);
-  long send_buffer(const udp::endpoint& target, const char* buf, size_t size);
+
+  /**
+   * Sends a datagram to a single endpoint
+   * @param  target   the endpoint to send to
+   * @param  buf      the datagram
+   * @param  size     the size of the datagram
+   * @param  control  true for NACKs and resent fragments, which simulated
+   *                  drops do not apply to, so tests show recovery from
+   *                  the configured loss of updates
+   * @return  bytes sent
+   **/
+  long send_buffer(const udp::endpoint& target, const char* buf, size_t size,
+      bool control = false);
+
+  /**
+   * Sends a datagram to every address that updates are sent to
+   * @param  buf      the datagram
+   * @param  size     the size of the datagram
+   * @param  control  true for NACKs and resent fragments
+   * @return  bytes sent
+   **/
+  long send_datagram(const char* buf, size_t size, bool control = false);
+
   virtual bool pre_send_buffer(size_t addr_index)
   {
     return addr_index != 0;
   }
 
+  /**
+   * Takes ownership of the fragments of a sent message so they can be
+   * resent on request. Only the last fragment_queue_length messages are
+   * kept.
+   * @param  map    the fragments of the sent message. Cleared on return.
+   **/
+  void keep_fragments(FragmentMap& map);
+
+  /**
+   * Resends fragments that a receiver reported missing. Fragments go to
+   * every address, like the original message, since the source endpoint
+   * of a NACK may not reach the receiver that sent it.
+   * @param  originator  the originator of the fragmented message
+   * @param  clock       the clock of the fragmented message
+   * @param  missing     the fragment identifiers to resend
+   * @return  bytes resent
+   **/
+  long resend_fragments(const std::string& originator, uint64_t clock,
+      const std::vector<uint32_t>& missing);
+
   /// enforces epochs when user specifies a max_send_hertz
   utility::EpochEnforcer<utility::Clock> enforcer_;
 
+  /// identifies a fragmented message by originator and clock
+  typedef std::pair<std::string, uint64_t> FragmentKey;
+
+  /// fragments of recently sent messages, kept for retransmission
+  std::map<FragmentKey, FragmentMap> retransmit_window_;
+
+  /// order messages were added to retransmit_window_, oldest first
+  std::deque<FragmentKey> retransmit_order_;
+
+  /// guards retransmit_window_ and retransmit_order_
+  std::mutex retransmit_mutex_;
+
   friend class UdpTransportReadThread;
 };
 }
@@ -2,13 +2,17 @@
 
 #include "madara/utility/Utility.h"
 #include "madara/transport/ReducedMessageHeader.h"
+#include "madara/transport/Fragmentation.h"
 
+#include <cstring>
 #include <iostream>
 
 namespace madara
 {
 namespace transport
 {
+const uint32_t UdpTransportReadThread::max_fragment_nacks;
+
 UdpTransportReadThread::UdpTransportReadThread(UdpTransport& transport)
   : transport_(transport)
 {
@@ -24,6 +28,13 @@ void UdpTransportReadThread::init(knowledge::KnowledgeBase& knowledge)
   if (settings_.queue_length > 0)
     buffer_ = new char[settings_.queue_length];
 
+  if (settings_.zero_copy_receive && settings_.queue_length > 0)
+    shared_buffer_.reset(new knowledge::SharedBuffer(settings_.queue_length));
+
+  // NACKs are limited to the size of a single datagram
+  if (settings_.reliable_fragments && settings_.max_fragment_size > 0)
+    nack_buffer_ = new char[settings_.max_fragment_size];
+
   madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
       "UdpTransportReadThread::init:"
       " UdpTransportReadThread started with queue length %d\n",
@@ -65,6 +76,7 @@ void UdpTransportReadThread::init(knowledge::KnowledgeBase& knowledge)
           settings_.debug_to_kb_prefix + ".received_data_min", kb);
       received_data_.set_name(
           settings_.debug_to_kb_prefix + ".received_data", kb);
+      sent_nacks_.set_name(settings_.debug_to_kb_prefix + ".sent_nacks", kb);
     }
   }
 }
@@ -123,6 +135,172 @@ void UdpTransportReadThread::rebroadcast(const char* print_prefix,
   }
 }
 
+bool UdpTransportReadThread::track_fragment(const char* buffer, size_t size)
+{
+  if (size < FragmentMessageHeader::static_encoded_size() ||
+      !FragmentMessageHeader::fragment_message_header_test(buffer))
+  {
+    return true;
+  }
+
+  FragmentMessageHeader header;
+  int64_t buffer_remaining = header.encoded_size();
+  header.read(buffer, buffer_remaining);
+
+  std::string originator(
+      header.originator, strnlen(header.originator, MAX_ORIGINATOR_LENGTH));
+
+  // our own multicasts are dropped by process_received_update
+  if (originator == transport_.id_)
+  {
+    return true;
+  }
+
+  PendingFragments& pending =
+      pending_fragments_[std::make_pair(originator, header.clock)];
+
+  if (pending.done)
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
+        "UdpTransportReadThread::track_fragment:"
+        " dropping late fragment %" PRIu32 " of finished message %s:%" PRIu64
+        "\n",
+        header.update_number, originator.c_str(), header.clock);
+
+    return false;
+  }
+
+  pending.last_activity = utility::get_time();
+
+  return true;
+}
+
+void UdpTransportReadThread::send_nacks(void)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  if (pending_fragments_.size() == 0 || nack_buffer_.get_ptr() == 0)
+  {
+    return;
+  }
+
+  int64_t now = utility::get_time();
+  int64_t interval = (int64_t)(settings_.fragment_nack_interval * 1000000000);
+  size_t max_missing =
+      (settings_.max_fragment_size - FRAGMENT_NACK_HEADER_SIZE) /
+      sizeof(uint32_t);
+  std::vector<uint32_t> missing;
+
+  for (auto i = pending_fragments_.begin(); i != pending_fragments_.end();)
+  {
+    PendingFragments& pending = i->second;
+
+    if (pending.done)
+    {
+      // remember finished messages long enough to drop late resends
+      if (now - pending.last_activity > interval * max_fragment_nacks)
+      {
+        i = pending_fragments_.erase(i);
+      }
+      else
+      {
+        ++i;
+      }
+
+      continue;
+    }
+
+    // completed and evicted messages are no longer in the fragment map
+    if (!missing_fragments(i->first.first.c_str(), i->first.second,
+            settings_.fragment_map, missing))
+    {
+      pending.done = true;
+      pending.last_activity = now;
+      ++i;
+      continue;
+    }
+
+    if (now - pending.last_activity < interval)
+    {
+      ++i;
+      continue;
+    }
+
+    if (pending.nacks >= max_fragment_nacks)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "UdpTransportReadThread::send_nacks:"
+          " giving up on %d missing fragments of %s:%" PRIu64 "\n",
+          (int)missing.size(), i->first.first.c_str(), i->first.second);
+
+      pending.done = true;
+      pending.last_activity = now;
+      ++i;
+      continue;
+    }
+
+    if (missing.size() > max_missing)
+    {
+      missing.resize(max_missing);
+    }
+
+    uint64_t size = write_fragment_nack(nack_buffer_.get_ptr(),
+        settings_.max_fragment_size, i->first.first.c_str(), i->first.second,
+        missing);
+
+    if (size > 0)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "UdpTransportReadThread::send_nacks:"
+          " requesting %d missing fragments of %s:%" PRIu64 "\n",
+          (int)missing.size(), i->first.first.c_str(), i->first.second);
+
+      transport_.send_datagram(nack_buffer_.get_ptr(), (size_t)size, true);
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++sent_nacks_;
+      }
+    }
+
+    ++pending.nacks;
+    pending.last_activity = now;
+    ++i;
+  }
+}
+
+void UdpTransportReadThread::handle_nack(
+    const char* buffer, size_t size, const udp::endpoint& remote)
+{
+  std::string originator;
+  uint64_t clock;
+  std::vector<uint32_t> missing;
+
+  if (read_fragment_nack(buffer, (int64_t)size, originator, clock, missing))
+  {
+    // NACKs reach every peer, but only the originator resends
+    if (originator != transport_.id_)
+    {
+      return;
+    }
+
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+        "UdpTransportReadThread::handle_nack:"
+        " %s:%d requested %d fragments of %s:%" PRIu64 "\n",
+        remote.address().to_string().c_str(), (int)remote.port(),
+        (int)missing.size(), originator.c_str(), clock);
+
+    transport_.resend_fragments(originator, clock, missing);
+  }
+  else
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+        "UdpTransportReadThread::handle_nack:"
+        " dropping malformed NACK from %s:%d\n",
+        remote.address().to_string().c_str(), (int)remote.port());
+  }
+}
+
 void UdpTransportReadThread::run(void)
 {
   const QoSTransportSettings& settings_ = transport_.settings_;
@@ -151,9 +329,20 @@ void UdpTransportReadThread::run(void)
     return;
   }
 
+  if (settings_.reliable_fragments)
+  {
+    send_nacks();
+  }
+
   madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
       "%s: entering a recv on the socket.\n", print_prefix);
 
+  // records from earlier messages may still reference the shared buffer
+  if (shared_buffer_)
+  {
+    buffer = shared_buffer_->prepare();
+  }
+
   udp::endpoint remote;
   boost::system::error_code err;
   size_t bytes_read = transport_.socket_.receive_from(
@@ -217,6 +406,20 @@ void UdpTransportReadThread::run(void)
         print_prefix, (long long)bytes_read);
   }
 
+  if (settings_.reliable_fragments)
+  {
+    if (fragment_nack_test(buffer, bytes_read))
+    {
+      handle_nack(buffer, bytes_read, remote);
+      return;
+    }
+
+    if (!track_fragment(buffer, bytes_read))
+    {
+      return;
+    }
+  }
+
   MessageHeader* header = 0;
 
   std::stringstream remote_host;
@@ -226,13 +429,16 @@ void UdpTransportReadThread::run(void)
 
   knowledge::KnowledgeMap rebroadcast_records;
 
+  knowledge::SharedBuffer::Scope shared_scope(shared_buffer_.get(), bytes_read);
+
   process_received_update(buffer, (uint32_t)bytes_read, transport_.id_,
       *context_, settings_, transport_.send_monitor_,
       transport_.receive_monitor_, rebroadcast_records,
 #ifndef _MADARA_NO_KARL_
       on_data_received_,
 #endif  // _MADARA_NO_KARL_
-      print_prefix, remote_host.str().c_str(), header);
+      print_prefix, remote_host.str().c_str(), header,
+      &transport_.metrics_);
 
   if (header)
   {
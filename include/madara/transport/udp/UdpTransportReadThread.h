@@ -2,9 +2,12 @@
 #define _MADARA_UDP_TRANSPORT_READ_THREAD_H_
 
 #include <string>
+#include <map>
+#include <memory>
 
 #include "madara/utility/ScopedArray.h"
 #include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/SharedBuffer.h"
 #include "madara/transport/BandwidthMonitor.h"
 #include "madara/transport/QoSTransportSettings.h"
 #include "madara/expression/ExpressionTree.h"
@@ -58,7 +61,54 @@ public:
   void rebroadcast(const char* print_prefix, MessageHeader* header,
       const knowledge::KnowledgeMap& records);
 
+  /// NACKs sent for a message before giving up on its missing fragments
+  static const uint32_t max_fragment_nacks = 20;
+
 protected:
+  /**
+   * Records the progress of a fragmented message so missing fragments
+   * can be requested later
+   * @param  buffer   the received datagram
+   * @param  size     the size of the datagram
+   * @return  false if the fragment belongs to a message that has already
+   *          been completed or abandoned and should be dropped
+   **/
+  bool track_fragment(const char* buffer, size_t size);
+
+  /**
+   * Sends NACKs for incomplete messages that have not made progress
+   * within the fragment_nack_interval. NACKs go to the same addresses
+   * as updates, since the source endpoint of a multicast or broadcast
+   * datagram may not reach the originator, and name the originator so
+   * only it answers.
+   **/
+  void send_nacks(void);
+
+  /**
+   * Resends the fragments requested in a NACK, if this transport is the
+   * originator of the message
+   * @param  buffer   the received NACK
+   * @param  size     the size of the NACK
+   * @param  remote   the sender of the NACK
+   **/
+  void handle_nack(
+      const char* buffer, size_t size, const udp::endpoint& remote);
+
+  /**
+   * State for a fragmented message that is being reassembled
+   **/
+  struct PendingFragments
+  {
+    /// last time a fragment arrived or a NACK was sent (ns)
+    int64_t last_activity = 0;
+
+    /// NACKs sent so far
+    uint32_t nacks = 0;
+
+    /// true once the message has been completed or abandoned
+    bool done = false;
+  };
+
   UdpTransport& transport_;
 
   knowledge::ThreadSafeContext* context_ = nullptr;
@@ -71,6 +121,16 @@ protected:
   /// buffer for receiving
   madara::utility::ScopedArray<char> buffer_;
 
+  /// buffers for receiving that records may reference, if zero copy
+  std::unique_ptr<knowledge::SharedBuffer> shared_buffer_;
+
+  /// buffer for writing NACKs
+  madara::utility::ScopedArray<char> nack_buffer_;
+
+  /// fragmented messages being reassembled, by originator and clock
+  std::map<std::pair<std::string, uint64_t>, PendingFragments>
+      pending_fragments_;
+
   /// received packets
   knowledge::containers::Integer received_packets_;
 
@@ -85,6 +145,9 @@ protected:
 
   /// min data received
   knowledge::containers::Integer received_data_min_;
+
+  /// NACKs sent for missing fragments
+  knowledge::containers::Integer sent_nacks_;
 };
 }
 }
@@ -5,14 +5,36 @@
 
 #include "madara/transport/ReducedMessageHeader.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Tracer.h"
 #include "madara/expression/ExpressionTree.h"
 #include "madara/expression/Interpreter.h"
 #include "madara/transport/Fragmentation.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include "madara/utility/IntTypes.h"
 #include "ZMQContext.h"
 
+const size_t madara::transport::ZMQTransport::max_send_buffers;
+
+namespace
+{
+/**
+ * Called by ZMQ when it is done with a zero-copy message. The hint is a
+ * heap-allocated reference that keeps the buffer alive after the
+ * transport has been destroyed.
+ **/
+template<typename T>
+void release_send_buffer(void*, void* hint)
+{
+  std::shared_ptr<T>* buffer = (std::shared_ptr<T>*)hint;
+  (*buffer)->in_flight = false;
+  delete buffer;
+}
+}
+
 madara::transport::ZMQTransport::ZMQTransport(const std::string& id,
     madara::knowledge::ThreadSafeContext& context, TransportSettings& config,
     bool launch_transport)
@@ -234,6 +256,8 @@ int madara::transport::ZMQTransport::setup(void)
           " starting %d threads at %f hertz\n",
           settings_.read_threads, hertz);
 
+      read_threads_.set_thread_settings(settings_.read_thread_settings());
+
       for (uint32_t i = 0; i < settings_.read_threads; ++i)
       {
         std::stringstream thread_name;
@@ -241,8 +265,8 @@ int madara::transport::ZMQTransport::setup(void)
         thread_name << i;
 
         read_threads_.run(hertz, thread_name.str(),
-            new ZMQTransportReadThread(settings_, id_, write_socket_,
-                send_monitor_, receive_monitor_, packet_scheduler_));
+            new ZMQTransportReadThread(settings_, id_, *this,
+                send_monitor_, receive_monitor_));
       }
     }
   }
@@ -250,55 +274,277 @@ int madara::transport::ZMQTransport::setup(void)
   return this->validate_transport();
 }
 
-long madara::transport::ZMQTransport::send_data(
-    const madara::knowledge::KnowledgeMap& orig_updates)
+std::shared_ptr<madara::transport::ZMQTransport::SendBuffer>
+madara::transport::ZMQTransport::acquire_send_buffer(void)
 {
-  long result(0);
-  const char* print_prefix = "ZMQTransport::send_data";
+  for (auto& buffer : send_buffers_)
+  {
+    if (!buffer->in_flight)
+    {
+      return buffer;
+    }
+  }
+
+  if (send_buffers_.size() < max_send_buffers)
+  {
+    std::shared_ptr<SendBuffer> buffer(new SendBuffer);
+    buffer->data.reset(new char[settings_.queue_length]);
+    send_buffers_.push_back(buffer);
+    return buffer;
+  }
+
+  return std::shared_ptr<SendBuffer>();
+}
+
+long madara::transport::ZMQTransport::send_updates(
+    const knowledge::KnowledgeMap& updates, const std::string* topic,
+    MessageHeader* rebroadcast_header)
+{
+  const char* print_prefix = "ZMQTransport::send_updates";
+
+  // subscribers match the topic frame, so it must prefix every name
+  if (topic)
+  {
+    for (const auto& update : updates)
+    {
+      if (!utility::begins_with(update.first, *topic))
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_ERROR,
+            "ZMQTransport::send:"
+            " rejecting update of %s under topic \"%s\", which is not a"
+            " prefix of its name\n",
+            update.first.c_str(), topic->c_str());
+
+        return -1;
+      }
+    }
+  }
+
+  // read threads rebroadcast on the same socket and buffers
+  std::lock_guard<std::mutex> guard(send_mutex_);
+
+  std::shared_ptr<SendBuffer> buffer = acquire_send_buffer();
+
+  // if ZMQ still holds every send buffer, fall back to a copying send
+  char* data = buffer ? buffer->data.get() : buffer_.get_ptr();
+
+  long result;
+
+  if (rebroadcast_header)
+  {
+    int64_t buffer_remaining = (int64_t)settings_.queue_length;
 
-  if (!settings_.no_sending)
+    result = prep_rebroadcast(context_, data, buffer_remaining, settings_,
+        print_prefix, rebroadcast_header, updates, packet_scheduler_);
+  }
+  else
+  {
+    result = prep_send(
+        updates, print_prefix, data, (int64_t)settings_.queue_length);
+  }
+
+  if (result <= 0)
+  {
+    return result;
+  }
+
+  MADARA_TRACE_SPAN("socket_send");
+
+  // build the data frame before the topic frame goes out with SNDMORE,
+  // since a topic frame without its data frame would be joined to the
+  // next message
+  zmq_msg_t message;
+  int rc;
+
+  if (buffer)
+  {
+    // ZMQ releases the buffer once it is done with it
+    std::shared_ptr<SendBuffer>* hint = new std::shared_ptr<SendBuffer>(buffer);
+
+    buffer->in_flight = true;
+    rc = zmq_msg_init_data(&message, data, (size_t)result,
+        release_send_buffer<SendBuffer>, hint);
+
+    if (rc != 0)
+    {
+      // ZMQ did not take the hint, so it never releases the buffer
+      buffer->in_flight = false;
+      delete hint;
+    }
+  }
+  else
+  {
+    rc = zmq_msg_init_size(&message, (size_t)result);
+
+    if (rc == 0)
+    {
+      memcpy(zmq_msg_data(&message), data, (size_t)result);
+    }
+  }
+
+  if (rc != 0)
   {
-    result = prep_send(orig_updates, print_prefix);
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "ZMQTransport::send:"
+        " failed to create a %d byte message. Error %s\n",
+        (int)result, zmq_strerror(zmq_errno()));
 
-    if (settings_.hosts.size() > 0 && result > 0)
+    return -1;
+  }
+
+  if (topic)
+  {
+    if (zmq_send(write_socket_, topic->c_str(), topic->size(), ZMQ_SNDMORE) <
+        0)
     {
       madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
           "ZMQTransport::send:"
-          " sending %d bytes on socket\n",
-          (int)result);
+          " failed to send topic frame %s. Error %s\n",
+          topic->c_str(), zmq_strerror(zmq_errno()));
 
-      // send the prepped buffer over ZeroMQ with timeout of 300ms
-      result = (long)zmq_send(
-          write_socket_, (void*)buffer_.get_ptr(), (size_t)result, 0);
+      zmq_msg_close(&message);
 
-      if (result > 0)
-      {
-        if (settings_.debug_to_kb_prefix != "")
-        {
-          sent_data_ += result;
-          ++sent_packets_;
-          if (sent_data_max_ < result)
-          {
-            sent_data_max_ = result;
-          }
-          if (sent_data_min_ > result || sent_data_min_ == 0)
-          {
-            sent_data_min_ = result;
-          }
-        }
+      return -1;
+    }
+  }
 
-        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
-            "ZMQTransport::send:"
-            " sent %d bytes on socket\n",
-            (int)result);
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "ZMQTransport::send:"
+      " sending %d bytes on socket\n",
+      (int)result);
+
+  // send the prepped buffer over ZeroMQ with timeout of 300ms. PUB
+  // sockets accept the rest of a message once its first frame is queued.
+  int sent = zmq_msg_send(&message, write_socket_, 0);
+
+  if (sent < 0)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "ZMQTransport::send:"
+        " failed to send data frame. Error %s\n",
+        zmq_strerror(zmq_errno()));
+
+    // a failed send leaves ownership of the message with us
+    zmq_msg_close(&message);
+  }
+
+  return (long)sent;
+}
+
+long madara::transport::ZMQTransport::send_by_topic(
+    const knowledge::KnowledgeMap& updates, MessageHeader* rebroadcast_header)
+{
+  if (settings_.zmq_topics.size() == 0)
+  {
+    return send_updates(updates, 0, rebroadcast_header);
+  }
+
+  // split updates by the longest topic prefix of each variable name
+  std::map<std::string, knowledge::KnowledgeMap> topics;
+
+  for (const auto& update : updates)
+  {
+    const std::string* match = 0;
+
+    for (const auto& topic : settings_.zmq_topics)
+    {
+      if (utility::begins_with(update.first, topic) &&
+          (!match || topic.size() > match->size()))
+      {
+        match = &topic;
       }
-      else
+    }
+
+    if (!match)
+    {
+      // only subscribers to every topic receive the empty topic
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "ZMQTransport::send:"
+          " %s matches no zmq_topics and is sent under the empty"
+          " topic\n",
+          update.first.c_str());
+    }
+
+    topics[match ? *match : std::string()].insert(update);
+  }
+
+  // each topic is its own message, so each sees the same history.
+  // Rebroadcasts do not send history and leave it to the send thread.
+  uint64_t last_toi_sent = last_toi_sent_;
+  uint64_t latest_toi_sent = last_toi_sent;
+
+  long result = 0;
+
+  for (const auto& topic : topics)
+  {
+    if (!rebroadcast_header)
+    {
+      last_toi_sent_ = last_toi_sent;
+    }
+
+    long sent = send_updates(topic.second, &topic.first, rebroadcast_header);
+
+    if (!rebroadcast_header)
+    {
+      latest_toi_sent = std::max(latest_toi_sent, last_toi_sent_);
+    }
+
+    if (sent < 0 && result == 0)
+    {
+      result = sent;
+    }
+    else if (sent > 0)
+    {
+      result = result < 0 ? sent : result + sent;
+    }
+  }
+
+  if (!rebroadcast_header)
+  {
+    last_toi_sent_ = latest_toi_sent;
+  }
+
+  return result;
+}
+
+long madara::transport::ZMQTransport::send_data(
+    const madara::knowledge::KnowledgeMap& orig_updates)
+{
+  long result(0);
+
+  if (!settings_.no_sending && settings_.hosts.size() > 0)
+  {
+    result = send_by_topic(orig_updates, 0);
+
+    if (result > 0)
+    {
+      if (settings_.debug_to_kb_prefix != "")
       {
-        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
-            "ZMQTransport::send:"
-            " failed to send message. Error code %d\n",
-            (int)result);
+        sent_data_ += result;
+        ++sent_packets_;
+        if (sent_data_max_ < result)
+        {
+          sent_data_max_ = result;
+        }
+        if (sent_data_min_ > result || sent_data_min_ == 0)
+        {
+          sent_data_min_ = result;
+        }
       }
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "ZMQTransport::send:"
+          " sent %d bytes on socket\n",
+          (int)result);
+    }
+    else
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "ZMQTransport::send:"
+          " failed to send message. Error code %d\n",
+          (int)result);
+
+      metrics_.failed_sends.add();
     }
   }
 
@@ -9,7 +9,11 @@
  * multicast transport for sending knowledge updates in KaRL
  **/
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "madara/MadaraExport.h"
 #include "madara/utility/ScopedArray.h"
@@ -39,6 +43,8 @@ namespace transport
  *        5) on data received logic<br />
  *        6) multi-assignment of records<br />
  *        7) rebroadcasting<br />
+ *        8) zero-copy sends and receives<br />
+ *        9) publisher-side filtering with TransportSettings::zmq_topics<br />
  **/
 class MADARA_EXPORT ZMQTransport : public Base
 {
@@ -91,6 +97,54 @@ public:
   virtual int setup(void) override;
 
 private:
+  /// rebroadcasts through send_by_topic
+  friend class ZMQTransportReadThread;
+
+  /// the most send buffers that may be lent to ZMQ at once
+  static const size_t max_send_buffers = 8;
+
+  /**
+   * A buffer lent to ZMQ for a zero-copy send. ZMQ clears in_flight
+   * from its I/O thread once the message has been sent or discarded.
+   **/
+  struct SendBuffer
+  {
+    /// the encoded message
+    std::unique_ptr<char[]> data;
+
+    /// true while ZMQ holds the buffer
+    std::atomic<bool> in_flight{false};
+  };
+
+  /**
+   * Returns a send buffer that ZMQ is not holding, allocating one if
+   * fewer than max_send_buffers exist
+   * @return  a free send buffer or an empty pointer if all are in flight
+   **/
+  std::shared_ptr<SendBuffer> acquire_send_buffer(void);
+
+  /**
+   * Encodes and sends updates as one ZMQ message
+   * @param  updates   updates to send
+   * @param  topic     topic frame to send first, or 0 for no topic frame
+   * @param  rebroadcast_header  header of the received message, if the
+   *                   updates are a rebroadcast, or 0 for new updates
+   * @return  bytes sent, or the prep result if nothing was sent
+   **/
+  long send_updates(const knowledge::KnowledgeMap& updates,
+      const std::string* topic, MessageHeader* rebroadcast_header = 0);
+
+  /**
+   * Sends updates as one message per zmq_topics prefix, or as a single
+   * message without a topic frame if there are no topics
+   * @param  updates   updates to send
+   * @param  rebroadcast_header  header of the received message, if the
+   *                   updates are a rebroadcast, or 0 for new updates
+   * @return  bytes sent, or a negative result if nothing was sent
+   **/
+  long send_by_topic(const knowledge::KnowledgeMap& updates,
+      MessageHeader* rebroadcast_header);
+
   /// knowledge base for threads to use
   knowledge::KnowledgeBase knowledge_;
 
@@ -100,6 +154,13 @@ private:
   /// underlying socket for sending
   void* write_socket_;
 
+  /// buffers for zero-copy sends, reused once ZMQ releases them
+  std::vector<std::shared_ptr<SendBuffer>> send_buffers_;
+
+  /// serializes the socket, which is not thread safe, and send buffers
+  /// between sends and read thread rebroadcasts
+  std::mutex send_mutex_;
+
   /// sent packets
   knowledge::containers::Integer sent_packets_;
 
@@ -1,4 +1,5 @@
 #include "madara/transport/zmq/ZMQTransportReadThread.h"
+#include "madara/transport/zmq/ZMQTransport.h"
 
 #include "madara/transport/ReducedMessageHeader.h"
 #include "madara/transport/Fragmentation.h"
@@ -7,19 +8,19 @@
 
 #include <iostream>
 #include <algorithm>
+#include <vector>
 
 madara::transport::ZMQTransportReadThread::ZMQTransportReadThread(
     const TransportSettings& settings, const std::string& id,
-    void* write_socket, BandwidthMonitor& send_monitor,
-    BandwidthMonitor& receive_monitor, PacketScheduler& packet_scheduler)
+    ZMQTransport& transport, BandwidthMonitor& send_monitor,
+    BandwidthMonitor& receive_monitor)
   : settings_(settings),
     id_(id),
     context_(0),
-    write_socket_(write_socket),
+    transport_(transport),
     read_socket_(0),
     send_monitor_(send_monitor),
-    receive_monitor_(receive_monitor),
-    packet_scheduler_(packet_scheduler)
+    receive_monitor_(receive_monitor)
 {
 }
 
@@ -27,6 +28,7 @@ void madara::transport::ZMQTransportReadThread::init(
     knowledge::KnowledgeBase& knowledge)
 {
   context_ = &(knowledge.get_context());
+  metrics_ = &context_->get_metrics().bundle<TransportMetrics>();
 
   if (!settings_.no_receiving)
   {
@@ -52,7 +54,7 @@ void madara::transport::ZMQTransportReadThread::init(
           settings_.debug_to_kb_prefix + ".received_data", knowledge);
     }
 
-    // setup the receive buffer
+    // setup the rebroadcast buffer (receives are processed in place)
     if (settings_.queue_length > 0)
       buffer_ = new char[settings_.queue_length];
 
@@ -73,21 +75,33 @@ void madara::transport::ZMQTransportReadThread::init(
           zmq_strerror(zmq_errno()));
     }
 
-    // subscribe to all messages
-    result = zmq_setsockopt(read_socket_, ZMQ_SUBSCRIBE, 0, 0);
+    // subscribe to our topics, or to all messages if there are none
+    std::vector<std::string> topics(settings_.zmq_topics);
 
-    if (result == 0)
+    if (topics.size() == 0)
     {
-      madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
-          "ZMQTransportReadThread::init:"
-          " successfully set sockopt for ZMQ_SUBSCRIBE\n");
+      topics.push_back("");
     }
-    else
+
+    for (const auto& topic : topics)
     {
-      madara_logger_log(context_->get_logger(), logger::LOG_ERROR,
-          "ZMQTransportReadThread::init:"
-          " ERROR: errno = %s\n",
-          zmq_strerror(zmq_errno()));
+      result = zmq_setsockopt(
+          read_socket_, ZMQ_SUBSCRIBE, topic.c_str(), topic.size());
+
+      if (result == 0)
+      {
+        madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
+            "ZMQTransportReadThread::init:"
+            " successfully set sockopt for ZMQ_SUBSCRIBE to \"%s\"\n",
+            topic.c_str());
+      }
+      else
+      {
+        madara_logger_log(context_->get_logger(), logger::LOG_ERROR,
+            "ZMQTransportReadThread::init:"
+            " ERROR: errno = %s\n",
+            zmq_strerror(zmq_errno()));
+      }
     }
 
     // if you don't do this, ZMQ waits forever for no reason. Super smart.
@@ -242,38 +256,42 @@ void madara::transport::ZMQTransportReadThread::cleanup(void)
       " finished cleanup\n");
 }
 
+void madara::transport::ZMQTransportReadThread::check_topic(
+    const char* frame, size_t size)
+{
+  if (settings_.zmq_topics.size() == 0)
+  {
+    return;
+  }
+
+  std::string topic(frame, size);
+
+  if (std::find(settings_.zmq_topics.begin(), settings_.zmq_topics.end(),
+          topic) == settings_.zmq_topics.end() &&
+      warned_topics_.insert(topic).second)
+  {
+    madara_logger_log(context_->get_logger(), logger::LOG_WARNING,
+        "ZMQTransportReadThread::check_topic:"
+        " received topic \"%s\", which is not in zmq_topics. Publishers"
+        " and subscribers must use the same zmq_topics, or updates sent"
+        " under topics missing here are never received\n",
+        topic.c_str());
+  }
+}
+
 void madara::transport::ZMQTransportReadThread::rebroadcast(
     const char* print_prefix, MessageHeader* header,
     const knowledge::KnowledgeMap& records)
 {
-  int64_t buffer_remaining = (int64_t)settings_.queue_length;
-  char* buffer = buffer_.get_ptr();
-  int result(0);
-
-  if (!settings_.no_sending)
+  if (!settings_.no_sending && settings_.hosts.size() > 0)
   {
-    result = prep_rebroadcast(*context_, buffer, buffer_remaining, settings_,
-        print_prefix, header, records, packet_scheduler_);
+    // subscribers with zmq_topics only receive messages with topic frames
+    long result = transport_.send_by_topic(records, header);
 
-    if (result > 0)
-    {
-      if (settings_.hosts.size() > 0 && result > 0)
-      {
-        madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
-            "ZMQTransportReadThread::send:"
-            " sending %d bytes on socket\n",
-            result);
-
-        // send the prepped buffer over ZeroMQ
-        result = zmq_send(write_socket_, (void*)buffer_.get_ptr(),
-            (size_t)result, ZMQ_DONTWAIT);
-
-        madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
-            "ZMQTransportReadThread::send:"
-            " sent %d bytes on socket\n",
-            result);
-      }
-    }
+    madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " rebroadcast %d bytes\n",
+        print_prefix, (int)result);
   }
 }
 
@@ -284,8 +302,7 @@ void madara::transport::ZMQTransportReadThread::run(void)
     // allocate a buffer to send
     char* buffer = buffer_.get_ptr();
     const char* print_prefix = "ZMQTransportReadThread::run";
-    int64_t buffer_remaining = settings_.queue_length;
-    size_t zmq_buffer_size = buffer_remaining;
+    int64_t buffer_remaining = 0;
 
     madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
         "%s:"
@@ -309,15 +326,32 @@ void madara::transport::ZMQTransportReadThread::run(void)
         " entering a recv on the socket.\n",
         print_prefix);
 
-    // blocking receive up to rcv timeout (1 second)
-    buffer_remaining =
-        (int64_t)zmq_recv(read_socket_, (void*)buffer, zmq_buffer_size, 0);
+    // blocking receive up to rcv timeout (1 second). The message is
+    // processed in place, without copying it into our buffer.
+    zmq_msg_t message;
+    zmq_msg_init(&message);
+
+    buffer_remaining = (int64_t)zmq_msg_recv(&message, read_socket_, 0);
+
+    // a leading topic frame is only for publisher-side filtering
+    while (buffer_remaining >= 0 && zmq_msg_more(&message))
+    {
+      check_topic(
+          (const char*)zmq_msg_data(&message), (size_t)buffer_remaining);
+
+      zmq_msg_close(&message);
+      zmq_msg_init(&message);
+
+      buffer_remaining = (int64_t)zmq_msg_recv(&message, read_socket_, 0);
+    }
 
     madara_logger_log(context_->get_logger(), logger::LOG_MINOR,
         "%s:"
         " past recv on the socket.\n",
         print_prefix);
 
+    buffer = (char*)zmq_msg_data(&message);
+
     if (buffer_remaining > 0)
     {
       if (settings_.debug_to_kb_prefix != "")
@@ -348,7 +382,7 @@ void madara::transport::ZMQTransportReadThread::run(void)
 #ifndef _MADARA_NO_KARL_
           on_data_received_,
 #endif  // _MADARA_NO_KARL_
-          print_prefix, header->originator, header);
+          print_prefix, header->originator, header, metrics_);
 
       madara_logger_log(context_->get_logger(), logger::LOG_MINOR,
           "%s:"
@@ -357,6 +391,15 @@ void madara::transport::ZMQTransportReadThread::run(void)
 
       if (header)
       {
+        if (header->ttl > 0 && rebroadcast_records.size() > 0 &&
+            settings_.get_participant_ttl() > 0)
+        {
+          --header->ttl;
+          header->ttl = std::min(settings_.get_participant_ttl(), header->ttl);
+
+          rebroadcast(print_prefix, header, rebroadcast_records);
+        }
+
         // delete header
         delete header;
       }
@@ -373,5 +416,7 @@ void madara::transport::ZMQTransportReadThread::run(void)
         ++failed_receives_;
       }
     }
+
+    zmq_msg_close(&message);
   }
 }
@@ -9,6 +9,7 @@
  * multicast transport for reading knowledge updates in KaRL
  **/
 
+#include <set>
 #include <string>
 
 #include "madara/utility/ScopedArray.h"
@@ -26,6 +27,8 @@ namespace madara
 {
 namespace transport
 {
+class ZMQTransport;
+
 /**
  * @class ZMQTransportReadThread
  * @brief Thread for reading knowledge updates through a ZMQ
@@ -39,15 +42,14 @@ public:
    * @param    settings   Transport settings
    * @param    id      host:port identifier of this process, to allow for
    *                   rejection of duplicates
-   * @param    write_socket    socket for sending
+   * @param    transport  the transport that rebroadcasts are sent through
    * @param    send_monitor    bandwidth monitor for enforcing send limits
    * @param    receive_monitor    bandwidth monitor for enforcing
    *                              receive limits
-   * @param    packet_scheduler scheduler for mimicking network conditions
    **/
   ZMQTransportReadThread(const TransportSettings& settings,
-      const std::string& id, void* write_socket, BandwidthMonitor& send_monitor,
-      BandwidthMonitor& receive_monitor, PacketScheduler& packet_scheduler);
+      const std::string& id, ZMQTransport& transport,
+      BandwidthMonitor& send_monitor, BandwidthMonitor& receive_monitor);
 
   /**
    * Initializes MADARA context-related items
@@ -77,6 +79,15 @@ public:
       const knowledge::KnowledgeMap& records);
 
 private:
+  /**
+   * Warns once for each publisher topic frame that is not one of our
+   * topics, which means the publisher and this subscriber use different
+   * zmq_topics and some updates will never match our subscriptions
+   * @param  frame  the topic frame
+   * @param  size   the size of the topic frame
+   **/
+  void check_topic(const char* frame, size_t size);
+
   /// quality-of-service transport settings
   const QoSTransportSettings settings_;
 
@@ -86,8 +97,14 @@ private:
   /// knowledge context
   knowledge::ThreadSafeContext* context_;
 
-  /// underlying socket for sending
-  void* write_socket_;
+  /// transport metrics of the context, looked up once in init
+  TransportMetrics* metrics_ = nullptr;
+
+  /// topic frames outside zmq_topics that have been reported
+  std::set<std::string> warned_topics_;
+
+  /// sends rebroadcasts with the same topic frames as other updates
+  ZMQTransport& transport_;
 
   /// The multicast socket we are reading from
   void* read_socket_;
@@ -106,8 +123,6 @@ private:
   /// monitor for receiving bandwidth usage
   BandwidthMonitor& receive_monitor_;
 
-  /// scheduler for mimicking target network conditions
-  PacketScheduler& packet_scheduler_;
 
   /// received packets
   knowledge::containers::Integer received_packets_;
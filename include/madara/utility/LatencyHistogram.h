@@ -0,0 +1,255 @@
+#ifndef _MADARA_UTILITY_LATENCY_HISTOGRAM_H_
+#define _MADARA_UTILITY_LATENCY_HISTOGRAM_H_
+
+/**
+ * @file LatencyHistogram.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the LatencyHistogram class, a fixed-size
+ * log-linear histogram for recording latencies in nanoseconds
+ **/
+
+#include <atomic>
+#include <cstddef>
+#include "IntTypes.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class LatencyHistogram
+ * @brief Records non-negative values into log-linear buckets in the
+ *        style of HDR histograms. Values below sub_buckets are exact, and
+ *        larger values are kept within 1/(sub_buckets/2) relative error.
+ *        record is lock-free and intended for a single writer. Readers
+ *        on other threads may observe a slightly stale distribution.
+ */
+class LatencyHistogram
+{
+public:
+  /// bits of precision kept for each power of two
+  static const int sub_bucket_bits = 5;
+
+  /// values below this are recorded exactly
+  static const size_t sub_buckets = size_t(1) << sub_bucket_bits;
+
+  /// buckets for each power of two above sub_buckets
+  static const size_t half_buckets = sub_buckets / 2;
+
+  /// total buckets, enough for any positive int64_t
+  static const size_t buckets =
+      sub_buckets + half_buckets * (63 - sub_bucket_bits);
+
+  /**
+   * Constructor
+   **/
+  LatencyHistogram()
+  {
+    reset();
+  }
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  /**
+   * Records a value. Negative values are recorded as 0.
+   * @param  value   the value to record, usually in nanoseconds
+   **/
+  inline void record(int64_t value)
+  {
+    if (value < 0)
+    {
+      value = 0;
+    }
+
+    std::atomic<uint64_t>& bucket = counts_[index_of((uint64_t)value)];
+
+    // single writer, so plain loads and stores avoid locked adds
+    bucket.store(
+        bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count_.store(
+        count_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    if (value > max_.load(std::memory_order_relaxed))
+    {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Records a value from any thread. Slower than record, because the
+   * counts are updated with atomic adds.
+   * @param  value   the value to record, usually in nanoseconds
+   **/
+  inline void record_concurrent(int64_t value)
+  {
+    if (value < 0)
+    {
+      value = 0;
+    }
+
+    counts_[index_of((uint64_t)value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_release);
+
+    int64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max_.compare_exchange_weak(
+               current, value, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /**
+   * Clears all recorded values. Not safe while a writer is recording.
+   **/
+  inline void reset(void)
+  {
+    for (auto& bucket : counts_)
+    {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the number of recorded values
+   * @return  the number of recorded values
+   **/
+  inline uint64_t count(void) const
+  {
+    return count_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Returns the largest recorded value
+   * @return  the largest recorded value, or 0 if none were recorded
+   **/
+  inline int64_t max(void) const
+  {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the value at a percentile
+   * @param  percentile   the percentile in [0, 100]
+   * @return  the highest value equivalent to the percentile, or 0 if
+   *          no values were recorded
+   **/
+  inline int64_t percentile(double percentile) const
+  {
+    int64_t result = 0;
+    percentiles(&percentile, &result, 1);
+    return result;
+  }
+
+  /**
+   * Computes several percentiles in one pass over the buckets
+   * @param  percentiles  the percentiles in [0, 100], in ascending order
+   * @param  results      receives the value at each percentile
+   * @param  size         the number of percentiles
+   **/
+  inline void percentiles(
+      const double* percentiles, int64_t* results, size_t size) const
+  {
+    uint64_t total = count();
+    uint64_t seen = 0;
+    size_t cur = 0;
+
+    for (size_t i = 0; i < buckets && cur < size; ++i)
+    {
+      seen += counts_[i].load(std::memory_order_relaxed);
+
+      while (cur < size && total > 0 &&
+             seen * 100.0 >= percentiles[cur] * total)
+      {
+        results[cur] = highest_equivalent(i);
+
+        // the bucket bound may exceed anything actually recorded
+        if (results[cur] > max())
+        {
+          results[cur] = max();
+        }
+
+        ++cur;
+      }
+    }
+
+    for (; cur < size; ++cur)
+    {
+      results[cur] = total > 0 ? max() : 0;
+    }
+  }
+
+  /**
+   * Returns the bucket that a value is recorded in
+   * @param  value   the value
+   * @return  the bucket index
+   **/
+  static inline size_t index_of(uint64_t value)
+  {
+    if (value < sub_buckets)
+    {
+      return (size_t)value;
+    }
+
+    int shift = most_significant_bit(value) - sub_bucket_bits + 1;
+
+    return sub_buckets + (shift - 1) * half_buckets +
+           (size_t)((value >> shift) - half_buckets);
+  }
+
+  /**
+   * Returns the largest value recorded in a bucket
+   * @param  index   the bucket index
+   * @return  the largest value in the bucket
+   **/
+  static inline int64_t highest_equivalent(size_t index)
+  {
+    if (index < sub_buckets)
+    {
+      return (int64_t)index;
+    }
+
+    size_t offset = index - sub_buckets;
+    int shift = (int)(offset / half_buckets) + 1;
+    uint64_t sub = offset % half_buckets + half_buckets;
+
+    return (int64_t)(((sub + 1) << shift) - 1);
+  }
+
+private:
+  /**
+   * Returns the position of the highest set bit
+   * @param  value   a non-zero value
+   * @return  the bit position, 0 for the least significant bit
+   **/
+  static inline int most_significant_bit(uint64_t value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int result = 0;
+    while (value >>= 1)
+    {
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  /// counts per bucket
+  std::atomic<uint64_t> counts_[buckets];
+
+  /// total recorded values
+  std::atomic<uint64_t> count_;
+
+  /// largest recorded value
+  std::atomic<int64_t> max_;
+};
+}
+}
+
+#endif  // _MADARA_UTILITY_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,137 @@
+#include "LockProfiler.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace madara
+{
+namespace utility
+{
+std::atomic<bool> LockProfiler::enabled_(false);
+
+namespace
+{
+/// the names of the categories
+const char* category_names[LockProfiler::NUM_CATEGORIES] = {
+    "other", "evaluate", "transport_apply", "transport_send", "container",
+    "checkpoint"};
+
+/// wait times per category
+LatencyHistogram wait_times[LockProfiler::NUM_CATEGORIES];
+
+/// hold times per category
+LatencyHistogram hold_times[LockProfiler::NUM_CATEGORIES];
+
+#ifndef MADARA_NO_THREAD_LOCAL
+/// the category of the calling thread
+thread_local LockProfiler::Category local_category = LockProfiler::OTHER;
+#endif
+
+/// returns a valid index for a category
+inline size_t index_of(LockProfiler::Category category)
+{
+  return category >= 0 && category < LockProfiler::NUM_CATEGORIES
+             ? (size_t)category
+             : (size_t)LockProfiler::OTHER;
+}
+}
+
+void LockProfiler::enable(void)
+{
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void LockProfiler::disable(void)
+{
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void LockProfiler::reset(void)
+{
+  for (size_t i = 0; i < NUM_CATEGORIES; ++i)
+  {
+    wait_times[i].reset();
+    hold_times[i].reset();
+  }
+}
+
+const LatencyHistogram& LockProfiler::get_wait(Category category)
+{
+  return wait_times[index_of(category)];
+}
+
+const LatencyHistogram& LockProfiler::get_hold(Category category)
+{
+  return hold_times[index_of(category)];
+}
+
+const char* LockProfiler::get_name(Category category)
+{
+  return category_names[index_of(category)];
+}
+
+std::string LockProfiler::to_string(void)
+{
+  static const double percentiles[3] = {50, 90, 99};
+
+  std::string result(
+      "category          locks   wait p50/p90/p99/max ns      "
+      "hold p50/p90/p99/max ns\n");
+
+  for (size_t i = 0; i < NUM_CATEGORIES; ++i)
+  {
+    const LatencyHistogram& wait = wait_times[i];
+    const LatencyHistogram& hold = hold_times[i];
+
+    if (wait.count() == 0)
+    {
+      continue;
+    }
+
+    int64_t waits[3];
+    int64_t holds[3];
+    wait.percentiles(percentiles, waits, 3);
+    hold.percentiles(percentiles, holds, 3);
+
+    char line[200];
+    snprintf(line, sizeof(line),
+        "%-15s %7" PRIu64 "   %" PRId64 "/%" PRId64 "/%" PRId64 "/%" PRId64
+        "   %" PRId64 "/%" PRId64 "/%" PRId64 "/%" PRId64 "\n",
+        category_names[i], wait.count(), waits[0], waits[1], waits[2],
+        wait.max(), holds[0], holds[1], holds[2], hold.max());
+
+    result += line;
+  }
+
+  return result;
+}
+
+LockProfiler::Category LockProfiler::get_category(void)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  return local_category;
+#else
+  return OTHER;
+#endif
+}
+
+void LockProfiler::set_category(Category category)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  local_category = category;
+#else
+  (void)category;
+#endif
+}
+
+void LockProfiler::record_wait(Category category, int64_t nanoseconds)
+{
+  wait_times[index_of(category)].record_concurrent(nanoseconds);
+}
+
+void LockProfiler::record_hold(Category category, int64_t nanoseconds)
+{
+  hold_times[index_of(category)].record_concurrent(nanoseconds);
+}
+}
+}
@@ -0,0 +1,310 @@
+#ifndef _MADARA_UTILITY_LOCK_PROFILER_H_
+#define _MADARA_UTILITY_LOCK_PROFILER_H_
+
+/**
+ * @file LockProfiler.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the LockProfiler class, which records how long
+ * locks are waited for and held by call site category, and the
+ * ProfiledMutex used as MADARA_LOCK_TYPE when the profile_lock feature
+ * is enabled
+ **/
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "madara/MadaraExport.h"
+#include "IntTypes.h"
+#include "LatencyHistogram.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class LockProfiler
+ * @brief Process-wide histograms of lock wait and hold times in
+ *        nanoseconds, one pair per call site category. The category of a
+ *        lock is the category of the calling thread when the lock is
+ *        first acquired. Threads are OTHER unless a LockCategoryScope is
+ *        active. Recording is off until enable is called.
+ **/
+class MADARA_EXPORT LockProfiler
+{
+public:
+  /**
+   * Call site categories
+   **/
+  enum Category
+  {
+    OTHER,
+    EVALUATE,
+    TRANSPORT_APPLY,
+    TRANSPORT_SEND,
+    CONTAINER,
+    CHECKPOINT,
+    NUM_CATEGORIES
+  };
+
+  /**
+   * Starts recording lock times
+   **/
+  static void enable(void);
+
+  /**
+   * Stops recording lock times. Recorded times are kept.
+   **/
+  static void disable(void);
+
+  /**
+   * Checks if lock times are being recorded
+   * @return  true if profiling is enabled
+   **/
+  static inline bool is_enabled(void)
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Clears recorded times. Call while no locks are being recorded.
+   **/
+  static void reset(void);
+
+  /**
+   * Returns the wait times of a category. Every acquisition is recorded,
+   * so uncontended acquisitions appear as 0.
+   * @param  category  the call site category
+   * @return  the histogram of wait times
+   **/
+  static const LatencyHistogram& get_wait(Category category);
+
+  /**
+   * Returns the hold times of a category
+   * @param  category  the call site category
+   * @return  the histogram of hold times
+   **/
+  static const LatencyHistogram& get_hold(Category category);
+
+  /**
+   * Returns the name of a category
+   * @param  category  the call site category
+   * @return  the category name, e.g., "evaluate"
+   **/
+  static const char* get_name(Category category);
+
+  /**
+   * Returns a table of acquisitions, wait and hold percentiles for
+   * each category that was recorded
+   * @return  the report
+   **/
+  static std::string to_string(void);
+
+  /**
+   * Returns the category of the calling thread
+   * @return  the current category
+   **/
+  static Category get_category(void);
+
+  /**
+   * Sets the category of the calling thread. Has no effect when
+   * MADARA_NO_THREAD_LOCAL is defined.
+   * @param  category  the new category
+   **/
+  static void set_category(Category category);
+
+  /**
+   * Records a wait time
+   * @param  category  the call site category
+   * @param  nanoseconds  the time spent waiting to acquire
+   **/
+  static void record_wait(Category category, int64_t nanoseconds);
+
+  /**
+   * Records a hold time
+   * @param  category  the call site category
+   * @param  nanoseconds  the time the lock was held
+   **/
+  static void record_hold(Category category, int64_t nanoseconds);
+
+private:
+  /// true while lock times are recorded
+  static std::atomic<bool> enabled_;
+};
+
+/**
+ * @class LockCategoryScope
+ * @brief Sets the lock category of the calling thread until destroyed.
+ *        Use MADARA_LOCK_CATEGORY so the scope compiles away unless the
+ *        profile_lock feature is enabled.
+ **/
+class LockCategoryScope
+{
+public:
+  /**
+   * Constructor
+   * @param  category  the category for locks taken in this scope
+   **/
+  inline explicit LockCategoryScope(LockProfiler::Category category)
+    : previous_(LockProfiler::get_category())
+  {
+    LockProfiler::set_category(category);
+  }
+
+  LockCategoryScope(const LockCategoryScope&) = delete;
+  LockCategoryScope& operator=(const LockCategoryScope&) = delete;
+
+  /**
+   * Destructor. Restores the previous category.
+   **/
+  inline ~LockCategoryScope()
+  {
+    LockProfiler::set_category(previous_);
+  }
+
+private:
+  /// the category before this scope
+  LockProfiler::Category previous_;
+};
+
+/**
+ * @class ProfiledMutex
+ * @brief A recursive mutex that reports wait and hold times to
+ *        LockProfiler while profiling is enabled. Only the outermost
+ *        acquisition of a recursive lock is timed.
+ **/
+class ProfiledMutex
+{
+public:
+  /**
+   * Acquires the mutex
+   **/
+  inline void lock(void)
+  {
+    if (!LockProfiler::is_enabled())
+    {
+      mutex_.lock();
+      acquired(false, 0);
+      return;
+    }
+
+    int64_t start = now();
+    int64_t wait = 0;
+
+    // uncontended locks skip the second clock read
+    if (!mutex_.try_lock())
+    {
+      mutex_.lock();
+      wait = now() - start;
+    }
+
+    acquired(true, start + wait);
+
+    if (depth_ == 1)
+    {
+      LockProfiler::record_wait(category_, wait);
+    }
+  }
+
+  /**
+   * Acquires the mutex if it is free or already held by this thread
+   * @return  true if the mutex was acquired
+   **/
+  inline bool try_lock(void)
+  {
+    if (!mutex_.try_lock())
+    {
+      return false;
+    }
+
+    bool timed = LockProfiler::is_enabled();
+    acquired(timed, timed ? now() : 0);
+
+    if (timed && depth_ == 1)
+    {
+      LockProfiler::record_wait(category_, 0);
+    }
+
+    return true;
+  }
+
+  /**
+   * Releases the mutex
+   **/
+  inline void unlock(void)
+  {
+    if (--depth_ == 0 && timed_)
+    {
+      LockProfiler::record_hold(category_, now() - held_since_);
+    }
+
+    mutex_.unlock();
+  }
+
+private:
+  /**
+   * Tracks an acquisition by the owning thread
+   * @param  timed   true if profiling was enabled when acquired
+   * @param  time    when the mutex was acquired, if timed
+   **/
+  inline void acquired(bool timed, int64_t time)
+  {
+    if (++depth_ == 1)
+    {
+      timed_ = timed;
+      held_since_ = time;
+      category_ = LockProfiler::get_category();
+    }
+  }
+
+  /**
+   * Returns a steady time in nanoseconds
+   **/
+  static inline int64_t now(void)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /// the underlying mutex
+  std::recursive_mutex mutex_;
+
+  /// recursive acquisitions by the owner. Only the owner accesses the
+  /// fields below.
+  int depth_ = 0;
+
+  /// true if the outermost acquisition is timed
+  bool timed_ = false;
+
+  /// when the outermost acquisition completed
+  int64_t held_since_ = 0;
+
+  /// the category of the outermost acquisition
+  LockProfiler::Category category_ = LockProfiler::OTHER;
+};
+}
+}
+
+#ifdef _MADARA_PROFILE_LOCK_
+
+/**
+ * Attributes locks taken in the enclosing scope to a LockProfiler
+ * category, e.g., MADARA_LOCK_CATEGORY(EVALUATE)
+ **/
+#define MADARA_LOCK_CATEGORY(category)                            \
+  ::madara::utility::LockCategoryScope MADARA_LOCK_CATEGORY_NAME( \
+      madara_lock_category_, __LINE__)(                           \
+      ::madara::utility::LockProfiler::category)
+
+#define MADARA_LOCK_CATEGORY_NAME(a, b) MADARA_LOCK_CATEGORY_NAME_(a, b)
+#define MADARA_LOCK_CATEGORY_NAME_(a, b) a##b
+
+#else
+
+#define MADARA_LOCK_CATEGORY(category)
+
+#endif  // _MADARA_PROFILE_LOCK_
+
+#endif  // _MADARA_UTILITY_LOCK_PROFILER_H_
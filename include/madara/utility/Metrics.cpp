@@ -0,0 +1,268 @@
+#include "Metrics.h"
+#include "madara/exceptions/NameException.h"
+
+#include <fstream>
+#include <stdio.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace madara
+{
+namespace utility
+{
+const double Metrics::percentiles[3] = {50, 90, 99};
+
+namespace
+{
+/// the names of the percentiles in samples
+const char* percentile_suffixes[3] = {".p50", ".p90", ".p99"};
+
+/// the quantile labels of the percentiles in Prometheus summaries
+const char* quantile_labels[3] = {"0.5", "0.9", "0.99"};
+
+/// converts a metric name to a valid Prometheus metric name
+std::string prometheus_name(const std::string& prefix, const std::string& name)
+{
+  std::string result(prefix + name);
+
+  for (size_t i = 0; i < result.size(); ++i)
+  {
+    char c = result[i];
+
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+            c == ':' || (i > 0 && c >= '0' && c <= '9')))
+    {
+      result[i] = '_';
+    }
+  }
+
+  return result;
+}
+
+/// escapes help text for the Prometheus format
+std::string prometheus_help(const std::string& help)
+{
+  std::string result;
+
+  for (char c : help)
+  {
+    if (c == '\\')
+    {
+      result += "\\\\";
+    }
+    else if (c == '\n')
+    {
+      result += "\\n";
+    }
+    else
+    {
+      result += c;
+    }
+  }
+
+  return result;
+}
+
+/// appends one line of the Prometheus format
+void append_line(std::string& text, const std::string& name,
+    const std::string& labels, int64_t value)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), " %" PRId64 "\n", value);
+
+  text += name;
+  text += labels;
+  text += buffer;
+}
+}
+
+Metrics::Entry& Metrics::find(
+    const std::string& name, const std::string& help, Type type)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  auto found = metrics_.find(name);
+
+  if (found != metrics_.end())
+  {
+    if (found->second.type != type)
+    {
+      throw exceptions::NameException("Metrics::find: " + name +
+                                      " is already a different kind of metric");
+    }
+
+    return found->second;
+  }
+
+  Entry& entry = metrics_[name];
+  entry.type = type;
+  entry.help = help;
+
+  if (type == COUNTER)
+  {
+    entry.counter.reset(new Counter());
+  }
+  else if (type == GAUGE)
+  {
+    entry.gauge.reset(new Gauge());
+  }
+  else
+  {
+    entry.histogram.reset(new Histogram());
+  }
+
+  return entry;
+}
+
+Metrics::Counter& Metrics::counter(
+    const std::string& name, const std::string& help)
+{
+  return *find(name, help, COUNTER).counter;
+}
+
+Metrics::Gauge& Metrics::gauge(const std::string& name, const std::string& help)
+{
+  return *find(name, help, GAUGE).gauge;
+}
+
+Metrics::Histogram& Metrics::histogram(
+    const std::string& name, const std::string& help)
+{
+  return *find(name, help, HISTOGRAM).histogram;
+}
+
+std::vector<std::pair<std::string, int64_t>> Metrics::samples(void) const
+{
+  std::vector<std::pair<std::string, int64_t>> result;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  for (auto& metric : metrics_)
+  {
+    const Entry& entry = metric.second;
+
+    if (entry.type == COUNTER)
+    {
+      result.push_back(std::make_pair(metric.first, entry.counter->get()));
+    }
+    else if (entry.type == GAUGE)
+    {
+      result.push_back(std::make_pair(metric.first, entry.gauge->get()));
+    }
+    else
+    {
+      const LatencyHistogram& histogram = entry.histogram->get_histogram();
+      int64_t values[3];
+      histogram.percentiles(percentiles, values, 3);
+
+      result.push_back(std::make_pair(
+          metric.first + ".count", (int64_t)entry.histogram->count()));
+      result.push_back(
+          std::make_pair(metric.first + ".sum", entry.histogram->sum()));
+      result.push_back(
+          std::make_pair(metric.first + ".max", histogram.max()));
+
+      for (int i = 0; i < 3; ++i)
+      {
+        result.push_back(
+            std::make_pair(metric.first + percentile_suffixes[i], values[i]));
+      }
+    }
+  }
+
+  return result;
+}
+
+std::string Metrics::to_prometheus(const std::string& prefix) const
+{
+  std::string result;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  for (auto& metric : metrics_)
+  {
+    const Entry& entry = metric.second;
+    std::string name = prometheus_name(prefix, metric.first);
+
+    if (entry.help != "")
+    {
+      result += "# HELP " + name + " " + prometheus_help(entry.help) + "\n";
+    }
+
+    if (entry.type == COUNTER)
+    {
+      result += "# TYPE " + name + " counter\n";
+      append_line(result, name, "", entry.counter->get());
+    }
+    else if (entry.type == GAUGE)
+    {
+      result += "# TYPE " + name + " gauge\n";
+      append_line(result, name, "", entry.gauge->get());
+    }
+    else
+    {
+      const LatencyHistogram& histogram = entry.histogram->get_histogram();
+      int64_t values[3];
+      histogram.percentiles(percentiles, values, 3);
+
+      result += "# TYPE " + name + " summary\n";
+
+      for (int i = 0; i < 3; ++i)
+      {
+        append_line(result, name,
+            std::string("{quantile=\"") + quantile_labels[i] + "\"}",
+            values[i]);
+      }
+
+      append_line(result, name + "_sum", "", entry.histogram->sum());
+      append_line(
+          result, name + "_count", "", (int64_t)entry.histogram->count());
+    }
+  }
+
+  return result;
+}
+
+bool Metrics::save_prometheus(
+    const std::string& filename, const std::string& prefix) const
+{
+  std::string temp(filename + ".tmp");
+
+  {
+    std::ofstream file(temp.c_str(), std::ios::out | std::ios::trunc);
+
+    if (!file)
+    {
+      return false;
+    }
+
+    file << to_prometheus(prefix);
+
+    if (!file)
+    {
+      return false;
+    }
+  }
+
+  // rename replaces an existing target atomically on POSIX. On Windows,
+  // rename fails if the target exists, so MoveFileEx is asked to replace it.
+#ifdef _WIN32
+  return MoveFileExA(temp.c_str(), filename.c_str(),
+             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return std::rename(temp.c_str(), filename.c_str()) == 0;
+#endif
+}
+
+size_t Metrics::size(void) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return metrics_.size();
+}
+}
+}
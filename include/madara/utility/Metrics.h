@@ -0,0 +1,304 @@
+#ifndef _MADARA_UTILITY_METRICS_H_
+#define _MADARA_UTILITY_METRICS_H_
+
+/**
+ * @file Metrics.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the Metrics class, a registry of named counters,
+ * gauges and histograms that can be exported in the Prometheus text
+ * format
+ **/
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "madara/MadaraExport.h"
+#include "IntTypes.h"
+#include "LatencyHistogram.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class Metrics
+ * @brief A registry of named metrics. Metrics are created on first use
+ *        and live as long as the registry, so callers should look them
+ *        up once and keep the reference. Updating a metric is a single
+ *        atomic operation and is safe from any thread.
+ **/
+class MADARA_EXPORT Metrics
+{
+public:
+  /**
+   * The kinds of metrics
+   **/
+  enum Type
+  {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM
+  };
+
+  /**
+   * A value that only increases, e.g., packets sent
+   **/
+  class Counter
+  {
+  public:
+    /**
+     * Increases the counter
+     * @param  value   the amount to add
+     **/
+    inline void add(int64_t value = 1)
+    {
+      value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the counter
+     * @return  the current count
+     **/
+    inline int64_t get(void) const
+    {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// the count
+    std::atomic<int64_t> value_{0};
+  };
+
+  /**
+   * A value that may go up or down, e.g., the size of a map
+   **/
+  class Gauge
+  {
+  public:
+    /**
+     * Sets the gauge
+     * @param  value   the new value
+     **/
+    inline void set(int64_t value)
+    {
+      value_.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Changes the gauge
+     * @param  value   the amount to add, which may be negative
+     **/
+    inline void add(int64_t value)
+    {
+      value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the gauge
+     * @return  the current value
+     **/
+    inline int64_t get(void) const
+    {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// the value
+    std::atomic<int64_t> value_{0};
+  };
+
+  /**
+   * A distribution of values, e.g., latencies in nanoseconds
+   **/
+  class Histogram
+  {
+  public:
+    /**
+     * Records a value. Negative values are recorded as 0.
+     * @param  value   the value to record
+     **/
+    inline void record(int64_t value)
+    {
+      histogram_.record_concurrent(value);
+      sum_.fetch_add(value > 0 ? value : 0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the number of recorded values
+     * @return  the number of recorded values
+     **/
+    inline uint64_t count(void) const
+    {
+      return histogram_.count();
+    }
+
+    /**
+     * Returns the sum of recorded values
+     * @return  the sum of recorded values
+     **/
+    inline int64_t sum(void) const
+    {
+      return sum_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the recorded distribution
+     * @return  the histogram of recorded values
+     **/
+    inline const LatencyHistogram& get_histogram(void) const
+    {
+      return histogram_;
+    }
+
+  private:
+    /// the distribution
+    LatencyHistogram histogram_;
+
+    /// the sum of recorded values
+    std::atomic<int64_t> sum_{0};
+  };
+
+  /// the percentiles exported for each histogram
+  static const double percentiles[3];
+
+  /**
+   * Returns a counter, creating it if needed
+   * @param  name    the name of the counter, e.g., transport.sent_packets
+   * @param  help    a description used when the counter is created
+   * @return  the counter
+   * @throw exceptions::NameException  name is already another type
+   **/
+  Counter& counter(const std::string& name, const std::string& help = "");
+
+  /**
+   * Returns a gauge, creating it if needed
+   * @param  name    the name of the gauge, e.g., context.map_size
+   * @param  help    a description used when the gauge is created
+   * @return  the gauge
+   * @throw exceptions::NameException  name is already another type
+   **/
+  Gauge& gauge(const std::string& name, const std::string& help = "");
+
+  /**
+   * Returns a histogram, creating it if needed
+   * @param  name    the name of the histogram, e.g., context.lock_wait_ns
+   * @param  help    a description used when the histogram is created
+   * @return  the histogram
+   * @throw exceptions::NameException  name is already another type
+   **/
+  Histogram& histogram(const std::string& name, const std::string& help = "");
+
+  /**
+   * Returns a bundle of metrics that a subsystem looks up together,
+   * creating it on first use. T must be constructible from Metrics&.
+   * This lets code without a place to keep references, e.g., free
+   * functions, avoid looking up each metric by name.
+   * @return  the bundle for this registry
+   **/
+  template<typename T>
+  T& bundle(void)
+  {
+    std::lock_guard<std::mutex> guard(bundles_mutex_);
+
+    for (auto& entry : bundles_)
+    {
+      if (entry.first == std::type_index(typeid(T)))
+      {
+        return *static_cast<T*>(entry.second.get());
+      }
+    }
+
+    std::shared_ptr<T> result = std::make_shared<T>(*this);
+    bundles_.push_back(std::make_pair(std::type_index(typeid(T)),
+        std::shared_ptr<void>(result)));
+
+    return *result;
+  }
+
+  /**
+   * Returns every metric as name and value pairs. Counters and gauges
+   * have one pair. Histograms have .count, .sum, .max and one pair per
+   * percentile, e.g., .p99.
+   * @return  the current values, sorted by name
+   **/
+  std::vector<std::pair<std::string, int64_t>> samples(void) const;
+
+  /**
+   * Returns the metrics in the Prometheus text exposition format
+   * @param  prefix  text added to the front of each metric name
+   * @return  the metrics text. Histograms are exported as summaries.
+   **/
+  std::string to_prometheus(const std::string& prefix = "madara_") const;
+
+  /**
+   * Saves the metrics in the Prometheus text exposition format. The file
+   * is written beside the target and renamed into place, so scrapers
+   * never read a partial file.
+   * @param  filename  the file to write
+   * @param  prefix    text added to the front of each metric name
+   * @return  true if the file was written
+   **/
+  bool save_prometheus(
+      const std::string& filename, const std::string& prefix = "madara_") const;
+
+  /**
+   * Returns the number of metrics
+   * @return  the number of registered metrics
+   **/
+  size_t size(void) const;
+
+private:
+  /**
+   * A registered metric
+   **/
+  struct Entry
+  {
+    /// the kind of metric
+    Type type;
+
+    /// the description
+    std::string help;
+
+    /// the counter, if type is COUNTER
+    std::unique_ptr<Counter> counter;
+
+    /// the gauge, if type is GAUGE
+    std::unique_ptr<Gauge> gauge;
+
+    /// the histogram, if type is HISTOGRAM
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  /**
+   * Returns a metric, creating it if needed
+   * @param  name    the name of the metric
+   * @param  help    a description used when the metric is created
+   * @param  type    the kind of metric
+   * @return  the metric entry
+   * @throw exceptions::NameException  name is already another type
+   **/
+  Entry& find(const std::string& name, const std::string& help, Type type);
+
+  /// protects metrics_
+  mutable std::mutex mutex_;
+
+  /// the metrics by name
+  std::map<std::string, Entry> metrics_;
+
+  /// protects bundles_
+  std::mutex bundles_mutex_;
+
+  /// bundles by type
+  std::vector<std::pair<std::type_index, std::shared_ptr<void>>> bundles_;
+};
+}
+}
+
+#endif  // _MADARA_UTILITY_METRICS_H_
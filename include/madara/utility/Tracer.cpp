@@ -0,0 +1,366 @@
+#include "Tracer.h"
+#include "madara/logger/Logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * A ring of the newest spans of one thread. The owning thread writes
+ * spans without locking. Exports copy spans concurrently and discard any
+ * that were overwritten while copying.
+ **/
+class Tracer::Buffer
+{
+public:
+  /**
+   * A recorded span
+   **/
+  struct Slot
+  {
+    std::atomic<const char*> name;
+    std::atomic<int64_t> start;
+    std::atomic<int64_t> duration;
+  };
+
+  Buffer(uint64_t buffer_generation, uint64_t buffer_id, size_t spans)
+    : generation(buffer_generation),
+      id(buffer_id),
+      size(std::max(spans, (size_t)1)),
+      slots(new Slot[size])
+  {
+  }
+
+  /**
+   * Writes a span. Only call from the owning thread.
+   **/
+  inline void push(const char* name, int64_t start, int64_t duration)
+  {
+    uint64_t index = count.load(std::memory_order_relaxed);
+
+    // tell exports the slot is being overwritten before touching it
+    begun.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Slot& slot = slots[index % size];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+
+    count.store(index + 1, std::memory_order_release);
+  }
+
+  /// the clear generation that the buffer belongs to
+  const uint64_t generation;
+
+  /// the thread id used in exported traces
+  const uint64_t id;
+
+  /// the number of slots
+  const size_t size;
+
+  /// the spans
+  std::unique_ptr<Slot[]> slots;
+
+  /// the number of spans ever written
+  std::atomic<uint64_t> count{0};
+
+  /// the number of spans ever started, which is at most count + 1
+  std::atomic<uint64_t> begun{0};
+
+  /// the owning thread
+  const std::thread::id owner = std::this_thread::get_id();
+
+  /// protects name
+  std::mutex mutex;
+
+  /// the thread name used in exported traces
+  std::string name;
+};
+
+namespace
+{
+/// protects buffers
+std::mutex buffers_mutex;
+
+/// buffers of the current generation, one per thread that recorded
+std::vector<std::shared_ptr<Tracer::Buffer>> buffers;
+
+/// incremented whenever recorded spans are cleared
+std::atomic<uint64_t> generation{0};
+
+/// the number of spans kept by new buffers
+std::atomic<size_t> capacity{65536};
+
+/// the id of the next buffer
+uint64_t next_id = 1;
+
+#ifndef MADARA_NO_THREAD_LOCAL
+/// the buffer of the calling thread
+thread_local std::shared_ptr<Tracer::Buffer> local_buffer;
+
+/// the name of the calling thread set with Tracer::set_thread_name
+thread_local std::string local_name;
+#endif
+
+/// escapes a string for use in JSON
+void append_escaped(std::string& json, const std::string& text)
+{
+  for (char c : text)
+  {
+    if (c == '"' || c == '\\')
+    {
+      json += '\\';
+      json += c;
+    }
+    else if ((unsigned char)c < 0x20)
+    {
+      char code[8];
+      snprintf(code, sizeof(code), "\\u%04x", (unsigned)c);
+      json += code;
+    }
+    else
+    {
+      json += c;
+    }
+  }
+}
+
+/// returns the process id used in exported traces
+int process_id(void)
+{
+#ifdef _WIN32
+  return _getpid();
+#else
+  return (int)getpid();
+#endif
+}
+}
+
+std::atomic<bool> Tracer::enabled_{false};
+
+void Tracer::enable(size_t spans_per_thread)
+{
+  if (capacity.exchange(spans_per_thread) != spans_per_thread)
+  {
+    clear();
+  }
+
+  enabled_ = true;
+}
+
+void Tracer::disable(void)
+{
+  enabled_ = false;
+}
+
+void Tracer::clear(void)
+{
+  std::lock_guard<std::mutex> guard(buffers_mutex);
+
+  // threads holding old buffers replace them on their next span
+  ++generation;
+  buffers.clear();
+}
+
+Tracer::Buffer* Tracer::thread_buffer(void)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  if (local_buffer &&
+      local_buffer->generation == generation.load(std::memory_order_acquire))
+  {
+    return local_buffer.get();
+  }
+#endif
+
+  std::lock_guard<std::mutex> guard(buffers_mutex);
+
+#ifdef MADARA_NO_THREAD_LOCAL
+  for (auto& buffer : buffers)
+  {
+    if (buffer->owner == std::this_thread::get_id())
+    {
+      return buffer.get();
+    }
+  }
+#endif
+
+  std::shared_ptr<Buffer> buffer(
+      new Buffer(generation.load(), next_id++, capacity.load()));
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  // default to the name that the thread logs with
+  buffer->name =
+      local_name != "" ? local_name : logger::Logger::get_thread_name();
+
+  local_buffer = buffer;
+#endif
+
+  buffers.push_back(buffer);
+
+  return buffer.get();
+}
+
+void Tracer::record(const char* name, int64_t start, int64_t end)
+{
+  // wall clock adjustments may move end before start
+  thread_buffer()->push(name, start, std::max(end - start, (int64_t)0));
+}
+
+void Tracer::set_thread_name(const std::string& name)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  // threads that have not recorded yet get a buffer with their first span
+  local_name = name;
+
+  if (!local_buffer)
+  {
+    return;
+  }
+
+  Buffer* buffer = local_buffer.get();
+#else
+  Buffer* buffer = thread_buffer();
+#endif
+
+  std::lock_guard<std::mutex> guard(buffer->mutex);
+  buffer->name = name;
+}
+
+size_t Tracer::size(void)
+{
+  std::lock_guard<std::mutex> guard(buffers_mutex);
+
+  size_t result = 0;
+
+  for (auto& buffer : buffers)
+  {
+    result += (size_t)std::min(
+        buffer->count.load(std::memory_order_acquire), (uint64_t)buffer->size);
+  }
+
+  return result;
+}
+
+size_t Tracer::append_events(std::string& json)
+{
+  std::vector<std::shared_ptr<Buffer>> copies;
+
+  {
+    std::lock_guard<std::mutex> guard(buffers_mutex);
+    copies = buffers;
+  }
+
+  int pid = process_id();
+  size_t events = 0;
+  size_t result = 0;
+  char event[256];
+
+  struct Span
+  {
+    const char* name;
+    int64_t start;
+    int64_t duration;
+  };
+
+  std::vector<Span> spans;
+
+  for (auto& buffer : copies)
+  {
+    std::string name;
+
+    {
+      std::lock_guard<std::mutex> guard(buffer->mutex);
+      name = buffer->name;
+    }
+
+    if (name != "")
+    {
+      snprintf(event, sizeof(event),
+          "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"tid\":%" PRIu64 ",\"args\":{\"name\":\"",
+          events > 0 ? ",\n" : "\n", pid, buffer->id);
+      json += event;
+      append_escaped(json, name);
+      json += "\"}}";
+      ++events;
+    }
+
+    uint64_t end = buffer->count.load(std::memory_order_acquire);
+    uint64_t first = end > buffer->size ? end - buffer->size : 0;
+
+    spans.clear();
+
+    for (uint64_t i = first; i < end; ++i)
+    {
+      Buffer::Slot& slot = buffer->slots[i % buffer->size];
+      spans.push_back({slot.name.load(std::memory_order_relaxed),
+          slot.start.load(std::memory_order_relaxed),
+          slot.duration.load(std::memory_order_relaxed)});
+    }
+
+    // spans that the owner started overwriting while we copied are torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t begun = buffer->begun.load(std::memory_order_relaxed);
+    uint64_t valid = begun > buffer->size ? begun - buffer->size : 0;
+
+    for (uint64_t i = std::max(first, valid); i < end; ++i)
+    {
+      const Span& span = spans[i - first];
+
+      snprintf(event, sizeof(event),
+          "%s{\"name\":\"%s\",\"cat\":\"madara\",\"ph\":\"X\","
+          "\"ts\":%" PRId64 ".%03d,\"dur\":%" PRId64 ".%03d,"
+          "\"pid\":%d,\"tid\":%" PRIu64 "}",
+          events > 0 ? ",\n" : "\n", span.name, span.start / 1000,
+          (int)(span.start % 1000), span.duration / 1000,
+          (int)(span.duration % 1000), pid, buffer->id);
+      json += event;
+      ++events;
+      ++result;
+    }
+  }
+
+  return result;
+}
+
+std::string Tracer::to_chrome_trace(void)
+{
+  std::string json("{\"traceEvents\":[");
+  append_events(json);
+  json += "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  return json;
+}
+
+int64_t Tracer::save_chrome_trace(const std::string& filename)
+{
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+
+  if (!file)
+  {
+    return -1;
+  }
+
+  std::string json("{\"traceEvents\":[");
+  size_t spans = append_events(json);
+  json += "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  file << json;
+
+  return file ? (int64_t)spans : -1;
+}
+}
+}
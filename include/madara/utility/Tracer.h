@@ -0,0 +1,188 @@
+#ifndef _MADARA_UTILITY_TRACER_H_
+#define _MADARA_UTILITY_TRACER_H_
+
+/**
+ * @file Tracer.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the Tracer class, which records timed spans into
+ * per-thread buffers and exports them as Chrome trace JSON, and the
+ * MADARA_TRACE_SPAN macro used to instrument MADARA internals
+ **/
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include "madara/MadaraExport.h"
+#include "IntTypes.h"
+#include "Utility.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class Tracer
+ * @brief Records named spans of time into a ring per thread. Recording
+ *        is lock-free and is skipped entirely while tracing is disabled,
+ *        so instrumented code costs one relaxed load when not in use.
+ *        Each ring keeps the newest spans of its thread. Spans may be
+ *        exported at any time as Chrome trace JSON, which Perfetto and
+ *        chrome://tracing both load.
+ **/
+class MADARA_EXPORT Tracer
+{
+public:
+  /**
+   * Starts recording spans
+   * @param  spans_per_thread  the number of spans each thread keeps
+   **/
+  static void enable(size_t spans_per_thread = 65536);
+
+  /**
+   * Stops recording spans. Recorded spans are kept for export.
+   **/
+  static void disable(void);
+
+  /**
+   * Checks if spans are being recorded
+   * @return  true if tracing is enabled
+   **/
+  static inline bool is_enabled(void)
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Forgets all recorded spans
+   **/
+  static void clear(void);
+
+  /**
+   * Records a span for the calling thread
+   * @param  name    the span name. Must outlive the tracer, e.g.,
+   *                 a string literal.
+   * @param  start   the start of the span in nanoseconds
+   * @param  end     the end of the span in nanoseconds
+   **/
+  static void record(const char* name, int64_t start, int64_t end);
+
+  /**
+   * Names the calling thread in exported traces
+   * @param  name    the thread name
+   **/
+  static void set_thread_name(const std::string& name);
+
+  /**
+   * Returns the number of spans available for export
+   * @return  the number of recorded spans kept in all threads
+   **/
+  static size_t size(void);
+
+  /**
+   * Returns the recorded spans as Chrome trace JSON
+   * @return  the JSON trace
+   **/
+  static std::string to_chrome_trace(void);
+
+  /**
+   * Saves the recorded spans as a Chrome trace JSON file
+   * @param  filename  the file to write
+   * @return  the number of spans written, or -1 if the file could not
+   *          be opened
+   **/
+  static int64_t save_chrome_trace(const std::string& filename);
+
+  /// the span ring of one thread, defined in Tracer.cpp
+  class Buffer;
+
+private:
+  /**
+   * Returns the buffer of the calling thread, creating it if needed
+   * @return  the buffer of the calling thread
+   **/
+  static Buffer* thread_buffer(void);
+
+  /**
+   * Appends the JSON events of all buffers
+   * @param  json    the string to append to
+   * @return  the number of spans appended, excluding thread names
+   **/
+  static size_t append_events(std::string& json);
+
+  /// true while spans are recorded
+  static std::atomic<bool> enabled_;
+};
+
+/**
+ * @class TraceSpan
+ * @brief Records a span from construction until end or destruction.
+ *        Use MADARA_TRACE_SPAN so the span compiles away when
+ *        MADARA_NO_TRACING is defined.
+ **/
+class TraceSpan
+{
+public:
+  /**
+   * Constructor. Starts the span if tracing is enabled.
+   * @param  name    the span name. Must outlive the tracer, e.g.,
+   *                 a string literal.
+   **/
+  inline explicit TraceSpan(const char* name)
+    : name_(Tracer::is_enabled() ? name : nullptr),
+      start_(name_ ? get_time() : 0)
+  {
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  /**
+   * Destructor. Ends the span if it has not been ended.
+   **/
+  inline ~TraceSpan()
+  {
+    end();
+  }
+
+  /**
+   * Ends the span early
+   **/
+  inline void end(void)
+  {
+    if (name_)
+    {
+      Tracer::record(name_, start_, get_time());
+      name_ = nullptr;
+    }
+  }
+
+private:
+  /// the span name, or null if the span is not recorded
+  const char* name_;
+
+  /// when the span started, in nanoseconds
+  int64_t start_;
+};
+}
+}
+
+#define MADARA_TRACE_CONCAT_(a, b) a##b
+#define MADARA_TRACE_CONCAT(a, b) MADARA_TRACE_CONCAT_(a, b)
+
+#ifndef MADARA_NO_TRACING
+
+/**
+ * Records a span named name until the end of the enclosing scope
+ **/
+#define MADARA_TRACE_SPAN(name)                     \
+  ::madara::utility::TraceSpan MADARA_TRACE_CONCAT( \
+      madara_trace_span_, __LINE__)(name)
+
+#else
+
+#define MADARA_TRACE_SPAN(name)
+
+#endif  // MADARA_NO_TRACING
+
+#endif  // _MADARA_UTILITY_TRACER_H_
@@ -16,6 +16,14 @@
 #include "Utility.h"
 #include "Timer.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
 namespace madara
 {
 namespace utility
@@ -387,6 +395,106 @@ char* get_var(const std::string& source, size_t cur, size_t& end)
   return getenv(source.substr(cur, source.size() - cur).c_str());
 }
 
+bool set_thread_affinity(const std::vector<int>& cores)
+{
+  if (cores.empty())
+  {
+    return true;
+  }
+
+  bool result = false;
+
+#ifdef _WIN32
+  DWORD_PTR mask = 0;
+
+  for (int core : cores)
+  {
+    if (core >= 0 && core < (int)(sizeof(mask) * 8))
+      mask |= DWORD_PTR(1) << core;
+  }
+
+  result = mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  for (int core : cores)
+  {
+    if (core >= 0 && core < CPU_SETSIZE)
+      CPU_SET(core, &set);
+  }
+
+  result = CPU_COUNT(&set) > 0 &&
+           0 == pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+
+  madara_logger_ptr_log(logger::global_logger.get(),
+      result ? logger::LOG_MAJOR : logger::LOG_WARNING,
+      "utility::set_thread_affinity:"
+      " %s affinity to %d cores\n",
+      result ? "set" : "unable to set", (int)cores.size());
+
+  return result;
+}
+
+bool set_thread_scheduling(int policy, int priority)
+{
+  bool result = false;
+
+#ifdef _WIN32
+  if (policy == 0)
+  {
+    result = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL) != 0;
+  }
+  else
+  {
+    result = set_thread_priority(priority);
+  }
+#else
+  int native_policy = SCHED_OTHER;
+
+  if (policy == 1)
+    native_policy = SCHED_FIFO;
+  else if (policy == 2)
+    native_policy = SCHED_RR;
+
+  sched_param sch;
+  sch.sched_priority = native_policy == SCHED_OTHER ? 0 : priority;
+
+  result = 0 == pthread_setschedparam(pthread_self(), native_policy, &sch);
+#endif
+
+  madara_logger_ptr_log(logger::global_logger.get(),
+      result ? logger::LOG_MAJOR : logger::LOG_WARNING,
+      "utility::set_thread_scheduling:"
+      " %s policy %d at priority %d\n",
+      result ? "set" : "unable to set", policy, priority);
+
+  return result;
+}
+
+bool lock_memory(void)
+{
+  // mlockall covers the whole process, so only the first caller locks
+  static const bool result = []() {
+    bool locked = false;
+
+#ifndef _WIN32
+    locked = 0 == mlockall(MCL_CURRENT | MCL_FUTURE);
+#endif
+
+    madara_logger_ptr_log(logger::global_logger.get(),
+        locked ? logger::LOG_MAJOR : logger::LOG_WARNING,
+        "utility::lock_memory:"
+        " %s process memory\n",
+        locked ? "locked" : "unable to lock");
+
+    return locked;
+  }();
+
+  return result;
+}
+
 std::string clean_dir_name(const std::string& source)
 {
 // define the characters we'll want to replace
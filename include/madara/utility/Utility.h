@@ -42,6 +42,31 @@ typedef std::chrono::time_point<Clock> TimeValue;
  **/
 MADARA_EXPORT bool set_thread_priority(int priority = 20);
 
+/**
+ * Restricts the calling thread to a set of CPU cores
+ * @param     cores        the cores the thread may run on. If empty, the
+ *                         call does nothing and returns true.
+ * @return    true if set call was successful
+ **/
+MADARA_EXPORT bool set_thread_affinity(const std::vector<int>& cores);
+
+/**
+ * Sets the scheduling policy and priority of the calling thread
+ * @param     policy       0 for the default policy, 1 for SCHED_FIFO,
+ *                         2 for SCHED_RR
+ * @param     priority     the priority within the policy
+ * @return    true if set call was successful
+ **/
+MADARA_EXPORT bool set_thread_scheduling(int policy, int priority);
+
+/**
+ * Locks all current and future pages of the process into memory to
+ * avoid page faults in time-critical threads. The lock is process-wide,
+ * so only the first call locks; later calls return its result.
+ * @return    true if the memory was locked
+ **/
+MADARA_EXPORT bool lock_memory(void);
+
 /**
  * Gets the MADARA version number
  * @return    the MADARA version number
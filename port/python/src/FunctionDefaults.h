@@ -32,23 +32,12 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_to_string_0_of_1, to_string, 0, 1)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_get_1_of_2, get, 1, 2)
 
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_send_modifieds_0_of_2, send_modifieds, 0, 2)
-
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_load_context_1_of_2, load_context, 1, 2)
-
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_load_context_1_of_3, load_context, 1, 3)
-
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_set_2_of_3, set, 2, 3)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_set_index_2_of_3, set_index, 3, 4)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_eval_1_of_2, evaluate, 1, 2)
 
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_wait_1_of_2, wait, 1, 2)
-
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_print_1_of_2, print, 1, 2)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_print_0_of_1, print, 0, 1)
@@ -59,18 +48,6 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
     m_retrieve_index_2_of_3, retrieve_index, 2, 3)
 
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_save_as_json_1_of_1, save_as_json, 1, 1)
-
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_save_as_karl_1_of_1, save_as_karl, 1, 1)
-
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_save_context_1_of_1, save_context, 1, 1)
-
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
-    m_save_checkpoint_1_of_1, save_checkpoint, 1, 1)
-
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_resize_1_of_1, resize, 1, 1)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(m_resize_0_of_2, resize, 0, 2)
@@ -70,6 +70,9 @@ BOOST_PYTHON_MODULE(madara)
       "IntegerVector")
       .def(vector_indexing_suite<std::vector<int64_t>>());
 
+  class_<std::vector<int>>("IntVector")
+      .def(vector_indexing_suite<std::vector<int>>());
+
   class_<std::vector<double>>("DoubleVector")
       .def(vector_indexing_suite<std::vector<double>>());
 
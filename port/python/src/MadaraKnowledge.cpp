@@ -7,6 +7,8 @@
 #include <boost/python/dict.hpp>
 #include <boost/python/import.hpp>
 #include <boost/python/enum.hpp>
+#include <boost/python/make_function.hpp>
+#include <boost/mpl/vector.hpp>
 
 #include "madara/knowledge/KnowledgeBase.h"
 #include "madara/knowledge/FileFragmenter.h"
@@ -14,6 +16,7 @@
 #include "madara/knowledge/CheckpointPlayer.h"
 #include "madara/knowledge/AnyRegistry.h"
 #include "madara/filters/GenericFilters.h"
+#include "madara/python/Release_GIL.h"
 #include "FunctionDefaults.h"
 #include "MadaraKnowledgeContainers.h"
 #include "MadaraKnowledge.h"
@@ -83,6 +86,170 @@ static std::map<uint64_t,
     const std::pair<const std::string, DontDestruct<object>>*>
     registered_tags;
 
+/**
+ * Calls a member function without holding the GIL
+ **/
+template<typename M, typename R, typename C, typename... Args>
+struct WithoutGIL
+{
+  M method;
+
+  R operator()(C& self, Args... args) const
+  {
+    madara::python::Release_GIL release_gil;
+    return (self.*method)(args...);
+  }
+};
+
+/**
+ * Wraps a blocking member function so that other Python threads can run
+ * while it executes. Python functions and filters called from within
+ * (e.g., by evaluate, wait or send_modifieds) take the GIL back themselves
+ * while the knowledge base lock is held, so every binding that may wait on
+ * the knowledge base lock, such as get and set, must be wrapped too.
+ * Otherwise, a thread holding the GIL while it waits on the knowledge base
+ * lock deadlocks with such a callback.
+ **/
+template<typename R, typename C, typename... Args, typename Keywords>
+object without_gil(R (C::*method)(Args...), const Keywords& keywords)
+{
+  return make_function(WithoutGIL<R (C::*)(Args...), R, C, Args...>{method},
+      default_call_policies(), keywords, boost::mpl::vector<R, C&, Args...>());
+}
+
+template<typename R, typename C, typename... Args, typename Keywords>
+object without_gil(R (C::*method)(Args...) const, const Keywords& keywords)
+{
+  return make_function(
+      WithoutGIL<R (C::*)(Args...) const, R, C, Args...>{method},
+      default_call_policies(), keywords, boost::mpl::vector<R, C&, Args...>());
+}
+
+template<typename R, typename C>
+object without_gil(R (C::*method)(void))
+{
+  return make_function(WithoutGIL<R (C::*)(void), R, C>{method},
+      default_call_policies(), boost::mpl::vector<R, C&>());
+}
+
+/**
+ * A Python object exporting a read-only buffer over a shared
+ * KnowledgeRecord array. It holds a reference to the array, so views
+ * built on it stay valid after the record changes.
+ **/
+struct SharedBuffer
+{
+  PyObject_HEAD
+
+  /// keeps the shared array alive
+  std::shared_ptr<const void>* owner;
+
+  /// the first element
+  const void* data;
+
+  /// the number of elements
+  Py_ssize_t size;
+
+  /// the size of each element
+  Py_ssize_t itemsize;
+
+  /// the struct module format of each element
+  const char* format;
+};
+
+static int shared_buffer_get(PyObject* self, Py_buffer* view, int flags)
+{
+  SharedBuffer* buffer = (SharedBuffer*)self;
+
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+  {
+    PyErr_SetString(PyExc_BufferError, "shared records are read-only");
+    view->obj = 0;
+    return -1;
+  }
+
+  view->obj = self;
+  Py_INCREF(self);
+  view->buf = (void*)buffer->data;
+  view->len = buffer->size * buffer->itemsize;
+  view->readonly = 1;
+  view->itemsize = buffer->itemsize;
+  view->format =
+      (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? (char*)buffer->format : 0;
+  view->ndim = 1;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &buffer->size : 0;
+  view->strides =
+      (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &buffer->itemsize : 0;
+  view->suboffsets = 0;
+  view->internal = 0;
+
+  return 0;
+}
+
+static void shared_buffer_dealloc(PyObject* self)
+{
+  delete ((SharedBuffer*)self)->owner;
+  Py_TYPE(self)->tp_free(self);
+}
+
+static PyBufferProcs shared_buffer_procs;
+
+static PyTypeObject shared_buffer_type = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+/**
+ * Creates a read-only memoryview of a shared array without copying it
+ * @param  shared   the shared array
+ * @param  format   the struct module format of each element
+ * @return  a memoryview, or None if shared is empty
+ **/
+template<typename T>
+object share_view(std::shared_ptr<const std::vector<T>> shared,
+    const char* format)
+{
+  if (!shared)
+  {
+    return object();
+  }
+
+  if (shared_buffer_type.tp_as_buffer == 0)
+  {
+    shared_buffer_procs.bf_getbuffer = shared_buffer_get;
+
+    shared_buffer_type.tp_name = "madara.knowledge.SharedBuffer";
+    shared_buffer_type.tp_basicsize = sizeof(SharedBuffer);
+    shared_buffer_type.tp_dealloc = shared_buffer_dealloc;
+    shared_buffer_type.tp_flags = Py_TPFLAGS_DEFAULT
+#if PY_MAJOR_VERSION < 3
+                                  | Py_TPFLAGS_HAVE_NEWBUFFER
+#endif
+        ;
+    shared_buffer_type.tp_doc = "Read-only buffer over a shared record";
+    shared_buffer_type.tp_as_buffer = &shared_buffer_procs;
+
+    if (PyType_Ready(&shared_buffer_type) < 0)
+    {
+      throw_error_already_set();
+    }
+  }
+
+  SharedBuffer* buffer = PyObject_New(SharedBuffer, &shared_buffer_type);
+
+  if (!buffer)
+  {
+    throw_error_already_set();
+  }
+
+  buffer->owner = new std::shared_ptr<const void>(shared);
+  buffer->data = shared->data();
+  buffer->size = (Py_ssize_t)shared->size();
+  buffer->itemsize = (Py_ssize_t)sizeof(T);
+  buffer->format = format;
+
+  handle<> owner((PyObject*)buffer);
+
+  return object(handle<>(PyMemoryView_FromObject(owner.get())));
+}
+
 #define MADARA_MEMB(ret, klass, name, args) \
   static_cast<ret(klass::*) args>(&klass::name)
 
@@ -815,6 +982,31 @@ void define_knowledge(void)
           "@return a shared_ptr, sharing with the internal one."
           "If this record is not an int array, returns NULL shared_ptr")
 
+      // zero-copy views of shared arrays
+      .def("view_binary",
+          +[](const madara::knowledge::KnowledgeRecord& record) {
+            return share_view(record.share_binary(), "B");
+          },
+          "@return a read-only memoryview of the binary value that shares "
+          "the record's buffer (e.g., numpy.frombuffer). "
+          "If this record is not a binary file value, returns None")
+
+      .def("view_doubles",
+          +[](const madara::knowledge::KnowledgeRecord& record) {
+            return share_view(record.share_doubles(), "d");
+          },
+          "@return a read-only memoryview of the doubles array that shares "
+          "the record's buffer (e.g., numpy.asarray). "
+          "If this record is not a doubles array, returns None")
+
+      .def("view_integers",
+          +[](const madara::knowledge::KnowledgeRecord& record) {
+            return share_view(record.share_integers(), "q");
+          },
+          "@return a read-only memoryview of the integer array that shares "
+          "the record's buffer (e.g., numpy.asarray). "
+          "If this record is not an int array, returns None")
+
       // sets the contents of the record to a jpeg
       .def("size", &madara::knowledge::KnowledgeRecord::size,
           "Returns the size of the value")
@@ -1187,13 +1379,17 @@ void define_knowledge(void)
 
       // get a knowledge record
       .def("get",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::Variables::*)(
-              const madara::knowledge::VariableReference&,
-              const madara::knowledge::KnowledgeReferenceSettings&)>(
-              &madara::knowledge::Variables::get),
-          m_get_1_of_2(args("variable", "settings"),
-              "Retrieves the value of a variable"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::Variables::*)(
+                  const madara::knowledge::VariableReference&,
+                  const madara::knowledge::KnowledgeReferenceSettings&)>(
+                  &madara::knowledge::Variables::get),
+              (arg("variable"),
+                  arg("settings") =
+                      madara::knowledge::KnowledgeReferenceSettings(
+                          false))),
+          "Retrieves the value of a variable")
 
       // converts to a string
       .def("get_ref", &madara::knowledge::Variables::get_ref,
@@ -1570,32 +1766,39 @@ void define_knowledge(void)
 
       // evaluate an expression
       .def("evaluate",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(
-              const std::string&, const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::evaluate),
-          m_eval_1_of_2(
-              args("expression", "settings"), "Evaluates an expression"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(const std::string&,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::evaluate),
+              (arg("expression"),
+                  arg("settings") = madara::knowledge::EvalSettings())),
+          "Evaluates an expression. Releases the GIL while evaluating")
 
       // evaluate an expression
       .def("evaluate",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(
-              madara::knowledge::CompiledExpression&,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::evaluate),
-          m_eval_1_of_2(
-              args("expression", "settings"), "Evaluates an expression"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(
+                  madara::knowledge::CompiledExpression&,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::evaluate),
+              (arg("expression"),
+                  arg("settings") = madara::knowledge::EvalSettings())),
+          "Evaluates an expression. Releases the GIL while evaluating")
 
       // Evaluates a root-based tree
       .def("evaluate",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(
-              madara::expression::ComponentNode * root,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::evaluate),
-          m_eval_1_of_2(args("expression", "settings"),
-              "Evaluates a root-based tree (result of compile)"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(
+                  madara::expression::ComponentNode * root,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::evaluate),
+              (arg("expression"),
+                  arg("settings") = madara::knowledge::EvalSettings())),
+          "Evaluates a root-based tree (result of compile). Releases the GIL "
+          "while evaluating")
 
       // load and evaluate KaRL file
       .def("evaluate_file", &madara::knowledge::KnowledgeBase::evaluate_file,
@@ -1635,21 +1838,30 @@ void define_knowledge(void)
 
       // Retrieve a knowledge value
       .def("get",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(const std::string&,
-              const madara::knowledge::KnowledgeReferenceSettings&)>(
-              &madara::knowledge::KnowledgeBase::get),
-          m_get_1_of_2(args("key", "settings"), "Retrieves a knowledge value"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(const std::string&,
+                  const madara::knowledge::KnowledgeReferenceSettings&)>(
+                  &madara::knowledge::KnowledgeBase::get),
+              (arg("key"),
+                  arg("settings") =
+                      madara::knowledge::KnowledgeReferenceSettings(
+                          false))),
+          "Retrieves a knowledge value")
 
       // get a knowledge record
       .def("get",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(
-              const madara::knowledge::VariableReference&,
-              const madara::knowledge::KnowledgeReferenceSettings&)>(
-              &madara::knowledge::KnowledgeBase::get),
-          m_get_1_of_2(args("variable", "settings"),
-              "Atomically returns the value of a variable."))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(
+                  const madara::knowledge::VariableReference&,
+                  const madara::knowledge::KnowledgeReferenceSettings&)>(
+                  &madara::knowledge::KnowledgeBase::get),
+              (arg("variable"),
+                  arg("settings") =
+                      madara::knowledge::KnowledgeReferenceSettings(
+                          false))),
+          "Atomically returns the value of a variable.")
 
       // get entire stored history
       .def("get_history",
@@ -1864,31 +2076,41 @@ void define_knowledge(void)
 
       // expands and prints a statement
       .def("load_context",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, bool,
-              const madara::knowledge::KnowledgeUpdateSettings&)>(
-              &madara::knowledge::KnowledgeBase::load_context),
-          m_load_context_1_of_3(args("filename", "use_id", "settings"),
-              "Loads a variable context from a file"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&, bool,
+                  const madara::knowledge::KnowledgeUpdateSettings&)>(
+                  &madara::knowledge::KnowledgeBase::load_context),
+              (arg("filename"), arg("use_id") = true,
+                  arg("settings") = madara::knowledge::KnowledgeUpdateSettings(
+                      true, true, true, false))),
+          "Loads a variable context from a file")
 
       // expands and prints a statement
       .def("load_context",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, FileHeader&, bool use_id,
-              const madara::knowledge::KnowledgeUpdateSettings&)>(
-              &madara::knowledge::KnowledgeBase::load_context),
-          m_load_context_1_of_3(args("filename", "use_id", "settings"),
-              "Loads a variable context from a file"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&, FileHeader&, bool use_id,
+                  const madara::knowledge::KnowledgeUpdateSettings&)>(
+                  &madara::knowledge::KnowledgeBase::load_context),
+              (arg("filename"), arg("meta"), arg("use_id") = true,
+                  arg("settings") = madara::knowledge::KnowledgeUpdateSettings(
+                      true, true, true, false))),
+          "Loads a variable context from a file")
 
       // expands and prints a statement
       .def("load_context",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              madara::knowledge::CheckpointSettings&,
-              const madara::knowledge::KnowledgeUpdateSettings&)>(
-              &madara::knowledge::KnowledgeBase::load_context),
-          m_load_context_1_of_2(args("checkpoint_settings", "update_settings"),
-              "Loads a variable context from a file with settings "
-              "for checkpoint and knowledge updates"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  madara::knowledge::CheckpointSettings&,
+                  const madara::knowledge::KnowledgeUpdateSettings&)>(
+                  &madara::knowledge::KnowledgeBase::load_context),
+              (arg("checkpoint_settings"),
+                  arg("update_settings") =
+                      madara::knowledge::KnowledgeUpdateSettings(
+                          true, true, true, false))),
+          "Loads a variable context from a file with settings "
+          "for checkpoint and knowledge updates")
 
       // locks the knowledge base from updates from other threads
       .def("lock", &madara::knowledge::KnowledgeBase::lock,
@@ -1981,69 +2203,77 @@ void define_knowledge(void)
 
       // saves the context as JSON
       .def("save_as_json",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const std::string&) const>(
-              &madara::knowledge::KnowledgeBase::save_as_json),
-          m_save_as_json_1_of_1(
-              args("settings"), "Saves the context to a file as JSON"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&) const>(
+                  &madara::knowledge::KnowledgeBase::save_as_json),
+              (arg("settings"))),
+          "Saves the context to a file as JSON")
 
       // saves the context as JSON
       .def("save_as_json",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const madara::knowledge::CheckpointSettings&) const>(
-              &madara::knowledge::KnowledgeBase::save_as_json),
-          m_save_as_json_1_of_1(
-              args("settings"), "Saves the context to a file as JSON"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const madara::knowledge::CheckpointSettings&) const>(
+                  &madara::knowledge::KnowledgeBase::save_as_json),
+              (arg("settings"))),
+          "Saves the context to a file as JSON")
 
       // saves the context as karl
       .def("save_as_karl",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const std::string&) const>(
-              &madara::knowledge::KnowledgeBase::save_as_karl),
-          m_save_as_karl_1_of_1(args("settings"), "Saves the context to a file "
-                                                  "as karl assignments, rather "
-                                                  "than binary"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&) const>(
+                  &madara::knowledge::KnowledgeBase::save_as_karl),
+              (arg("settings"))),
+          "Saves the context to a file as karl assignments, rather "
+          "than binary")
 
       // saves the context as karl
       .def("save_as_karl",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const madara::knowledge::CheckpointSettings&) const>(
-              &madara::knowledge::KnowledgeBase::save_as_karl),
-          m_save_as_karl_1_of_1(args("settings"), "Saves the context to a file "
-                                                  "as karl assignments, rather "
-                                                  "than binary"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const madara::knowledge::CheckpointSettings&) const>(
+                  &madara::knowledge::KnowledgeBase::save_as_karl),
+              (arg("settings"))),
+          "Saves the context to a file as karl assignments, rather "
+          "than binary")
 
       // saves a diff of the context as binary
       .def("save_checkpoint",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, bool reset_modifieds)>(
-              &madara::knowledge::KnowledgeBase::save_checkpoint),
-          m_save_checkpoint_1_of_1(args("settings"),
-              "Saves a checkpoint of a list of changes to a file"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&, bool reset_modifieds)>(
+                  &madara::knowledge::KnowledgeBase::save_checkpoint),
+              (arg("settings"), arg("reset_modifieds") = true)),
+          "Saves a checkpoint of a list of changes to a file")
 
       // saves a diff of the context as binary
       .def("save_checkpoint",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              madara::knowledge::CheckpointSettings&) const>(
-              &madara::knowledge::KnowledgeBase::save_checkpoint),
-          m_save_checkpoint_1_of_1(args("settings"),
-              "Saves a checkpoint of a list of changes to a file"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  madara::knowledge::CheckpointSettings&) const>(
+                  &madara::knowledge::KnowledgeBase::save_checkpoint),
+              (arg("settings"))),
+          "Saves a checkpoint of a list of changes to a file")
 
       // saves the context as binary
       .def("save_context",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              const std::string&) const>(
-              &madara::knowledge::KnowledgeBase::save_context),
-          m_save_context_1_of_1(
-              args("settings"), "Saves the context to a file"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&) const>(
+                  &madara::knowledge::KnowledgeBase::save_context),
+              (arg("settings"))),
+          "Saves the context to a file")
 
       // saves the context as binary
       .def("save_context",
-          static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
-              madara::knowledge::CheckpointSettings&) const>(
-              &madara::knowledge::KnowledgeBase::save_context),
-          m_save_context_1_of_1(
-              args("settings"), "Saves the context to a file with settings"))
+          without_gil(
+              static_cast<int64_t (madara::knowledge::KnowledgeBase::*)(
+                  madara::knowledge::CheckpointSettings&) const>(
+                  &madara::knowledge::KnowledgeBase::save_context),
+              (arg("settings"))),
+          "Saves the context to a file with settings")
 
       // Saves the list of modified records to use later for resending
       .def("save_modifieds", &madara::knowledge::KnowledgeBase::save_modifieds,
@@ -2057,77 +2287,105 @@ void define_knowledge(void)
 
       // Sends all modified variables through the attached transports
       .def("send_modifieds",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::send_modifieds),
-          m_send_modifieds_0_of_2(args("prefix", "settings"),
-              "Sends all modified variables through the attached transports."))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::send_modifieds),
+              (arg("prefix") =
+                      std::string("KnowledgeBase::send_modifieds"),
+                  arg("settings") = madara::knowledge::EvalSettings::SEND)),
+          "Sends all modified variables through the attached transports. "
+          "Releases the GIL while sending")
 
       // sets a knowledge record to a specified value
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const VariableReference &,
-              const KnowledgeRecord &,
-              const EvalSettings & )>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Atomically sets the value of a variable to a KnowledgeRecord."))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const VariableReference &,
+                  const KnowledgeRecord &,
+                  const EvalSettings & )>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Atomically sets the value of a variable to a KnowledgeRecord.")
 
       // sets a knowledge record to a specified value
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string &,
-              const KnowledgeRecord &,
-              const EvalSettings & )>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Atomically sets the value of a variable to a KnowledgeRecord."))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string &,
+                  const KnowledgeRecord &,
+                  const EvalSettings & )>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Atomically sets the value of a variable to a KnowledgeRecord.")
 
       // sets a knowledge record to a double
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, double,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Sets a knowledge record to a double"))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&, double,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Sets a knowledge record to a double")
 
       // sets a knowledge record to an array of doubles
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, const std::vector<double>&,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Sets a knowledge record to an array of doubles"))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&, const std::vector<double>&,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Sets a knowledge record to an array of doubles")
 
       // sets a knowledge record to an integer
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, madara::knowledge::KnowledgeRecord::Integer,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Sets a knowledge record to an integer"))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&,
+                  madara::knowledge::KnowledgeRecord::Integer,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Sets a knowledge record to an integer")
 
       // sets a knowledge record to an array of integer
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string&,
-              const std::vector<madara::knowledge::KnowledgeRecord::Integer>&,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Sets a knowledge record to an array of integers"))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&,
+                  const std::vector<
+                      madara::knowledge::KnowledgeRecord::Integer>&,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Sets a knowledge record to an array of integers")
 
       // sets a knowledge record to a string
       .def("set",
-          static_cast<int (madara::knowledge::KnowledgeBase::*)(
-              const std::string&, const std::string&,
-              const madara::knowledge::EvalSettings&)>(
-              &madara::knowledge::KnowledgeBase::set),
-          m_set_2_of_3(args("key", "value", "settings"),
-              "Sets a knowledge record to a string"))
+          without_gil(
+              static_cast<int (madara::knowledge::KnowledgeBase::*)(
+                  const std::string&, const std::string&,
+                  const madara::knowledge::EvalSettings&)>(
+                  &madara::knowledge::KnowledgeBase::set),
+              (arg("key"), arg("value"),
+                  arg("settings") = madara::knowledge::EvalSettings(
+                      true, false, true, false, false))),
+          "Sets a knowledge record to a string")
 
       // sets a knowledge record to an Any
       .def("set",
@@ -2284,27 +2542,34 @@ void define_knowledge(void)
 
       // wait on an expression
       .def("wait",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(
-              const std::string&, const madara::knowledge::WaitSettings&)>(
-              &madara::knowledge::KnowledgeBase::wait),
-          m_wait_1_of_2(args("expression", "settings"),
-              "Waits for an expression to evaluate to true"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(const std::string&,
+                  const madara::knowledge::WaitSettings&)>(
+                  &madara::knowledge::KnowledgeBase::wait),
+              (arg("expression"),
+                  arg("settings") = madara::knowledge::WaitSettings())),
+          "Waits for an expression to evaluate to true. Releases the GIL "
+          "while waiting")
 
       // wait on an expression
       .def("wait",
-          static_cast<madara::knowledge::KnowledgeRecord (
-              madara::knowledge::KnowledgeBase::*)(
-              madara::knowledge::CompiledExpression&,
-              const madara::knowledge::WaitSettings&)>(
-              &madara::knowledge::KnowledgeBase::wait),
-          m_wait_1_of_2(args("expression", "settings"),
-              "Waits for an expression to evaluate to true"))
+          without_gil(
+              static_cast<madara::knowledge::KnowledgeRecord (
+                  madara::knowledge::KnowledgeBase::*)(
+                  madara::knowledge::CompiledExpression&,
+                  const madara::knowledge::WaitSettings&)>(
+                  &madara::knowledge::KnowledgeBase::wait),
+              (arg("expression"),
+                  arg("settings") = madara::knowledge::WaitSettings())),
+          "Waits for an expression to evaluate to true. Releases the GIL "
+          "while waiting")
 
       // wait for a change to happen
       .def("wait_for_change",
-          &madara::knowledge::KnowledgeBase::wait_for_change,
-          "Wait for a change to happen to the context (e.g., from transports)")
+          without_gil(&madara::knowledge::KnowledgeBase::wait_for_change),
+          "Wait for a change to happen to the context (e.g., from "
+          "transports). Releases the GIL while waiting")
 
       // Write a file from the knowledge base to a specified location
       .def("write_file", &madara::knowledge::KnowledgeBase::write_file,
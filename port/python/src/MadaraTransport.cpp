@@ -59,7 +59,8 @@ void define_transport(void)
       .value("BROADCAST", madara::transport::BROADCAST)
       .value("REGISTRY_SERVER", madara::transport::REGISTRY_SERVER)
       .value("REGISTRY_CLIENT", madara::transport::REGISTRY_CLIENT)
-      .value("ZMQ", madara::transport::ZMQ);
+      .value("ZMQ", madara::transport::ZMQ)
+      .value("SHMEM", madara::transport::SHMEM);
 
   {
     /********************************************************
@@ -197,6 +198,54 @@ void define_transport(void)
           &madara::transport::TransportSettings::write_domain,
           "Indicates the domain to write to")
 
+      .def_readwrite("tcp_nodelay",
+          &madara::transport::TransportSettings::tcp_nodelay,
+          "Disables Nagle's algorithm on TCP streams")
+
+      .def_readwrite("tcp_cork",
+          &madara::transport::TransportSettings::tcp_cork,
+          "Corks TCP streams while coalesced messages are written")
+
+      .def_readwrite("reliable_fragments",
+          &madara::transport::TransportSettings::reliable_fragments,
+          "Recovers lost UDP fragments with negative acknowledgements")
+
+      .def_readwrite("fragment_nack_interval",
+          &madara::transport::TransportSettings::fragment_nack_interval,
+          "Seconds without progress before missing fragments are requested")
+
+      .def_readwrite("send_array_deltas",
+          &madara::transport::TransportSettings::send_array_deltas,
+          "Sends only the changed elements of arrays changed by set_index")
+
+      .def_readwrite("array_delta_full_interval",
+          &madara::transport::TransportSettings::array_delta_full_interval,
+          "Maximum consecutive array deltas before a full update")
+
+      .def_readwrite("zero_copy_receive",
+          &madara::transport::TransportSettings::zero_copy_receive,
+          "Received Cap'n Proto values reference the receive buffer")
+
+      .def_readwrite("zmq_topics",
+          &madara::transport::TransportSettings::zmq_topics,
+          "Variable prefixes published and subscribed to as ZMQ topics")
+
+      .def_readwrite("read_thread_cores",
+          &madara::transport::TransportSettings::read_thread_cores,
+          "CPU cores that read threads may run on")
+
+      .def_readwrite("read_thread_policy",
+          &madara::transport::TransportSettings::read_thread_policy,
+          "Scheduling policy of read threads: 0 default, 1 FIFO, 2 RR")
+
+      .def_readwrite("read_thread_priority",
+          &madara::transport::TransportSettings::read_thread_priority,
+          "Priority of read threads within a real-time policy")
+
+      .def_readwrite("lock_memory",
+          &madara::transport::TransportSettings::lock_memory,
+          "Locks process memory with mlockall when read threads start")
+
       ;
 
   /********************************************************
@@ -0,0 +1,155 @@
+#!/usr/bin/env python
+
+# Compares list conversions of large arrays with zero-copy views, and
+# checks that wait and wait_for_change let other Python threads run.
+#
+# usage: python benchmark_views.py [elements] [iterations]
+
+from __future__ import print_function
+
+import sys
+import threading
+import time
+
+import madara
+from madara.knowledge import *
+
+try:
+  import numpy
+except ImportError:
+  numpy = None
+
+elements = int(sys.argv[1]) if len(sys.argv) > 1 else 100000
+iterations = int(sys.argv[2]) if len(sys.argv) > 2 else 100
+
+madara_fails = 0
+
+kb = KnowledgeBase()
+kb.set("doubles", madara.from_pydoubles([float(i) for i in range(elements)]))
+kb.set("integers", madara.from_pylongs(list(range(elements))))
+
+record = kb.get("doubles")
+
+def bench(name, function):
+  start = time.time()
+  for i in range(iterations):
+    result = function()
+  elapsed = time.time() - start
+  print("  {0}: {1:.3f} ms per call".format(name, elapsed * 1000 / iterations))
+  return result
+
+print("\nReading {0} doubles {1} times...".format(elements, iterations))
+
+bench("to_doubles", lambda: list(record.to_doubles()))
+view = bench("view_doubles", lambda: record.view_doubles())
+
+if numpy is not None:
+  array = bench("numpy.asarray (view_doubles)",
+    lambda: numpy.asarray(record.view_doubles()))
+
+  if array[elements - 1] == elements - 1 and not array.flags.writeable:
+    print("  Testing read-only numpy view: SUCCESS")
+  else:
+    print("  Testing read-only numpy view: FAIL")
+    madara_fails += 1
+
+if (len(view) == elements and view[elements - 1] == elements - 1 and
+    view.readonly):
+  print("  Testing doubles view contents: SUCCESS")
+else:
+  print("  Testing doubles view contents: FAIL")
+  madara_fails += 1
+
+integers = kb.get("integers").view_integers()
+
+if len(integers) == elements and integers[elements - 1] == elements - 1:
+  print("  Testing integers view contents: SUCCESS")
+else:
+  print("  Testing integers view contents: FAIL")
+  madara_fails += 1
+
+# a view keeps its array alive after the variable changes
+kb.set("doubles", 1.0)
+record = None
+
+if view[elements - 1] == elements - 1:
+  print("  Testing view outlives record: SUCCESS")
+else:
+  print("  Testing view outlives record: FAIL")
+  madara_fails += 1
+
+if kb.get("doubles").view_integers() is None:
+  print("  Testing view of mismatched type is None: SUCCESS")
+else:
+  print("  Testing view of mismatched type is None: FAIL")
+  madara_fails += 1
+
+print("\nCounting in a Python thread during a wait for change...")
+
+ticks = [0]
+woken = [False]
+
+def count():
+  start = time.time()
+
+  while time.time() - start < 1.0:
+    ticks[0] += 1
+
+  # keep changing the context until the waiting thread wakes
+  while not woken[0]:
+    kb.set("counted", ticks[0])
+    time.sleep(0.01)
+
+counter = threading.Thread(target=count)
+counter.start()
+
+kb.wait_for_change()
+
+woken[0] = True
+counter.join()
+
+print("  {0} ticks counted during wait".format(ticks[0]))
+
+if ticks[0] > 1000:
+  print("  Testing GIL release during wait_for_change: SUCCESS")
+else:
+  print("  Testing GIL release during wait_for_change: FAIL")
+  madara_fails += 1
+
+print("\nCounting in a Python thread during a wait on an expression...")
+
+ticks = [0]
+
+def count_then_finish():
+  start = time.time()
+
+  while time.time() - start < 1.0:
+    ticks[0] += 1
+
+  # ends the wait below, which also needs the knowledge base lock
+  kb.set("finished", ticks[0])
+
+wait_settings = WaitSettings()
+wait_settings.max_wait_time = 10
+
+counter = threading.Thread(target=count_then_finish)
+counter.start()
+
+result = kb.wait("finished > 0", wait_settings)
+
+counter.join()
+
+print("  {0} ticks counted during wait".format(ticks[0]))
+
+if ticks[0] > 1000 and result.is_true():
+  print("  Testing GIL release during wait: SUCCESS")
+else:
+  print("  Testing GIL release during wait: FAIL")
+  madara_fails += 1
+
+if madara_fails > 0:
+  print("OVERALL: FAIL. {0} tests failed.".format(madara_fails))
+else:
+  print("OVERALL: SUCCESS.")
+
+sys.exit(madara_fails)
@@ -115,5 +115,26 @@ int main(int, char**)
   test_eq(kb.get("v").to_integers(), std::vector<int64_t>({}));
   test_eq(kb.get("w").to_integers(), std::vector<int64_t>({7, 13, 9}));
 
+  // pushing without local changes leaves records unmodified
+  tx.pull();
+  VariableReference wref = kb.get_ref("w");
+  uint64_t w_version = wref.get_record_unsafe()->version();
+  tx.push();
+  test_eq(wref.get_record_unsafe()->version(), w_version);
+
+  // pulls copy records modified since the last pull
+  kb.set("x", (int64_t)7);
+  kb.set_index("w", 2, (int64_t)19);
+  tx.pull();
+  test_eq(x, 7);
+  test_eq(w, std::vector<int64_t>({7, 13, 19}));
+
+  // and still revert local changes to unmodified records
+  x = 100;
+  w[0] = 100;
+  tx.pull();
+  test_eq(x, 7);
+  test_eq(w, std::vector<int64_t>({7, 13, 19}));
+
   tests_finalize();
 }
@@ -1,5 +1,6 @@
 #define BOOST_PP_VARIADICS 1
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <sys/types.h>
@@ -273,6 +274,52 @@ void test_record()
   }
 }
 
+void test_lazy_record()
+{
+  KnowledgeRecord k0(tags::any<std::vector<std::string>>{}, {"a", "b", "c"});
+
+  std::vector<char> buf(2048);
+  int64_t remaining = buf.size();
+  char* end = k0.write(buf.data(), "lazy", remaining);
+  std::vector<char> encoded(buf.data(), end);
+
+  // reading keeps the encoding, which is resent without serializing again
+  KnowledgeRecord k1;
+  std::string key;
+  remaining = encoded.size();
+  k1.read(encoded.data(), key, remaining);
+  TEST_EQ(remaining, 0);
+  TEST_EQ(k1.is_true(), true);
+  TEST_EQ(k1.get_encoded_size(key), (int64_t)encoded.size());
+
+  KnowledgeRecord k2(k1);
+  remaining = buf.size();
+  end = k2.write(buf.data(), key, remaining);
+  TEST_EQ(std::vector<char>(buf.data(), end) == encoded, true);
+
+  // copies share the value once it is unserialized
+  TEST_EQ(k2.get_any_cref<std::vector<std::string>>()[1], "b");
+  TEST_EQ(&k1.get_any_cref<std::vector<std::string>>(),
+      &k2.get_any_cref<std::vector<std::string>>());
+  TEST_EQ(k1.share_any<std::vector<std::string>>()->at(2), "c");
+
+  // relays forward types they have not registered, without decoding
+  std::string tag("vecstr");
+  auto found =
+      std::search(encoded.begin(), encoded.end(), tag.begin(), tag.end());
+  TEST_EQ(found != encoded.end(), true);
+  found[tag.size() - 1] = '?';
+
+  KnowledgeRecord k3;
+  remaining = encoded.size();
+  k3.read(encoded.data(), key, remaining);
+  TEST_EQ(remaining, 0);
+
+  remaining = buf.size();
+  end = k3.write(buf.data(), key, remaining);
+  TEST_EQ(std::vector<char>(buf.data(), end) == encoded, true);
+}
+
 void test_kb(KnowledgeBase& kb)
 {
   kb.set("hello_str", "world");
@@ -791,6 +838,7 @@ int main(int, char**)
 
   test_any();
   test_record();
+  test_lazy_record();
 
   {
     KnowledgeBase kb;
@@ -0,0 +1,333 @@
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <string.h>
+
+#include "madara/knowledge/Any.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "boost/iostreams/stream.hpp"
+#include "boost/iostreams/device/array.hpp"
+
+#include "test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+namespace bio = boost::iostreams;
+
+using namespace madara;
+using namespace knowledge;
+
+struct Pose
+{
+  double x;
+  double y;
+  double z;
+  int64_t frame;
+
+  template<typename Archive>
+  void serialize(Archive& ar, unsigned int)
+  {
+    ar& x& y& z& frame;
+  }
+};
+
+MADARA_USE_CEREAL(Pose);
+
+size_t iterations = 100000;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-n" || arg1 == "--iterations")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> iterations;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests and times serialization of Any values to buffers.\n\n"
+          " [-n|--iterations num]    number of times to serialize small\n"
+          "                          values (default 100000)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+// serializes the way Any did before it wrote to buffers directly
+size_t stream_serialize(const Any& any, char* data, size_t size)
+{
+  bio::array_sink output_sink(data, size);
+  bio::stream<bio::array_sink> output_stream(output_sink);
+
+  auto pos = output_stream.tellp();
+  {
+    madara_oarchive archive(output_stream);
+    archive << std::string(any.tag());
+  }
+  any.serialize(output_stream);
+
+  return output_stream.tellp() - pos;
+}
+
+// unserializes the way Any did before it read from buffers directly
+template<typename T>
+void stream_unserialize(const char* data, size_t size, Any& any)
+{
+  std::string tag;
+  size_t len;
+  {
+    bio::array_source input_source(data, size);
+    bio::stream<bio::array_source> input_stream(input_source);
+
+    auto pos = input_stream.tellg();
+    madara_iarchive archive(input_stream);
+    archive >> tag;
+    len = input_stream.tellg() - pos;
+  }
+
+  Any value = AnyRegistry::construct(tag.c_str());
+
+  bio::array_source input_source(data + len, size - len);
+  bio::stream<bio::array_source> input_stream(input_source);
+  madara_iarchive archive(input_stream);
+  archive >> value.ref<T>();
+
+  any = std::move(value);
+}
+
+bool operator==(const Pose& lhs, const Pose& rhs)
+{
+  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z &&
+         lhs.frame == rhs.frame;
+}
+
+size_t value_size(const Pose&)
+{
+  return sizeof(Pose);
+}
+
+size_t value_size(const std::vector<double>& value)
+{
+  return value.size() * sizeof(double);
+}
+
+template<typename T>
+void time_type(const char* name, const T& value, size_t count)
+{
+  std::vector<char> buf(value_size(value) + 256);
+  Any any(value);
+  size_t size = 0;
+
+  uint64_t start = utility::get_time();
+  for (size_t i = 0; i < count; ++i)
+  {
+    size = stream_serialize(any, buf.data(), buf.size());
+  }
+  uint64_t stream_save = utility::get_time() - start;
+
+  std::vector<char> stream_bytes(buf.begin(), buf.begin() + size);
+
+  start = utility::get_time();
+  for (size_t i = 0; i < count; ++i)
+  {
+    size = any.tagged_serialize(buf.data(), buf.size());
+  }
+  uint64_t buffer_save = utility::get_time() - start;
+
+  std::vector<char> buffer_bytes(buf.begin(), buf.begin() + size);
+
+  TEST_EQ(buffer_bytes == stream_bytes, true);
+
+  Any result;
+  start = utility::get_time();
+  for (size_t i = 0; i < count; ++i)
+  {
+    stream_unserialize<T>(buf.data(), size, result);
+  }
+  uint64_t stream_load = utility::get_time() - start;
+
+  Any loaded;
+  start = utility::get_time();
+  for (size_t i = 0; i < count; ++i)
+  {
+    loaded.tagged_unserialize(buf.data(), size);
+  }
+  uint64_t buffer_load = utility::get_time() - start;
+
+  TEST_EQ(result.ref<T>() == value, true);
+  TEST_EQ(loaded.ref<T>() == value, true);
+
+  std::cerr << "  " << name << " (" << size << " bytes), ns per object:\n"
+            << "    serialize:   " << stream_save / count << " with streams, "
+            << buffer_save / count << " direct\n"
+            << "    unserialize: " << stream_load / count << " with streams, "
+            << buffer_load / count << " direct\n";
+}
+
+void test_direct(void)
+{
+  std::cerr << "Testing direct serialization against streams\n";
+
+  Pose pose{1.5, -2.25, 3.0, 42};
+  time_type("Pose", pose, iterations);
+
+  std::vector<double> vec(100000);
+  for (size_t i = 0; i < vec.size(); ++i)
+  {
+    vec[i] = i * 0.5;
+  }
+  time_type("vector<double>", vec, iterations / 1000 + 1);
+
+  // too small a buffer throws, and KnowledgeRecord reports it
+  char small[16];
+  bool thrown = false;
+  try
+  {
+    Any(pose).tagged_serialize(small, sizeof(small));
+  }
+  catch (const std::exception&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+}
+
+void test_type_ids(void)
+{
+  std::cerr << "Testing compact type ids\n";
+
+  TEST_EQ(AnyRegistry::send_type_ids(), false);
+  TEST_EQ(AnyRegistry::lookup_type_id(AnyRegistry::get_type_id("Pose")),
+      std::string("Pose"));
+  TEST_EQ(AnyRegistry::lookup_type_id(AnyRegistry::get_type_id("Unused")) ==
+              nullptr,
+      true);
+
+  Pose pose{4.0, 5.0, 6.0, 7};
+  Any any(pose);
+
+  char full[256];
+  size_t full_size = any.tagged_serialize(full, sizeof(full));
+
+  AnyRegistry::set_send_type_ids(true);
+
+  char compact[256];
+  size_t compact_size = any.tagged_serialize(compact, sizeof(compact));
+
+  TEST_EQ(compact[0], AnyRegistry::TYPE_ID_MARKER);
+  TEST_EQ(full_size - compact_size, (size_t)(1 + 8 + 4 - 5));
+
+  Any loaded;
+  loaded.tagged_unserialize(compact, compact_size);
+  TEST_EQ(loaded.tag(), std::string("Pose"));
+  TEST_EQ(loaded.ref<Pose>() == pose, true);
+
+  // records round trip with ids
+  KnowledgeRecord record(any);
+  std::vector<char> buf(2048);
+  int64_t remaining = buf.size();
+  char* end = record.write(buf.data(), "pose", remaining);
+
+  KnowledgeRecord read_record;
+  std::string key;
+  remaining = end - buf.data();
+  read_record.read(buf.data(), key, remaining);
+
+  TEST_EQ(key, "pose");
+  TEST_EQ(read_record.to_any<Pose>() == pose, true);
+
+  // types without ids still write tag strings
+  std::vector<char> unnamed_buf;
+  Any(type<std::vector<int64_t>>{}).tagged_serialize("Unused", unnamed_buf);
+  TEST_NE(unnamed_buf[0], AnyRegistry::TYPE_ID_MARKER);
+
+  AnyRegistry::set_send_type_ids(false);
+
+  // ids of tags this process does not know cannot be read
+  uint32_t id = utility::endian_swap(AnyRegistry::get_type_id("Unused"));
+  char unknown[16] = {AnyRegistry::TYPE_ID_MARKER};
+  memcpy(unknown + 1, &id, sizeof(id));
+
+  bool thrown = false;
+  try
+  {
+    Any().tagged_unserialize(unknown, sizeof(unknown));
+  }
+  catch (const exceptions::BadAnyAccess&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+
+  // records with such ids can still be printed, copied and forwarded
+  char* id_pos = std::search(buf.data(), end, compact, compact + 5);
+  TEST_EQ(id_pos != end, true);
+  memcpy(id_pos + 1, &id, sizeof(id));
+  std::vector<char> forwarded(buf.data(), end);
+
+  KnowledgeRecord relayed;
+  remaining = forwarded.size();
+  relayed.read(forwarded.data(), key, remaining);
+  TEST_EQ(remaining, 0);
+  TEST_EQ(relayed.to_string().find("bytes") != std::string::npos, true);
+  TEST_EQ(relayed.size(), 1u);
+
+  KnowledgeRecord copy(relayed);
+  copy.unshare();
+  remaining = buf.size();
+  end = copy.write(buf.data(), key, remaining);
+  TEST_EQ(std::vector<char>(buf.data(), end) == forwarded, true);
+
+  thrown = false;
+  try
+  {
+    relayed.to_any<Pose>();
+  }
+  catch (const exceptions::BadAnyAccess&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  Any::register_type<Pose>("Pose");
+  Any::register_type<std::vector<double>>("vecdbl");
+
+  test_direct();
+  test_type_ids();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,268 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/exceptions/UninitializedException.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+size_t keys = 1000;
+size_t iterations = 100;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-k" || arg1 == "--keys")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> keys;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--iterations")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> iterations;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests and times setting and getting batches of variables.\n\n"
+          " [-k|--keys num]          number of variables in a batch\n"
+          "                          (default 1000)\n"
+          " [-n|--iterations num]    number of batches to time\n"
+          "                          (default 100)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+std::vector<std::string> make_keys(const std::string& prefix, size_t count)
+{
+  std::vector<std::string> result(count);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    std::stringstream buffer;
+    buffer << prefix << i;
+    result[i] = buffer.str();
+  }
+
+  return result;
+}
+
+void test_set_get(void)
+{
+  std::cerr << "Testing batch sets and gets\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+
+  std::vector<std::string> names = make_keys("agent.", 3);
+  TEST_EQ(kb.set_batch(names, std::vector<Integer>({1, 2, 3})), 0);
+
+  TEST_EQ(kb.get("agent.0").to_integer(), (Integer)1);
+  TEST_EQ(kb.get("agent.2").to_integer(), (Integer)3);
+
+  // every variable in the batch is modified
+  TEST_EQ(context.get_modifieds().size(), (size_t)3);
+  context.reset_modified();
+
+  VariableReferences refs = kb.get_refs(names);
+  TEST_EQ(refs.size(), (size_t)3);
+  TEST_EQ(kb.set_batch(refs, std::vector<double>({1.5, 2.5, 3.5})), 0);
+  TEST_EQ(kb.get("agent.1").to_double(), 2.5);
+
+  TEST_EQ(kb.set_batch(refs,
+              std::vector<std::string>({"one", "two", "three"})), 0);
+  TEST_EQ(kb.get("agent.2").to_string(), std::string("three"));
+
+  std::vector<KnowledgeRecord> records;
+  records.push_back(KnowledgeRecord(std::vector<double>({1.0, 2.0})));
+  records.push_back(KnowledgeRecord(Integer(7)));
+  records.push_back(KnowledgeRecord("seven"));
+  TEST_EQ(kb.set_batch(refs, records), 0);
+  TEST_EQ(kb.get("agent.0").size(), (size_t)2);
+
+  std::vector<KnowledgeRecord> values;
+  kb.get_batch(refs, values);
+  TEST_EQ(values.size(), (size_t)3);
+  TEST_EQ(values[1].to_integer(), (Integer)7);
+  TEST_EQ(values[2].to_string(), std::string("seven"));
+
+  // missing keys are read as empty records and are not created
+  std::vector<std::string> lookups = {"agent.1", "missing", "agent.0"};
+  kb.get_batch(lookups, values);
+  TEST_EQ(values.size(), (size_t)3);
+  TEST_EQ(values[0].to_integer(), (Integer)7);
+  TEST_EQ(values[1].exists(), false);
+  TEST_EQ(values[2].size(), (size_t)2);
+  TEST_EQ(kb.exists("missing"), false);
+
+  bool thrown = false;
+  try
+  {
+    KnowledgeReferenceSettings strict;
+    strict.exception_on_unitialized = true;
+    kb.get_batch(lookups, values, strict);
+  }
+  catch (const exceptions::UninitializedException&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+
+  // mismatched sizes set nothing
+  context.reset_modified();
+  TEST_EQ(kb.set_batch(names, std::vector<Integer>({1, 2})), -1);
+  TEST_EQ(context.get_modifieds().size(), (size_t)0);
+  TEST_EQ(kb.get("agent.1").to_integer(), (Integer)7);
+
+  // variable expansion is applied to each key when asked for
+  EvalSettings expand;
+  expand.expand_variables = true;
+  kb.set(".id", Integer(4));
+  names = {"agent.{.id}"};
+  TEST_EQ(kb.set_batch(names, std::vector<Integer>({44}), expand), 0);
+  TEST_EQ(kb.get("agent.4").to_integer(), (Integer)44);
+
+  // locals are set but not sent
+  context.reset_modified();
+  names = {".local", "global"};
+  TEST_EQ(kb.set_batch(names, std::vector<Integer>({1, 2})), 0);
+  TEST_EQ(context.get_modifieds().size(), (size_t)1);
+  TEST_EQ(kb.get(".local").to_integer(), (Integer)1);
+}
+
+void test_timing(void)
+{
+  std::cerr << "Timing " << iterations << " batches of " << keys
+            << " variables\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+
+  std::vector<std::string> names = make_keys("sensors.", keys);
+  VariableReferences refs = kb.get_refs(names);
+  std::vector<double> values(keys);
+
+  uint64_t key_loop = 0;
+  uint64_t ref_loop = 0;
+  uint64_t key_batch = 0;
+  uint64_t ref_batch = 0;
+  uint64_t ref_get_loop = 0;
+  uint64_t ref_get_batch = 0;
+
+  double loop_sum = 0;
+  double batch_sum = 0;
+  std::vector<KnowledgeRecord> records;
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    for (size_t j = 0; j < keys; ++j)
+    {
+      values[j] = (double)(i + j);
+    }
+
+    uint64_t start = utility::get_time();
+    for (size_t j = 0; j < keys; ++j)
+    {
+      kb.set(names[j], values[j]);
+    }
+    key_loop += utility::get_time() - start;
+
+    start = utility::get_time();
+    for (size_t j = 0; j < keys; ++j)
+    {
+      kb.set(refs[j], values[j]);
+    }
+    ref_loop += utility::get_time() - start;
+
+    start = utility::get_time();
+    kb.set_batch(names, values);
+    key_batch += utility::get_time() - start;
+
+    start = utility::get_time();
+    kb.set_batch(refs, values);
+    ref_batch += utility::get_time() - start;
+
+    start = utility::get_time();
+    for (size_t j = 0; j < keys; ++j)
+    {
+      loop_sum += kb.get(refs[j]).to_double();
+    }
+    ref_get_loop += utility::get_time() - start;
+
+    start = utility::get_time();
+    kb.get_batch(refs, records);
+    for (size_t j = 0; j < records.size(); ++j)
+    {
+      batch_sum += records[j].to_double();
+    }
+    ref_get_batch += utility::get_time() - start;
+
+    context.reset_modified();
+  }
+
+  TEST_EQ(loop_sum, batch_sum);
+  TEST_EQ(kb.get(names[keys - 1]).to_double(),
+      (double)(iterations - 1 + keys - 1));
+
+  size_t total = keys * iterations;
+
+  std::cerr << "  ns per variable set: " << key_loop / total
+            << " key loop, " << key_batch / total << " key batch, "
+            << ref_loop / total << " reference loop, " << ref_batch / total
+            << " reference batch\n"
+            << "  ns per variable get: " << ref_get_loop / total
+            << " reference loop, " << ref_get_batch / total
+            << " reference batch\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_set_get();
+  test_timing();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <string.h>
 
 #define BUFFER_SIZE 1000
 #define LARGE_BUFFER_SIZE 500000
@@ -394,6 +396,102 @@ void test_records_frag(void)
   delete[] payload;
 }
 
+void test_fragment_nacks(void)
+{
+  uint32_t size = 300000 + transport::MessageHeader::static_encoded_size();
+
+  char* payload = new char[size];
+  char* buffer = payload;
+  int64_t buffer_remaining = size;
+  transport::FragmentMap map;
+  transport::OriginatorFragmentMap frag_map;
+
+  transport::MessageHeader header;
+  header.size = size;
+
+  buffer = header.write(buffer, buffer_remaining);
+  memset(buffer, 'x', 300000);
+
+  transport::frag(payload, 50000, map);
+
+  // drop fragments 1 and 4 of the 7 fragment message
+  for (unsigned int i = 0; i < map.size(); ++i)
+  {
+    if (i != 1 && i != 4)
+      transport::add_fragment("testmachine", 1, i, map[i], 5, frag_map, true);
+  }
+
+  std::vector<uint32_t> missing;
+
+  if (transport::missing_fragments("testmachine", 1, frag_map, missing) &&
+      missing.size() == 2 && missing[0] == 1 && missing[1] == 4)
+  {
+    std::cerr << "SUCCESS. missing_fragments found fragments 1 and 4.\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. missing_fragments did not find fragments 1 and 4.\n";
+    ++madara_fails;
+  }
+
+  char nack[BUFFER_SIZE];
+  uint64_t nack_size =
+      transport::write_fragment_nack(nack, BUFFER_SIZE, "testmachine", 1,
+          missing);
+
+  std::string originator;
+  uint64_t clock = 0;
+  std::vector<uint32_t> requested;
+
+  if (nack_size > 0 && transport::fragment_nack_test(nack, nack_size) &&
+      !transport::FragmentMessageHeader::fragment_message_header_test(nack) &&
+      transport::read_fragment_nack(
+          nack, (int64_t)nack_size, originator, clock, requested) &&
+      originator == "testmachine" && clock == 1 && requested == missing)
+  {
+    std::cerr << "SUCCESS. fragment NACK was encoded and decoded.\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. fragment NACK was not encoded and decoded.\n";
+    ++madara_fails;
+  }
+
+  if (transport::read_fragment_nack(
+          nack, (int64_t)nack_size - 1, originator, clock, requested))
+  {
+    std::cerr << "FAIL. read_fragment_nack accepted a truncated NACK.\n";
+    ++madara_fails;
+  }
+  else
+  {
+    std::cerr << "SUCCESS. read_fragment_nack rejected a truncated NACK.\n";
+  }
+
+  // resend the requested fragments, which completes the message
+  char* result = 0;
+  for (size_t i = 0; i < requested.size(); ++i)
+  {
+    result = transport::add_fragment("testmachine", 1, requested[i],
+        map[requested[i]], 5, frag_map, true);
+  }
+
+  if (result &&
+      !transport::missing_fragments("testmachine", 1, frag_map, missing))
+  {
+    std::cerr << "SUCCESS. resent fragments completed the message.\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. resent fragments did not complete the message.\n";
+    ++madara_fails;
+  }
+
+  delete[] result;
+  transport::delete_fragments(map);
+  delete[] payload;
+}
+
 int main(int argc, char* argv[])
 {
   handle_arguments(argc, argv);
@@ -401,6 +499,7 @@ int main(int argc, char* argv[])
   test_frag();
   test_add_frag();
   test_records_frag();
+  test_fragment_nacks();
 
   if (madara_fails > 0)
   {
@@ -0,0 +1,182 @@
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Integer.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/LockProfiler.h"
+
+#include "test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef utility::LockProfiler LockProfiler;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  if (argc > 1)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nProgram summary for %s:\n\n"
+        "  Tests lock wait and hold time profiling.\n\n",
+        argv[0]);
+    exit(0);
+  }
+}
+
+void test_categories(void)
+{
+  std::cerr << "Testing lock categories\n";
+
+  TEST_EQ(LockProfiler::get_category(), LockProfiler::OTHER);
+
+  {
+    utility::LockCategoryScope evaluate(LockProfiler::EVALUATE);
+
+#ifndef MADARA_NO_THREAD_LOCAL
+    TEST_EQ(LockProfiler::get_category(), LockProfiler::EVALUATE);
+
+    {
+      utility::LockCategoryScope container(LockProfiler::CONTAINER);
+      TEST_EQ(LockProfiler::get_category(), LockProfiler::CONTAINER);
+    }
+
+    TEST_EQ(LockProfiler::get_category(), LockProfiler::EVALUATE);
+#endif
+  }
+
+  TEST_EQ(LockProfiler::get_category(), LockProfiler::OTHER);
+  TEST_EQ(std::string(LockProfiler::get_name(LockProfiler::TRANSPORT_APPLY)),
+      "transport_apply");
+}
+
+void test_profiled_mutex(void)
+{
+  std::cerr << "Testing wait and hold times of a profiled mutex\n";
+
+  utility::ProfiledMutex mutex;
+
+  LockProfiler::reset();
+
+  // nothing is recorded until profiling is enabled
+  mutex.lock();
+  mutex.unlock();
+
+  TEST_EQ(LockProfiler::get_wait(LockProfiler::OTHER).count(), (uint64_t)0);
+
+  LockProfiler::enable();
+
+  const int threads = 4;
+  const int iterations = 10;
+  const int64_t hold_ns = 1000000;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+  {
+    workers.push_back(std::thread([&] {
+      utility::LockCategoryScope category(LockProfiler::CHECKPOINT);
+
+      for (int i = 0; i < iterations; ++i)
+      {
+        std::lock_guard<utility::ProfiledMutex> guard(mutex);
+
+        // recursive acquisitions are not timed separately
+        std::lock_guard<utility::ProfiledMutex> inner(mutex);
+
+        std::this_thread::sleep_for(std::chrono::nanoseconds(hold_ns));
+      }
+    }));
+  }
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  LockProfiler::disable();
+
+  LockProfiler::Category category = LockProfiler::CHECKPOINT;
+
+#ifdef MADARA_NO_THREAD_LOCAL
+  category = LockProfiler::OTHER;
+#endif
+
+  const utility::LatencyHistogram& wait = LockProfiler::get_wait(category);
+  const utility::LatencyHistogram& hold = LockProfiler::get_hold(category);
+
+  TEST_EQ(wait.count(), (uint64_t)(threads * iterations));
+  TEST_EQ(hold.count(), (uint64_t)(threads * iterations));
+
+  // with four threads sleeping under the lock, someone had to wait
+  TEST_GT(wait.max(), (int64_t)0);
+  TEST_GE(hold.percentile(1), hold_ns - hold_ns / 16);
+
+  std::string report = LockProfiler::to_string();
+  TEST_NE(report.find(LockProfiler::get_name(category)), std::string::npos);
+
+  std::cerr << report;
+
+  // times are not recorded after profiling is disabled
+  mutex.lock();
+  mutex.unlock();
+
+  TEST_EQ(hold.count(), (uint64_t)(threads * iterations));
+
+  LockProfiler::reset();
+
+  TEST_EQ(wait.count(), (uint64_t)0);
+}
+
+void test_knowledge_base(void)
+{
+#if defined(_MADARA_PROFILE_LOCK_) && !defined(MADARA_NO_THREAD_LOCAL)
+  std::cerr << "Testing lock categories of a knowledge base\n";
+
+  knowledge::KnowledgeBase kb;
+  knowledge::containers::Integer value("value", kb);
+
+  LockProfiler::reset();
+  LockProfiler::enable();
+
+  kb.evaluate("a = 1");
+  value = 5;
+
+  LockProfiler::disable();
+
+  TEST_GE(LockProfiler::get_hold(LockProfiler::EVALUATE).count(), (uint64_t)1);
+  TEST_GE(
+      LockProfiler::get_hold(LockProfiler::CONTAINER).count(), (uint64_t)1);
+#else
+  std::cerr << "Skipping knowledge base tests without profile_lock\n";
+#endif
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_categories();
+  test_profiled_mutex();
+  test_knowledge_base();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
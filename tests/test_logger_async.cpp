@@ -0,0 +1,308 @@
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "madara/logger/GlobalLogger.h"
+#include "madara/logger/Logger.h"
+#include "madara/utility/Timer.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+// shortcuts
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+size_t num_threads(4);
+int messages(10000);
+double bench_time(1.0);
+std::string filename("test_logger_async.txt");
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-d" || arg1 == "--duration")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> bench_time;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-f" || arg1 == "--file")
+    {
+      if (i + 1 < argc)
+      {
+        filename = argv[i + 1];
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--messages")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> messages;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-t" || arg1 == "--threads")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_threads;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests and benchmarks asynchronous logging.\n\n"
+          " [-d|--duration sec]      seconds to run each benchmark\n"
+          " [-f|--file name]         the log file to write to\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-n|--messages num]      messages per thread\n"
+          " [-t|--threads num]       the number of logging threads\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/// reads the lines of the log file
+std::vector<std::string> read_lines(void)
+{
+  std::vector<std::string> lines;
+  std::ifstream input(filename.c_str());
+  std::string line;
+
+  while (std::getline(input, line))
+  {
+    lines.push_back(line);
+  }
+
+  return lines;
+}
+
+/// logs messages from several threads at once
+void log_from_threads(logger::Logger& output, int count)
+{
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < num_threads; ++t)
+  {
+    threads.push_back(std::thread([&output, count, t] {
+      for (int i = 0; i < count; ++i)
+      {
+        madara_logger_log(
+            output, logger::LOG_MAJOR, "thread %d message %d\n", (int)t, i);
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+void test_async_file(void)
+{
+  std::cerr << "Testing async logging from " << num_threads << " threads\n";
+
+  std::remove(filename.c_str());
+
+  logger::Logger output(false);
+  output.set_level(logger::LOG_MAJOR);
+  output.add_file(filename);
+  output.enable_async(1 << 22);
+
+  TEST_EQ(output.is_async(), true);
+
+  log_from_threads(output, messages);
+
+  output.flush();
+  output.clear();
+
+  TEST_EQ(output.get_dropped(), (uint64_t)0);
+
+  std::vector<std::string> lines = read_lines();
+  TEST_EQ(lines.size(), num_threads * messages);
+
+  // messages from each thread are written in the order they were logged
+  std::vector<int> next(num_threads, 0);
+  size_t out_of_order = 0;
+
+  for (auto& line : lines)
+  {
+    int thread = 0, message = 0;
+    if (sscanf(line.c_str(), "thread %d message %d", &thread, &message) ==
+            2 &&
+        thread >= 0 && thread < (int)num_threads)
+    {
+      if (message != next[thread])
+      {
+        ++out_of_order;
+      }
+      next[thread] = message + 1;
+    }
+  }
+
+  TEST_EQ(out_of_order, (size_t)0);
+
+  output.disable_async();
+  TEST_EQ(output.is_async(), false);
+}
+
+void test_drops(void)
+{
+  std::cerr << "Testing dropped messages in full rings\n";
+
+  std::remove(filename.c_str());
+
+  logger::Logger output(false);
+  output.set_level(logger::LOG_MAJOR);
+  output.add_file(filename);
+
+  // a tiny ring and a slow writer, so most messages cannot fit
+  output.enable_async(256, 10.0);
+
+  const int count = 1000;
+  for (int i = 0; i < count; ++i)
+  {
+    madara_logger_log(output, logger::LOG_MAJOR, "message %d\n", i);
+  }
+
+  // disabling writes everything that fit
+  output.disable_async();
+  output.clear();
+
+  uint64_t dropped = output.get_dropped();
+  std::vector<std::string> lines = read_lines();
+
+  TEST_GT(dropped, (uint64_t)0);
+  TEST_EQ(lines.size() + dropped, (uint64_t)count);
+}
+
+/// logs from all threads for bench_time and returns calls per second
+double benchmark(bool async)
+{
+  std::remove(filename.c_str());
+
+  logger::Logger output(false);
+  output.set_level(logger::LOG_MAJOR);
+  output.add_file(filename);
+
+  if (async)
+  {
+    output.enable_async();
+  }
+
+  std::atomic<bool> done(false);
+  std::atomic<int64_t> calls(0);
+  std::vector<std::thread> threads;
+
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+
+  for (size_t t = 0; t < num_threads; ++t)
+  {
+    threads.push_back(std::thread([&output, &done, &calls, t] {
+      int64_t local = 0;
+      while (!done)
+      {
+        madara_logger_log(output, logger::LOG_MAJOR,
+            "thread %d message %d with a payload of %f\n", (int)t, (int)local,
+            1.5);
+        ++local;
+      }
+      calls += local;
+    }));
+  }
+
+  utility::sleep(bench_time);
+  done = true;
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  timer.stop();
+
+  if (async)
+  {
+    std::cerr << "  async: dropped " << output.get_dropped() << " of " << calls
+              << " messages\n";
+    output.disable_async();
+  }
+
+  return calls / timer.duration_ds();
+}
+
+void test_benchmark(void)
+{
+  std::cerr << "Benchmarking " << num_threads << " threads for " << bench_time
+            << "s each\n";
+
+  double sync_rate = benchmark(false);
+  double async_rate = benchmark(true);
+
+  std::cerr << "  sync:  " << (int64_t)sync_rate << " log calls per second\n";
+  std::cerr << "  async: " << (int64_t)async_rate << " log calls per second\n";
+
+  TEST_GT(async_rate, 0.0);
+
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_async_file();
+  test_drops();
+  test_benchmark();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,265 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Map.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+namespace containers = madara::knowledge::containers;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+size_t agents = 10000;
+size_t syncs = 100;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-a" || arg1 == "--agents")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> agents;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--syncs")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> syncs;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests and times syncing the keys of maps.\n\n"
+          " [-a|--agents num]        number of agents in the map\n"
+          "                          (default 10000)\n"
+          " [-n|--syncs num]         number of times to sync the keys\n"
+          "                          (default 100)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+std::string agent_name(size_t id)
+{
+  std::stringstream buffer;
+  buffer << "agents." << id;
+  return buffer.str();
+}
+
+// syncs the keys the way Map did before the context journaled new keys
+std::vector<std::string> copy_sync_keys(ThreadSafeContext& context,
+    const std::string& common,
+    std::map<std::string, VariableReference>& map)
+{
+  std::vector<std::string> additions;
+  ContextGuard guard(context);
+
+  map.clear();
+
+  std::map<std::string, KnowledgeRecord> contents;
+  context.to_map(common, contents);
+  KnowledgeUpdateSettings keep_local(true);
+
+  for (auto i = contents.begin(); i != contents.end(); ++i)
+  {
+    std::string key = i->first.substr(common.size());
+
+    if (map.find(key) == map.end())
+    {
+      additions.push_back(key);
+      map[key] = context.get_ref(i->first, keep_local);
+    }
+  }
+
+  return additions;
+}
+
+void test_journal(void)
+{
+  std::cerr << "Testing the journal of new keys\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+
+  kb.set("agents.1", Integer(1));
+  kb.set("other", Integer(2));
+
+  uint64_t position = 0;
+  std::vector<std::string> names;
+
+  TEST_EQ(context.get_new_keys("agents.", position, names), true);
+  TEST_EQ(names.size(), (size_t)1);
+
+  names.clear();
+  TEST_EQ(context.get_new_keys("agents.", position, names), true);
+  TEST_EQ(names.size(), (size_t)0);
+
+  // variables created by references and qualities are journaled too
+  kb.get_ref("agents.2");
+  kb.set("agents.3", "three");
+  context.set_quality("agents.4", 3, true, KnowledgeReferenceSettings());
+
+  TEST_EQ(context.get_new_keys("agents.", position, names), true);
+  TEST_EQ(names.size(), (size_t)3);
+
+  // deleting a variable makes callers rescan
+  context.delete_variable("agents.2");
+
+  names.clear();
+  TEST_EQ(context.get_new_keys("agents.", position, names), false);
+  TEST_EQ(names.size(), (size_t)3);
+
+  names.clear();
+  TEST_EQ(context.get_new_keys("agents.", position, names), true);
+  TEST_EQ(names.size(), (size_t)0);
+}
+
+void test_map(void)
+{
+  std::cerr << "Testing syncing map keys\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+
+  kb.set("agents.1", Integer(1));
+  kb.set("agents.2", Integer(2));
+
+  containers::Map map("agents", kb);
+  TEST_EQ(map.size(), (size_t)2);
+  TEST_EQ(map.sync_keys().size(), (size_t)0);
+
+  kb.set("agents.3", Integer(3));
+  kb.set("others.4", Integer(4));
+
+  std::vector<std::string> additions = map.sync_keys();
+  TEST_EQ(additions.size(), (size_t)1);
+  TEST_EQ(additions[0], std::string("3"));
+  TEST_EQ(map.size(), (size_t)3);
+
+  // keys the map adds itself are not additions
+  map.set("5", Integer(5));
+  TEST_EQ(map.sync_keys().size(), (size_t)0);
+  TEST_EQ(map.size(), (size_t)4);
+
+  // deleted keys leave the map, and new ones are still added
+  context.delete_variable("agents.1");
+  kb.set("agents.6", Integer(6));
+
+  additions = map.sync_keys();
+  TEST_EQ(additions.size(), (size_t)1);
+  TEST_EQ(additions[0], std::string("6"));
+  TEST_EQ(map.size(), (size_t)4);
+  TEST_EQ(map.exists("1"), false);
+  TEST_EQ(map["6"].to_integer(), Integer(6));
+
+  // creating more keys than the journal holds makes the map rescan
+  for (size_t i = 0; i < 70000; ++i)
+  {
+    kb.get_ref(agent_name(i + 100) + ".x");
+  }
+
+  additions = map.sync_keys();
+  TEST_EQ(additions.size(), (size_t)70000);
+  TEST_EQ(map.size(), (size_t)70004);
+}
+
+void test_scale(void)
+{
+  std::cerr << "Timing " << syncs << " syncs of a map of " << agents
+            << " agents\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+
+  // each agent has a position and a short history
+  for (size_t i = 0; i < agents; ++i)
+  {
+    kb.set(agent_name(i) + ".pos", std::vector<double>(16, 1.0 * i));
+  }
+
+  containers::Map map("agents", kb);
+  std::map<std::string, VariableReference> copied;
+  copy_sync_keys(context, "agents.", copied);
+
+  TEST_EQ(map.size(), agents);
+  TEST_EQ(copied.size(), agents);
+
+  // one agent joins between syncs
+  uint64_t copy_time = 0;
+  uint64_t journal_time = 0;
+  size_t copy_additions = 0;
+  size_t journal_additions = 0;
+
+  for (size_t i = 0; i < syncs; ++i)
+  {
+    kb.set(agent_name(agents + i) + ".pos", std::vector<double>(16, 0.0));
+
+    uint64_t start = utility::get_time();
+    copy_additions = copy_sync_keys(context, "agents.", copied).size();
+    copy_time += utility::get_time() - start;
+
+    start = utility::get_time();
+    journal_additions += map.sync_keys().size();
+    journal_time += utility::get_time() - start;
+  }
+
+  TEST_EQ(map.size(), agents + syncs);
+  TEST_EQ(copied.size(), agents + syncs);
+  TEST_EQ(journal_additions, syncs);
+
+  // the copying sync reports every key as added
+  TEST_EQ(copy_additions, agents + syncs);
+
+  std::cerr << "  ns per sync: " << copy_time / syncs
+            << " copying the prefix, " << journal_time / syncs
+            << " with the key journal\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_journal();
+  test_map();
+  test_scale();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,191 @@
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "madara/exceptions/NameException.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/MetricsPublisher.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Metrics.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+std::string filename("test_metrics.prom");
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-f" || arg1 == "--file")
+    {
+      if (i + 1 < argc)
+      {
+        filename = argv[i + 1];
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests the metrics registry and metrics publishing.\n\n"
+          " [-f|--file name]         the Prometheus file to write to\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+void test_registry(void)
+{
+  std::cerr << "Testing the metrics registry\n";
+
+  utility::Metrics metrics;
+
+  utility::Metrics::Counter& sent = metrics.counter("sent", "Things sent");
+  sent.add();
+  sent.add(4);
+
+  TEST_EQ(&metrics.counter("sent"), &sent);
+  TEST_EQ(sent.get(), (int64_t)5);
+
+  utility::Metrics::Gauge& size = metrics.gauge("size");
+  size.set(10);
+  size.add(-3);
+  TEST_EQ(size.get(), (int64_t)7);
+
+  utility::Metrics::Histogram& latency = metrics.histogram("latency");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.push_back(std::thread([&latency] {
+      for (int i = 1; i <= 1000; ++i)
+      {
+        latency.record(i);
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  TEST_EQ(latency.count(), (uint64_t)4000);
+  TEST_EQ(latency.sum(), (int64_t)(4 * 500500));
+  TEST_EQ(latency.get_histogram().max(), (int64_t)1000);
+  TEST_EQ(metrics.size(), (size_t)3);
+
+  bool thrown = false;
+  try
+  {
+    metrics.gauge("sent");
+  }
+  catch (const madara::exceptions::NameException&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+
+  std::vector<std::pair<std::string, int64_t>> samples = metrics.samples();
+
+  // histograms have count, sum, max and three percentiles
+  TEST_EQ(samples.size(), (size_t)8);
+  TEST_EQ(samples[0].first, "latency.count");
+  TEST_EQ(samples[0].second, (int64_t)4000);
+  TEST_EQ(samples[6].first, "sent");
+  TEST_EQ(samples[6].second, (int64_t)5);
+  TEST_EQ(samples[7].first, "size");
+  TEST_EQ(samples[7].second, (int64_t)7);
+
+  std::string text = metrics.to_prometheus();
+
+  TEST_NE(text.find("# HELP madara_sent Things sent\n"), std::string::npos);
+  TEST_NE(text.find("# TYPE madara_sent counter\nmadara_sent 5\n"),
+      std::string::npos);
+  TEST_NE(text.find("# TYPE madara_size gauge\nmadara_size 7\n"),
+      std::string::npos);
+  TEST_NE(text.find("# TYPE madara_latency summary\n"), std::string::npos);
+  TEST_NE(text.find("madara_latency{quantile=\"0.99\"}"), std::string::npos);
+  TEST_NE(text.find("madara_latency_count 4000\n"), std::string::npos);
+}
+
+void test_publishing(void)
+{
+  std::cerr << "Testing metrics published from a knowledge base\n";
+
+  std::remove(filename.c_str());
+
+  knowledge::KnowledgeBase kb;
+
+  kb.evaluate("a = 1");
+  kb.evaluate("a = 1");
+  kb.evaluate("b = 2");
+
+  knowledge::MetricsPublisher::publish(kb.get_context(), ".metrics", filename);
+
+  TEST_EQ(kb.get(".metrics.context.evaluations").to_integer(),
+      (knowledge::KnowledgeRecord::Integer)3);
+  TEST_EQ(kb.get(".metrics.interpreter.cache_misses").to_integer(),
+      (knowledge::KnowledgeRecord::Integer)2);
+  TEST_EQ(kb.get(".metrics.interpreter.cache_hits").to_integer(),
+      (knowledge::KnowledgeRecord::Integer)1);
+  TEST_GE(kb.get(".metrics.context.map_size").to_integer(),
+      (knowledge::KnowledgeRecord::Integer)2);
+  TEST_EQ(kb.get(".metrics.interpreter.compile_ns.count").to_integer(),
+      (knowledge::KnowledgeRecord::Integer)2);
+
+  std::ifstream input(filename.c_str());
+  std::stringstream contents;
+  contents << input.rdbuf();
+
+  TEST_NE(contents.str().find("madara_context_evaluations 3\n"),
+      std::string::npos);
+
+  std::remove(filename.c_str());
+
+  {
+    // periodic publishing sets the variables without being asked
+    knowledge::MetricsPublisher publisher(kb, 100, ".periodic");
+    utility::sleep(0.1);
+  }
+
+  TEST_EQ(kb.get(".periodic.context.evaluations").to_integer(),
+      (knowledge::KnowledgeRecord::Integer)3);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_registry();
+  test_publishing();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,313 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/ArrayDelta.h"
+#include "madara/knowledge/containers/TensorT.h"
+#include "madara/knowledge/containers/DoubleVector2D.h"
+#include "madara/exceptions/IndexException.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+namespace containers = madara::knowledge::containers;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+size_t grid_size = 256;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-s" || arg1 == "--size")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> grid_size;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests tensors and times them against per-element vectors.\n\n"
+          " [-s|--size num]          rows and columns of the timed grids\n"
+          "                          (default 256)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+size_t count_variables(KnowledgeBase& kb)
+{
+  const ThreadSafeContext& context = kb.get_context();
+  ContextGuard guard(kb);
+  return context.get_map_unsafe().size();
+}
+
+void test_matrix(void)
+{
+  std::cerr << "Testing a 3x4 double tensor\n";
+
+  KnowledgeBase kb;
+  containers::DoubleTensor matrix("grid", kb, {3, 4});
+
+  TEST_EQ(matrix.elements(), (size_t)12);
+  TEST_EQ(kb.get("grid").type(), (uint32_t)KnowledgeRecord::DOUBLE_ARRAY);
+  TEST_EQ(kb.get("grid").size(), (size_t)12);
+  TEST_EQ(kb.get("grid.size").to_string(", "), std::string("3, 4"));
+
+  // only the elements and the size are variables
+  TEST_EQ(count_variables(kb), (size_t)2);
+
+  matrix.set({1, 2}, 1.5);
+  TEST_EQ((matrix[{1, 2}]), 1.5);
+  TEST_EQ(kb.get("grid").retrieve_index(6).to_double(), 1.5);
+
+  // rows are contiguous, columns are strided
+  matrix.row(2).set({1.0, 2.0, 3.0, 4.0});
+  matrix.column(0).fill(-1.0);
+
+  std::vector<double> row = matrix.row(2).to_vector();
+  TEST_EQ(row.size(), (size_t)4);
+  TEST_EQ(row[0], -1.0);
+  TEST_EQ(row[3], 4.0);
+
+  std::vector<double> column = matrix.column(2).to_vector();
+  TEST_EQ(column.size(), (size_t)3);
+  TEST_EQ(column[1], 1.5);
+  TEST_EQ(column[2], 3.0);
+
+  containers::DoubleTensor::View element = matrix.row(1).slice(0, 2);
+  TEST_EQ(element.elements(), (size_t)1);
+  TEST_EQ(element[{}], 1.5);
+
+  std::vector<double> all;
+  matrix.copy_to(all);
+  TEST_EQ(all.size(), (size_t)12);
+  TEST_EQ(all[0], -1.0);
+  TEST_EQ(all[11], 4.0);
+
+  // bulk sets replace the record in one update
+  std::vector<double> values(12);
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = (double)i;
+  }
+  matrix.set(values);
+  TEST_EQ((matrix[{2, 1}]), 9.0);
+
+  bool thrown = false;
+  try
+  {
+    matrix[{3, 0}];
+  }
+  catch (const exceptions::IndexException&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+
+  thrown = false;
+  try
+  {
+    matrix.row(0).set({1.0});
+  }
+  catch (const exceptions::IndexException&)
+  {
+    thrown = true;
+  }
+  TEST_EQ(thrown, true);
+
+  // another tensor reads the size from the knowledge base
+  containers::DoubleTensor reader("grid", kb);
+  TEST_EQ(reader.elements(), (size_t)12);
+  TEST_EQ((reader[{2, 3}]), 11.0);
+
+  // resizing to the same number of elements keeps them in place
+  matrix.resize({4, 3});
+  TEST_EQ((matrix[{3, 2}]), 11.0);
+  reader.resize();
+  containers::DoubleTensor::Dimensions dims = reader.size();
+  TEST_EQ(dims.size(), (size_t)2);
+  TEST_EQ(dims[0], (size_t)4);
+}
+
+void test_cube(void)
+{
+  std::cerr << "Testing a 2x3x4 integer tensor\n";
+
+  KnowledgeBase kb;
+  containers::IntegerTensor cube("cube", kb, {2, 3, 4});
+
+  TEST_EQ(kb.get("cube").type(), (uint32_t)KnowledgeRecord::INTEGER_ARRAY);
+
+  cube.slice(0, 1).fill(7);
+  cube.set({0, 2, 3}, 5);
+
+  containers::IntegerTensor::View plane = cube.slice(2, 3);
+  TEST_EQ(plane.size().size(), (size_t)2);
+
+  std::vector<Integer> values = plane.to_vector();
+  TEST_EQ(values.size(), (size_t)6);
+  TEST_EQ(values[2], (Integer)5);
+  TEST_EQ(values[3], (Integer)7);
+  TEST_EQ(values[0], (Integer)0);
+
+  TEST_EQ((cube[{1, 0, 0}]), (Integer)7);
+  TEST_EQ((cube[{0, 1, 1}]), (Integer)0);
+  TEST_EQ((plane[{1, 2}]), (Integer)7);
+}
+
+void test_deltas(void)
+{
+  std::cerr << "Testing changes to views as array deltas\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+  context.enable_array_deltas(0);
+
+  containers::DoubleTensor matrix("grid", kb, {8, 8});
+  matrix.set({0, 0}, 1.0);
+  context.get_modifieds_current(std::map<std::string, bool>(), true);
+
+  // a column changes one element in each row
+  matrix.column(3).fill(2.0);
+
+  KnowledgeMap modifieds =
+      context.get_modifieds_current(std::map<std::string, bool>(), true);
+
+  TEST_EQ(modifieds.size(), (size_t)1);
+
+  ArrayDelta delta;
+  TEST_EQ(context.get_array_delta("grid", modifieds["grid"], delta), true);
+  TEST_EQ(ArrayDelta::count(delta.ranges), (size_t)8);
+  TEST_EQ(delta.ranges.size(), (size_t)8);
+
+  // bulk writes to a view mark the tensor changed once
+  size_t changes = 0;
+  uint64_t listener =
+      context.add_change_listener([&changes](const char*) { ++changes; });
+
+  matrix.column(5).fill(4.0);
+  matrix.column(6).set(std::vector<double>(8, 5.0));
+  context.remove_change_listener(listener);
+
+  TEST_EQ(changes, (size_t)2);
+  TEST_EQ((matrix[{7, 5}]), 4.0);
+  TEST_EQ((matrix[{7, 6}]), 5.0);
+}
+
+void test_timing(void)
+{
+  std::cerr << "Timing " << grid_size << "x" << grid_size
+            << " tensors against DoubleVector2D\n";
+
+  size_t elements = grid_size * grid_size;
+
+  KnowledgeBase tensor_kb;
+  KnowledgeBase vector_kb;
+
+  uint64_t start = utility::get_time();
+  containers::DoubleTensor tensor("grid", tensor_kb, {grid_size, grid_size});
+  uint64_t tensor_create = utility::get_time() - start;
+
+  start = utility::get_time();
+  containers::DoubleVector2D vector("grid", vector_kb, {grid_size, grid_size});
+  uint64_t vector_create = utility::get_time() - start;
+
+  start = utility::get_time();
+  for (size_t i = 0; i < grid_size; ++i)
+  {
+    for (size_t j = 0; j < grid_size; ++j)
+    {
+      tensor.set({i, j}, (double)(i + j));
+    }
+  }
+  uint64_t tensor_set = utility::get_time() - start;
+
+  start = utility::get_time();
+  for (size_t i = 0; i < grid_size; ++i)
+  {
+    for (size_t j = 0; j < grid_size; ++j)
+    {
+      vector.set({i, j}, (double)(i + j));
+    }
+  }
+  uint64_t vector_set = utility::get_time() - start;
+
+  double tensor_sum = 0;
+  start = utility::get_time();
+  for (size_t i = 0; i < grid_size; ++i)
+  {
+    std::vector<double> row = tensor.row(i).to_vector();
+    for (size_t j = 0; j < row.size(); ++j)
+    {
+      tensor_sum += row[j];
+    }
+  }
+  uint64_t tensor_get = utility::get_time() - start;
+
+  double vector_sum = 0;
+  start = utility::get_time();
+  for (size_t i = 0; i < grid_size; ++i)
+  {
+    for (size_t j = 0; j < grid_size; ++j)
+    {
+      vector_sum += vector[{i, j}];
+    }
+  }
+  uint64_t vector_get = utility::get_time() - start;
+
+  TEST_EQ(tensor_sum, vector_sum);
+  TEST_EQ(count_variables(tensor_kb), (size_t)2);
+  TEST_EQ(count_variables(vector_kb), elements + 1);
+
+  std::cerr << "  ms to create: " << tensor_create / 1000000 << " tensor, "
+            << vector_create / 1000000 << " vector\n"
+            << "  ns per element set: " << tensor_set / elements
+            << " tensor, " << vector_set / elements << " vector\n"
+            << "  ns per element read: " << tensor_get / elements
+            << " tensor rows, " << vector_get / elements << " vector\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_matrix();
+  test_cube();
+  test_deltas();
+  test_timing();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,211 @@
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/TimeSeries.h"
+#include "madara/logger/GlobalLogger.h"
+
+#include "test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace logger = madara::logger;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  if (argc > 1)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nProgram summary for %s:\n\n"
+        "  Tests columnar time series history.\n\n",
+        argv[0]);
+    exit(0);
+  }
+}
+
+void test_series(bool compressed)
+{
+  std::cerr << "Testing " << (compressed ? "compressed" : "uncompressed")
+            << " time series\n";
+
+  knowledge::TimeSeries series(1000, compressed);
+
+  // a slowly changing double sampled every 10 ms, with some jitter
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    uint64_t toi = 1000000000 + i * 10000000 + (i % 3) * 1000;
+    series.add(toi, knowledge::KnowledgeRecord(20.0 + (i / 100) * 0.5));
+  }
+
+  TEST_EQ(series.is_integer(), false);
+
+  // compressed series evict whole blocks
+  if (compressed)
+  {
+    TEST_GE(series.size(), (size_t)1000);
+    TEST_LT(series.size(), (size_t)(1000 + knowledge::TimeSeries::block_size));
+  }
+  else
+  {
+    TEST_EQ(series.size(), (size_t)1000);
+  }
+
+  // the newest sample round trips exactly
+  std::vector<knowledge::TimeSeries::Sample> newest =
+      series.get(series.newest_toi());
+
+  TEST_EQ(newest.size(), (size_t)1);
+  TEST_EQ(newest[0].toi, 1000000000 + 1999 * 10000000ull + 1000);
+  TEST_EQ(newest[0].value, 20.0 + 19 * 0.5);
+
+  // one second of samples starting at sample 1500
+  uint64_t start = 1000000000 + 1500 * 10000000ull;
+  uint64_t end = start + 1000000000 - 1;
+
+  std::vector<knowledge::TimeSeries::Sample> samples = series.get(start, end);
+
+  TEST_EQ(samples.size(), (size_t)100);
+  TEST_EQ(samples.front().toi, start);
+  TEST_EQ(samples.front().value, 27.5);
+
+  bool sorted = true;
+  for (size_t i = 1; i < samples.size(); ++i)
+  {
+    sorted = sorted && samples[i - 1].toi <= samples[i].toi;
+  }
+  TEST_EQ(sorted, true);
+
+  knowledge::TimeSeries::Window summary = series.summarize(start, end);
+
+  TEST_EQ(summary.count, (uint64_t)100);
+  TEST_EQ(summary.min, 27.5);
+  TEST_EQ(summary.max, 27.5);
+  TEST_EQ(summary.mean, 27.5);
+
+  // downsample two seconds into 500 ms windows
+  std::vector<knowledge::TimeSeries::Window> windows =
+      series.aggregate(500000000, start, start + 2000000000 - 1);
+
+  TEST_EQ(windows.size(), (size_t)4);
+  TEST_EQ(windows[0].start, start);
+  TEST_EQ(windows[1].start, start + 500000000);
+  TEST_EQ(windows[0].count, (uint64_t)50);
+  TEST_EQ(windows[3].mean, 28.0);
+
+  size_t visited = series.for_each(
+      [](uint64_t, double value) { (void)value; }, start, end);
+
+  TEST_EQ(visited, (size_t)100);
+
+  std::cerr << "  " << series.size() << " samples in "
+            << series.memory_size() << " bytes\n";
+
+  if (compressed)
+  {
+    TEST_LT(series.memory_size(), series.size() * 4);
+  }
+  else
+  {
+    TEST_LE(series.memory_size(), series.size() * 16);
+  }
+}
+
+void test_integers(void)
+{
+  std::cerr << "Testing integer time series\n";
+
+  knowledge::TimeSeries series(10, true);
+
+  series.add(100, knowledge::KnowledgeRecord(Integer(-5)));
+  series.add(200, knowledge::KnowledgeRecord(Integer(1) << 60));
+  series.add(300, 7.9);
+
+  // earlier times are stored as the newest time
+  series.add(250, knowledge::KnowledgeRecord(Integer(3)));
+
+  TEST_EQ(series.is_integer(), true);
+  TEST_EQ(series.add(400, knowledge::KnowledgeRecord("text")), false);
+
+  std::vector<knowledge::TimeSeries::Sample> samples = series.get();
+
+  TEST_EQ(samples.size(), (size_t)4);
+  TEST_EQ(samples[0].value, -5.0);
+  TEST_EQ(samples[1].value, (double)(Integer(1) << 60));
+  TEST_EQ(samples[2].value, 7.0);
+  TEST_EQ(samples[3].toi, (uint64_t)300);
+}
+
+void test_knowledge_base(void)
+{
+  std::cerr << "Testing time series of a knowledge base\n";
+
+  knowledge::KnowledgeBase kb;
+
+  kb.set("speed", 1.5);
+  kb.set_time_series_capacity("speed", 100);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    kb.set("speed", 2.0 + i);
+  }
+
+  kb.evaluate("speed = 20.5");
+  kb.set("other", Integer(1));
+
+  std::vector<knowledge::TimeSeries::Sample> samples =
+      kb.get_time_series("speed");
+
+  TEST_EQ(samples.size(), (size_t)12);
+  TEST_EQ(samples.front().value, 1.5);
+  TEST_EQ(samples.back().value, 20.5);
+  TEST_EQ(samples.back().toi, kb.get("speed").toi());
+
+  knowledge::TimeSeries::Window summary = kb.summarize_time_series("speed");
+
+  TEST_EQ(summary.count, (uint64_t)12);
+  TEST_EQ(summary.min, 1.5);
+  TEST_EQ(summary.max, 20.5);
+
+  TEST_EQ(kb.evaluate("#time_series ('speed', 'count')").to_integer(),
+      (Integer)12);
+  TEST_EQ(kb.evaluate("#time_series ('speed', 'max')").to_double(), 20.5);
+  TEST_EQ(kb.evaluate("#time_series ('speed', 'values')").size(),
+      (uint32_t)12);
+  TEST_EQ(kb.evaluate("#time_series ('speed', 'count', #get_time () + "
+                      "1000000000)")
+              .to_integer(),
+      (Integer)0);
+  TEST_EQ(kb.evaluate("#time_series ('other', 'count')").to_integer(),
+      (Integer)0);
+
+  kb.set_time_series_capacity("speed", 0);
+
+  TEST_EQ(kb.get_time_series("speed").size(), (size_t)0);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_series(false);
+  test_series(true);
+  test_integers();
+  test_knowledge_base();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
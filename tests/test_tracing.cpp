@@ -0,0 +1,237 @@
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+#include "madara/utility/Tracer.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+// shortcuts
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+std::string filename("test_tracing.json");
+int iterations(1000000);
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-f" || arg1 == "--file")
+    {
+      if (i + 1 < argc)
+      {
+        filename = argv[i + 1];
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-i" || arg1 == "--iterations")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> iterations;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests span tracing and Chrome trace export.\n\n"
+          " [-f|--file name]         the trace file to write to\n"
+          " [-i|--iterations num]    spans to record in the benchmark\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/// counts the occurrences of text in a string
+size_t count(const std::string& source, const std::string& text)
+{
+  size_t result = 0;
+
+  for (size_t pos = source.find(text); pos != std::string::npos;
+       pos = source.find(text, pos + text.size()))
+  {
+    ++result;
+  }
+
+  return result;
+}
+
+void test_recording(void)
+{
+  std::cerr << "Testing span recording\n";
+
+  utility::Tracer::disable();
+  utility::Tracer::clear();
+
+  {
+    MADARA_TRACE_SPAN("disabled");
+  }
+
+  TEST_EQ(utility::Tracer::size(), (size_t)0);
+
+  utility::Tracer::enable();
+  TEST_EQ(utility::Tracer::is_enabled(), true);
+
+  {
+    MADARA_TRACE_SPAN("outer");
+    {
+      MADARA_TRACE_SPAN("inner");
+      utility::sleep(0.01);
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; ++t)
+  {
+    threads.push_back(std::thread([t] {
+      if (t == 0)
+      {
+        utility::Tracer::set_thread_name("named \"worker\"");
+      }
+
+      for (int i = 0; i < 10; ++i)
+      {
+        MADARA_TRACE_SPAN("worker_span");
+      }
+    }));
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  utility::Tracer::disable();
+
+  {
+    MADARA_TRACE_SPAN("disabled");
+  }
+
+  TEST_EQ(utility::Tracer::size(), (size_t)32);
+
+  std::string json = utility::Tracer::to_chrome_trace();
+
+  TEST_EQ(json.find("{\"traceEvents\":["), (size_t)0);
+  TEST_EQ(count(json, "\"ph\":\"X\""), (size_t)32);
+  TEST_EQ(count(json, "\"name\":\"outer\""), (size_t)1);
+  TEST_EQ(count(json, "\"name\":\"inner\""), (size_t)1);
+  TEST_EQ(count(json, "\"name\":\"worker_span\""), (size_t)30);
+  TEST_EQ(count(json, "\"name\":\"disabled\""), (size_t)0);
+  TEST_EQ(count(json, "named \\\"worker\\\""), (size_t)1);
+
+  // the inner span slept for 10ms, so it lasted at least 10000us
+  size_t inner = json.find("\"name\":\"inner\"");
+  size_t dur = json.find("\"dur\":", inner);
+  TEST_GE(std::stod(json.substr(dur + 6)), 10000.0);
+
+  TEST_EQ(utility::Tracer::save_chrome_trace(filename), (int64_t)32);
+
+  std::ifstream input(filename.c_str());
+  std::stringstream contents;
+  contents << input.rdbuf();
+  TEST_EQ(contents.str() == json, true);
+
+  utility::Tracer::clear();
+  TEST_EQ(utility::Tracer::size(), (size_t)0);
+
+  std::remove(filename.c_str());
+}
+
+void test_overflow(void)
+{
+  std::cerr << "Testing that full buffers keep the newest spans\n";
+
+  utility::Tracer::enable(16);
+
+  for (int i = 0; i < 100; ++i)
+  {
+    MADARA_TRACE_SPAN("overflow");
+  }
+
+  utility::Tracer::disable();
+
+  TEST_EQ(utility::Tracer::size(), (size_t)16);
+  TEST_EQ(count(utility::Tracer::to_chrome_trace(), "\"ph\":\"X\""),
+      (size_t)16);
+
+  utility::Tracer::enable();
+  utility::Tracer::disable();
+  TEST_EQ(utility::Tracer::size(), (size_t)0);
+}
+
+/// records iterations spans and returns nanoseconds per span
+double benchmark(void)
+{
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+
+  for (int i = 0; i < iterations; ++i)
+  {
+    MADARA_TRACE_SPAN("benchmark");
+  }
+
+  timer.stop();
+
+  return (double)timer.duration_ns() / iterations;
+}
+
+void test_benchmark(void)
+{
+  std::cerr << "Benchmarking " << iterations << " spans\n";
+
+  utility::Tracer::disable();
+  double disabled = benchmark();
+
+  utility::Tracer::enable();
+  double enabled = benchmark();
+  utility::Tracer::disable();
+  utility::Tracer::clear();
+
+  std::cerr << "  disabled: " << disabled << " ns per span\n";
+  std::cerr << "  enabled:  " << enabled << " ns per span\n";
+
+  TEST_GT(enabled, 0.0);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+#ifndef MADARA_NO_TRACING
+  test_recording();
+  test_overflow();
+  test_benchmark();
+#else
+  std::cerr << "Tracing is compiled out with notracing. Skipping tests.\n";
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
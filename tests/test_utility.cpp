@@ -13,6 +13,7 @@
 #include "madara/utility/Utility.h"
 
 #include "madara/utility/Timer.h"
+#include "madara/utility/LatencyHistogram.h"
 #include "madara/knowledge/FileFragmenter.h"
 
 namespace knowledge = madara::knowledge;
@@ -301,6 +302,69 @@ void test_time(void)
   }
 }
 
+void test_latency_histogram(void)
+{
+  std::cerr << "\n********* Testing LatencyHistogram *************\n\n";
+
+  static utility::LatencyHistogram histogram;
+
+  bool buckets_ok = true;
+
+  // every value must fall within the bounds of its bucket
+  for (uint64_t value = 0; value < 1000000; value += 7)
+  {
+    size_t index = utility::LatencyHistogram::index_of(value);
+
+    if (utility::LatencyHistogram::highest_equivalent(index) < (int64_t)value ||
+        (index > 0 && utility::LatencyHistogram::highest_equivalent(
+                          index - 1) >= (int64_t)value))
+    {
+      buckets_ok = false;
+    }
+  }
+
+  std::cerr << "Testing bucket bounds... ";
+
+  if (buckets_ok &&
+      utility::LatencyHistogram::index_of(INT64_MAX) <
+          utility::LatencyHistogram::buckets)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+
+  // record 1us to 10ms in 1us steps
+  for (int64_t i = 1; i <= 10000; ++i)
+  {
+    histogram.record(i * 1000);
+  }
+
+  double percentiles[] = {50, 99, 99.9};
+  int64_t results[3];
+  histogram.percentiles(percentiles, results, 3);
+
+  std::cerr << "Testing percentiles (p50=" << results[0]
+            << " p99=" << results[1] << " p99.9=" << results[2] << ")... ";
+
+  // each percentile must be within the 1/16 relative error of its bucket
+  if (histogram.count() == 10000 && histogram.max() == 10000000 &&
+      results[0] >= 5000000 && results[0] <= 5000000 * 17 / 16 &&
+      results[1] >= 9900000 && results[1] <= 10000000 &&
+      results[2] >= 9990000 && results[2] <= 10000000)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+}
+
 void test_sqrt(void)
 {
   // keep track of time
@@ -732,6 +796,7 @@ int main(int argc, char** argv)
   test_endian_swap();
   test_heaps();
   test_time();
+  test_latency_histogram();
   test_ints();
   test_sleep();
   test_file_fragmenter();
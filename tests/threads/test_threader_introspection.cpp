@@ -206,6 +206,35 @@ void test_debug_to_kb_introspection(void)
     std::cerr << "FAIL. Knowledge was:\n";
     kb.print();
   }
+
+  std::cerr << "Result of latency percentiles was: ";
+
+  if (kb.get(".threader.thread0.run_p50").exists() &&
+      kb.get(".threader.thread0.run_p999") >=
+          kb.get(".threader.thread0.run_p50") &&
+      kb.get(".threader.thread0.lateness_p99").exists() &&
+      kb.get(".threader.thread0.deadline_misses").exists())
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL. Knowledge was:\n";
+    kb.print();
+  }
+
+  std::cerr << "Result of saving latencies was: ";
+
+  if (threader.save_latencies("test_threader_latencies.txt") > 0)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL\n";
+  }
 }
 
 void test_debug_to_control(void)
@@ -0,0 +1,396 @@
+
+#include <atomic>
+#include <ctime>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/threads/Threader.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+namespace threads = madara::threads;
+namespace logger = madara::logger;
+
+size_t pool_threads(2);
+size_t bench_threads(64);
+double bench_hertz(100);
+double bench_time(2.0);
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-b" || arg1 == "--bench-threads")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> bench_threads;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-d" || arg1 == "--duration")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> bench_time;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--pool")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> pool_threads;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-z" || arg1 == "--hertz")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> bench_hertz;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests thread control in Threader pool mode and compares the\n"
+          "  cost of many periodic threads with and without a pool.\n\n"
+          " [-b|--bench-threads num] the number of benchmark threads\n"
+          " [-d|--duration secs]     the duration of each benchmark\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-p|--pool threads]      the number of pool threads\n"
+          " [-z|--hertz hertz]       the hertz rate of benchmark threads\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+class CountingThread : public threads::BaseThread
+{
+public:
+  CountingThread(std::atomic<int64_t>& counter) : counter_(counter) {}
+
+  virtual void run(void)
+  {
+    ++counter_;
+  }
+
+private:
+  std::atomic<int64_t>& counter_;
+};
+
+void test_one_shot(void)
+{
+  std::cerr << "Testing one shot threads in a pool\n";
+
+  std::atomic<int64_t> counters[8];
+  threads::Threader threader;
+  threader.use_pool(pool_threads);
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    counters[i] = 0;
+    threader.run("once" + std::to_string(i), new CountingThread(counters[i]));
+  }
+
+  TEST_EQ(threader.wait(), true);
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    TEST_EQ((int64_t)counters[i], (int64_t)1);
+  }
+}
+
+void test_pause_resume(void)
+{
+  std::cerr << "Testing pause and resume of a pooled thread\n";
+
+  std::atomic<int64_t> counter(0);
+  threads::Threader threader;
+  threader.use_pool(pool_threads);
+
+  threader.run(100, "periodic", new CountingThread(counter), true);
+
+  utility::sleep(0.2);
+  TEST_EQ((int64_t)counter, (int64_t)0);
+
+  threader.resume("periodic");
+  utility::sleep(0.5);
+  TEST_GT((int64_t)counter, (int64_t)10);
+
+  threader.pause("periodic");
+  utility::sleep(0.1);
+  int64_t paused_count = counter;
+  utility::sleep(0.3);
+  TEST_EQ((int64_t)counter, paused_count);
+
+  threader.terminate("periodic");
+  TEST_EQ(threader.wait("periodic"), true);
+}
+
+void test_change_hertz(void)
+{
+  std::cerr << "Testing change_hertz of a pooled thread\n";
+
+  std::atomic<int64_t> counter(0);
+  threads::Threader threader;
+  threader.use_pool(pool_threads);
+
+  threader.run(10, "periodic", new CountingThread(counter));
+
+  utility::sleep(1.0);
+  int64_t slow_count = counter;
+  TEST_LE(slow_count, (int64_t)12);
+
+  threader.change_hertz("periodic", 200);
+  utility::sleep(1.0);
+  TEST_GT((int64_t)counter - slow_count, (int64_t)100);
+
+  threader.terminate();
+  TEST_EQ(threader.wait(), true);
+}
+
+void test_blasters_share(void)
+{
+  std::cerr << "Testing that blasters do not starve a periodic thread\n";
+
+  std::atomic<int64_t> blasted(0);
+  std::atomic<int64_t> counter(0);
+  threads::Threader threader;
+  threader.use_pool(1);
+
+  threader.run(0, "blaster1", new CountingThread(blasted));
+  threader.run(0, "blaster2", new CountingThread(blasted));
+  threader.run(50, "periodic", new CountingThread(counter));
+
+  utility::sleep(1.0);
+
+  threader.terminate();
+  TEST_EQ(threader.wait(), true);
+
+  TEST_GT((int64_t)blasted, (int64_t)1000);
+  TEST_GT((int64_t)counter, (int64_t)25);
+}
+
+void test_control_plane_writes(bool pool)
+{
+  std::cerr << "Testing control plane writes that bypass the Threader"
+            << (pool ? " in a pool\n" : "\n");
+
+  std::atomic<int64_t> counter(0);
+  threads::Threader threader;
+
+  if (pool)
+  {
+    threader.use_pool(pool_threads);
+  }
+
+  knowledge::KnowledgeBase control = threader.get_control_plane();
+
+  threader.run(1000, "fast", new CountingThread(counter));
+  utility::sleep(0.2);
+
+  // flags set directly in the control plane are seen at the sync period
+  control.set("fast.paused", knowledge::KnowledgeRecord::Integer(1));
+  utility::sleep(0.1);
+  int64_t paused_count = counter;
+  utility::sleep(0.2);
+  TEST_EQ((int64_t)counter, paused_count);
+
+  control.set("fast.paused", knowledge::KnowledgeRecord::Integer(0));
+  control.set("fast.hertz", 100.0);
+  utility::sleep(0.1);
+  int64_t resumed_count = counter;
+  utility::sleep(1.0);
+  TEST_LE((int64_t)counter - resumed_count, (int64_t)110);
+  TEST_GT((int64_t)counter - resumed_count, (int64_t)50);
+
+  control.set("fast.terminated", knowledge::KnowledgeRecord::Integer(1));
+
+  knowledge::WaitSettings settings;
+  settings.max_wait_time = 1.0;
+  TEST_EQ(threader.wait("fast", settings), true);
+}
+
+int64_t benchmark(bool pool, double& cpu_seconds)
+{
+  std::atomic<int64_t> counter(0);
+  threads::Threader threader;
+
+  if (pool)
+  {
+    threader.use_pool(pool_threads);
+  }
+
+  std::clock_t start = std::clock();
+
+  for (size_t i = 0; i < bench_threads; ++i)
+  {
+    threader.run(bench_hertz, "bench" + std::to_string(i),
+        new CountingThread(counter));
+  }
+
+  utility::sleep(bench_time);
+
+  threader.terminate();
+  threader.wait();
+
+  cpu_seconds = (double)(std::clock() - start) / CLOCKS_PER_SEC;
+
+  return counter;
+}
+
+class CpuThread : public threads::BaseThread
+{
+public:
+  CpuThread(std::atomic<int>& cpu) : cpu_(cpu) {}
+
+  virtual void run(void)
+  {
+#ifdef __linux__
+    cpu_ = sched_getcpu();
+#else
+    cpu_ = 0;
+#endif
+  }
+
+private:
+  std::atomic<int>& cpu_;
+};
+
+void test_thread_settings(void)
+{
+  std::cerr << "Testing thread affinity and scheduling settings\n";
+
+  // pinning may be refused, e.g., if core 0 is outside our cpuset
+  bool can_pin = false;
+  std::thread probe(
+      [&can_pin] { can_pin = utility::set_thread_affinity({0}); });
+  probe.join();
+
+  threads::ThreadSettings pinned;
+  pinned.cores.push_back(0);
+
+  // unprivileged processes cannot use real-time policies, but the
+  // thread must still run with whatever settings were accepted
+  threads::ThreadSettings realtime;
+  realtime.policy = threads::ThreadSettings::POLICY_FIFO;
+  realtime.priority = 1;
+
+  std::atomic<int> pinned_cpu(-1), realtime_cpu(-1), default_cpu(-1);
+
+  threads::Threader threader;
+  threader.set_thread_settings("pinned", pinned);
+  threader.set_thread_settings(realtime);
+
+  threader.run("pinned", new CpuThread(pinned_cpu));
+  threader.run("realtime", new CpuThread(realtime_cpu));
+
+  threader.set_thread_settings(threads::ThreadSettings());
+  threader.run("default", new CpuThread(default_cpu));
+
+  TEST_EQ(threader.wait(), true);
+
+  TEST_GE((int)realtime_cpu, 0);
+  TEST_GE((int)default_cpu, 0);
+
+  if (can_pin)
+  {
+    TEST_EQ((int)pinned_cpu, 0);
+  }
+  else
+  {
+    TEST_GE((int)pinned_cpu, 0);
+  }
+}
+
+void test_benchmark(void)
+{
+  std::cerr << "Benchmarking " << bench_threads << " threads at "
+            << bench_hertz << " hz for " << bench_time << "s\n";
+
+  double thread_cpu = 0, pool_cpu = 0;
+  int64_t thread_runs = benchmark(false, thread_cpu);
+  int64_t pool_runs = benchmark(true, pool_cpu);
+
+  std::cerr << "  one OS thread per BaseThread: " << thread_runs
+            << " executions, " << thread_cpu << "s cpu\n";
+  std::cerr << "  pool of " << pool_threads << ": " << pool_runs
+            << " executions, " << pool_cpu << "s cpu\n";
+
+  // the pool should keep up with the requested rate
+  TEST_GT(pool_runs,
+      (int64_t)(bench_threads * bench_hertz * bench_time * 0.5));
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+#ifndef _MADARA_NO_KARL_
+  test_one_shot();
+  test_pause_resume();
+  test_change_hertz();
+  test_blasters_share();
+  test_control_plane_writes(false);
+  test_control_plane_writes(true);
+  test_thread_settings();
+  test_benchmark();
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "This test is disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,308 @@
+
+#include <atomic>
+#include <string>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/threads/Threader.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+#include "madara/utility/Utility.h"
+
+#include "../test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+namespace threads = madara::threads;
+namespace logger = madara::logger;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+size_t pool_threads(2);
+int latency_samples(1000);
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--samples")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> latency_samples;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--pool")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> pool_threads;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests threads that are executed by knowledge changes.\n\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-n|--samples num]       the number of latency samples\n"
+          " [-p|--pool threads]      the number of pool threads\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/// time of the last change made by the test, in nanoseconds
+std::atomic<int64_t> changed_at(0);
+
+class ReactingThread : public threads::BaseThread
+{
+public:
+  ReactingThread(std::atomic<int64_t>& counter, std::atomic<int64_t>& latency)
+    : counter_(counter), latency_(latency)
+  {
+  }
+
+  virtual void run(void)
+  {
+    ++counter_;
+    latency_ += utility::get_time() - changed_at;
+  }
+
+private:
+  std::atomic<int64_t>& counter_;
+  std::atomic<int64_t>& latency_;
+};
+
+void change(knowledge::KnowledgeBase& kb, const std::string& key, Integer value)
+{
+  changed_at = utility::get_time();
+  kb.set(key, value);
+}
+
+void test_keys_and_prefixes(bool pool)
+{
+  std::cerr << "Testing key and prefix triggers"
+            << (pool ? " in a pool\n" : "\n");
+
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+  std::atomic<int64_t> key_runs(0), prefix_runs(0), latency(0);
+
+  if (pool)
+  {
+    threader.use_pool(pool_threads);
+  }
+
+  threads::ThreadTrigger key_trigger;
+  key_trigger.keys.push_back("input");
+
+  threads::ThreadTrigger prefix_trigger;
+  prefix_trigger.prefixes.push_back("sensor.");
+
+  threader.run(key_trigger, "key", new ReactingThread(key_runs, latency));
+  threader.run(
+      prefix_trigger, "prefix", new ReactingThread(prefix_runs, latency));
+
+  utility::sleep(0.1);
+
+  // both threads run once after init
+  TEST_EQ((int64_t)key_runs, (int64_t)1);
+  TEST_EQ((int64_t)prefix_runs, (int64_t)1);
+
+  for (Integer i = 1; i <= 5; ++i)
+  {
+    change(kb, "input", i);
+    utility::sleep(0.02);
+  }
+
+  change(kb, "sensor.left", 1);
+  utility::sleep(0.02);
+  change(kb, "sensor.right", 1);
+  utility::sleep(0.02);
+  change(kb, "unrelated", 1);
+  utility::sleep(0.1);
+
+  TEST_EQ((int64_t)key_runs, (int64_t)6);
+  TEST_EQ((int64_t)prefix_runs, (int64_t)3);
+
+  // idle triggered threads must still see terminate promptly
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+
+  threader.terminate();
+
+  knowledge::WaitSettings settings;
+  settings.max_wait_time = 1.0;
+  TEST_EQ(threader.wait(settings), true);
+
+  timer.stop();
+  TEST_LT(timer.duration_ns(), (uint64_t)500000000);
+}
+
+void test_condition(void)
+{
+  std::cerr << "Testing condition triggers\n";
+
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+  std::atomic<int64_t> runs(0), latency(0);
+
+  threads::ThreadTrigger trigger;
+  trigger.keys.push_back("input");
+  trigger.condition = "input > 3";
+
+  threader.run(trigger, "condition", new ReactingThread(runs, latency));
+
+  for (Integer i = 1; i <= 6; ++i)
+  {
+    change(kb, "input", i);
+    utility::sleep(0.02);
+  }
+
+  utility::sleep(0.1);
+
+  TEST_EQ((int64_t)runs, (int64_t)3);
+
+  threader.terminate();
+  threader.wait();
+}
+
+void test_debounce_and_rate(void)
+{
+  std::cerr << "Testing debounce and max rate\n";
+
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+  std::atomic<int64_t> debounced(0), limited(0), latency(0);
+
+  threads::ThreadTrigger debounce;
+  debounce.keys.push_back("burst");
+  debounce.debounce = 0.1;
+
+  threads::ThreadTrigger rate;
+  rate.keys.push_back("stream");
+  rate.max_hertz = 10;
+
+  threader.run(debounce, "debounce", new ReactingThread(debounced, latency));
+  threader.run(rate, "rate", new ReactingThread(limited, latency));
+
+  utility::sleep(0.2);
+
+  // a burst of 100 changes within the debounce window runs once
+  for (Integer i = 0; i < 100; ++i)
+  {
+    change(kb, "burst", i);
+  }
+
+  // a second of changes at 1khz runs at most about 10 times
+  for (Integer i = 0; i < 1000; ++i)
+  {
+    change(kb, "stream", i);
+    utility::sleep(0.001);
+  }
+
+  utility::sleep(0.3);
+
+  TEST_EQ((int64_t)debounced, (int64_t)2);
+  TEST_LE((int64_t)limited, (int64_t)14);
+  TEST_GE((int64_t)limited, (int64_t)5);
+
+  threader.terminate();
+  threader.wait();
+}
+
+void test_latency(bool pool)
+{
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+  std::atomic<int64_t> runs(0), latency(0);
+
+  if (pool)
+  {
+    threader.use_pool(pool_threads);
+  }
+
+  threads::ThreadTrigger trigger;
+  trigger.keys.push_back("input");
+
+  threader.run(trigger, "reactor", new ReactingThread(runs, latency));
+
+  utility::sleep(0.1);
+  runs = 0;
+  latency = 0;
+
+  for (int i = 0; i < latency_samples; ++i)
+  {
+    change(kb, "input", i);
+
+    while (runs <= i)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  std::cerr << "Average trigger latency" << (pool ? " in a pool: " : ": ")
+            << latency / (runs > 0 ? (int64_t)runs : 1) << " ns over " << runs
+            << " changes\n";
+
+  TEST_EQ((int64_t)runs, (int64_t)latency_samples);
+
+  threader.terminate();
+  threader.wait();
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+#ifndef _MADARA_NO_KARL_
+  test_keys_and_prefixes(false);
+  test_keys_and_prefixes(true);
+  test_condition();
+  test_debounce_and_rate();
+  test_latency(false);
+  test_latency(true);
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "This test is disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,261 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/shmem/SharedMemoryTransport.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../../test.h"
+
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+namespace ipc = boost::interprocess;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+std::string segment("madara_test_shmem");
+size_t iterations = 1000;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-s" || arg1 == "--segment")
+    {
+      if (i + 1 < argc)
+        segment = argv[i + 1];
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--iterations")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> iterations;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests the shared memory transport by connecting two knowledge\n"
+          "  bases in the same process to a shared memory segment and\n"
+          "  measuring round trip latency.\n\n"
+          " [-s|--segment name]      the shared memory segment name\n"
+          " [-n|--iterations num]    number of round trips to time\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+transport::QoSTransportSettings make_settings(void)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::SHMEM;
+  settings.hosts.push_back(segment);
+  settings.queue_length = 1000000;
+  return settings;
+}
+
+void test_delivery(void)
+{
+  std::cerr << "Testing shared memory delivery\n";
+
+  transport::QoSTransportSettings settings = make_settings();
+
+  KnowledgeBase sender("", settings);
+  KnowledgeBase receiver("", settings);
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 5;
+  wait_settings.poll_frequency = -1;
+
+  sender.set("var1", Integer(42), EvalSettings::SEND);
+  sender.set("var2", "hello", EvalSettings::SEND);
+  sender.set("var3", std::vector<double>(10000, 3.5), EvalSettings::SEND);
+  sender.set("done", Integer(1), EvalSettings::SEND);
+
+  // messages are delivered in ring order, so done arrives last
+  receiver.wait("done == 1", wait_settings);
+
+  TEST_EQ(receiver.get("var1").to_integer(), (Integer)42);
+  TEST_EQ(receiver.get("var2").to_string(), std::string("hello"));
+  TEST_EQ(receiver.get("var3").size(), (size_t)10000);
+  TEST_EQ(receiver.get("var3").retrieve_index(9999).to_double(), 3.5);
+
+  // local variables must never leave the process
+  sender.set(".local", Integer(1), EvalSettings::SEND);
+  sender.set("var4", Integer(4), EvalSettings::SEND);
+
+  receiver.wait("var4 == 4", wait_settings);
+
+  TEST_EQ(receiver.get("var4").to_integer(), (Integer)4);
+  TEST_EQ(receiver.exists(".local"), false);
+}
+
+void test_wraparound(void)
+{
+  std::cerr << "Testing shared memory ring wraparound\n";
+
+  transport::QoSTransportSettings settings = make_settings();
+
+  // a small ring forces the writer to wrap and evict old messages
+  settings.queue_length = 4096;
+
+  KnowledgeBase sender("", settings);
+  KnowledgeBase receiver("", settings);
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 5;
+  wait_settings.poll_frequency = -1;
+
+  for (Integer i = 1; i <= 200; ++i)
+  {
+    sender.set("counter", i, EvalSettings::SEND);
+  }
+
+  receiver.wait("counter == 200", wait_settings);
+
+  TEST_EQ(receiver.get("counter").to_integer(), (Integer)200);
+}
+
+void test_detach(void)
+{
+  std::cerr << "Testing shared memory segment removal\n";
+
+  transport::QoSTransportSettings settings = make_settings();
+
+  {
+    KnowledgeBase first("", settings);
+
+    ipc::managed_shared_memory segment(ipc::open_only, ::segment.c_str());
+    transport::SharedMemoryRing* ring =
+        segment.find<transport::SharedMemoryRing>("ring").first;
+
+    {
+      ipc::scoped_lock<ipc::interprocess_mutex> guard(ring->mutex);
+      TEST_EQ(ring->attached, (uint32_t)1);
+
+#ifndef _WIN32
+      // a process that exited without closing its transport
+      ring->attached_pids[ring->attached++] = 2147483000;
+#endif
+    }
+
+    KnowledgeBase second("", settings);
+
+    ipc::scoped_lock<ipc::interprocess_mutex> guard(ring->mutex);
+    TEST_EQ(ring->attached, (uint32_t)2);
+  }
+
+  bool removed = false;
+
+  try
+  {
+    ipc::shared_memory_object object(
+        ipc::open_only, segment.c_str(), ipc::read_only);
+  }
+  catch (const ipc::interprocess_exception&)
+  {
+    removed = true;
+  }
+
+  TEST_EQ(removed, true);
+}
+
+void test_latency(void)
+{
+  std::cerr << "Testing shared memory round trip latency\n";
+
+  transport::QoSTransportSettings settings = make_settings();
+
+  KnowledgeBase ping("", settings);
+  KnowledgeBase pong("", settings);
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 5;
+  wait_settings.poll_frequency = -1;
+
+  size_t completed = 0;
+  int64_t start = utility::get_time();
+
+  for (Integer i = 1; i <= (Integer)iterations; ++i)
+  {
+    ping.set("ping", i, EvalSettings::SEND);
+
+    std::stringstream ping_logic;
+    ping_logic << "ping == " << i;
+    pong.wait(ping_logic.str(), wait_settings);
+    pong.set("pong", i, EvalSettings::SEND);
+
+    std::stringstream pong_logic;
+    pong_logic << "pong == " << i;
+    if (ping.wait(pong_logic.str(), wait_settings).is_true())
+    {
+      ++completed;
+    }
+  }
+
+  int64_t elapsed = utility::get_time() - start;
+
+  TEST_EQ(completed, iterations);
+
+  std::cerr << "  " << completed << " round trips in " << elapsed / 1000
+            << " us (" << (completed ? elapsed / (int64_t)completed : 0)
+            << " ns per round trip)\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+#ifndef _MADARA_NO_KARL_
+  test_delivery();
+  test_wraparound();
+  test_detach();
+  test_latency();
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "This test is disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
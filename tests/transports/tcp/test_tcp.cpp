@@ -0,0 +1,200 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../../test.h"
+
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+std::string host1("127.0.0.1:40100");
+std::string host2("127.0.0.1:40101");
+size_t iterations = 10000;
+size_t payload_size = 1000;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-n" || arg1 == "--iterations")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> iterations;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--payload")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> payload_size;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests the TCP transport by connecting two knowledge bases\n"
+          "  over localhost and measuring throughput.\n\n"
+          " [-n|--iterations num]    number of updates to send\n"
+          " [-p|--payload bytes]     size of the string sent with each update\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+transport::QoSTransportSettings make_settings(
+    const std::string& self, const std::string& peer)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::TCP;
+  settings.hosts.push_back(self);
+  settings.hosts.push_back(peer);
+  settings.queue_length = 10000000;
+  return settings;
+}
+
+/**
+ * Sends a marker until the receiver sees it, which proves the outgoing
+ * connection from sender to receiver is established
+ **/
+bool wait_for_connection(KnowledgeBase& sender, KnowledgeBase& receiver)
+{
+  for (Integer i = 1; i <= 50; ++i)
+  {
+    sender.set("connected", i, EvalSettings::SEND);
+    utility::sleep(0.1);
+
+    if (receiver.get("connected").to_integer() > 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void test_delivery(void)
+{
+  std::cerr << "Testing TCP delivery\n";
+
+  KnowledgeBase sender("", make_settings(host1, host2));
+  KnowledgeBase receiver("", make_settings(host2, host1));
+
+  TEST_EQ(wait_for_connection(sender, receiver), true);
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 5;
+  wait_settings.poll_frequency = -1;
+
+  // larger than max_fragment_size, which TCP framing does not need
+  sender.set("var1", Integer(42), EvalSettings::SEND);
+  sender.set("var2", std::vector<double>(20000, 3.5), EvalSettings::SEND);
+  sender.set("done", Integer(1), EvalSettings::SEND);
+
+  // streams are ordered, so done arrives last
+  receiver.wait("done == 1", wait_settings);
+
+  TEST_EQ(receiver.get("var1").to_integer(), (Integer)42);
+  TEST_EQ(receiver.get("var2").size(), (size_t)20000);
+  TEST_EQ(receiver.get("var2").retrieve_index(19999).to_double(), 3.5);
+}
+
+void test_throughput(void)
+{
+  std::cerr << "Testing TCP throughput\n";
+
+  KnowledgeBase sender("", make_settings(host1, host2));
+  KnowledgeBase receiver("", make_settings(host2, host1));
+
+  TEST_EQ(wait_for_connection(sender, receiver), true);
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 30;
+  wait_settings.poll_frequency = -1;
+
+  std::string payload(payload_size, 'x');
+
+  int64_t start = utility::get_time();
+
+  for (Integer i = 1; i <= (Integer)iterations; ++i)
+  {
+    sender.set("payload", payload);
+    sender.set("counter", i, EvalSettings::SEND);
+  }
+
+  std::stringstream logic;
+  logic << "counter == " << iterations;
+  receiver.wait(logic.str(), wait_settings);
+
+  int64_t elapsed = utility::get_time() - start;
+
+  TEST_EQ(receiver.get("counter").to_integer(), (Integer)iterations);
+  TEST_EQ(receiver.get("payload").to_string(), payload);
+
+  double seconds = elapsed / 1000000000.0;
+
+  std::cerr << "  " << iterations << " updates of " << payload_size
+            << " bytes in " << seconds << " s ("
+            << (seconds > 0 ? iterations / seconds : 0) << " updates/s)\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+#ifndef _MADARA_NO_KARL_
+  test_delivery();
+  test_throughput();
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "This test is disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,325 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+namespace transport = madara::transport;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+size_t updates = 200;
+double producer_hertz = 1000;
+double cap_hertz = 20;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-n" || arg1 == "--updates")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> updates;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--producer-hertz")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> producer_hertz;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-c" || arg1 == "--cap-hertz")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> cap_hertz;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests capping and coalescing the sends of variables.\n\n"
+          " [-n|--updates num]       updates made by the fast producer\n"
+          "                          (default 200)\n"
+          " [-p|--producer-hertz hz] rate of the fast producer\n"
+          "                          (default 1000)\n"
+          " [-c|--cap-hertz hz]      send cap of the fast producer\n"
+          "                          (default 20)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/**
+ * Transport that counts what it is asked to send
+ **/
+class CaptureTransport : public transport::Base
+{
+public:
+  CaptureTransport(const std::string& id,
+      transport::TransportSettings& settings, KnowledgeBase& kb)
+    : transport::Base(id, settings, kb.get_context())
+  {
+  }
+
+  long send_data(const KnowledgeMap& updates) override
+  {
+    for (const auto& update : updates)
+    {
+      ++counts[update.first];
+      latest[update.first] = update.second;
+    }
+
+    return 0;
+  }
+
+  std::map<std::string, size_t> counts;
+  KnowledgeMap latest;
+};
+
+void test_coalescing(void)
+{
+  std::cerr << "Testing capped variables are coalesced\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+  std::map<std::string, bool> all;
+
+  kb.set_send_rate("imu.", 10);
+
+  kb.set("imu.x", Integer(1));
+  kb.set("status", Integer(1));
+
+  KnowledgeMap sent = context.get_modifieds_current(all, true);
+  TEST_EQ(sent.size(), (size_t)2);
+
+  kb.set("imu.x", Integer(2));
+  kb.set("imu.x", Integer(3));
+  kb.set("status", Integer(2));
+
+  // the capped variable is held back, but stays modified
+  sent = context.get_modifieds_current(all, false);
+  TEST_EQ(sent.size(), (size_t)1);
+  sent = context.get_modifieds_current(all, true);
+  TEST_EQ(sent.size(), (size_t)1);
+  TEST_EQ(sent.count("status"), (size_t)1);
+  TEST_EQ(context.get_modifieds().size(), (size_t)1);
+
+  // send lists respect the caps too
+  std::map<std::string, bool> imu_only = {{"imu.x", true}};
+  TEST_EQ(context.get_modifieds_current(imu_only, true).size(), (size_t)0);
+
+  // once due, only the latest value is sent
+  utility::sleep(0.11);
+  sent = context.get_modifieds_current(all, true);
+  TEST_EQ(sent.size(), (size_t)1);
+  TEST_EQ(sent["imu.x"].to_integer(), (Integer)3);
+  TEST_EQ(context.get_modifieds().size(), (size_t)0);
+
+  kb.clear_send_rates();
+  kb.set("imu.x", Integer(4));
+  TEST_EQ(context.get_modifieds_current(all, true).size(), (size_t)1);
+}
+
+void test_prefixes(void)
+{
+  std::cerr << "Testing the longest prefix decides the cap\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+  std::map<std::string, bool> all;
+
+  kb.set_send_rate("", 1);
+  kb.set_send_rate("imu.", 1);
+  kb.set_send_rate("imu.fast.", 1000000);
+  kb.set_send_rate("imu.slow", 1);
+
+  kb.set("imu.fast.x", Integer(1));
+  kb.set("imu.slow", Integer(1));
+  kb.set("imu.x", Integer(1));
+  kb.set("other", Integer(1));
+  TEST_EQ(context.get_modifieds_current(all, true).size(), (size_t)4);
+
+  utility::sleep(0.001);
+
+  kb.set("imu.fast.x", Integer(2));
+  kb.set("imu.slow", Integer(2));
+  kb.set("imu.x", Integer(2));
+  kb.set("other", Integer(2));
+
+  KnowledgeMap sent = context.get_modifieds_current(all, true);
+  TEST_EQ(sent.size(), (size_t)1);
+  TEST_EQ(sent.count("imu.fast.x"), (size_t)1);
+
+  // removing a cap falls back to the next longest prefix
+  kb.set_send_rate("imu.fast.", 0);
+  kb.set_send_rate("", 0);
+  kb.set("imu.fast.x", Integer(3));
+
+  sent = context.get_modifieds_current(all, true);
+  TEST_EQ(sent.size(), (size_t)1);
+  TEST_EQ(sent.count("other"), (size_t)1);
+}
+
+void test_flush(void)
+{
+  std::cerr << "Testing held variables are flushed without a send\n";
+
+  KnowledgeBase kb;
+  transport::TransportSettings settings;
+  CaptureTransport* capture = new CaptureTransport("capture", settings, kb);
+  kb.attach_transport(capture);
+
+  kb.set_send_rate("imu.", 10);
+
+  EvalSettings send;
+  send.delay_sending_modifieds = false;
+
+  kb.set("imu.x", Integer(1), send);
+  kb.set("imu.x", Integer(2), send);
+  kb.set("imu.x", Integer(3), send);
+
+  // changes the user has not sent yet are left for them to send
+  kb.set("status", Integer(1));
+
+  TEST_EQ(capture->counts["imu.x"], (size_t)1);
+
+  utility::sleep(0.2);
+
+  TEST_EQ(capture->counts["imu.x"], (size_t)2);
+  TEST_EQ(capture->latest["imu.x"].to_integer(), (Integer)3);
+  TEST_EQ(capture->counts["status"], (size_t)0);
+  TEST_EQ(kb.get_context().get_modifieds().size(), (size_t)1);
+
+  // nothing more is sent once the held value is flushed
+  utility::sleep(0.2);
+  TEST_EQ(capture->counts["imu.x"], (size_t)2);
+}
+
+void test_evaluate_while_flushing(void)
+{
+  std::cerr << "Testing evaluate does not deadlock with the send thread\n";
+
+  KnowledgeBase kb;
+  transport::TransportSettings settings;
+  CaptureTransport* capture = new CaptureTransport("capture", settings, kb);
+  kb.attach_transport(capture);
+
+  // a high cap wakes the send thread often while evaluate holds the
+  // context and sends
+  kb.set_send_rate("imu.", 10000);
+
+  CompiledExpression expression = kb.compile("imu.x = .i");
+
+  for (Integer i = 0; i < 20000; ++i)
+  {
+    kb.set(".i", i);
+    kb.evaluate(expression, EvalSettings::SEND);
+  }
+
+  utility::sleep(0.01);
+
+  TEST_GE(capture->counts["imu.x"], (size_t)1);
+  TEST_EQ(capture->latest["imu.x"].to_integer(), (Integer)19999);
+}
+
+void test_producer(void)
+{
+  std::cerr << "Sending " << updates << " updates at " << producer_hertz
+            << " hz capped at " << cap_hertz << " hz\n";
+
+  KnowledgeBase kb;
+  transport::TransportSettings settings;
+  CaptureTransport* capture = new CaptureTransport("capture", settings, kb);
+  kb.attach_transport(capture);
+
+  kb.set_send_rate("imu.", cap_hertz);
+
+  EvalSettings send;
+  send.delay_sending_modifieds = false;
+
+  size_t commands = 0;
+  uint64_t start = utility::get_time();
+
+  for (size_t i = 0; i < updates; ++i)
+  {
+    kb.set("imu.x", Integer(i), send);
+
+    // a low rate command that must not be held back
+    if (i % 20 == 0)
+    {
+      kb.set("cmd", Integer(i), send);
+      ++commands;
+    }
+
+    utility::sleep(1.0 / producer_hertz);
+  }
+
+  double elapsed = (utility::get_time() - start) / 1000000000.0;
+
+  // the final value is flushed by the send thread once due
+  utility::sleep(2.0 / cap_hertz);
+
+  size_t allowed = (size_t)(elapsed * cap_hertz) + 2;
+
+  TEST_EQ(capture->counts["cmd"], commands);
+  TEST_LE(capture->counts["imu.x"], allowed);
+  TEST_GE(capture->counts["imu.x"], (size_t)2);
+  TEST_EQ(capture->latest["imu.x"].to_integer(), (Integer)(updates - 1));
+
+  std::cerr << "  imu.x sent " << capture->counts["imu.x"] << " of "
+            << updates << " updates in " << elapsed << " s, cmd sent "
+            << capture->counts["cmd"] << " of " << commands << "\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_coalescing();
+  test_prefixes();
+  test_flush();
+  test_evaluate_while_flushing();
+  test_producer();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
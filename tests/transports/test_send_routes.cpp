@@ -0,0 +1,328 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/PrefixRoutes.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+namespace transport = madara::transport;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+size_t variables = 10000;
+size_t routes = 4;
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-n" || arg1 == "--variables")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> variables;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-r" || arg1 == "--routes")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> routes;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests and times routing modifieds to transports by prefix.\n\n"
+          " [-n|--variables num]     modified variables in the timed sends\n"
+          "                          (default 10000)\n"
+          " [-r|--routes num]        routed transports in the timed sends\n"
+          "                          (default 4)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/**
+ * Transport that keeps what it is asked to send
+ **/
+class CaptureTransport : public transport::Base
+{
+public:
+  CaptureTransport(const std::string& id,
+      transport::TransportSettings& settings, KnowledgeBase& kb)
+    : transport::Base(id, settings, kb.get_context())
+  {
+  }
+
+  long send_data(const KnowledgeMap& updates) override
+  {
+    sends.push_back(updates);
+    return 0;
+  }
+
+  std::vector<KnowledgeMap> sends;
+};
+
+void test_routes(void)
+{
+  std::cerr << "Testing compiled prefix routes\n";
+
+  transport::PrefixRoutes routes;
+  routes.add(0, {"agent."});
+  routes.add(1, {"agent.0.", "cmd."});
+  routes.add(2, {});
+  routes.add(3, {"agent.0.", "agent.0.pos", "b"});
+  routes.compile();
+
+  TEST_EQ(routes.empty(), false);
+  TEST_EQ(routes.is_routed(0), true);
+  TEST_EQ(routes.is_routed(2), false);
+  TEST_EQ(routes.is_routed(4), false);
+
+  const transport::PrefixRoutes::Transports* found =
+      routes.match("agent.0.pos");
+  TEST_EQ(found != nullptr, true);
+  TEST_EQ(found->size(), (size_t)3);
+
+  // nested prefixes inherit the transports of shorter ones
+  found = routes.match("agent.0.vel");
+  TEST_EQ(found != nullptr, true);
+  TEST_EQ(found->size(), (size_t)3);
+
+  // a sibling between the key and its prefix is skipped
+  found = routes.match("agent.1.pos");
+  TEST_EQ(found != nullptr, true);
+  TEST_EQ(found->size(), (size_t)1);
+  TEST_EQ((*found)[0], (size_t)0);
+
+  found = routes.match("cmd.go");
+  TEST_EQ(found != nullptr, true);
+  TEST_EQ((*found)[0], (size_t)1);
+
+  TEST_EQ(routes.match("agent") == nullptr, true);
+  TEST_EQ(routes.match("a") == nullptr, true);
+  TEST_EQ(routes.match("zzz") == nullptr, true);
+  TEST_EQ(routes.match("bz") != nullptr, true);
+
+  KnowledgeMap modifieds;
+  modifieds["agent.0.pos"] = KnowledgeRecord(Integer(1));
+  modifieds["agent.1.pos"] = KnowledgeRecord(Integer(2));
+  modifieds["cmd.go"] = KnowledgeRecord(Integer(3));
+  modifieds["other"] = KnowledgeRecord(Integer(4));
+
+  std::vector<KnowledgeMap> partitions;
+  routes.partition(modifieds, partitions);
+
+  TEST_EQ(partitions.size(), (size_t)4);
+  TEST_EQ(partitions[0].size(), (size_t)2);
+  TEST_EQ(partitions[1].size(), (size_t)2);
+  TEST_EQ(partitions[2].size(), (size_t)0);
+  TEST_EQ(partitions[3].size(), (size_t)1);
+
+  routes.clear();
+  routes.compile();
+  TEST_EQ(routes.empty(), true);
+}
+
+void test_send_modifieds(void)
+{
+  std::cerr << "Testing send_modifieds with routed transports\n";
+
+  KnowledgeBase kb;
+
+  transport::TransportSettings telemetry_settings;
+  telemetry_settings.send_prefixes = {"agent.0.", "sensors."};
+  transport::TransportSettings command_settings;
+  command_settings.send_prefixes = {"cmd."};
+  transport::TransportSettings all_settings;
+
+  CaptureTransport* telemetry =
+      new CaptureTransport("telemetry", telemetry_settings, kb);
+  CaptureTransport* commands =
+      new CaptureTransport("commands", command_settings, kb);
+  CaptureTransport* all = new CaptureTransport("all", all_settings, kb);
+
+  kb.attach_transport(telemetry);
+  kb.attach_transport(commands);
+  kb.attach_transport(all);
+
+  kb.set("agent.0.pos", Integer(1));
+  kb.set("sensors.imu", 2.5);
+  kb.set("other", Integer(3));
+  kb.send_modifieds();
+
+  TEST_EQ(telemetry->sends.size(), (size_t)1);
+  TEST_EQ(telemetry->sends[0].size(), (size_t)2);
+  TEST_EQ(telemetry->sends[0].count("other"), (size_t)0);
+
+  // transports are not called when none of their prefixes changed
+  TEST_EQ(commands->sends.size(), (size_t)0);
+
+  TEST_EQ(all->sends.size(), (size_t)1);
+  TEST_EQ(all->sends[0].size(), (size_t)3);
+
+  kb.set("cmd.go", Integer(1));
+  kb.send_modifieds();
+
+  TEST_EQ(telemetry->sends.size(), (size_t)1);
+  TEST_EQ(commands->sends.size(), (size_t)1);
+  TEST_EQ(commands->sends[0].begin()->first, std::string("cmd.go"));
+  TEST_EQ(all->sends.size(), (size_t)2);
+
+  // removing a transport recompiles the routes of the others
+  kb.remove_transport(0);
+  kb.set("sensors.imu", 3.5);
+  kb.set("cmd.stop", Integer(1));
+  kb.send_modifieds();
+
+  TEST_EQ(commands->sends.size(), (size_t)2);
+  TEST_EQ(commands->sends[1].size(), (size_t)1);
+  TEST_EQ(all->sends.size(), (size_t)3);
+  TEST_EQ(all->sends[2].size(), (size_t)2);
+}
+
+void test_send_list(void)
+{
+  std::cerr << "Testing modifieds limited by send lists\n";
+
+  KnowledgeBase kb;
+  ThreadSafeContext& context = kb.get_context();
+
+  kb.set("a", Integer(1));
+  kb.set("b", Integer(2));
+  kb.set("c", Integer(3));
+
+  std::map<std::string, bool> none;
+  std::map<std::string, bool> send_list = {{"b", true}};
+  std::map<std::string, bool> long_list = {
+      {"a", true}, {"c", true}, {"d", true}, {"e", true}};
+
+  // peeking leaves the modifieds in place
+  TEST_EQ(context.get_modifieds_current(none, false).size(), (size_t)3);
+  TEST_EQ(context.get_modifieds_current(send_list, false).size(), (size_t)1);
+  TEST_EQ(context.get_modifieds_current(long_list, false).size(), (size_t)2);
+  TEST_EQ(context.get_modifieds().size(), (size_t)3);
+
+  TEST_EQ(context.get_modifieds_current(send_list, true).size(), (size_t)1);
+  TEST_EQ(context.get_modifieds().size(), (size_t)2);
+  TEST_EQ(context.get_modifieds_current(long_list, true).size(), (size_t)2);
+  TEST_EQ(context.get_modifieds().size(), (size_t)0);
+}
+
+void test_timing(void)
+{
+  std::cerr << "Timing " << variables << " modifieds sent to " << routes
+            << " routed transports\n";
+
+  KnowledgeMap modifieds;
+  std::vector<std::vector<std::string>> prefixes(routes);
+
+  for (size_t i = 0; i < variables; ++i)
+  {
+    std::stringstream buffer;
+    buffer << "agent." << i % 100 << ".var" << i;
+    modifieds[buffer.str()] = KnowledgeRecord(Integer(i));
+  }
+
+  // the agents are split evenly between the transports
+  for (size_t i = 0; i < 100; ++i)
+  {
+    std::stringstream buffer;
+    buffer << "agent." << i << ".";
+    prefixes[i % routes].push_back(buffer.str());
+  }
+
+  transport::PrefixRoutes compiled;
+  for (size_t i = 0; i < routes; ++i)
+  {
+    compiled.add(i, prefixes[i]);
+  }
+  compiled.compile();
+
+  // each transport scanning the full set for its prefixes
+  uint64_t start = utility::get_time();
+  std::vector<KnowledgeMap> scanned(routes);
+  for (size_t i = 0; i < routes; ++i)
+  {
+    for (const auto& modified : modifieds)
+    {
+      for (const std::string& prefix : prefixes[i])
+      {
+        if (utility::begins_with(modified.first, prefix))
+        {
+          scanned[i].emplace_hint(
+              scanned[i].end(), modified.first, modified.second);
+          break;
+        }
+      }
+    }
+  }
+  uint64_t scan_time = utility::get_time() - start;
+
+  start = utility::get_time();
+  std::vector<KnowledgeMap> partitions;
+  compiled.partition(modifieds, partitions);
+  uint64_t partition_time = utility::get_time() - start;
+
+  size_t scanned_total = 0;
+  size_t partitioned_total = 0;
+  for (size_t i = 0; i < routes; ++i)
+  {
+    scanned_total += scanned[i].size();
+    partitioned_total += partitions[i].size();
+  }
+
+  TEST_EQ(scanned_total, variables);
+  TEST_EQ(partitioned_total, variables);
+
+  std::cerr << "  us to route: " << scan_time / 1000
+            << " scanning per transport, " << partition_time / 1000
+            << " partitioning once\n";
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_routes();
+  test_send_modifieds();
+  test_send_list();
+  test_timing();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,363 @@
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string.h>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/ArrayDelta.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../../test.h"
+
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+std::string host1("127.0.0.1:43122");
+std::string host2("127.0.0.1:43123");
+size_t array_size = 50000;
+size_t changes = 10;
+Integer rounds = 20;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-s" || arg1 == "--size")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> array_size;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-c" || arg1 == "--changes")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> changes;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-r" || arg1 == "--rounds")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> rounds;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests sending the changed elements of large arrays between\n"
+          "  two knowledge bases, and reports the bytes sent with and\n"
+          "  without array deltas.\n\n"
+          " [-s|--size elements]     the number of doubles in the array\n"
+          " [-c|--changes elements]  the elements changed in each round\n"
+          " [-r|--rounds rounds]     the number of rounds of changes\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+void test_ranges(void)
+{
+  std::cerr << "Testing ranges of changed elements\n";
+
+  ArrayDelta::Ranges ranges;
+
+  ArrayDelta::add_index(ranges, 5);
+  ArrayDelta::add_index(ranges, 7);
+  ArrayDelta::add_index(ranges, 5);
+  ArrayDelta::add_index(ranges, 1);
+
+  TEST_EQ(ranges.size(), (size_t)3);
+
+  // 6 joins the ranges of 5 and 7
+  ArrayDelta::add_index(ranges, 6);
+  ArrayDelta::add_index(ranges, 0);
+
+  TEST_EQ(ranges.size(), (size_t)2);
+  TEST_EQ(ranges[0].first, (uint32_t)0);
+  TEST_EQ(ranges[0].second, (uint32_t)2);
+  TEST_EQ(ranges[1].first, (uint32_t)5);
+  TEST_EQ(ranges[1].second, (uint32_t)3);
+  TEST_EQ(ArrayDelta::count(ranges), (size_t)5);
+}
+
+void test_encoding(void)
+{
+  std::cerr << "Testing encoding of array deltas\n";
+
+  KnowledgeRecord base(std::vector<Integer>{1, 2, 3, 4, 5, 6});
+  KnowledgeRecord changed(base);
+  changed.set_index(1, Integer(20));
+  changed.set_index(4, Integer(-50));
+  changed.set_toi(1234);
+
+  ArrayDelta delta;
+  delta.type = KnowledgeRecord::INTEGER_ARRAY;
+  delta.size = 6;
+  delta.base_toi = 42;
+  delta.toi = changed.toi();
+  ArrayDelta::add_index(delta.ranges, 1);
+  ArrayDelta::add_index(delta.ranges, 4);
+
+  std::vector<char> buffer(1000);
+  int64_t buffer_remaining = buffer.size();
+
+  char* end = delta.write(buffer.data(), "values", changed, buffer_remaining);
+
+  TEST_EQ((int64_t)(end - buffer.data()), delta.get_encoded_size("values"));
+  TEST_EQ(ArrayDelta::is_delta(buffer.data(), end - buffer.data()), true);
+
+  ArrayDelta received;
+  std::string key;
+  buffer_remaining = end - buffer.data();
+
+  received.read(buffer.data(), key, buffer_remaining);
+
+  TEST_EQ(buffer_remaining, (int64_t)0);
+  TEST_EQ(key, "values");
+  TEST_EQ(received.base_toi, (uint64_t)42);
+  TEST_EQ(received.toi, (uint64_t)1234);
+  TEST_EQ(received.values.size(), (size_t)2);
+
+  KnowledgeRecord result(std::vector<Integer>{1, 2, 3, 4, 5, 6});
+
+  TEST_EQ(received.patch(result), true);
+  TEST_EQ(result.to_string(), changed.to_string());
+
+  // an array of another size is not the one the delta was made from
+  KnowledgeRecord resized(std::vector<Integer>{1, 2, 3});
+
+  TEST_EQ(received.patch(resized), false);
+
+  // a full record is not a delta
+  buffer_remaining = buffer.size();
+  end = base.write(buffer.data(), "values", buffer_remaining);
+
+  TEST_EQ(ArrayDelta::is_delta(buffer.data(), end - buffer.data()), false);
+}
+
+void test_context_apply(void)
+{
+  std::cerr << "Testing deltas applied to a context in place\n";
+
+  ThreadSafeContext context;
+
+  ArrayDelta delta;
+  delta.type = KnowledgeRecord::DOUBLE_ARRAY;
+  delta.size = 4;
+  delta.base_toi = 100;
+  delta.toi = 200;
+  ArrayDelta::add_index(delta.ranges, 2);
+
+  double value = 7.5;
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  delta.values.push_back(bits);
+
+  context.set("samples", std::vector<double>(4, 0.5));
+
+  // without a full update from the sender, there is no base
+  TEST_EQ(context.apply_array_delta("samples", delta, 0, 10, 1000), -4);
+
+  context.set_array_delta_base("samples", 100);
+
+  TEST_EQ(context.apply_array_delta("samples", delta, 0, 10, 1000), 1);
+  TEST_EQ(context.get("samples").retrieve_index(2).to_double(), 7.5);
+  TEST_EQ(context.get("samples").toi(), (uint64_t)1000);
+
+  // the next delta must be made from the one just applied
+  TEST_EQ(context.apply_array_delta("samples", delta, 0, 20, 2000), -4);
+
+  delta.base_toi = 200;
+  delta.toi = 300;
+
+  // a local change means the array is not the base of the delta
+  context.set_index("samples", 0, 1.0);
+  TEST_EQ(context.apply_array_delta("samples", delta, 0, 20, 2000), -4);
+}
+
+transport::TransportSettings make_settings(
+    const std::string& self, const std::string& peer, bool deltas,
+    uint32_t full_interval = 100)
+{
+  transport::TransportSettings settings;
+  settings.type = transport::UDP;
+  settings.hosts.push_back(self);
+  settings.hosts.push_back(peer);
+  settings.queue_length = 10000000;
+  settings.send_array_deltas = deltas;
+  settings.array_delta_full_interval = full_interval;
+  return settings;
+}
+
+/**
+ * Sends rounds of sparse changes to a large array
+ * @return  the bytes sent after the first full update
+ **/
+int64_t test_sparse_updates(bool deltas)
+{
+  std::cerr << "Testing sparse array updates "
+            << (deltas ? "with" : "without") << " deltas\n";
+
+  KnowledgeBase sender("", make_settings(host1, host2, deltas));
+  KnowledgeBase receiver("", make_settings(host2, host1, false));
+
+  utility::Metrics::Counter& sent_bytes =
+      sender.get_context().get_metrics().counter("transport.sent_bytes");
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 10;
+  wait_settings.poll_frequency = -1;
+
+  sender.set("samples", std::vector<double>(array_size, 0.5),
+      EvalSettings::DELAY);
+  sender.set("ready", Integer(1), EvalSettings::SEND);
+
+  receiver.wait("ready", wait_settings);
+
+  int64_t initial_bytes = sent_bytes.get();
+  bool matched = true;
+
+  for (Integer round = 1; round <= rounds; ++round)
+  {
+    for (size_t i = 0; i < changes; ++i)
+    {
+      size_t index = (round * 7919 + i * 104729) % array_size;
+      sender.set_index(
+          "samples", index, round + i * 0.25, EvalSettings::DELAY);
+    }
+
+    sender.set("round", round, EvalSettings::SEND);
+
+    std::stringstream logic;
+    logic << "round == " << round;
+    receiver.wait(logic.str(), wait_settings);
+
+    matched = matched && receiver.get("samples").to_string() ==
+                             sender.get("samples").to_string();
+  }
+
+  TEST_EQ(matched, true);
+
+  int64_t bytes = sent_bytes.get() - initial_bytes;
+
+  std::cerr << "  " << bytes / rounds << " bytes per round\n";
+
+  return bytes;
+}
+
+void test_recovery(void)
+{
+  std::cerr << "Testing recovery of a receiver that missed an update\n";
+
+  KnowledgeBase sender("", make_settings(host1, host2, true, 5));
+  KnowledgeBase receiver("", make_settings(host2, host1, false));
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 10;
+  wait_settings.poll_frequency = -1;
+
+  EvalSettings local;
+  local.treat_globals_as_locals = true;
+
+  sender.set("samples", std::vector<double>(1000, 0.5), EvalSettings::DELAY);
+  sender.set("ready", Integer(1), EvalSettings::SEND);
+
+  receiver.wait("ready", wait_settings);
+
+  // the receiver's copy no longer matches the base of the next deltas
+  receiver.set_index("samples", 999, 7.0, local);
+
+  Integer recovered = 0;
+
+  for (Integer round = 1; round <= 10 && recovered == 0; ++round)
+  {
+    sender.set_index("samples", round, 1.0 * round, EvalSettings::DELAY);
+    sender.set("round", round, EvalSettings::SEND);
+
+    std::stringstream logic;
+    logic << "round == " << round;
+    receiver.wait(logic.str(), wait_settings);
+
+    if (receiver.get("samples").to_string() ==
+        sender.get("samples").to_string())
+    {
+      recovered = round;
+    }
+  }
+
+  // dropped deltas are replaced by the next full update, which follows
+  // five deltas
+  TEST_GT(recovered, (Integer)1);
+  TEST_LE(recovered, (Integer)6);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_ranges();
+  test_encoding();
+  test_context_apply();
+
+#ifndef _MADARA_NO_KARL_
+  int64_t full_bytes = test_sparse_updates(false);
+  int64_t delta_bytes = test_sparse_updates(true);
+
+  TEST_LT(delta_bytes * 10, full_bytes);
+
+  test_recovery();
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Transport tests are disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
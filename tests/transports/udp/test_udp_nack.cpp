@@ -0,0 +1,212 @@
+#include <string>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../../test.h"
+
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+std::string host1("127.0.0.1:43120");
+std::string host2("127.0.0.1:43121");
+std::string multicast("239.255.0.1:43122");
+double drop_rate = 0.2;
+size_t payload_size = 300000;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-d" || arg1 == "--drop-rate")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> drop_rate;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--payload")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> payload_size;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests recovery of dropped UDP fragments with NACKs by\n"
+          "  sending large updates between two knowledge bases.\n\n"
+          " [-d|--drop-rate rate]    rate of datagrams dropped by the sender\n"
+          " [-p|--payload bytes]     size of the string sent with each update\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+transport::QoSTransportSettings make_settings(
+    const std::string& self, const std::string& peer)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::UDP;
+  settings.hosts.push_back(self);
+  settings.hosts.push_back(peer);
+  settings.queue_length = 10000000;
+  settings.reliable_fragments = true;
+  return settings;
+}
+
+void test_nack_recovery(
+    transport::QoSTransportSettings sender_settings,
+    const transport::QoSTransportSettings& receiver_settings)
+{
+  sender_settings.update_drop_rate(
+      drop_rate, transport::PACKET_DROP_DETERMINISTIC);
+
+  KnowledgeBase sender("sender", sender_settings);
+  KnowledgeBase receiver("receiver", receiver_settings);
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 10;
+  wait_settings.poll_frequency = -1;
+
+  for (Integer i = 1; i <= 3; ++i)
+  {
+    std::string payload(payload_size, (char)('a' + i));
+
+    sender.set("payload", payload);
+    sender.set("counter", i, EvalSettings::SEND);
+
+    std::stringstream logic;
+    logic << "counter == " << i;
+    receiver.wait(logic.str(), wait_settings);
+
+    TEST_EQ(receiver.get("counter").to_integer(), i);
+    TEST_EQ(receiver.get("payload").to_string(), payload);
+  }
+}
+
+void test_udp_nack_recovery(void)
+{
+  std::cerr << "Testing recovery of dropped UDP fragments at drop rate "
+            << drop_rate << "\n";
+
+  test_nack_recovery(make_settings(host1, host2), make_settings(host2, host1));
+}
+
+void test_multicast_nack_recovery(void)
+{
+  std::cerr << "Testing recovery of dropped multicast fragments at drop rate "
+            << drop_rate << "\n";
+
+  // both peers share the group port, so NACKs must go to the group
+  transport::QoSTransportSettings settings;
+  settings.type = transport::MULTICAST;
+  settings.hosts.push_back(multicast);
+  settings.queue_length = 10000000;
+  settings.reliable_fragments = true;
+
+  test_nack_recovery(settings, settings);
+}
+
+/**
+ * Transport without datagrams of its own, which relies on prep_send drops
+ **/
+class PrepTransport : public transport::Base
+{
+public:
+  PrepTransport(const std::string& id, transport::TransportSettings& settings,
+      ThreadSafeContext& context)
+    : transport::Base(id, settings, context)
+  {
+    setup();
+  }
+
+  long send_data(const KnowledgeMap& updates) override
+  {
+    return prep_send(updates, "PrepTransport::send_data");
+  }
+};
+
+void test_other_transport_drops(void)
+{
+  std::cerr << "Testing reliable fragments keep drops of other transports\n";
+
+  KnowledgeBase kb;
+  KnowledgeMap updates;
+  updates["counter"] = KnowledgeRecord(Integer(1));
+
+  transport::QoSTransportSettings settings;
+  settings.reliable_fragments = true;
+  settings.update_drop_rate(1.0, transport::PACKET_DROP_PROBABLISTIC);
+
+  PrepTransport dropping("dropping", settings, kb.get_context());
+  TEST_EQ(dropping.send_data(updates), 0L);
+
+  settings.update_drop_rate(0.0, transport::PACKET_DROP_PROBABLISTIC);
+
+  PrepTransport sending("sending", settings, kb.get_context());
+  TEST_GT(sending.send_data(updates), 0L);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_other_transport_drops();
+
+#ifndef _MADARA_NO_KARL_
+  test_udp_nack_recovery();
+  test_multicast_nack_recovery();
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "This test is disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
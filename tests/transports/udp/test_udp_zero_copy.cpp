@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/CapnObject.h"
+#include "madara/knowledge/SharedBuffer.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../../test.h"
+
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+std::string host1("127.0.0.1:43132");
+std::string host2("127.0.0.1:43133");
+size_t scan_size = 32768;
+Integer rounds = 10;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-s" || arg1 == "--size")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> scan_size;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-r" || arg1 == "--rounds")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> rounds;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests received Cap'n Proto values that reference the receive\n"
+          "  buffer instead of copying it.\n\n"
+          " [-s|--size bytes]        the size of each message\n"
+          " [-r|--rounds rounds]     the number of messages to send\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/// a message of size bytes, filled with a pattern for round
+std::vector<char> make_scan(size_t size, Integer round)
+{
+  std::vector<char> scan(size - size % sizeof(capnp::word));
+  for (size_t i = 0; i < scan.size(); ++i)
+  {
+    scan[i] = (char)(i * 31 + round);
+  }
+  return scan;
+}
+
+bool within(const char* data, const char* buffer, size_t size)
+{
+  return data >= buffer && data < buffer + size;
+}
+
+void test_shared_buffer(void)
+{
+  std::cerr << "Testing shared buffers\n";
+
+  SharedBuffer shared(1024);
+
+  char* first = shared.prepare();
+
+  TEST_EQ((uintptr_t)first % sizeof(capnp::word), (uintptr_t)0);
+  TEST_EQ(SharedBuffer::share(first, 8) == nullptr, true);
+
+  std::shared_ptr<const char> kept;
+  {
+    SharedBuffer::Scope scope(&shared, 512);
+
+    kept = SharedBuffer::share(first + 8, 16);
+
+    TEST_EQ(kept.get() == first + 8, true);
+    TEST_EQ(SharedBuffer::share(first + 500, 16) == nullptr, true);
+  }
+
+  TEST_EQ(SharedBuffer::share(first + 8, 16) == nullptr, true);
+
+  // the first buffer is still referenced, so it is not received into
+  char* second = shared.prepare();
+  TEST_NE(second == first, true);
+
+  kept.reset();
+
+  TEST_EQ(shared.prepare() == second, true);
+}
+
+void test_record(void)
+{
+  std::cerr << "Testing records read from shared buffers\n";
+
+  std::vector<char> scan = make_scan(256, 1);
+
+  KnowledgeRecord record;
+  record.emplace_any(type<GenericCapnObject>{}, "Scan", scan.data(),
+      scan.size());
+
+  KnowledgeRecord values(std::vector<double>{1.0, 2.0});
+
+  SharedBuffer shared(4096);
+  char* buffer = shared.prepare();
+
+  // misaligns the record, which is padded to align the message
+  int64_t remaining = shared.size() - 3;
+  char* end = record.write(buffer + 3, "scan", remaining);
+  end = values.write(end, "values", remaining);
+
+  KnowledgeRecord read_record;
+  KnowledgeRecord read_values;
+  {
+    SharedBuffer::Scope scope(&shared, end - buffer);
+
+    std::string key;
+    remaining = end - buffer - 3;
+    const char* next = read_record.read(buffer + 3, key, remaining);
+    read_values.read(next, key, remaining);
+  }
+
+  {
+    const GenericCapnObject object =
+        read_record.to_any<GenericCapnObject>();
+
+    TEST_EQ(object.tag(), std::string("Scan"));
+    TEST_EQ(object.size(), scan.size());
+    TEST_EQ(within(object.data(), buffer, shared.size()), true);
+    TEST_EQ(std::equal(scan.begin(), scan.end(), object.data()), true);
+    TEST_EQ(read_values.retrieve_index(1).to_double(), 2.0);
+  }
+
+  // the doubles were copied, so the buffer is free once the record and
+  // the object are gone
+  read_record.clear_value();
+
+  TEST_EQ(shared.prepare() == buffer, true);
+}
+
+#ifndef _MADARA_NO_KARL_
+
+transport::TransportSettings make_settings(
+    const std::string& self, const std::string& peer, bool zero_copy)
+{
+  transport::TransportSettings settings;
+  settings.type = transport::UDP;
+  settings.hosts.push_back(self);
+  settings.hosts.push_back(peer);
+  settings.zero_copy_receive = zero_copy;
+  return settings;
+}
+
+void test_transport(void)
+{
+  std::cerr << "Testing zero copy receiving over UDP\n";
+
+  KnowledgeBase sender("", make_settings(host1, host2, false));
+  KnowledgeBase receiver("", make_settings(host2, host1, true));
+
+  WaitSettings wait_settings;
+  wait_settings.max_wait_time = 10;
+  wait_settings.poll_frequency = -1;
+
+  std::vector<GenericCapnObject> received;
+  bool matched = true;
+
+  for (Integer round = 1; round <= rounds; ++round)
+  {
+    std::vector<char> scan = make_scan(scan_size, round);
+
+    sender.emplace_any("scan", EvalSettings::DELAY, type<GenericCapnObject>{},
+        "Scan", scan.data(), scan.size());
+    sender.set("round", round, EvalSettings::SEND);
+
+    std::stringstream logic;
+    logic << "round == " << round;
+    receiver.wait(logic.str(), wait_settings);
+
+    const GenericCapnObject object =
+        receiver.get("scan").to_any<GenericCapnObject>();
+
+    matched = matched && object.size() == scan.size() &&
+              std::equal(scan.begin(), scan.end(), object.data()) &&
+              (uintptr_t)object.data() % sizeof(capnp::word) == 0;
+
+    received.push_back(object);
+  }
+
+  TEST_EQ(matched, true);
+  TEST_EQ(received.size(), (size_t)rounds);
+
+  // later messages were received into other buffers
+  bool kept = true;
+  for (size_t i = 0; i < received.size(); ++i)
+  {
+    std::vector<char> scan = make_scan(scan_size, (Integer)i + 1);
+    const GenericCapnObject& object = received[i];
+    kept = kept && std::equal(scan.begin(), scan.end(), object.data());
+  }
+
+  TEST_EQ(kept, true);
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_shared_buffer();
+  test_record();
+
+#ifndef _MADARA_NO_KARL_
+  test_transport();
+#else
+  madara_logger_ptr_log(madara::logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Transport tests are disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -91,6 +91,13 @@ void handle_arguments(int argc, char** argv)
     {
       settings.send_reduced_message_header = true;
     }
+    else if (arg1 == "-t" || arg1 == "--topic")
+    {
+      if (i + 1 < argc)
+        settings.zmq_topics.push_back(argv[i + 1]);
+
+      ++i;
+    }
     else
     {
       madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
@@ -115,6 +122,9 @@ void handle_arguments(int argc, char** argv)
           "detail)\n"
           " [-f|--logfile file]      log to a file\n"
           " [-r|--reduced]           use the reduced message header\n"
+          " [-t|--topic prefix]      a variable prefix to publish and "
+          "subscribe\n"
+          "                          to as a ZMQ topic (can be repeated)\n"
           "\n",
           argv[0]);
       exit(0);
@@ -0,0 +1,126 @@
+#include <string>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../../test.h"
+
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+namespace utility = madara::utility;
+
+using namespace madara;
+using namespace knowledge;
+
+typedef KnowledgeRecord::Integer Integer;
+
+std::string publisher_host("tcp://127.0.0.1:40170");
+std::string matching_host("tcp://127.0.0.1:40171");
+std::string other_host("tcp://127.0.0.1:40172");
+std::string downstream_host("tcp://127.0.0.1:40173");
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests that ZMQ subscribers only receive updates, including\n"
+          "  rebroadcasts, published under their zmq_topics.\n\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/**
+ * Settings that bind to the first host and subscribe to the rest
+ **/
+transport::QoSTransportSettings make_settings(const std::string& bind,
+    const std::string& topic, const std::string& publisher = "")
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::ZMQ;
+  settings.hosts.push_back(bind);
+
+  if (publisher != "")
+  {
+    settings.hosts.push_back(publisher);
+  }
+
+  settings.zmq_topics.push_back(topic);
+  return settings;
+}
+
+void test_topics(void)
+{
+  std::cerr << "Testing ZMQ topics for updates and rebroadcasts\n";
+
+  transport::QoSTransportSettings publisher_settings(
+      make_settings(publisher_host, "imu."));
+  publisher_settings.set_rebroadcast_ttl(2);
+
+  // the matching subscriber relays to a downstream subscriber
+  transport::QoSTransportSettings matching_settings(
+      make_settings(matching_host, "imu.", publisher_host));
+  matching_settings.enable_participant_ttl(2);
+
+  KnowledgeBase publisher("publisher", publisher_settings);
+  KnowledgeBase matching("matching", matching_settings);
+  KnowledgeBase other(
+      "other", make_settings(other_host, "gps.", publisher_host));
+  KnowledgeBase downstream(
+      "downstream", make_settings(downstream_host, "imu.", matching_host));
+
+  // resend until ZMQ has connected every subscriber
+  for (Integer i = 1; i <= 50 && !downstream.get("imu.x").is_true(); ++i)
+  {
+    publisher.set("imu.x", i, EvalSettings::SEND);
+    utility::sleep(0.1);
+  }
+
+  TEST_GT(matching.get("imu.x").to_integer(), (Integer)0);
+  TEST_GT(downstream.get("imu.x").to_integer(), (Integer)0);
+  TEST_EQ(other.get("imu.x").exists(), false);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_topics();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}